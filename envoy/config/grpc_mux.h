@@ -110,7 +110,31 @@ public:
 using GrpcMuxPtr = std::unique_ptr<GrpcMux>;
 using GrpcMuxSharedPtr = std::shared_ptr<GrpcMux>;
 
-template <class ResponseProto> using ResponseProtoPtr = std::unique_ptr<ResponseProto>;
+/**
+ * Deleter of received protos. A proto is either heap allocated, or allocated on an arena that holds
+ * nothing else and is freed along with the proto.
+ */
+template <class ResponseProto> class ResponseProtoDeleter {
+public:
+  ResponseProtoDeleter() = default;
+  // Allows taking ownership of heap allocated protos held by a std::unique_ptr.
+  ResponseProtoDeleter(std::default_delete<ResponseProto>) {} // NOLINT(google-explicit-constructor)
+  explicit ResponseProtoDeleter(std::unique_ptr<Protobuf::Arena>&& arena)
+      : arena_(std::move(arena)) {}
+
+  void operator()(ResponseProto* message) const {
+    // An arena allocated proto is freed when the deleter, and so the arena, is destroyed.
+    if (arena_ == nullptr) {
+      delete message;
+    }
+  }
+
+private:
+  std::unique_ptr<Protobuf::Arena> arena_;
+};
+
+template <class ResponseProto>
+using ResponseProtoPtr = std::unique_ptr<ResponseProto, ResponseProtoDeleter<ResponseProto>>;
 /**
  * A grouping of callbacks that a GrpcMux should provide to its GrpcStream.
  */
@@ -335,6 +335,13 @@ public:
    */
   virtual void onDatagramsDropped(uint32_t dropped) PURE;
 
+  /**
+   * Called after reading from the socket into pooled packet buffers. Does nothing by default.
+   * @param allocated supplies the number of packet buffers that had to be allocated.
+   * @param reused supplies the number of packet buffers reused from the pool.
+   */
+  virtual void onPacketBuffersAcquired(uint64_t /*allocated*/, uint64_t /*reused*/) {}
+
   /**
    * Called when the underlying socket is ready for read, before onData() is
    * called. Called only once per event loop, even if followed by multiple
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -94,6 +95,17 @@ public:
    * @return the max depth used when verifying the certificate-chain
    */
   virtual absl::optional<uint32_t> maxVerifyDepth() const PURE;
+
+  /**
+   * @return the maximum number of successfully verified certificate chains to cache, or 0 if the
+   *         results of verifications are not cached.
+   */
+  virtual uint32_t verifiedCertificateCacheMaxEntries() const PURE;
+
+  /**
+   * @return how long a successfully verified certificate chain is cached for.
+   */
+  virtual std::chrono::milliseconds verifiedCertificateCacheTtl() const PURE;
 };
 
 using CertificateValidationContextConfigPtr = std::unique_ptr<CertificateValidationContextConfig>;
@@ -18,6 +18,18 @@
 namespace Envoy {
 namespace Ssl {
 
+/**
+ * Dynamic TLS record sizing settings, see ContextConfig::dynamicRecordSizing().
+ */
+struct DynamicRecordSizing {
+  // The maximum payload size of the records written while ramping up.
+  uint32_t initial_record_size_;
+  // The number of bytes written before switching to full-sized records.
+  uint64_t ramp_up_bytes_;
+  // How long a connection must be idle for records to be small again.
+  std::chrono::milliseconds idle_timeout_;
+};
+
 /**
  * Supplies the configuration for an SSL context.
  */
@@ -111,6 +123,12 @@ public:
    * @return the access log manager object reference
    */
   virtual AccessLog::AccessLogManager& accessLogManager() const PURE;
+
+  /**
+   * @return the dynamic TLS record sizing settings, or absl::nullopt if records are always written
+   *         full-sized.
+   */
+  virtual absl::optional<DynamicRecordSizing> dynamicRecordSizing() const PURE;
 };
 
 class ClientContextConfig : public virtual ContextConfig {
@@ -4,10 +4,12 @@
 
 #include "envoy/common/time.h"
 #include "envoy/config/typed_config.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
 #include "envoy/ssl/private_key/private_key.h"
 #include "envoy/stats/scope.h"
+#include "envoy/thread/thread.h"
 
 namespace Envoy {
 namespace Ssl {
@@ -32,6 +34,44 @@ public:
   createSslServerContext(Stats::Scope& scope, const ServerContextConfig& config,
                          const std::vector<std::string>& server_names) PURE;
 
+  using ServerContextCb = std::function<void(ServerContextSharedPtr)>;
+
+  /**
+   * Builds a ServerContext from a ServerContextConfig and hands it to the supplied callback. If a
+   * server context batch is open (see startServerContextBatch()) the build is deferred until the
+   * batch is finished; otherwise the context is built and the callback invoked before returning.
+   * The callback is invoked with nullptr if the config is not ready. The config, the scope and the
+   * callback target must outlive the batch, unless it is cancelled.
+   */
+  virtual void createSslServerContextDeferred(Stats::Scope& scope,
+                                              const ServerContextConfig& config,
+                                              const std::vector<std::string>& server_names,
+                                              ServerContextCb cb) PURE;
+
+  /**
+   * Opens a batch in which calls to createSslServerContextDeferred() are queued rather than built
+   * immediately. Batches do not nest.
+   */
+  virtual void startServerContextBatch() PURE;
+
+  /**
+   * Builds all of the server contexts queued since startServerContextBatch(), using up to
+   * max_threads threads, then invokes their callbacks on the calling thread in the order they were
+   * queued. If any context fails to build, the callbacks of the contexts that were built are still
+   * invoked, and the first error in queue order is then rethrown as it was thrown by the build.
+   * @param thread_factory supplies the threads used for the build.
+   * @param max_threads supplies the maximum number of threads, including the calling thread.
+   */
+  virtual void finishServerContextBatch(Thread::ThreadFactory& thread_factory,
+                                        uint32_t max_threads) PURE;
+
+  /**
+   * Closes the batch and drops the server contexts queued since startServerContextBatch() without
+   * building them or invoking their callbacks, whose targets may already be destroyed when cleaning
+   * up after a failure. This is a no-op if no batch is open. It does not throw.
+   */
+  virtual void cancelServerContextBatch() PURE;
+
   /**
    * @return the number of days until the next certificate being managed will expire, the value is
    * set when not expired.
@@ -66,7 +106,8 @@ using ContextManagerPtr = std::unique_ptr<ContextManager>;
 class ContextManagerFactory : public Config::UntypedFactory {
 public:
   ~ContextManagerFactory() override = default;
-  virtual ContextManagerPtr createContextManager(TimeSource& time_source) PURE;
+  virtual ContextManagerPtr createContextManager(TimeSource& time_source,
+                                                 Runtime::Loader& runtime) PURE;
 
   // There could be only one factory thus the name is static.
   std::string name() const override { return "ssl_context_manager"; }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
@@ -84,6 +85,58 @@ public:
   virtual StatMapPtr latch() PURE;
 };
 
+/**
+ * Estimate of the response time of a host, used by latency aware load balancing. The estimate is a
+ * peak sensitive exponentially weighted moving average (EWMA): a sample larger than the current
+ * estimate replaces it, while smaller samples are blended in with a weight that grows with the time
+ * elapsed since the previous sample. Implementations must be thread safe since samples are recorded
+ * by every worker.
+ */
+class ResponseTimeEstimator {
+public:
+  virtual ~ResponseTimeEstimator() = default;
+
+  /**
+   * Record an observed response time.
+   * @param response_time supplies the time between the end of the downstream request and the end
+   *        of the upstream response.
+   */
+  virtual void add(std::chrono::milliseconds response_time) PURE;
+
+  /**
+   * @return the current estimate in milliseconds, decayed to the current time. Returns 0 if no
+   *         response time was ever recorded.
+   */
+  virtual double estimate() const PURE;
+};
+
+/**
+ * Utilization based weight of a host, derived from the ORCA load reports the host attaches to its
+ * responses. Implementations must be thread safe since reports are recorded by every worker.
+ */
+class UtilizationWeight {
+public:
+  virtual ~UtilizationWeight() = default;
+
+  /**
+   * Record a load report. Reports without a positive request rate and utilization are ignored.
+   * @param rps supplies the requests per second served by the host.
+   * @param utilization supplies the utilization of the host.
+   */
+  virtual void update(double rps, double utilization) PURE;
+
+  /**
+   * @param blackout_period supplies how long the host must have been reporting load before its
+   *        weight is used.
+   * @param expiration_period supplies how long the last report is valid for. Once it expires, the
+   *        blackout period starts over with the next report, so this is not const.
+   * @return the weight of the host, i.e. rps / utilization of the most recent load report, or 0
+   *         if the host has no usable weight.
+   */
+  virtual double weight(std::chrono::milliseconds blackout_period,
+                        std::chrono::milliseconds expiration_period) PURE;
+};
+
 class ClusterInfo;
 
 /**
@@ -171,6 +224,16 @@ public:
    */
   virtual LoadMetricStats& loadMetricStats() const PURE;
 
+  /**
+   * @return the response time estimate of the host.
+   */
+  virtual ResponseTimeEstimator& responseTimeEstimator() const PURE;
+
+  /**
+   * @return the utilization based weight of the host.
+   */
+  virtual UtilizationWeight& utilizationWeight() const PURE;
+
   /**
    * @return the locality of the host (deployment specific). This will be the default instance if
    *         unknown.
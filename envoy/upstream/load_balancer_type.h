@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <set>
 #include <string>
 #include <vector>
@@ -23,7 +24,9 @@ enum class LoadBalancerType {
   OriginalDst,
   Maglev,
   ClusterProvided,
-  LoadBalancingPolicyConfig
+  LoadBalancingPolicyConfig,
+  PeakEwma,
+  OrcaWeightedRoundRobin
 };
 
 /**
@@ -115,6 +118,17 @@ public:
    * elements in a list value defined in endpoint metadata.
    */
   virtual bool listAsAny() const PURE;
+
+  /*
+   * @return bool whether subsets should only be created when a request selects them.
+   */
+  virtual bool lazySubsetCreation() const PURE;
+
+  /*
+   * @return std::chrono::milliseconds how long a lazily created subset may go without being
+   * selected before it is removed.
+   */
+  virtual std::chrono::milliseconds lazySubsetIdleTimeout() const PURE;
 };
 
 } // namespace Upstream
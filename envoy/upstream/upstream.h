@@ -576,6 +576,8 @@ public:
   COUNTER(upstream_cx_none_healthy)                                                                \
   COUNTER(upstream_cx_overflow)                                                                    \
   COUNTER(upstream_cx_pool_overflow)                                                               \
+  COUNTER(upstream_cx_preconnect_hit)                                                              \
+  COUNTER(upstream_cx_preconnect_waste)                                                            \
   COUNTER(upstream_cx_protocol_error)                                                              \
   COUNTER(upstream_cx_rx_bytes_total)                                                              \
   COUNTER(upstream_cx_total)                                                                       \
@@ -789,6 +791,38 @@ public:
    */
   virtual float peekaheadRatio() const PURE;
 
+  /**
+   * Configuration of rate predictive preconnecting.
+   */
+  struct RatePredictivePreconnect {
+    // The interval in which stream arrivals are counted and for which connections are preconnected.
+    std::chrono::milliseconds interval_;
+    // The weight of the most recent interval in the moving average of arrivals per interval.
+    double smoothing_factor_;
+  };
+
+  /**
+   * @return the rate predictive preconnect configuration, or absl::nullopt if streams are not
+   *         preconnected for based on their arrival rate.
+   */
+  virtual const absl::optional<RatePredictivePreconnect>& ratePredictivePreconnect() const PURE;
+
+  /**
+   * Configuration of warm TCP connections.
+   */
+  struct WarmTcpConnections {
+    // The number of unclaimed connections to keep for each host.
+    uint32_t connections_;
+    // How long an unclaimed connection may stay idle before it is closed.
+    absl::optional<std::chrono::milliseconds> idle_timeout_;
+  };
+
+  /**
+   * @return the warm TCP connection configuration, or absl::nullopt if TCP connection pools do
+   *         not keep unclaimed connections.
+   */
+  virtual const absl::optional<WarmTcpConnections>& warmTcpConnections() const PURE;
+
   /**
    * @return soft limit on size of the cluster's connections read and write buffers.
    */
@@ -882,6 +916,20 @@ public:
   virtual const absl::optional<envoy::config::cluster::v3::Cluster::LeastRequestLbConfig>&
   lbLeastRequestConfig() const PURE;
 
+  /**
+   * @return configuration for peak EWMA load balancing, only used if LB type is peak EWMA.
+   */
+  virtual const absl::optional<envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig>&
+  lbPeakEwmaConfig() const PURE;
+
+  /**
+   * @return configuration for ORCA weighted round robin load balancing, only used if LB type is
+   *         ORCA weighted round robin.
+   */
+  virtual const absl::optional<
+      envoy::config::cluster::v3::Cluster::OrcaWeightedRoundRobinLbConfig>&
+  lbOrcaWeightedRoundRobinConfig() const PURE;
+
   /**
    * @return configuration for ring hash load balancing, only used if type is set to ring_hash_lb.
    */
@@ -1025,6 +1073,12 @@ public:
    */
   virtual bool connectionPoolPerDownstreamConnection() const PURE;
 
+  /**
+   * @return the number of worker threads owning the HTTP/2 and HTTP/3 upstream connections which
+   *         are shared by all workers, or 0 if every worker uses its own connections.
+   */
+  virtual uint32_t sharedConnectionPoolOwnerThreads() const PURE;
+
   /**
    * @return true if this cluster is configured to ignore hosts for the purpose of load balancing
    * computations until they have been health checked for the first time.
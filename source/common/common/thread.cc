@@ -1,6 +1,8 @@
 #include "source/common/common/thread.h"
 
+#include <algorithm>
 #include <thread>
+#include <vector>
 
 #include "source/common/common/assert.h"
 #include "source/common/common/macros.h"
@@ -101,5 +103,25 @@ SkipAsserts::~SkipAsserts() { ThreadIds::get().decSkipAsserts(); }
 
 bool SkipAsserts::skip() { return ThreadIds::get().skipAsserts(); }
 
+void parallelFor(ThreadFactory& thread_factory, uint32_t max_threads, size_t count,
+                 const std::function<void(size_t)>& fn) {
+  std::atomic<size_t> next_index{0};
+  auto run = [&next_index, count, &fn]() {
+    for (size_t index = next_index++; index < count; index = next_index++) {
+      fn(index);
+    }
+  };
+
+  std::vector<ThreadPtr> threads;
+  const size_t num_threads = std::min<size_t>(std::max<uint32_t>(max_threads, 1), count);
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread(run, Options{"parallel_for"}));
+  }
+  run();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+}
+
 } // namespace Thread
 } // namespace Envoy
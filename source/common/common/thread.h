@@ -314,5 +314,14 @@ public:
   static bool skip();
 };
 
+/**
+ * Calls fn(index) for every index in [0, count), spread over the calling thread and up to
+ * max_threads - 1 threads created by thread_factory, and returns once all of the calls returned.
+ * Each index is passed to exactly one call, in no particular order across threads, so fn must be
+ * safe to call concurrently for distinct indices. fn must not throw.
+ */
+void parallelFor(ThreadFactory& thread_factory, uint32_t max_threads, size_t count,
+                 const std::function<void(size_t)>& fn);
+
 } // namespace Thread
 } // namespace Envoy
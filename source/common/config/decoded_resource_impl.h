@@ -93,6 +93,28 @@ private:
   const absl::optional<std::chrono::milliseconds> ttl_;
 };
 
+/**
+ * A DecodedResource that shares an already decoded resource, e.g. one that is unchanged since a
+ * previous update, and reports it at a new version.
+ */
+class SharedDecodedResource : public DecodedResource {
+public:
+  SharedDecodedResource(std::shared_ptr<const DecodedResource> resource, const std::string& version)
+      : resource_(std::move(resource)), version_(version) {}
+
+  // Config::DecodedResource
+  const std::string& name() const override { return resource_->name(); }
+  const std::vector<std::string>& aliases() const override { return resource_->aliases(); }
+  const std::string& version() const override { return version_; };
+  const Protobuf::Message& resource() const override { return resource_->resource(); };
+  bool hasResource() const override { return resource_->hasResource(); }
+  absl::optional<std::chrono::milliseconds> ttl() const override { return resource_->ttl(); }
+
+private:
+  const std::shared_ptr<const DecodedResource> resource_;
+  const std::string version_;
+};
+
 struct DecodedResourcesWrapper {
   DecodedResourcesWrapper() = default;
   DecodedResourcesWrapper(OpaqueResourceDecoder& resource_decoder,
@@ -1,12 +1,17 @@
 #include "source/common/config/grpc_mux_impl.h"
 
+#include <exception>
+#include <thread>
+
 #include "envoy/service/discovery/v3/discovery.pb.h"
 
+#include "source/common/common/thread.h"
 #include "source/common/config/decoded_resource_impl.h"
 #include "source/common/config/utility.h"
 #include "source/common/config/xds_source_id.h"
 #include "source/common/memory/utils.h"
 #include "source/common/protobuf/protobuf.h"
+#include "source/common/runtime/runtime_features.h"
 
 #include "absl/container/btree_map.h"
 #include "absl/container/node_hash_set.h"
@@ -31,10 +36,15 @@ private:
   absl::flat_hash_set<GrpcMuxImpl*> muxes_;
 };
 using AllMuxes = ThreadSafeSingleton<AllMuxesState>;
+
+// Responses are only decoded on multiple threads when each thread gets at least this many
+// resources, below which starting the threads costs more than it saves.
+constexpr size_t MinResourcesPerDecodeThread = 64;
 } // namespace
 
 GrpcMuxImpl::GrpcMuxImpl(const LocalInfo::LocalInfo& local_info,
                          Grpc::RawAsyncClientPtr async_client, Event::Dispatcher& dispatcher,
+                         Thread::ThreadFactory& thread_factory,
                          const Protobuf::MethodDescriptor& service_method,
                          Random::RandomGenerator& random, Stats::Scope& scope,
                          const RateLimitSettings& rate_limit_settings, bool skip_subsequent_node,
@@ -46,7 +56,7 @@ GrpcMuxImpl::GrpcMuxImpl(const LocalInfo::LocalInfo& local_info,
       local_info_(local_info), skip_subsequent_node_(skip_subsequent_node),
       config_validators_(std::move(config_validators)),
       xds_resources_delegate_(xds_resources_delegate), target_xds_authority_(target_xds_authority),
-      first_stream_request_(true), dispatcher_(dispatcher),
+      first_stream_request_(true), dispatcher_(dispatcher), thread_factory_(thread_factory),
       dynamic_update_callback_handle_(local_info.contextProvider().addDynamicContextUpdateCallback(
           [this](absl::string_view resource_type_url) {
             onDynamicContextUpdate(resource_type_url);
@@ -215,7 +225,7 @@ ScopedResume GrpcMuxImpl::pause(const std::vector<std::string> type_urls) {
 }
 
 void GrpcMuxImpl::onDiscoveryResponse(
-    std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
+    ResponseProtoPtr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
     ControlPlaneStats& control_plane_stats) {
   const std::string type_url = message->type_url();
   ENVOY_LOG(debug, "Received gRPC message for {} at version {}", type_url, message->version_info());
@@ -266,8 +276,61 @@ void GrpcMuxImpl::onDiscoveryResponse(
   TRY_ASSERT_MAIN_THREAD {
     std::vector<DecodedResourcePtr> resources;
     OpaqueResourceDecoder& resource_decoder = *api_state.watches_.front()->resource_decoder_;
+    // In state-of-the-world xDS most resources of a response are usually unchanged since the
+    // previous one. Those are recognized by their serialized bytes and reuse the previously decoded
+    // and validated message.
+    const bool reuse_decoded_resources =
+        Runtime::runtimeFeatureEnabled("envoy.reloadable_features.xds_reuse_unchanged_resources");
+    absl::flat_hash_map<std::string, std::shared_ptr<const DecodedResource>> decoded_resources;
+    uint32_t reused_resources = 0;
+    const auto is_reusable = [&](const ProtobufWkt::Any& resource) {
+      return reuse_decoded_resources && !resource.Is<envoy::service::discovery::v3::Resource>();
+    };
+
+    // Unpacking and validating the resources of a large response may block the main thread for a
+    // long time, so the resources that are not reused are decoded on multiple threads up front.
+    // The results are still consumed in order below, so that the response is rejected for its
+    // first invalid resource, exactly as when decoding serially.
+    std::vector<DecodedResourcePtr> predecoded;
+    std::vector<std::exception_ptr> predecode_errors;
+    const uint32_t decode_threads =
+        Runtime::runtimeFeatureEnabled("envoy.reloadable_features.xds_parallel_resource_decoding")
+            ? std::min<size_t>(std::thread::hardware_concurrency(),
+                               message->resources_size() / MinResourcesPerDecodeThread)
+            : 1;
+    if (decode_threads > 1) {
+      predecoded.resize(message->resources_size());
+      predecode_errors.resize(message->resources_size());
+      Thread::parallelFor(
+          thread_factory_, decode_threads, message->resources_size(), [&](size_t i) {
+            const auto& resource = message->resources(i);
+            if (is_reusable(resource) && api_state.decoded_resources_.contains(resource.value())) {
+              return;
+            }
+            // Nothing may escape a decoding thread, so whatever the decoding throws is rethrown
+            // as is on the main thread below.
+            TRY_NEEDS_AUDIT {
+              predecoded[i] = DecodedResourceImpl::fromResource(resource_decoder, resource,
+                                                                message->version_info());
+            }
+            catch (...) {
+              predecode_errors[i] = std::current_exception();
+            }
+          });
+    }
+    const auto decode = [&](int i) -> DecodedResourcePtr {
+      if (predecoded.empty()) {
+        return DecodedResourceImpl::fromResource(resource_decoder, message->resources(i),
+                                                 message->version_info());
+      }
+      if (predecode_errors[i] != nullptr) {
+        std::rethrow_exception(predecode_errors[i]);
+      }
+      return std::move(predecoded[i]);
+    };
 
-    for (const auto& resource : message->resources()) {
+    for (int i = 0; i < message->resources_size(); ++i) {
+      const auto& resource = message->resources(i);
       // TODO(snowp): Check the underlying type when the resource is a Resource.
       if (!resource.Is<envoy::service::discovery::v3::Resource>() &&
           type_url != resource.type_url()) {
@@ -276,16 +339,34 @@ void GrpcMuxImpl::onDiscoveryResponse(
                         resource.type_url(), type_url, message->DebugString()));
       }
 
-      auto decoded_resource =
-          DecodedResourceImpl::fromResource(resource_decoder, resource, message->version_info());
+      if (is_reusable(resource)) {
+        std::shared_ptr<const DecodedResource> decoded_resource;
+        const auto it = api_state.decoded_resources_.find(resource.value());
+        if (it != api_state.decoded_resources_.end()) {
+          decoded_resource = it->second;
+          ++reused_resources;
+        } else {
+          decoded_resource = decode(i);
+        }
+        decoded_resources.emplace(resource.value(), decoded_resource);
+        resources.emplace_back(std::make_unique<SharedDecodedResource>(std::move(decoded_resource),
+                                                                       message->version_info()));
+        continue;
+      }
+
+      auto decoded_resource = decode(i);
 
       if (!isHeartbeatResource(type_url, *decoded_resource)) {
         resources.emplace_back(std::move(decoded_resource));
       }
     }
+    ENVOY_LOG(debug, "Reused {} unchanged resources of {} for {}", reused_resources,
+              resources.size(), type_url);
 
     processDiscoveryResources(resources, api_state, type_url, message->version_info(),
                               /*call_delegate=*/true);
+    // Only the resources of the accepted response are kept, so that removed ones are dropped.
+    api_state.decoded_resources_ = std::move(decoded_resources);
   }
   END_TRY
   catch (const EnvoyException& e) {
@@ -12,6 +12,7 @@
 #include "envoy/event/dispatcher.h"
 #include "envoy/grpc/status.h"
 #include "envoy/service/discovery/v3/discovery.pb.h"
+#include "envoy/thread/thread.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "source/common/common/cleanup.h"
@@ -23,6 +24,7 @@
 #include "source/common/config/ttl.h"
 #include "source/common/config/utility.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 
 namespace Envoy {
@@ -35,8 +37,9 @@ class GrpcMuxImpl : public GrpcMux,
                     public Logger::Loggable<Logger::Id::config> {
 public:
   GrpcMuxImpl(const LocalInfo::LocalInfo& local_info, Grpc::RawAsyncClientPtr async_client,
-              Event::Dispatcher& dispatcher, const Protobuf::MethodDescriptor& service_method,
-              Random::RandomGenerator& random, Stats::Scope& scope,
+              Event::Dispatcher& dispatcher, Thread::ThreadFactory& thread_factory,
+              const Protobuf::MethodDescriptor& service_method, Random::RandomGenerator& random,
+              Stats::Scope& scope,
               const RateLimitSettings& rate_limit_settings, bool skip_subsequent_node,
               CustomConfigValidatorsPtr&& config_validators,
               XdsResourcesDelegateOptRef xds_resources_delegate,
@@ -75,7 +78,7 @@ public:
   void onStreamEstablished() override;
   void onEstablishmentFailure() override;
   void
-  onDiscoveryResponse(std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
+  onDiscoveryResponse(ResponseProtoPtr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
                       ControlPlaneStats& control_plane_stats) override;
   void onWriteable() override;
 
@@ -157,6 +160,12 @@ private:
     // The identifier for the server that sent the most recent response, or
     // empty if there is none.
     std::string control_plane_identifier_{};
+    // The plain (not wrapped in a Resource) resources of the last accepted response, keyed by
+    // their serialized bytes. A resource of a later response with the same bytes reuses the
+    // decoded message rather than being unpacked and validated again. The bytes themselves are the
+    // key, rather than a hash of them, so that a hash collision can never hand out another
+    // resource.
+    absl::flat_hash_map<std::string, std::shared_ptr<const DecodedResource>> decoded_resources_;
   };
 
   bool isHeartbeatResource(const std::string& type_url, const DecodedResource& resource) {
@@ -202,6 +211,8 @@ private:
   std::unique_ptr<std::queue<std::string>> request_queue_;
 
   Event::Dispatcher& dispatcher_;
+  // Used to decode the resources of large responses on multiple threads.
+  Thread::ThreadFactory& thread_factory_;
   Common::CallbackHandlePtr dynamic_update_callback_handle_;
 
   // True iff Envoy is shutting down; no messages should be sent on the `grpc_stream_` when this is
@@ -236,7 +247,7 @@ public:
   void onWriteable() override {}
   void onStreamEstablished() override {}
   void onEstablishmentFailure() override {}
-  void onDiscoveryResponse(std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&&,
+  void onDiscoveryResponse(ResponseProtoPtr<envoy::service::discovery::v3::DiscoveryResponse>&&,
                            ControlPlaneStats&) override {}
 };
 
@@ -10,7 +10,9 @@
 #include "source/common/common/backoff_strategy.h"
 #include "source/common/common/token_bucket_impl.h"
 #include "source/common/config/utility.h"
+#include "source/common/grpc/common.h"
 #include "source/common/grpc/typed_async_client.h"
+#include "source/common/runtime/runtime_features.h"
 
 namespace Envoy {
 namespace Config {
@@ -23,8 +25,6 @@ constexpr uint32_t RetryMaxDelayMs = 30000; // Do not cross more than 30s
 
 } // namespace
 
-template <class ResponseProto> using ResponseProtoPtr = std::unique_ptr<ResponseProto>;
-
 // Oversees communication for gRPC xDS implementations (parent to both regular xDS and delta
 // xDS variants). Reestablishes the gRPC channel when necessary, and provides rate limiting of
 // requests.
@@ -90,17 +90,8 @@ public:
     UNREFERENCED_PARAMETER(metadata);
   }
 
-  void onReceiveMessage(ResponseProtoPtr<ResponseProto>&& message) override {
-    // Reset here so that it starts with fresh backoff interval on next disconnect.
-    backoff_strategy_->reset();
-    // Clear here instead of on stream establishment in case streams are immediately closed
-    // repeatedly.
-    clearCloseStatus();
-    // Sometimes during hot restarts this stat's value becomes inconsistent and will continue to
-    // have 0 until it is reconnected. Setting here ensures that it is consistent with the state of
-    // management server connection.
-    control_plane_stats_.connected_state_.set(1);
-    callbacks_->onDiscoveryResponse(std::move(message), control_plane_stats_);
+  void onReceiveMessage(Grpc::ResponsePtr<ResponseProto>&& message) override {
+    handleResponse(std::move(message));
   }
 
   void onReceiveTrailingMetadata(Http::ResponseTrailerMapPtr&& metadata) override {
@@ -115,6 +106,30 @@ public:
     setRetryTimer();
   }
 
+  // Grpc::RawAsyncStreamCallbacks
+  bool onReceiveMessageRaw(Buffer::InstancePtr&& response) override {
+    ResponseProtoPtr<ResponseProto> message;
+    if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.xds_parse_responses_on_arena")) {
+      // A response only lives while it is being applied, and may hold a large number of
+      // resources. Allocating it on an arena sized for the encoded response saves freeing each of
+      // its fields one by one afterwards.
+      Protobuf::ArenaOptions options;
+      options.start_block_size = std::max<size_t>(response->length(), options.start_block_size);
+      auto arena = std::make_unique<Protobuf::Arena>(options);
+      ResponseProto* arena_message = Protobuf::Arena::CreateMessage<ResponseProto>(arena.get());
+      message = ResponseProtoPtr<ResponseProto>(
+          arena_message, ResponseProtoDeleter<ResponseProto>(std::move(arena)));
+    } else {
+      message = std::make_unique<ResponseProto>();
+    }
+    if (response->length() > 0 &&
+        !Grpc::Common::parseBufferInstance(std::move(response), *message)) {
+      return false;
+    }
+    handleResponse(std::move(message));
+    return true;
+  }
+
   void maybeUpdateQueueSizeStat(uint64_t size) {
     // Although request_queue_.push() happens elsewhere, the only time the queue is non-transiently
     // non-empty is when it remains non-empty after a drain attempt. (The push() doesn't matter
@@ -144,6 +159,19 @@ public:
   absl::optional<Grpc::Status::GrpcStatus> getCloseStatus() { return last_close_status_; }
 
 private:
+  void handleResponse(ResponseProtoPtr<ResponseProto>&& message) {
+    // Reset here so that it starts with fresh backoff interval on next disconnect.
+    backoff_strategy_->reset();
+    // Clear here instead of on stream establishment in case streams are immediately closed
+    // repeatedly.
+    clearCloseStatus();
+    // Sometimes during hot restarts this stat's value becomes inconsistent and will continue to
+    // have 0 until it is reconnected. Setting here ensures that it is consistent with the state of
+    // management server connection.
+    control_plane_stats_.connected_state_.set(1);
+    callbacks_->onDiscoveryResponse(std::move(message), control_plane_stats_);
+  }
+
   void setRetryTimer() {
     retry_timer_->enableTimer(std::chrono::milliseconds(backoff_strategy_->nextBackOffMs()));
   }
@@ -95,8 +95,8 @@ SubscriptionPtr SubscriptionFactoryImpl::subscriptionFromConfigSource(
             Utility::factoryForGrpcApiConfigSource(cm_.grpcAsyncClientManager(), api_config_source,
                                                    scope, true)
                 ->createUncachedRawAsyncClient(),
-            dispatcher_, sotwGrpcMethod(type_url), api_.randomGenerator(), scope,
-            Utility::parseRateLimitSettings(api_config_source),
+            dispatcher_, api_.threadFactory(), sotwGrpcMethod(type_url), api_.randomGenerator(),
+            scope, Utility::parseRateLimitSettings(api_config_source),
             api_config_source.set_node_on_first_message_only(), std::move(custom_config_validators),
             xds_resources_delegate_, control_plane_id);
       }
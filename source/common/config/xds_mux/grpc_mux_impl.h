@@ -102,7 +102,7 @@ public:
   void onStreamEstablished() override { handleEstablishedStream(); }
   void onEstablishmentFailure() override { handleStreamEstablishmentFailure(); }
   void onWriteable() override { trySendDiscoveryRequests(); }
-  void onDiscoveryResponse(std::unique_ptr<RS>&& message,
+  void onDiscoveryResponse(ResponseProtoPtr<RS>&& message,
                            ControlPlaneStats& control_plane_stats) override {
     genericHandleResponse(message->type_url(), *message, control_plane_stats);
   }
@@ -1,5 +1,7 @@
 #include "source/common/conn_pool/conn_pool_base.h"
 
+#include <cmath>
+
 #include "source/common/common/assert.h"
 #include "source/common/common/debug_recursion_checker.h"
 #include "source/common/network/transport_socket_options_impl.h"
@@ -26,7 +28,8 @@ ConnPoolImplBase::ConnPoolImplBase(
     Upstream::ClusterConnectivityState& state)
     : state_(state), host_(host), priority_(priority), dispatcher_(dispatcher),
       socket_options_(options), transport_socket_options_(transport_socket_options),
-      upstream_ready_cb_(dispatcher_.createSchedulableCallback([this]() { onUpstreamReady(); })) {}
+      upstream_ready_cb_(dispatcher_.createSchedulableCallback([this]() { onUpstreamReady(); })),
+      arrival_interval_start_(dispatcher_.timeSource().monotonicTime()) {}
 
 ConnPoolImplBase::~ConnPoolImplBase() {
   ASSERT(isIdleImpl());
@@ -72,7 +75,8 @@ bool ConnPoolImplBase::shouldConnect(size_t pending_streams, size_t active_strea
          connecting_and_connected_capacity + active_streams;
 }
 
-bool ConnPoolImplBase::shouldCreateNewConnection(float global_preconnect_ratio) const {
+bool ConnPoolImplBase::shouldCreateNewConnection(float global_preconnect_ratio,
+                                                 bool predict_streams) const {
   // If the host is not healthy, don't make it do extra work, especially as
   // upstream selection logic may result in bypassing this upstream entirely.
   // If an Envoy user wants preconnecting for degraded upstreams this could be
@@ -96,9 +100,12 @@ bool ConnPoolImplBase::shouldCreateNewConnection(float global_preconnect_ratio)
     //
     // Local preconnect does not need to anticipate a stream. It is called as
     // new streams are established or torn down and simply attempts to maintain
-    // the correct ratio of streams and anticipated capacity.
+    // the correct ratio of streams and anticipated capacity. As a stream arrives,
+    // it also maintains enough capacity for the streams predicted to arrive next,
+    // if configured.
     return shouldConnect(pending_streams_.size(), num_active_streams_, connecting_stream_capacity_,
-                         perUpstreamPreconnectRatio());
+                         perUpstreamPreconnectRatio()) ||
+           (predict_streams && shouldPreconnectForPredictedStreams());
   }
 }
 
@@ -106,7 +113,50 @@ float ConnPoolImplBase::perUpstreamPreconnectRatio() const {
   return host_->cluster().perUpstreamPreconnectRatio();
 }
 
-ConnPoolImplBase::ConnectionResult ConnPoolImplBase::tryCreateNewConnections() {
+void ConnPoolImplBase::recordStreamArrival() {
+  const auto& config = host_->cluster().ratePredictivePreconnect();
+  if (!config.has_value()) {
+    return;
+  }
+
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  const auto elapsed = now - arrival_interval_start_;
+  if (elapsed >= config->interval_) {
+    // Fold the interval which ended into the moving average, and decay the average for each
+    // following interval in which no streams arrived.
+    const uint64_t intervals = elapsed / config->interval_;
+    const double alpha = config->smoothing_factor_;
+    average_streams_per_interval_ =
+        alpha * arrival_interval_streams_ + (1 - alpha) * average_streams_per_interval_;
+    average_streams_per_interval_ *= std::pow(1 - alpha, intervals - 1);
+    arrival_interval_streams_ = 0;
+    arrival_interval_start_ += intervals * config->interval_;
+  }
+  arrival_interval_streams_++;
+}
+
+bool ConnPoolImplBase::shouldPreconnectForPredictedStreams(int64_t excluded_capacity) const {
+  if (!host_->cluster().ratePredictivePreconnect().has_value()) {
+    return false;
+  }
+
+  // A burst shows up in the count of the current interval before it is folded into the average,
+  // so predict whichever is larger.
+  const int64_t predicted_streams = std::ceil(std::max<double>(
+      average_streams_per_interval_, static_cast<double>(arrival_interval_streams_)));
+  const int64_t wanted_capacity = pending_streams_.size() + predicted_streams;
+
+  // There may be many ready clients, so only add up as much of their capacity as is wanted.
+  int64_t capacity = static_cast<int64_t>(connecting_stream_capacity_) - excluded_capacity;
+  for (auto it = ready_clients_.begin(); it != ready_clients_.end() && capacity < wanted_capacity;
+       ++it) {
+    capacity += std::max<int64_t>((*it)->currentUnusedCapacity(), 0);
+  }
+  return wanted_capacity > capacity;
+}
+
+ConnPoolImplBase::ConnectionResult
+ConnPoolImplBase::tryCreateNewConnections(bool predict_streams) {
   ASSERT(!is_draining_for_deletion_);
   ConnPoolImplBase::ConnectionResult result;
   // Somewhat arbitrarily cap the number of connections preconnected due to new
@@ -116,7 +166,7 @@ ConnPoolImplBase::ConnectionResult ConnPoolImplBase::tryCreateNewConnections() {
   // many connections are desired when the host becomes healthy again, but
   // overwhelming it with connections is not desirable.
   for (int i = 0; i < 3; ++i) {
-    result = tryCreateNewConnection();
+    result = tryCreateNewConnection(0, predict_streams);
     if (result != ConnectionResult::CreatedNewConnection) {
       break;
     }
@@ -125,13 +175,16 @@ ConnPoolImplBase::ConnectionResult ConnPoolImplBase::tryCreateNewConnections() {
 }
 
 ConnPoolImplBase::ConnectionResult
-ConnPoolImplBase::tryCreateNewConnection(float global_preconnect_ratio) {
+ConnPoolImplBase::tryCreateNewConnection(float global_preconnect_ratio, bool predict_streams) {
   // There are already enough Connecting connections for the number of queued streams.
-  if (!shouldCreateNewConnection(global_preconnect_ratio)) {
+  if (!shouldCreateNewConnection(global_preconnect_ratio, predict_streams)) {
     ENVOY_LOG(trace, "not creating a new connection, shouldCreateNewConnection returned false.");
     return ConnectionResult::ShouldNotConnect;
   }
+  return createNewConnection();
+}
 
+ConnPoolImplBase::ConnectionResult ConnPoolImplBase::createNewConnection() {
   const bool can_create_connection = host_->canCreateConnection(priority_);
 
   if (!can_create_connection) {
@@ -152,6 +205,9 @@ ConnPoolImplBase::tryCreateNewConnection(float global_preconnect_ratio) {
     ASSERT(std::numeric_limits<uint64_t>::max() - connecting_stream_capacity_ >=
            static_cast<uint64_t>(client->currentUnusedCapacity()));
     ASSERT(client->real_host_description_);
+    // If the connecting connections can already serve all pending streams, this connection is
+    // established ahead of the streams which will use it.
+    client->preconnected_ = pending_streams_.size() <= connecting_stream_capacity_;
     // Increase the connecting capacity to reflect the streams this connection can serve.
     incrConnectingAndConnectedStreamCapacity(client->currentUnusedCapacity(), *client);
     LinkedList::moveIntoList(std::move(client), owningList(client->state()));
@@ -180,6 +236,11 @@ void ConnPoolImplBase::attachStreamToClient(Envoy::ConnectionPool::ActiveClient&
   }
   ENVOY_CONN_LOG(debug, "creating stream", client);
 
+  if (client.preconnected_) {
+    client.preconnected_ = false;
+    host_->cluster().stats().upstream_cx_preconnect_hit_.inc();
+  }
+
   // Latch capacity before updating remaining streams.
   uint64_t capacity = client.currentUnusedCapacity();
   client.remaining_streams_--;
@@ -256,6 +317,8 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
   ASSERT(!is_draining_for_deletion_);
   ASSERT(!deferred_deleting_);
 
+  recordStreamArrival();
+
   ASSERT(static_cast<ssize_t>(connecting_stream_capacity_) ==
          connectingCapacity(connecting_clients_) +
              connectingCapacity(early_data_clients_)); // O(n) debug check.
@@ -264,7 +327,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
     ENVOY_CONN_LOG(debug, "using existing fully connected connection", client);
     attachStreamToClient(client, context);
     // Even if there's a ready client, we may want to preconnect to handle the next incoming stream.
-    tryCreateNewConnections();
+    tryCreateNewConnections(/*predict_streams=*/true);
     return nullptr;
   }
 
@@ -274,7 +337,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
     attachStreamToClient(client, context);
     // Even if there's an available client, we may want to preconnect to handle the next
     // incoming stream.
-    tryCreateNewConnections();
+    tryCreateNewConnections(/*predict_streams=*/true);
     return nullptr;
   }
 
@@ -293,7 +356,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
   auto old_capacity = connecting_stream_capacity_;
   // This must come after newPendingStream() because this function uses the
   // length of pending_streams_ to determine if a new connection is needed.
-  const ConnectionResult result = tryCreateNewConnections();
+  const ConnectionResult result = tryCreateNewConnections(/*predict_streams=*/true);
   // If there is not enough connecting capacity, the only reason to not
   // increase capacity is if the connection limits are exceeded.
   ENVOY_BUG(pending_streams_.size() <= connecting_stream_capacity_ ||
@@ -483,6 +546,9 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
     ENVOY_CONN_LOG(debug, "client disconnected, failure reason: {}", client, failure_reason);
 
     Envoy::Upstream::reportUpstreamCxDestroy(host_, event);
+    if (client.preconnected_) {
+      host_->cluster().stats().upstream_cx_preconnect_waste_.inc();
+    }
     const bool incomplete_stream = client.closingWithIncompleteStream();
     if (incomplete_stream) {
       Envoy::Upstream::reportUpstreamCxDestroyActiveRequest(host_, event);
@@ -645,8 +711,12 @@ bool ConnPoolImplBase::connectingConnectionIsExcess(const ActiveClient& client)
   // If preconnect ratio is set, it also factors in the anticipated load based on both queued
   // streams and active streams, and makes sure the connecting capacity would still be sufficient to
   // serve that even with the most recent client removed.
+  //
+  // If rate predictive preconnecting is configured, the connection is kept if it is needed for the
+  // streams predicted to arrive next.
   return (pending_streams_.size() + num_active_streams_) * perUpstreamPreconnectRatio() <=
-         (connecting_stream_capacity_ - client.currentUnusedCapacity() + num_active_streams_);
+             (connecting_stream_capacity_ - client.currentUnusedCapacity() + num_active_streams_) &&
+         !shouldPreconnectForPredictedStreams(client.currentUnusedCapacity());
 }
 
 void ConnPoolImplBase::onPendingStreamCancel(PendingStream& stream,
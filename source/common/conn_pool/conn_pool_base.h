@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/common/conn_pool.h"
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection.h"
 #include "envoy/stats/timespan.h"
@@ -145,6 +146,9 @@ public:
   Event::TimerPtr connection_duration_timer_;
   bool resources_released_{false};
   bool timed_out_{false};
+  // True if this connection was created before any stream needed it and no stream has used it
+  // yet. Used for the preconnect hit and waste stats.
+  bool preconnected_{false};
   // TODO(danzh) remove this once http codec exposes the handshake state for h3.
   bool has_handshake_completed_{false};
 
@@ -280,6 +284,7 @@ public:
     return transport_socket_options_;
   }
   bool hasPendingStreams() const { return !pending_streams_.empty(); }
+  size_t numPendingStreams() const { return pending_streams_.size(); }
 
   void decrClusterStreamCapacity(uint32_t delta) {
     state_.decrConnectingAndConnectedStreamCapacity(delta);
@@ -322,15 +327,21 @@ protected:
     NoConnectionRateLimited,
     CreatedButRateLimited,
   };
-  // Creates up to 3 connections, based on the preconnect ratio.
+  // Creates up to 3 connections, based on the preconnect ratio and, if predict_streams is true,
+  // the streams predicted to arrive next.
   // Returns the ConnectionResult of the last attempt.
-  ConnectionResult tryCreateNewConnections();
+  ConnectionResult tryCreateNewConnections(bool predict_streams = false);
 
   // Creates a new connection if there is sufficient demand, it is allowed by resourceManager, or
   // to avoid starving this pool.
   // Demand is determined either by perUpstreamPreconnectRatio() or global_preconnect_ratio
-  // if this is called by maybePreconnect()
-  ConnectionResult tryCreateNewConnection(float global_preconnect_ratio = 0);
+  // if this is called by maybePreconnect(), and by the streams predicted to arrive next if
+  // predict_streams is true.
+  ConnectionResult tryCreateNewConnection(float global_preconnect_ratio = 0,
+                                          bool predict_streams = false);
+
+  // Creates a new connection if it is allowed by resourceManager, or to avoid starving this pool.
+  ConnectionResult createNewConnection();
 
   // A helper function which determines if a canceled pending connection should
   // be closed as excess or not.
@@ -338,10 +349,18 @@ protected:
 
   // A helper function which determines if a new incoming stream should trigger
   // connection preconnect.
-  bool shouldCreateNewConnection(float global_preconnect_ratio) const;
+  bool shouldCreateNewConnection(float global_preconnect_ratio, bool predict_streams) const;
 
   float perUpstreamPreconnectRatio() const;
 
+  // Counts a newly arrived stream towards the arrival rate used for rate predictive preconnecting.
+  void recordStreamArrival();
+
+  // A helper function which determines if more connections are needed to serve the streams
+  // predicted to arrive within the next rate predictive preconnect interval, not counting
+  // excluded_capacity of the current capacity.
+  bool shouldPreconnectForPredictedStreams(int64_t excluded_capacity = 0) const;
+
   ConnectionPool::Cancellable*
   addPendingStream(Envoy::ConnectionPool::PendingStreamPtr&& pending_stream) {
     LinkedList::moveIntoList(std::move(pending_stream), pending_streams_);
@@ -405,6 +424,12 @@ private:
   // True iff this object is in the deferred delete list.
   bool deferred_deleting_{false};
 
+  // The start of the current rate predictive preconnect interval, the number of streams which
+  // arrived in it, and the moving average of the number of streams arriving per interval.
+  MonotonicTime arrival_interval_start_;
+  uint32_t arrival_interval_streams_{0};
+  double average_streams_per_interval_{0};
+
   Event::SchedulableCallbackPtr upstream_ready_cb_;
   Common::DebugRecursionChecker recursion_checker_;
 };
@@ -0,0 +1,689 @@
+#include "source/common/http/shared_conn_pool.h"
+
+#include <memory>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/dump_state_utils.h"
+#include "source/common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Http {
+
+namespace {
+
+// A copy of the TLS properties of the owner's upstream connection, taken on the owner thread.
+// Ssl::ConnectionInfo implementations compute most properties lazily and cache them without
+// synchronization, so the worker must not read the owner's object.
+class SslConnectionInfoCopy : public Ssl::ConnectionInfo {
+public:
+  explicit SslConnectionInfoCopy(const Ssl::ConnectionInfo& info)
+      : peer_certificate_presented_(info.peerCertificatePresented()),
+        peer_certificate_validated_(info.peerCertificateValidated()),
+        uri_san_local_certificate_(info.uriSanLocalCertificate().begin(),
+                                   info.uriSanLocalCertificate().end()),
+        subject_local_certificate_(info.subjectLocalCertificate()),
+        sha256_peer_certificate_digest_(info.sha256PeerCertificateDigest()),
+        sha1_peer_certificate_digest_(info.sha1PeerCertificateDigest()),
+        serial_number_peer_certificate_(info.serialNumberPeerCertificate()),
+        issuer_peer_certificate_(info.issuerPeerCertificate()),
+        subject_peer_certificate_(info.subjectPeerCertificate()),
+        uri_san_peer_certificate_(info.uriSanPeerCertificate().begin(),
+                                  info.uriSanPeerCertificate().end()),
+        url_encoded_pem_encoded_peer_certificate_(info.urlEncodedPemEncodedPeerCertificate()),
+        url_encoded_pem_encoded_peer_certificate_chain_(
+            info.urlEncodedPemEncodedPeerCertificateChain()),
+        dns_sans_peer_certificate_(info.dnsSansPeerCertificate().begin(),
+                                   info.dnsSansPeerCertificate().end()),
+        dns_sans_local_certificate_(info.dnsSansLocalCertificate().begin(),
+                                    info.dnsSansLocalCertificate().end()),
+        valid_from_peer_certificate_(info.validFromPeerCertificate()),
+        expiration_peer_certificate_(info.expirationPeerCertificate()),
+        session_id_(info.sessionId()), ciphersuite_id_(info.ciphersuiteId()),
+        ciphersuite_string_(info.ciphersuiteString()), tls_version_(info.tlsVersion()),
+        alpn_(info.alpn()), sni_(info.sni()) {}
+
+  // Ssl::ConnectionInfo
+  bool peerCertificatePresented() const override { return peer_certificate_presented_; }
+  bool peerCertificateValidated() const override { return peer_certificate_validated_; }
+  absl::Span<const std::string> uriSanLocalCertificate() const override {
+    return uri_san_local_certificate_;
+  }
+  const std::string& subjectLocalCertificate() const override {
+    return subject_local_certificate_;
+  }
+  const std::string& sha256PeerCertificateDigest() const override {
+    return sha256_peer_certificate_digest_;
+  }
+  const std::string& sha1PeerCertificateDigest() const override {
+    return sha1_peer_certificate_digest_;
+  }
+  const std::string& serialNumberPeerCertificate() const override {
+    return serial_number_peer_certificate_;
+  }
+  const std::string& issuerPeerCertificate() const override { return issuer_peer_certificate_; }
+  const std::string& subjectPeerCertificate() const override { return subject_peer_certificate_; }
+  absl::Span<const std::string> uriSanPeerCertificate() const override {
+    return uri_san_peer_certificate_;
+  }
+  const std::string& urlEncodedPemEncodedPeerCertificate() const override {
+    return url_encoded_pem_encoded_peer_certificate_;
+  }
+  const std::string& urlEncodedPemEncodedPeerCertificateChain() const override {
+    return url_encoded_pem_encoded_peer_certificate_chain_;
+  }
+  absl::Span<const std::string> dnsSansPeerCertificate() const override {
+    return dns_sans_peer_certificate_;
+  }
+  absl::Span<const std::string> dnsSansLocalCertificate() const override {
+    return dns_sans_local_certificate_;
+  }
+  absl::optional<SystemTime> validFromPeerCertificate() const override {
+    return valid_from_peer_certificate_;
+  }
+  absl::optional<SystemTime> expirationPeerCertificate() const override {
+    return expiration_peer_certificate_;
+  }
+  const std::string& sessionId() const override { return session_id_; }
+  uint16_t ciphersuiteId() const override { return ciphersuite_id_; }
+  std::string ciphersuiteString() const override { return ciphersuite_string_; }
+  const std::string& tlsVersion() const override { return tls_version_; }
+  const std::string& alpn() const override { return alpn_; }
+  const std::string& sni() const override { return sni_; }
+
+private:
+  const bool peer_certificate_presented_;
+  const bool peer_certificate_validated_;
+  const std::vector<std::string> uri_san_local_certificate_;
+  const std::string subject_local_certificate_;
+  const std::string sha256_peer_certificate_digest_;
+  const std::string sha1_peer_certificate_digest_;
+  const std::string serial_number_peer_certificate_;
+  const std::string issuer_peer_certificate_;
+  const std::string subject_peer_certificate_;
+  const std::vector<std::string> uri_san_peer_certificate_;
+  const std::string url_encoded_pem_encoded_peer_certificate_;
+  const std::string url_encoded_pem_encoded_peer_certificate_chain_;
+  const std::vector<std::string> dns_sans_peer_certificate_;
+  const std::vector<std::string> dns_sans_local_certificate_;
+  const absl::optional<SystemTime> valid_from_peer_certificate_;
+  const absl::optional<SystemTime> expiration_peer_certificate_;
+  const std::string session_id_;
+  const uint16_t ciphersuite_id_;
+  const std::string ciphersuite_string_;
+  const std::string tls_version_;
+  const std::string alpn_;
+  const std::string sni_;
+};
+
+} // namespace
+
+void SharedConnPoolThread::post(Event::PostCb cb) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!shut_down_) {
+      dispatcher_.post(std::move(cb));
+      return;
+    }
+  }
+  // cb is destroyed outside of the lock, as it may post to another thread when destroyed.
+}
+
+void SharedConnPoolThread::shutdown() {
+  absl::MutexLock lock(&mutex_);
+  shut_down_ = true;
+}
+
+SharedConnPoolImpl::SharedConnPoolImpl(Event::Dispatcher& dispatcher,
+                                       SharedConnPoolThreadSharedPtr thread,
+                                       SharedConnPoolThreadSharedPtr owner,
+                                       Upstream::HostConstSharedPtr host,
+                                       OwnerConnPoolCb owner_pool)
+    : dispatcher_(dispatcher), thread_(std::move(thread)), owner_(std::move(owner)),
+      host_(std::move(host)), owner_pool_(std::move(owner_pool)) {}
+
+SharedConnPoolImpl::~SharedConnPoolImpl() {
+  // Pending streams are dropped and active streams are reset, as if the pool closed its
+  // connections.
+  idle_callbacks_.clear();
+  while (!streams_.empty()) {
+    streams_.front()->resetStream(StreamResetReason::LocalReset);
+  }
+  dispatcher_.clearDeferredDeleteList();
+}
+
+void SharedConnPoolImpl::drainConnections(Envoy::ConnectionPool::DrainBehavior drain_behavior) {
+  // The connections belong to the owner, which drains them itself. Once the last stream handed
+  // off by this pool completes, the pool can be deleted.
+  if (drain_behavior == Envoy::ConnectionPool::DrainBehavior::DrainAndDelete) {
+    draining_ = true;
+    if (isIdle()) {
+      for (const IdleCb& cb : idle_callbacks_) {
+        cb();
+      }
+    }
+  }
+}
+
+ConnectionPool::Cancellable* SharedConnPoolImpl::newStream(ResponseDecoder& response_decoder,
+                                                           ConnectionPool::Callbacks& callbacks,
+                                                           const StreamOptions& options) {
+  ASSERT(!draining_);
+  auto handoff = std::make_shared<StreamHandoff>();
+  LinkedList::moveIntoList(
+      std::make_unique<WorkerStream>(*this, response_decoder, callbacks, handoff), streams_);
+  WorkerStream& stream = *streams_.front();
+  ENVOY_LOG(debug, "handing off stream to the shared connection pool of {}", host_->hostname());
+
+  auto guard = std::make_shared<PostGuard>(thread_, [handoff]() {
+    if (handoff->worker_stream_ != nullptr) {
+      handoff->worker_stream_->onOwnerShutdown();
+    }
+  });
+  owner_->post([handoff, guard, owner = owner_, worker = thread_, owner_pool = owner_pool_,
+                options]() {
+    guard->disarm();
+    // The owner stream deletes itself once it is complete, reset or fails.
+    auto owner_stream = std::make_unique<OwnerStream>(owner, worker, handoff);
+    owner_stream.release()->newStream(owner_pool(), options);
+  });
+  return &stream;
+}
+
+void SharedConnPoolImpl::onStreamDestroyed(WorkerStream& stream) {
+  dispatcher_.deferredDelete(stream.removeFromList(streams_));
+  if (draining_ && isIdle()) {
+    for (const IdleCb& cb : idle_callbacks_) {
+      cb();
+    }
+  }
+}
+
+SharedConnPoolImpl::WorkerStream::WorkerStream(SharedConnPoolImpl& parent,
+                                               ResponseDecoder& response_decoder,
+                                               ConnectionPool::Callbacks& callbacks,
+                                               StreamHandoffSharedPtr handoff)
+    : parent_(parent), response_decoder_(response_decoder), pool_callbacks_(&callbacks),
+      handoff_(std::move(handoff)),
+      connection_info_(std::make_shared<Network::ConnectionInfoSetterImpl>(nullptr, nullptr)) {
+  handoff_->worker_stream_ = this;
+}
+
+SharedConnPoolImpl::WorkerStream::~WorkerStream() { ASSERT(destroyed_); }
+
+void SharedConnPoolImpl::WorkerStream::onPoolFailure(
+    ConnectionPool::PoolFailureReason reason, absl::string_view transport_failure_reason,
+    Upstream::HostDescriptionConstSharedPtr host) {
+  ASSERT(pool_callbacks_ != nullptr);
+  ConnectionPool::Callbacks* callbacks = pool_callbacks_;
+  pool_callbacks_ = nullptr;
+  destroy();
+  callbacks->onPoolFailure(reason, transport_failure_reason, host);
+}
+
+void SharedConnPoolImpl::WorkerStream::onPoolReady(const ConnectionSnapshot& snapshot,
+                                                   Upstream::HostDescriptionConstSharedPtr host) {
+  ASSERT(pool_callbacks_ != nullptr);
+  connection_info_->setLocalAddress(snapshot.local_address_);
+  connection_info_->setRemoteAddress(snapshot.remote_address_);
+  connection_info_->setSslConnection(snapshot.ssl_connection_);
+  if (snapshot.connection_id_.has_value()) {
+    connection_info_->setConnectionID(snapshot.connection_id_.value());
+  }
+  buffer_limit_ = snapshot.buffer_limit_;
+
+  stream_info_ = std::make_unique<StreamInfo::StreamInfoImpl>(parent_.dispatcher_.timeSource(),
+                                                              connection_info_);
+  if (snapshot.protocol_.has_value()) {
+    stream_info_->protocol(snapshot.protocol_.value());
+  }
+  if (snapshot.upstream_timing_.has_value()) {
+    auto upstream_info = std::make_shared<StreamInfo::UpstreamInfoImpl>();
+    upstream_info->upstreamTiming() = snapshot.upstream_timing_.value();
+    upstream_info->setUpstreamNumStreams(snapshot.upstream_num_streams_.value_or(0));
+    stream_info_->setUpstreamInfo(upstream_info);
+  }
+
+  ConnectionPool::Callbacks* callbacks = pool_callbacks_;
+  pool_callbacks_ = nullptr;
+  callbacks->onPoolReady(*this, host, *stream_info_, snapshot.protocol_);
+}
+
+void SharedConnPoolImpl::WorkerStream::onResetStream(StreamResetReason reason,
+                                                     absl::string_view transport_failure_reason) {
+  destroy();
+  for (StreamCallbacks* callbacks : callbacks_) {
+    if (callbacks != nullptr) {
+      callbacks->onResetStream(reason, transport_failure_reason);
+    }
+  }
+}
+
+void SharedConnPoolImpl::WorkerStream::onAboveWriteBufferHighWatermark() {
+  for (StreamCallbacks* callbacks : callbacks_) {
+    if (callbacks != nullptr) {
+      callbacks->onAboveWriteBufferHighWatermark();
+    }
+  }
+}
+
+void SharedConnPoolImpl::WorkerStream::onBelowWriteBufferLowWatermark() {
+  for (StreamCallbacks* callbacks : callbacks_) {
+    if (callbacks != nullptr) {
+      callbacks->onBelowWriteBufferLowWatermark();
+    }
+  }
+}
+
+void SharedConnPoolImpl::WorkerStream::onEncodedDataDelivered(uint64_t length) {
+  ASSERT(encode_bytes_in_flight_ >= length);
+  encode_bytes_in_flight_ -= length;
+  if (above_write_buffer_high_watermark_ && encode_bytes_in_flight_ <= buffer_limit_ / 2) {
+    above_write_buffer_high_watermark_ = false;
+    onBelowWriteBufferLowWatermark();
+  }
+}
+
+void SharedConnPoolImpl::WorkerStream::onOwnerShutdown() {
+  if (pending()) {
+    onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                  "shared connection pool owner shut down", parent_.host_);
+  } else {
+    onResetStream(StreamResetReason::ConnectionTermination,
+                  "shared connection pool owner shut down");
+  }
+}
+
+void SharedConnPoolImpl::WorkerStream::decode1xxHeaders(ResponseHeaderMapPtr&& headers) {
+  response_decoder_.decode1xxHeaders(std::move(headers));
+}
+
+void SharedConnPoolImpl::WorkerStream::decodeHeaders(ResponseHeaderMapPtr&& headers,
+                                                     bool end_stream) {
+  remote_complete_ = end_stream;
+  response_decoder_.decodeHeaders(std::move(headers), end_stream);
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::WorkerStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  const uint64_t length = data.length();
+  remote_complete_ = end_stream;
+  response_decoder_.decodeData(data, end_stream);
+  // From here on the data is subject to the flow control of the worker.
+  if (!end_stream && !destroyed_) {
+    postToOwner([length](OwnerStream& stream) { stream.onDecodedDataDelivered(length); });
+  }
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::WorkerStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  remote_complete_ = true;
+  response_decoder_.decodeTrailers(std::move(trailers));
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::WorkerStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  response_decoder_.decodeMetadata(std::move(metadata_map));
+}
+
+Status SharedConnPoolImpl::WorkerStream::encodeHeaders(const RequestHeaderMap& headers,
+                                                       bool end_stream) {
+  // The owner validates the headers when encoding them and resets the stream if they are invalid.
+  std::shared_ptr<RequestHeaderMap> copy = createHeaderMap<RequestHeaderMapImpl>(headers);
+  local_complete_ = end_stream;
+  postToOwner([copy, end_stream](OwnerStream& stream) { stream.encodeHeaders(*copy, end_stream); });
+  maybeComplete();
+  return okStatus();
+}
+
+void SharedConnPoolImpl::WorkerStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  auto copy = std::make_shared<Buffer::OwnedImpl>();
+  copy->add(data);
+  data.drain(data.length());
+  local_complete_ = end_stream;
+  encode_bytes_in_flight_ += copy->length();
+  postToOwner([copy, end_stream](OwnerStream& stream) { stream.encodeData(*copy, end_stream); });
+  if (!above_write_buffer_high_watermark_ && buffer_limit_ > 0 &&
+      encode_bytes_in_flight_ > buffer_limit_) {
+    above_write_buffer_high_watermark_ = true;
+    onAboveWriteBufferHighWatermark();
+  }
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::WorkerStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  std::shared_ptr<RequestTrailerMap> copy = createHeaderMap<RequestTrailerMapImpl>(trailers);
+  local_complete_ = true;
+  postToOwner([copy](OwnerStream& stream) { stream.encodeTrailers(*copy); });
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::WorkerStream::encodeMetadata(
+    const MetadataMapVector& metadata_map_vector) {
+  auto copy = std::make_shared<MetadataMapVector>();
+  for (const MetadataMapPtr& metadata_map : metadata_map_vector) {
+    copy->push_back(std::make_unique<MetadataMap>(*metadata_map));
+  }
+  postToOwner([copy](OwnerStream& stream) { stream.encodeMetadata(*copy); });
+}
+
+void SharedConnPoolImpl::WorkerStream::enableTcpTunneling() {
+  postToOwner([](OwnerStream& stream) { stream.enableTcpTunneling(); });
+}
+
+void SharedConnPoolImpl::WorkerStream::removeCallbacks(StreamCallbacks& callbacks) {
+  // Callbacks may be removed while they are being run, so only clear them.
+  for (StreamCallbacks*& entry : callbacks_) {
+    if (entry == &callbacks) {
+      entry = nullptr;
+      return;
+    }
+  }
+}
+
+void SharedConnPoolImpl::WorkerStream::resetStream(StreamResetReason reason) {
+  if (destroyed_) {
+    return;
+  }
+  postToOwner([reason](OwnerStream& stream) { stream.resetStream(reason); });
+  onResetStream(reason, absl::string_view());
+}
+
+void SharedConnPoolImpl::WorkerStream::readDisable(bool disable) {
+  postToOwner([disable](OwnerStream& stream) { stream.readDisable(disable); });
+}
+
+void SharedConnPoolImpl::WorkerStream::setFlushTimeout(std::chrono::milliseconds timeout) {
+  postToOwner([timeout](OwnerStream& stream) { stream.setFlushTimeout(timeout); });
+}
+
+void SharedConnPoolImpl::WorkerStream::cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) {
+  ASSERT(pool_callbacks_ != nullptr);
+  pool_callbacks_ = nullptr;
+  postToOwner([cancel_policy](OwnerStream& stream) { stream.cancel(cancel_policy); });
+  destroy();
+}
+
+void SharedConnPoolImpl::WorkerStream::postToOwner(std::function<void(OwnerStream&)> cb) {
+  auto guard = std::make_shared<PostGuard>(parent_.thread_, [handoff = handoff_]() {
+    if (handoff->worker_stream_ != nullptr) {
+      handoff->worker_stream_->onOwnerShutdown();
+    }
+  });
+  parent_.owner_->post([handoff = handoff_, guard, cb = std::move(cb)]() {
+    guard->disarm();
+    if (handoff->owner_stream_ != nullptr) {
+      cb(*handoff->owner_stream_);
+    }
+  });
+}
+
+void SharedConnPoolImpl::WorkerStream::maybeComplete() {
+  if (local_complete_ && remote_complete_) {
+    destroy();
+  }
+}
+
+void SharedConnPoolImpl::WorkerStream::destroy() {
+  if (destroyed_) {
+    return;
+  }
+  destroyed_ = true;
+  handoff_->worker_stream_ = nullptr;
+  parent_.onStreamDestroyed(*this);
+}
+
+SharedConnPoolImpl::OwnerStream::OwnerStream(SharedConnPoolThreadSharedPtr owner,
+                                             SharedConnPoolThreadSharedPtr worker,
+                                             StreamHandoffSharedPtr handoff)
+    : owner_(std::move(owner)), worker_(std::move(worker)), handoff_(std::move(handoff)) {
+  handoff_->owner_stream_ = this;
+}
+
+SharedConnPoolImpl::OwnerStream::~OwnerStream() { ASSERT(destroyed_); }
+
+void SharedConnPoolImpl::OwnerStream::newStream(ConnectionPool::Instance* pool,
+                                                const StreamOptions& options) {
+  if (pool == nullptr) {
+    onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                  "no shared connection pool", nullptr);
+    return;
+  }
+  cancellable_ = pool->newStream(*this, *this, options);
+}
+
+void SharedConnPoolImpl::OwnerStream::cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) {
+  if (cancellable_ != nullptr) {
+    cancellable_->cancel(cancel_policy);
+    cancellable_ = nullptr;
+    destroy();
+  } else if (encoder_ != nullptr) {
+    // The stream became ready while the cancellation was posted.
+    resetStream(StreamResetReason::LocalReset);
+  }
+}
+
+void SharedConnPoolImpl::OwnerStream::resetStream(StreamResetReason reason) {
+  if (cancellable_ != nullptr) {
+    cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+    return;
+  }
+  if (encoder_ != nullptr) {
+    // This calls onResetStream() which destroys this stream.
+    encoder_->getStream().resetStream(reason);
+  }
+}
+
+void SharedConnPoolImpl::OwnerStream::encodeHeaders(const RequestHeaderMap& headers,
+                                                    bool end_stream) {
+  ASSERT(encoder_ != nullptr);
+  local_complete_ = end_stream;
+  const Status status = encoder_->encodeHeaders(headers, end_stream);
+  if (!status.ok()) {
+    ENVOY_LOG(debug, "failed to encode handed off request headers: {}", status.message());
+    resetStream(StreamResetReason::LocalReset);
+    return;
+  }
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::OwnerStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  ASSERT(encoder_ != nullptr);
+  const uint64_t length = data.length();
+  local_complete_ = end_stream;
+  encoder_->encodeData(data, end_stream);
+  // From here on the data is subject to the flow control of the codec.
+  if (!end_stream) {
+    postToWorker([length](WorkerStream& stream) { stream.onEncodedDataDelivered(length); });
+  }
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::OwnerStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  ASSERT(encoder_ != nullptr);
+  local_complete_ = true;
+  encoder_->encodeTrailers(trailers);
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::OwnerStream::encodeMetadata(
+    const MetadataMapVector& metadata_map_vector) {
+  ASSERT(encoder_ != nullptr);
+  encoder_->encodeMetadata(metadata_map_vector);
+}
+
+void SharedConnPoolImpl::OwnerStream::enableTcpTunneling() {
+  ASSERT(encoder_ != nullptr);
+  encoder_->enableTcpTunneling();
+}
+
+void SharedConnPoolImpl::OwnerStream::readDisable(bool disable) {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().readDisable(disable);
+  }
+}
+
+void SharedConnPoolImpl::OwnerStream::setFlushTimeout(std::chrono::milliseconds timeout) {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().setFlushTimeout(timeout);
+  }
+}
+
+void SharedConnPoolImpl::OwnerStream::onDecodedDataDelivered(uint64_t length) {
+  ASSERT(decode_bytes_in_flight_ >= length);
+  decode_bytes_in_flight_ -= length;
+  updateReadDisabled();
+}
+
+void SharedConnPoolImpl::OwnerStream::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                                    absl::string_view transport_failure_reason,
+                                                    Upstream::HostDescriptionConstSharedPtr host) {
+  cancellable_ = nullptr;
+  postToWorker([reason, details = std::string(transport_failure_reason),
+                host](WorkerStream& stream) { stream.onPoolFailure(reason, details, host); });
+  destroy();
+}
+
+void SharedConnPoolImpl::OwnerStream::onPoolReady(RequestEncoder& encoder,
+                                                  Upstream::HostDescriptionConstSharedPtr host,
+                                                  StreamInfo::StreamInfo& info,
+                                                  absl::optional<Protocol> protocol) {
+  cancellable_ = nullptr;
+  encoder_ = &encoder;
+  encoder.getStream().addCallbacks(*this);
+
+  ConnectionSnapshot snapshot;
+  const Network::ConnectionInfoProvider& address_provider =
+      encoder.getStream().connectionInfoProvider();
+  snapshot.local_address_ = address_provider.localAddress();
+  snapshot.remote_address_ = address_provider.remoteAddress();
+  if (info.downstreamAddressProvider().sslConnection() != nullptr) {
+    snapshot.ssl_connection_ = std::make_shared<const SslConnectionInfoCopy>(
+        *info.downstreamAddressProvider().sslConnection());
+  }
+  snapshot.connection_id_ = info.downstreamAddressProvider().connectionID();
+  if (info.upstreamInfo() != nullptr) {
+    snapshot.upstream_timing_ = info.upstreamInfo()->upstreamTiming();
+    snapshot.upstream_num_streams_ = info.upstreamInfo()->upstreamNumStreams();
+  }
+  snapshot.protocol_ = protocol;
+  snapshot.buffer_limit_ = encoder.getStream().bufferLimit();
+
+  postToWorker([snapshot, host](WorkerStream& stream) { stream.onPoolReady(snapshot, host); });
+}
+
+void SharedConnPoolImpl::OwnerStream::decode1xxHeaders(ResponseHeaderMapPtr&& headers) {
+  auto holder = std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToWorker([holder](WorkerStream& stream) { stream.decode1xxHeaders(std::move(*holder)); });
+}
+
+void SharedConnPoolImpl::OwnerStream::decodeHeaders(ResponseHeaderMapPtr&& headers,
+                                                    bool end_stream) {
+  auto holder = std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  remote_complete_ = end_stream;
+  postToWorker([holder, end_stream](WorkerStream& stream) {
+    stream.decodeHeaders(std::move(*holder), end_stream);
+  });
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::OwnerStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  // Copy rather than move the data, as its slices may be charged to a memory account.
+  auto copy = std::make_shared<Buffer::OwnedImpl>();
+  copy->add(data);
+  data.drain(data.length());
+  remote_complete_ = end_stream;
+  decode_bytes_in_flight_ += copy->length();
+  postToWorker([copy, end_stream](WorkerStream& stream) { stream.decodeData(*copy, end_stream); });
+  updateReadDisabled();
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::OwnerStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  auto holder = std::make_shared<ResponseTrailerMapPtr>(std::move(trailers));
+  remote_complete_ = true;
+  postToWorker([holder](WorkerStream& stream) { stream.decodeTrailers(std::move(*holder)); });
+  maybeComplete();
+}
+
+void SharedConnPoolImpl::OwnerStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  auto holder = std::make_shared<MetadataMapPtr>(std::move(metadata_map));
+  postToWorker([holder](WorkerStream& stream) { stream.decodeMetadata(std::move(*holder)); });
+}
+
+void SharedConnPoolImpl::OwnerStream::dumpState(std::ostream& os, int indent_level) const {
+  const char* spaces = spacesForLevel(indent_level);
+  os << spaces << "SharedConnPoolImpl::OwnerStream " << this << DUMP_MEMBER(local_complete_)
+     << DUMP_MEMBER(remote_complete_) << "\n";
+}
+
+void SharedConnPoolImpl::OwnerStream::onResetStream(StreamResetReason reason,
+                                                    absl::string_view transport_failure_reason) {
+  // The codec stream is gone, so there are no callbacks to remove.
+  encoder_ = nullptr;
+  postToWorker([reason, details = std::string(transport_failure_reason)](WorkerStream& stream) {
+    stream.onResetStream(reason, details);
+  });
+  destroy();
+}
+
+void SharedConnPoolImpl::OwnerStream::onAboveWriteBufferHighWatermark() {
+  postToWorker([](WorkerStream& stream) { stream.onAboveWriteBufferHighWatermark(); });
+}
+
+void SharedConnPoolImpl::OwnerStream::onBelowWriteBufferLowWatermark() {
+  postToWorker([](WorkerStream& stream) { stream.onBelowWriteBufferLowWatermark(); });
+}
+
+void SharedConnPoolImpl::OwnerStream::postToWorker(std::function<void(WorkerStream&)> cb) {
+  auto guard = std::make_shared<PostGuard>(owner_, [handoff = handoff_]() {
+    if (handoff->owner_stream_ != nullptr) {
+      handoff->owner_stream_->resetStream(StreamResetReason::LocalReset);
+    }
+  });
+  worker_->post([handoff = handoff_, guard, cb = std::move(cb)]() {
+    guard->disarm();
+    if (handoff->worker_stream_ != nullptr) {
+      cb(*handoff->worker_stream_);
+    }
+  });
+}
+
+void SharedConnPoolImpl::OwnerStream::updateReadDisabled() {
+  if (encoder_ == nullptr) {
+    return;
+  }
+  const uint32_t limit = encoder_->getStream().bufferLimit();
+  if (!read_disabled_ && limit > 0 && decode_bytes_in_flight_ > limit) {
+    read_disabled_ = true;
+    encoder_->getStream().readDisable(true);
+  } else if (read_disabled_ && decode_bytes_in_flight_ <= limit / 2) {
+    read_disabled_ = false;
+    encoder_->getStream().readDisable(false);
+  }
+}
+
+void SharedConnPoolImpl::OwnerStream::maybeComplete() {
+  if (local_complete_ && remote_complete_) {
+    destroy();
+  }
+}
+
+void SharedConnPoolImpl::OwnerStream::destroy() {
+  if (destroyed_) {
+    return;
+  }
+  destroyed_ = true;
+  if (encoder_ != nullptr) {
+    if (read_disabled_) {
+      encoder_->getStream().readDisable(false);
+    }
+    encoder_->getStream().removeCallbacks(*this);
+    encoder_ = nullptr;
+  }
+  handoff_->owner_stream_ = nullptr;
+  owner_->dispatcher().deferredDelete(std::unique_ptr<OwnerStream>(this));
+}
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/codec.h"
+#include "envoy/http/conn_pool.h"
+#include "envoy/ssl/connection.h"
+#include "envoy/stream_info/stream_info.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/common/linked_object.h"
+#include "source/common/common/logger.h"
+#include "source/common/network/socket_impl.h"
+#include "source/common/stream_info/stream_info_impl.h"
+
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * Returns the connection pool on the owner thread which streams handed off by a
+ * SharedConnPoolImpl are created on. Called on the owner thread for every stream. May return
+ * nullptr if the owner no longer has the host's cluster.
+ */
+using OwnerConnPoolCb = std::function<ConnectionPool::Instance*()>;
+
+/**
+ * A thread taking part in shared connection pools. Stream events are posted to the thread through
+ * this object rather than through its dispatcher, so that nothing is posted to the dispatcher once
+ * the thread stopped taking part, e.g. because its worker shuts down. Shared with the other
+ * threads, which may outlive it.
+ */
+class SharedConnPoolThread {
+public:
+  explicit SharedConnPoolThread(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  /**
+   * Posts cb to the thread. If the thread was shut down, cb is destroyed without being run.
+   */
+  void post(Event::PostCb cb);
+
+  /**
+   * Stops posting to the thread. Callbacks which were posted before, but not run, are destroyed
+   * with the dispatcher.
+   */
+  void shutdown();
+
+  /**
+   * @return the dispatcher of the thread. Only to be used on the thread itself.
+   */
+  Event::Dispatcher& dispatcher() { return dispatcher_; }
+
+private:
+  Event::Dispatcher& dispatcher_;
+  absl::Mutex mutex_;
+  bool shut_down_ ABSL_GUARDED_BY(mutex_){};
+};
+using SharedConnPoolThreadSharedPtr = std::shared_ptr<SharedConnPoolThread>;
+
+/**
+ * A connection pool which does not own any connections. Each stream is handed off to a connection
+ * pool on another thread, the owner, so that all workers share the owner's HTTP/2 or HTTP/3
+ * connections to a host rather than each worker opening its own.
+ *
+ * Every event on a stream is posted to the other thread: requests are encoded on the owner and
+ * responses are decoded on the worker. Headers and bodies are copied so that no memory owned by
+ * one thread (including buffer memory accounts) is released on the other. Flow control is
+ * forwarded in both directions. Body data which has been posted to the other thread, but not yet
+ * handed to the codec or the response decoder, counts against the buffer limit of the stream: the
+ * owner read disables the upstream stream and the worker raises the write buffer high watermark
+ * while more than that is in flight.
+ *
+ * The streams of both halves survive the other half going away: each holds a shared
+ * StreamHandoff and events for a half which no longer exists are dropped. If one of the threads
+ * shuts down with events still posted to it, the half of the stream on the other thread is failed
+ * or reset.
+ */
+class SharedConnPoolImpl : public ConnectionPool::Instance,
+                           protected Logger::Loggable<Logger::Id::pool> {
+public:
+  SharedConnPoolImpl(Event::Dispatcher& dispatcher, SharedConnPoolThreadSharedPtr thread,
+                     SharedConnPoolThreadSharedPtr owner, Upstream::HostConstSharedPtr host,
+                     OwnerConnPoolCb owner_pool);
+  ~SharedConnPoolImpl() override;
+
+  // ConnectionPool::Instance
+  void addIdleCallback(IdleCb cb) override { idle_callbacks_.push_back(cb); }
+  bool isIdle() const override { return streams_.empty(); }
+  void drainConnections(Envoy::ConnectionPool::DrainBehavior drain_behavior) override;
+  Upstream::HostDescriptionConstSharedPtr host() const override { return host_; }
+  // Preconnecting is done by the owner's pool based on the streams handed off to it.
+  bool maybePreconnect(float) override { return false; }
+  bool hasActiveConnections() const override { return !streams_.empty(); }
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks,
+                                         const StreamOptions& options) override;
+  absl::string_view protocolDescription() const override { return "shared"; }
+
+private:
+  class WorkerStream;
+  class OwnerStream;
+
+  // Links the two halves of a stream. Each pointer is only accessed on the thread of the object
+  // it points to and is cleared when that object is destroyed.
+  struct StreamHandoff {
+    WorkerStream* worker_stream_{};
+    OwnerStream* owner_stream_{};
+  };
+  using StreamHandoffSharedPtr = std::shared_ptr<StreamHandoff>;
+
+  // Posts on_dropped to a thread when destroyed, unless it was disarmed first. Captured by the
+  // events posted between the two halves of a stream, so that one half learns about events which
+  // were destroyed without being run because the other thread shut down.
+  class PostGuard {
+  public:
+    PostGuard(SharedConnPoolThreadSharedPtr thread, Event::PostCb on_dropped)
+        : thread_(std::move(thread)), on_dropped_(std::move(on_dropped)) {}
+    ~PostGuard() {
+      if (thread_ != nullptr) {
+        thread_->post(std::move(on_dropped_));
+      }
+    }
+
+    void disarm() { thread_ = nullptr; }
+
+  private:
+    SharedConnPoolThreadSharedPtr thread_;
+    Event::PostCb on_dropped_;
+  };
+
+  // The properties of the owner's upstream connection that a worker may look at, copied when the
+  // stream is attached to the connection. ssl_connection_ is a copy too, never the owner's
+  // object.
+  struct ConnectionSnapshot {
+    Network::Address::InstanceConstSharedPtr local_address_;
+    Network::Address::InstanceConstSharedPtr remote_address_;
+    Ssl::ConnectionInfoConstSharedPtr ssl_connection_;
+    absl::optional<uint64_t> connection_id_;
+    absl::optional<StreamInfo::UpstreamTiming> upstream_timing_;
+    absl::optional<uint64_t> upstream_num_streams_;
+    absl::optional<Protocol> protocol_;
+    uint32_t buffer_limit_{};
+  };
+
+  // The half of a stream which lives on the worker and is used by the caller of newStream().
+  class WorkerStream : public RequestEncoder,
+                       public Stream,
+                       public ConnectionPool::Cancellable,
+                       public Event::DeferredDeletable,
+                       public LinkedObject<WorkerStream> {
+  public:
+    WorkerStream(SharedConnPoolImpl& parent, ResponseDecoder& response_decoder,
+                 ConnectionPool::Callbacks& callbacks, StreamHandoffSharedPtr handoff);
+    ~WorkerStream() override;
+
+    // @return whether neither the pool callbacks have been invoked nor the stream was canceled.
+    bool pending() const { return pool_callbacks_ != nullptr; }
+
+    // Events posted by the owner.
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       absl::string_view transport_failure_reason,
+                       Upstream::HostDescriptionConstSharedPtr host);
+    void onPoolReady(const ConnectionSnapshot& snapshot,
+                     Upstream::HostDescriptionConstSharedPtr host);
+    void onResetStream(StreamResetReason reason, absl::string_view transport_failure_reason);
+    void onAboveWriteBufferHighWatermark();
+    void onBelowWriteBufferLowWatermark();
+    void onEncodedDataDelivered(uint64_t length);
+    void onOwnerShutdown();
+    void decode1xxHeaders(ResponseHeaderMapPtr&& headers);
+    void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream);
+    void decodeData(Buffer::Instance& data, bool end_stream);
+    void decodeTrailers(ResponseTrailerMapPtr&& trailers);
+    void decodeMetadata(MetadataMapPtr&& metadata_map);
+
+    // RequestEncoder
+    Status encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
+    void encodeTrailers(const RequestTrailerMap& trailers) override;
+    void enableTcpTunneling() override;
+
+    // StreamEncoder
+    void encodeData(Buffer::Instance& data, bool end_stream) override;
+    Stream& getStream() override { return *this; }
+    void encodeMetadata(const MetadataMapVector& metadata_map_vector) override;
+    Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+    // Stream
+    void addCallbacks(StreamCallbacks& callbacks) override { callbacks_.push_back(&callbacks); }
+    void removeCallbacks(StreamCallbacks& callbacks) override;
+    void resetStream(StreamResetReason reason) override;
+    void readDisable(bool disable) override;
+    uint32_t bufferLimit() const override { return buffer_limit_; }
+    const Network::ConnectionInfoProvider& connectionInfoProvider() override {
+      return *connection_info_;
+    }
+    void setFlushTimeout(std::chrono::milliseconds timeout) override;
+    // The stream's buffers are owned by the owner thread, so there is nothing to charge.
+    void setAccount(Buffer::BufferMemoryAccountSharedPtr) override {}
+    const StreamInfo::BytesMeterSharedPtr& bytesMeter() override { return bytes_meter_; }
+
+    // ConnectionPool::Cancellable
+    void cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) override;
+
+  private:
+    void postToOwner(std::function<void(OwnerStream&)> cb);
+    void maybeComplete();
+    void destroy();
+
+    SharedConnPoolImpl& parent_;
+    ResponseDecoder& response_decoder_;
+    ConnectionPool::Callbacks* pool_callbacks_;
+    StreamHandoffSharedPtr handoff_;
+    std::vector<StreamCallbacks*> callbacks_;
+    std::shared_ptr<Network::ConnectionInfoSetterImpl> connection_info_;
+    std::unique_ptr<StreamInfo::StreamInfoImpl> stream_info_;
+    StreamInfo::BytesMeterSharedPtr bytes_meter_{std::make_shared<StreamInfo::BytesMeter>()};
+    uint32_t buffer_limit_{};
+    // Request body bytes posted to the owner which it has not encoded yet.
+    uint64_t encode_bytes_in_flight_{};
+    bool above_write_buffer_high_watermark_{};
+    bool local_complete_{};
+    bool remote_complete_{};
+    bool destroyed_{};
+  };
+
+  // The half of a stream which lives on the owner and is created on the owner's pool.
+  class OwnerStream : public ConnectionPool::Callbacks,
+                      public ResponseDecoder,
+                      public StreamCallbacks,
+                      public Event::DeferredDeletable {
+  public:
+    OwnerStream(SharedConnPoolThreadSharedPtr owner, SharedConnPoolThreadSharedPtr worker,
+                StreamHandoffSharedPtr handoff);
+    ~OwnerStream() override;
+
+    void newStream(ConnectionPool::Instance* pool, const StreamOptions& options);
+
+    // Events posted by the worker.
+    void cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy);
+    void resetStream(StreamResetReason reason);
+    void encodeHeaders(const RequestHeaderMap& headers, bool end_stream);
+    void encodeData(Buffer::Instance& data, bool end_stream);
+    void encodeTrailers(const RequestTrailerMap& trailers);
+    void encodeMetadata(const MetadataMapVector& metadata_map_vector);
+    void enableTcpTunneling();
+    void readDisable(bool disable);
+    void setFlushTimeout(std::chrono::milliseconds timeout);
+    void onDecodedDataDelivered(uint64_t length);
+
+    // ConnectionPool::Callbacks
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       absl::string_view transport_failure_reason,
+                       Upstream::HostDescriptionConstSharedPtr host) override;
+    void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host,
+                     StreamInfo::StreamInfo& info, absl::optional<Protocol> protocol) override;
+
+    // ResponseDecoder
+    void decode1xxHeaders(ResponseHeaderMapPtr&& headers) override;
+    void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) override;
+    void decodeData(Buffer::Instance& data, bool end_stream) override;
+    void decodeTrailers(ResponseTrailerMapPtr&& trailers) override;
+    void decodeMetadata(MetadataMapPtr&& metadata_map) override;
+    void dumpState(std::ostream& os, int indent_level) const override;
+
+    // StreamCallbacks
+    void onResetStream(StreamResetReason reason,
+                       absl::string_view transport_failure_reason) override;
+    void onAboveWriteBufferHighWatermark() override;
+    void onBelowWriteBufferLowWatermark() override;
+
+  private:
+    void postToWorker(std::function<void(WorkerStream&)> cb);
+    // Read disables the upstream stream while too much response body is in flight to the worker.
+    void updateReadDisabled();
+    void maybeComplete();
+    void destroy();
+
+    const SharedConnPoolThreadSharedPtr owner_;
+    const SharedConnPoolThreadSharedPtr worker_;
+    StreamHandoffSharedPtr handoff_;
+    ConnectionPool::Cancellable* cancellable_{};
+    RequestEncoder* encoder_{};
+    // Response body bytes posted to the worker which it has not decoded yet.
+    uint64_t decode_bytes_in_flight_{};
+    bool read_disabled_{};
+    bool local_complete_{};
+    bool remote_complete_{};
+    bool destroyed_{};
+  };
+
+  void onStreamDestroyed(WorkerStream& stream);
+
+  Event::Dispatcher& dispatcher_;
+  const SharedConnPoolThreadSharedPtr thread_;
+  const SharedConnPoolThreadSharedPtr owner_;
+  const Upstream::HostConstSharedPtr host_;
+  const OwnerConnPoolCb owner_pool_;
+  std::list<std::unique_ptr<WorkerStream>> streams_;
+  std::list<IdleCb> idle_callbacks_;
+  bool draining_{};
+};
+
+} // namespace Http
+} // namespace Envoy
@@ -17,6 +17,7 @@
 #include "source/common/event/dispatcher_impl.h"
 #include "source/common/network/address_impl.h"
 #include "source/common/network/io_socket_error_impl.h"
+#include "source/common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
 #include "event2/listener.h"
@@ -34,6 +35,15 @@ UdpListenerImpl::UdpListenerImpl(Event::DispatcherImpl& dispatcher, SocketShared
     : BaseListenerImpl(dispatcher, std::move(socket)), cb_(cb), time_source_(time_source),
       // Default prefer_gro to false for downstream server traffic.
       config_(config, false) {
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.udp_listener_packet_buffer_pool")) {
+    // Large enough for a GRO read if GRO is used, and for a single datagram otherwise, as
+    // recvmmsg() and recvmsg() read one datagram into each block then.
+    const bool use_gro = config_.prefer_gro_ && socket_->ioHandle().supportsUdpGro();
+    const uint32_t packets_per_block = use_gro ? NUM_DATAGRAMS_PER_RECEIVE : 1;
+    packet_buffer_pool_ = std::make_unique<UdpPacketBufferPool>(
+        packets_per_block * config_.max_rx_datagram_size_, packets_per_block,
+        MAX_CACHED_PACKET_BUFFERS);
+  }
   socket_->ioHandle().initializeFileEvent(
       dispatcher, [this](uint32_t events) -> void { onSocketEvent(events); },
       Event::PlatformDefaultTriggerType, Event::FileReadyType::Read | Event::FileReadyType::Write);
@@ -65,9 +75,15 @@ void UdpListenerImpl::onSocketEvent(short flags) {
 void UdpListenerImpl::handleReadCallback() {
   ENVOY_UDP_LOG(trace, "handleReadCallback");
   cb_.onReadReady();
+  const uint64_t old_allocated = packet_buffer_pool_ ? packet_buffer_pool_->allocated() : 0;
+  const uint64_t old_reused = packet_buffer_pool_ ? packet_buffer_pool_->reused() : 0;
   const Api::IoErrorPtr result = Utility::readPacketsFromSocket(
       socket_->ioHandle(), *socket_->connectionInfoProvider().localAddress(), *this, time_source_,
       config_.prefer_gro_, packets_dropped_);
+  if (packet_buffer_pool_ != nullptr) {
+    cb_.onPacketBuffersAcquired(packet_buffer_pool_->allocated() - old_allocated,
+                                packet_buffer_pool_->reused() - old_reused);
+  }
   if (result == nullptr) {
     // No error. The number of reads was limited by read rate. There are more packets to read.
     // Register to read more in the next event loop.
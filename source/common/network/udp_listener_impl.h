@@ -49,6 +49,7 @@ public:
   size_t numPacketsExpectedPerEventLoop() const override {
     return cb_.numPacketsExpectedPerEventLoop();
   }
+  UdpPacketBufferPool* packetBufferPool() override { return packet_buffer_pool_.get(); }
 
 protected:
   void handleWriteCallback();
@@ -61,8 +62,12 @@ private:
   void onSocketEvent(short flags);
   void disableEvent();
 
+  // The number of released packet buffers kept for reuse, which covers a recvmmsg() read.
+  static constexpr uint32_t MAX_CACHED_PACKET_BUFFERS = 4 * NUM_DATAGRAMS_PER_RECEIVE;
+
   TimeSource& time_source_;
   const ResolvedUdpSocketConfig config_;
+  UdpPacketBufferPoolPtr packet_buffer_pool_;
 };
 
 class UdpListenerWorkerRouterImpl : public UdpListenerWorkerRouter {
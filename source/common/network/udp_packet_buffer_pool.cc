@@ -0,0 +1,209 @@
+#include "source/common/network/udp_packet_buffer_pool.h"
+
+#include <atomic>
+#include <new>
+
+#include "source/common/buffer/buffer_impl.h"
+
+#include "absl/container/inlined_vector.h"
+
+namespace Envoy {
+namespace Network {
+
+// A block is allocated as this header, followed by the fragments for the packets read into the
+// block, followed by the packet memory.
+class UdpPacketBufferPool::Block {
+public:
+  // Keeps the block alive while a buffer references a packet in it.
+  class PacketFragment : public Buffer::BufferFragment {
+  public:
+    void set(Block& block, uint64_t offset, uint64_t length) {
+      block_ = &block;
+      offset_ = offset;
+      length_ = length;
+    }
+
+    // Buffer::BufferFragment
+    const void* data() const override { return block_->data() + offset_; }
+    size_t size() const override { return length_; }
+    void done() override { block_->unref(); }
+
+  protected:
+    Block* block_{};
+    uint64_t offset_{};
+    uint64_t length_{};
+  };
+
+  // Used once a block has handed out more packets than it has fragments for.
+  class AllocatedPacketFragment : public PacketFragment {
+  public:
+    void done() override {
+      Block* block = block_;
+      delete this;
+      block->unref();
+    }
+  };
+
+  static Block* create(uint64_t block_size, uint32_t fragments) {
+    const size_t header_size = sizeof(Block) + fragments * sizeof(PacketFragment);
+    uint8_t* memory = static_cast<uint8_t*>(::operator new(header_size + block_size));
+    auto* block = new (memory) Block(reinterpret_cast<PacketFragment*>(memory + sizeof(Block)),
+                                     fragments, memory + header_size);
+    for (uint32_t i = 0; i < fragments; ++i) {
+      new (&block->fragments_[i]) PacketFragment();
+    }
+    return block;
+  }
+
+  static void destroy(Block* block) {
+    for (uint32_t i = 0; i < block->num_fragments_; ++i) {
+      block->fragments_[i].~PacketFragment();
+    }
+    block->~Block();
+    ::operator delete(block);
+  }
+
+  uint8_t* data() const { return data_; }
+
+  // Called on the reading thread when the block leaves the pool for a read slot.
+  void reset(const std::shared_ptr<FreeBlocks>& free_blocks) {
+    refs_.store(1, std::memory_order_relaxed);
+    free_blocks_ = free_blocks;
+    fragments_used_ = 0;
+  }
+
+  // Called on the reading thread, which holds a reference through the read slot.
+  Buffer::BufferFragment& ref(uint64_t offset, uint64_t length) {
+    refs_.fetch_add(1, std::memory_order_relaxed);
+    PacketFragment* fragment = fragments_used_ < num_fragments_ ? &fragments_[fragments_used_++]
+                                                                : new AllocatedPacketFragment();
+    fragment->set(*this, offset, length);
+    return *fragment;
+  }
+
+  // Whether a buffer still references the block, besides the read slot. Only the reading thread
+  // adds references, so the answer can't change to true concurrently.
+  bool referenced() const { return refs_.load(std::memory_order_acquire) > 1; }
+
+  // Called on the reading thread once the read slot holding the block no longer references any
+  // packets handed out from it, so that all of its fragments are done.
+  void reuseFragments() { fragments_used_ = 0; }
+
+  void unref() {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // The pool may be gone, so the free blocks are released only after the block is returned.
+      const std::shared_ptr<FreeBlocks> free_blocks = std::move(free_blocks_);
+      free_blocks->release(this);
+    }
+  }
+
+private:
+  Block(PacketFragment* fragments, uint32_t num_fragments, uint8_t* data)
+      : fragments_(fragments), num_fragments_(num_fragments), data_(data) {}
+
+  PacketFragment* const fragments_;
+  const uint32_t num_fragments_;
+  uint8_t* const data_;
+  std::atomic<uint32_t> refs_{0};
+  // Set while the block is out of the pool.
+  std::shared_ptr<FreeBlocks> free_blocks_;
+  uint32_t fragments_used_{0};
+};
+
+UdpPacketBufferPool::FreeBlocks::~FreeBlocks() {
+  for (Block* block : blocks_) {
+    Block::destroy(block);
+  }
+}
+
+void UdpPacketBufferPool::FreeBlocks::release(Block* block) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (blocks_.size() < max_cached_blocks_) {
+      blocks_.push_back(block);
+      return;
+    }
+  }
+  Block::destroy(block);
+}
+
+UdpPacketBufferPool::UdpPacketBufferPool(uint64_t block_size, uint32_t packets_per_block,
+                                         uint32_t max_cached_blocks)
+    : block_size_(block_size), packets_per_block_(packets_per_block),
+      free_blocks_(std::make_shared<FreeBlocks>(max_cached_blocks)) {}
+
+UdpPacketBufferPool::~UdpPacketBufferPool() {
+  for (Block* block : slots_) {
+    if (block != nullptr) {
+      block->unref();
+    }
+  }
+}
+
+void UdpPacketBufferPool::prepareSlots(uint32_t count) {
+  if (slots_.size() < count) {
+    slots_.resize(count, nullptr);
+  }
+  uint32_t missing = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    Block*& block = slots_[i];
+    if (block != nullptr && block->referenced()) {
+      // Leave the block to the buffers of the packets read into it.
+      block->unref();
+      block = nullptr;
+    }
+    if (block == nullptr) {
+      ++missing;
+    } else {
+      block->reuseFragments();
+    }
+  }
+  if (missing == 0) {
+    return;
+  }
+
+  // Take all the missing blocks that are cached with a single lock.
+  absl::InlinedVector<Block*, 16> cached;
+  {
+    absl::MutexLock lock(&free_blocks_->mutex_);
+    while (cached.size() < missing && !free_blocks_->blocks_.empty()) {
+      cached.push_back(free_blocks_->blocks_.back());
+      free_blocks_->blocks_.pop_back();
+    }
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    Block*& block = slots_[i];
+    if (block != nullptr) {
+      continue;
+    }
+    if (!cached.empty()) {
+      block = cached.back();
+      cached.pop_back();
+      ++reused_;
+    } else {
+      // Not value initialized, as the packets are read over it.
+      block = Block::create(block_size_, packets_per_block_);
+      ++allocated_;
+    }
+    block->reset(free_blocks_);
+  }
+}
+
+uint8_t* UdpPacketBufferPool::slot(uint32_t index) const {
+  ASSERT(index < slots_.size() && slots_[index] != nullptr);
+  return slots_[index]->data();
+}
+
+Buffer::InstancePtr UdpPacketBufferPool::toBuffer(uint32_t index, uint64_t offset,
+                                                  uint64_t length) {
+  ASSERT(index < slots_.size() && slots_[index] != nullptr);
+  ASSERT(offset + length <= block_size_);
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
+  if (length > 0) {
+    buffer->addBufferFragment(slots_[index]->ref(offset, length));
+  }
+  return buffer;
+}
+
+} // namespace Network
+} // namespace Envoy
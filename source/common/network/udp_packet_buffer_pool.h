@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A pool of fixed size memory blocks that UDP packets are received into. The buffers handed out
+ * for the packets reference the blocks instead of copying them, so the packets of a GRO read can
+ * share a single block. A block goes back to the pool once the last buffer referencing it is
+ * destroyed, which may happen on another thread and after the pool itself is destroyed.
+ *
+ * The thread reading from the socket receives into the read slots of the pool, and is the only
+ * one to use the pool itself. A slot keeps its block across reads until a packet read into it is
+ * handed out, so a recvmmsg() which reads few packets only replaces the blocks of those packets.
+ * Blocks are reference counted in place and carry the buffer fragments of their packets, so
+ * handing out a packet allocates nothing but the buffer holding it.
+ */
+class UdpPacketBufferPool {
+public:
+  /**
+   * @param block_size supplies the size of each block.
+   * @param packets_per_block supplies the number of packets expected to be read into a block,
+   *        which are handed out without allocating a buffer fragment for them.
+   * @param max_cached_blocks supplies the number of released blocks kept for reuse. Blocks released
+   *        when the pool is full are freed.
+   */
+  UdpPacketBufferPool(uint64_t block_size, uint32_t packets_per_block, uint32_t max_cached_blocks);
+  ~UdpPacketBufferPool();
+
+  uint64_t blockSize() const { return block_size_; }
+
+  /**
+   * Makes sure the first count read slots hold a block. Only the slots whose block is still
+   * referenced by a buffer handed out by toBuffer() take another block, reused from the pool if
+   * one is available.
+   */
+  void prepareSlots(uint32_t count);
+
+  /**
+   * @return the blockSize() bytes of the block in the read slot at index.
+   */
+  uint8_t* slot(uint32_t index) const;
+
+  /**
+   * @return a buffer holding the length bytes at offset in the block of the read slot at index,
+   *         without copying them.
+   */
+  Buffer::InstancePtr toBuffer(uint32_t index, uint64_t offset, uint64_t length);
+
+  /**
+   * @return the number of blocks prepareSlots() had to allocate.
+   */
+  uint64_t allocated() const { return allocated_; }
+
+  /**
+   * @return the number of blocks prepareSlots() reused from the pool.
+   */
+  uint64_t reused() const { return reused_; }
+
+private:
+  class Block;
+
+  // The released blocks, shared with the blocks handed out so they can be returned after the pool
+  // is destroyed.
+  struct FreeBlocks {
+    explicit FreeBlocks(uint32_t max_cached_blocks) : max_cached_blocks_(max_cached_blocks) {}
+    ~FreeBlocks();
+    void release(Block* block);
+
+    const uint32_t max_cached_blocks_;
+    absl::Mutex mutex_;
+    std::vector<Block*> blocks_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  const uint64_t block_size_;
+  const uint32_t packets_per_block_;
+  const std::shared_ptr<FreeBlocks> free_blocks_;
+  // The block of each read slot, or nullptr until prepareSlots() fills the slot.
+  std::vector<Block*> slots_;
+  uint64_t allocated_{0};
+  uint64_t reused_{0};
+};
+
+using UdpPacketBufferPoolPtr = std::unique_ptr<UdpPacketBufferPool>;
+
+} // namespace Network
+} // namespace Envoy
@@ -554,11 +554,93 @@ void passPayloadToProcessor(uint64_t bytes_read, Buffer::InstancePtr buffer,
                                      std::move(buffer), receive_time);
 }
 
+namespace {
+
+// Reads packets into blocks of the pool and hands them to the processor without copying them.
+Api::IoCallUint64Result readFromSocketIntoPool(IoHandle& handle,
+                                               const Address::Instance& local_address,
+                                               UdpPacketProcessor& udp_packet_processor,
+                                               UdpPacketBufferPool& pool,
+                                               MonotonicTime receive_time, bool use_gro,
+                                               uint32_t* packets_dropped) {
+  const uint64_t max_rx_datagram_size = udp_packet_processor.maxDatagramSize();
+
+  if (use_gro || !handle.supportsMmsg()) {
+    const uint64_t max_rx_size =
+        use_gro ? NUM_DATAGRAMS_PER_RECEIVE * max_rx_datagram_size : max_rx_datagram_size;
+    pool.prepareSlots(1);
+    Buffer::RawSlice slice{pool.slot(0), max_rx_size};
+    IoHandle::RecvMsgOutput output(1, packets_dropped);
+    ENVOY_LOG_MISC(trace, "starting {}recvmsg with max={}", use_gro ? "gro " : "", max_rx_size);
+    Api::IoCallUint64Result result =
+        handle.recvmsg(&slice, 1, local_address.ip()->port(), output);
+    if (!result.ok() || output.msg_[0].truncated_and_dropped_) {
+      return result;
+    }
+
+    const uint64_t bytes_read = std::min(max_rx_size, result.return_value_);
+    // With GRO the kernel may have coalesced several packets of gso_size bytes, the last one
+    // possibly shorter. Each is handed over as its own buffer sharing the block.
+    const uint64_t gso_size = use_gro ? output.msg_[0].gso_size_ : 0;
+    ENVOY_LOG_MISC(trace, "recvmsg bytes {} with gso_size as {}", bytes_read, gso_size);
+    const uint64_t packet_size = gso_size == 0 ? bytes_read : gso_size;
+    uint64_t offset = 0;
+    do {
+      const uint64_t length = std::min(packet_size, bytes_read - offset);
+      passPayloadToProcessor(length, pool.toBuffer(0, offset, length),
+                             output.msg_[0].peer_address_, output.msg_[0].local_address_,
+                             udp_packet_processor, receive_time);
+      offset += length;
+    } while (offset < bytes_read);
+    return result;
+  }
+
+  // Only the slots whose packets are still referenced since the previous read take new blocks.
+  pool.prepareSlots(NUM_DATAGRAMS_PER_RECEIVE);
+  RawSliceArrays slices(NUM_DATAGRAMS_PER_RECEIVE, absl::FixedArray<Buffer::RawSlice>(1));
+  for (uint32_t i = 0; i < NUM_DATAGRAMS_PER_RECEIVE; i++) {
+    slices[i][0] = {pool.slot(i), max_rx_datagram_size};
+  }
+
+  IoHandle::RecvMsgOutput output(NUM_DATAGRAMS_PER_RECEIVE, packets_dropped);
+  ENVOY_LOG_MISC(trace, "starting recvmmsg with packets={} max={}", NUM_DATAGRAMS_PER_RECEIVE,
+                 max_rx_datagram_size);
+  Api::IoCallUint64Result result = handle.recvmmsg(slices, local_address.ip()->port(), output);
+  if (!result.ok()) {
+    return result;
+  }
+
+  uint64_t packets_read = result.return_value_;
+  ENVOY_LOG_MISC(trace, "recvmmsg read {} packets", packets_read);
+  for (uint64_t i = 0; i < packets_read; ++i) {
+    if (output.msg_[i].truncated_and_dropped_) {
+      continue;
+    }
+
+    const uint64_t msg_len = output.msg_[i].msg_len_;
+    ENVOY_LOG_MISC(debug, "Receive a packet with {} bytes from {}", msg_len,
+                   output.msg_[i].peer_address_->asString());
+    passPayloadToProcessor(msg_len, pool.toBuffer(i, 0, std::min(max_rx_datagram_size, msg_len)),
+                           output.msg_[i].peer_address_, output.msg_[i].local_address_,
+                           udp_packet_processor, receive_time);
+  }
+  return result;
+}
+
+} // namespace
+
 Api::IoCallUint64Result Utility::readFromSocket(IoHandle& handle,
                                                 const Address::Instance& local_address,
                                                 UdpPacketProcessor& udp_packet_processor,
                                                 MonotonicTime receive_time, bool use_gro,
                                                 uint32_t* packets_dropped) {
+  UdpPacketBufferPool* pool = udp_packet_processor.packetBufferPool();
+  if (pool != nullptr &&
+      pool->blockSize() >= (use_gro ? NUM_DATAGRAMS_PER_RECEIVE : 1) *
+                               udp_packet_processor.maxDatagramSize()) {
+    return readFromSocketIntoPool(handle, local_address, udp_packet_processor, *pool,
+                                  receive_time, use_gro, packets_dropped);
+  }
 
   if (use_gro) {
     Buffer::InstancePtr buffer = std::make_unique<Buffer::OwnedImpl>();
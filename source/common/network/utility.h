@@ -10,6 +10,7 @@
 #include "envoy/network/listener.h"
 
 #include "source/common/common/statusor.h"
+#include "source/common/network/udp_packet_buffer_pool.h"
 
 #include "absl/strings/string_view.h"
 
@@ -68,6 +69,12 @@ public:
    * An estimated number of packets to read in each read event.
    */
   virtual size_t numPacketsExpectedPerEventLoop() const PURE;
+
+  /**
+   * @return the pool of buffers to receive packets into, or nullptr to allocate a new buffer for
+   *         each read.
+   */
+  virtual UdpPacketBufferPool* packetBufferPool() { return nullptr; }
 };
 
 static const uint64_t DEFAULT_UDP_MAX_DATAGRAM_SIZE = 1500;
@@ -0,0 +1,31 @@
+#include "source/common/orca/orca_parser.h"
+
+#include <string>
+
+#include "source/common/common/base64.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Orca {
+
+absl::StatusOr<xds::data::orca::v3::OrcaLoadReport>
+parseOrcaLoadReportHeaders(const Http::HeaderMap& headers) {
+  static const Http::LowerCaseString header_bin{std::string(EndpointLoadMetricsHeaderBin)};
+
+  const auto header = headers.get(header_bin);
+  if (header.empty()) {
+    return absl::NotFoundError("no ORCA load report header");
+  }
+
+  const std::string decoded = Base64::decode(header[0]->value().getStringView());
+  xds::data::orca::v3::OrcaLoadReport load_report;
+  if (decoded.empty() || !load_report.ParseFromString(decoded)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("unable to parse ORCA load report header ", EndpointLoadMetricsHeaderBin));
+  }
+  return load_report;
+}
+
+} // namespace Orca
+} // namespace Envoy
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "envoy/http/header_map.h"
+
+#include "absl/status/statusor.h"
+#include "xds/data/orca/v3/orca_load_report.pb.h"
+
+namespace Envoy {
+namespace Orca {
+
+// Header used to send ORCA load metrics from the backend, as a base64 encoded binary
+// xds.data.orca.v3.OrcaLoadReport.
+static constexpr absl::string_view EndpointLoadMetricsHeaderBin = "endpoint-load-metrics-bin";
+
+/**
+ * Parse the ORCA load report carried in the given response headers or trailers.
+ * @param headers supplies the response headers or trailers.
+ * @return the parsed load report, a NotFound status if the headers do not carry a report, or an
+ *         InvalidArgument status if the report could not be decoded.
+ */
+absl::StatusOr<xds::data::orca::v3::OrcaLoadReport>
+parseOrcaLoadReportHeaders(const Http::HeaderMap& headers);
+
+} // namespace Orca
+} // namespace Envoy
@@ -26,6 +26,7 @@ void onDeprecatedFieldCommon(absl::string_view description, bool soft_deprecatio
 } // namespace
 
 void WipCounterBase::setWipCounter(Stats::Counter& wip_counter) {
+  absl::MutexLock lock(&wip_mutex_);
   ASSERT(wip_counter_ == nullptr);
   wip_counter_ = &wip_counter;
   wip_counter.add(prestats_wip_count_);
@@ -33,6 +34,7 @@ void WipCounterBase::setWipCounter(Stats::Counter& wip_counter) {
 
 void WipCounterBase::onWorkInProgressCommon(absl::string_view description) {
   ENVOY_LOG_MISC(warn, "{}", description);
+  absl::MutexLock lock(&wip_mutex_);
   if (wip_counter_ != nullptr) {
     wip_counter_->inc();
   } else {
@@ -43,6 +45,7 @@ void WipCounterBase::onWorkInProgressCommon(absl::string_view description) {
 void WarningValidationVisitorImpl::setCounters(Stats::Counter& unknown_counter,
                                                Stats::Counter& wip_counter) {
   setWipCounter(wip_counter);
+  absl::MutexLock lock(&mutex_);
   ASSERT(unknown_counter_ == nullptr);
   unknown_counter_ = &unknown_counter;
   unknown_counter.add(prestats_unknown_count_);
@@ -50,6 +53,7 @@ void WarningValidationVisitorImpl::setCounters(Stats::Counter& unknown_counter,
 
 void WarningValidationVisitorImpl::onUnknownField(absl::string_view description) {
   const uint64_t hash = HashUtil::xxHash64(description);
+  absl::MutexLock lock(&mutex_);
   auto it = descriptions_.insert(hash);
   // If we've seen this before, skip.
   if (!it.second) {
@@ -10,6 +10,7 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/documentation_url.h"
 #include "source/common/common/fmt.h"
+#include "source/common/common/thread.h"
 #include "source/common/protobuf/message_validator_impl.h"
 #include "source/common/protobuf/protobuf.h"
 #include "source/common/protobuf/visitor.h"
@@ -136,21 +137,32 @@ void deprecatedFieldHelper(Runtime::Loader* runtime, bool proto_annotated_as_dep
 #else
   bool warn_only = true;
 #endif
-  if (runtime &&
-      runtime->snapshot().getBoolean("envoy.features.fail_on_any_deprecated_feature", false)) {
+  // Resources of xDS responses may be validated on threads other than the main thread, which have
+  // no thread local snapshot. Only those pay for the locking of threadsafeSnapshot().
+  Runtime::SnapshotConstSharedPtr threadsafe_snapshot;
+  const Runtime::Snapshot* snapshot = nullptr;
+  if (runtime != nullptr) {
+    if (Thread::MainThread::isMainOrTestThread()) {
+      snapshot = &runtime->snapshot();
+    } else {
+      threadsafe_snapshot = runtime->threadsafeSnapshot();
+      snapshot = threadsafe_snapshot.get();
+    }
+  }
+  if (snapshot && snapshot->getBoolean("envoy.features.fail_on_any_deprecated_feature", false)) {
     warn_only = false;
   }
   bool warn_default = warn_only;
   // Allow runtime to be null both to not crash if this is called before server initialization,
   // and so proto validation works in context where runtime singleton is not set up (e.g.
   // standalone config validation utilities)
-  if (runtime && proto_annotated_as_deprecated) {
+  if (snapshot && proto_annotated_as_deprecated) {
     // This is set here, rather than above, so that in the absence of a
     // registry (i.e. test) the default for if a feature is allowed or not is
     // based on ENVOY_DISABLE_DEPRECATED_FEATURES.
     warn_only &= !proto_annotated_as_disallowed;
     warn_default = warn_only;
-    warn_only = runtime->snapshot().deprecatedFeatureEnabled(feature_name, warn_only);
+    warn_only = snapshot->deprecatedFeatureEnabled(feature_name, warn_only);
   }
   // Note this only checks if the runtime override has an actual effect. It
   // does not change the logged warning if someone "allows" a deprecated but not
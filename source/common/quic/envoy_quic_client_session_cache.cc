@@ -0,0 +1,183 @@
+#include "source/common/quic/envoy_quic_client_session_cache.h"
+
+#include <chrono>
+
+#include "source/common/common/base64.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "quiche/quic/core/crypto/transport_parameters.h"
+#include "quiche/quic/core/quic_versions.h"
+
+namespace Envoy {
+namespace Quic {
+
+namespace {
+
+// Mirrors the validity check of quic::QuicClientSessionCache, which allows a second of slack as
+// BoringSSL computes time differently.
+bool isValid(const SSL_SESSION& session, uint64_t now) {
+  const uint64_t time = SSL_SESSION_get_time(&session);
+  return now + 1 >= time && now < time + SSL_SESSION_get_timeout(&session);
+}
+
+std::string toBase64(const uint8_t* data, size_t length) {
+  return Base64::encode(reinterpret_cast<const char*>(data), length);
+}
+
+// Entries are stored as base64 encoded session|transport parameters|application state.
+absl::optional<std::string> serializeEntry(const SSL_SESSION& session,
+                                           const quic::TransportParameters& params,
+                                           const quic::ApplicationState* application_state) {
+  uint8_t* session_data;
+  size_t session_length;
+  if (SSL_SESSION_to_bytes(&session, &session_data, &session_length) != 1) {
+    return absl::nullopt;
+  }
+  bssl::UniquePtr<uint8_t> session_bytes(session_data);
+  std::vector<uint8_t> params_data;
+  if (!quic::SerializeTransportParameters(params, &params_data)) {
+    return absl::nullopt;
+  }
+  return absl::StrCat(toBase64(session_data, session_length), "|",
+                      toBase64(params_data.data(), params_data.size()), "|",
+                      application_state == nullptr
+                          ? ""
+                          : toBase64(application_state->data(), application_state->size()));
+}
+
+} // namespace
+
+EnvoyQuicClientSessionCache::EnvoyQuicClientSessionCache(std::shared_ptr<KeyValueStore> store,
+                                                         std::string key_prefix)
+    : store_(std::move(store)), key_prefix_(absl::StrCat(key_prefix, "\n")) {
+  if (store_ == nullptr) {
+    return;
+  }
+  std::vector<std::string> stale_keys;
+  store_->iterate([this, &stale_keys](const std::string& key, const std::string&) {
+    if (!absl::StartsWith(key, key_prefix_)) {
+      stale_keys.push_back(key);
+    }
+    return KeyValueStore::Iterate::Continue;
+  });
+  for (const std::string& key : stale_keys) {
+    store_->remove(key);
+  }
+}
+
+void EnvoyQuicClientSessionCache::Insert(const quic::QuicServerId& server_id,
+                                         bssl::UniquePtr<SSL_SESSION> session,
+                                         const quic::TransportParameters& params,
+                                         const quic::ApplicationState* application_state) {
+  if (store_ != nullptr) {
+    absl::optional<std::string> value = serializeEntry(*session, params, application_state);
+    if (value.has_value()) {
+      store_->addOrUpdate(storeKey(server_id), value.value(),
+                          std::chrono::seconds(SSL_SESSION_get_timeout(session.get())));
+    } else {
+      ENVOY_LOG(debug, "failed to serialize the resumption state for {}", server_id.ToString());
+    }
+  }
+  cache_.Insert(server_id, std::move(session), params, application_state);
+}
+
+std::unique_ptr<quic::QuicResumptionState>
+EnvoyQuicClientSessionCache::Lookup(const quic::QuicServerId& server_id, quic::QuicWallTime now,
+                                    const SSL_CTX* ctx) {
+  std::unique_ptr<quic::QuicResumptionState> state = cache_.Lookup(server_id, now, ctx);
+  if (store_ == nullptr) {
+    return state;
+  }
+  const std::string key = storeKey(server_id);
+  const absl::optional<absl::string_view> value = store_->get(key);
+  if (!value.has_value()) {
+    return state;
+  }
+  if (state == nullptr) {
+    state = parseEntry(value.value(), now, ctx);
+  }
+  // Session tickets are single use, the server will issue a new one on the resumed connection.
+  // The stored entry holds the same ticket as the in-memory one, so it goes too.
+  store_->remove(key);
+  return state;
+}
+
+void EnvoyQuicClientSessionCache::ClearEarlyData(const quic::QuicServerId& server_id) {
+  cache_.ClearEarlyData(server_id);
+  if (store_ != nullptr) {
+    store_->remove(storeKey(server_id));
+  }
+}
+
+void EnvoyQuicClientSessionCache::OnNewTokenReceived(const quic::QuicServerId& server_id,
+                                                     absl::string_view token) {
+  cache_.OnNewTokenReceived(server_id, token);
+}
+
+void EnvoyQuicClientSessionCache::RemoveExpiredEntries(quic::QuicWallTime now) {
+  // Expired entries of the store are removed by its own TTL handling.
+  cache_.RemoveExpiredEntries(now);
+}
+
+void EnvoyQuicClientSessionCache::Clear() {
+  cache_.Clear();
+  if (store_ == nullptr) {
+    return;
+  }
+  std::vector<std::string> keys;
+  store_->iterate([&keys](const std::string& key, const std::string&) {
+    keys.push_back(key);
+    return KeyValueStore::Iterate::Continue;
+  });
+  for (const std::string& key : keys) {
+    store_->remove(key);
+  }
+}
+
+std::string EnvoyQuicClientSessionCache::storeKey(const quic::QuicServerId& server_id) const {
+  return absl::StrCat(key_prefix_, server_id.ToString());
+}
+
+std::unique_ptr<quic::QuicResumptionState>
+EnvoyQuicClientSessionCache::parseEntry(absl::string_view value, quic::QuicWallTime now,
+                                        const SSL_CTX* ctx) const {
+  const std::vector<absl::string_view> parts = absl::StrSplit(value, '|');
+  if (parts.size() != 3) {
+    return nullptr;
+  }
+  const std::string session_data = Base64::decode(parts[0]);
+  const std::string params_data = Base64::decode(parts[1]);
+  const std::string application_state_data = Base64::decode(parts[2]);
+  if (session_data.empty() || params_data.empty()) {
+    return nullptr;
+  }
+
+  bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_from_bytes(
+      reinterpret_cast<const uint8_t*>(session_data.data()), session_data.size(), ctx));
+  if (session == nullptr || !isValid(*session, now.ToUNIXSeconds())) {
+    return nullptr;
+  }
+  auto params = std::make_unique<quic::TransportParameters>();
+  std::string error_details;
+  if (!quic::ParseTransportParameters(quic::CurrentSupportedHttp3Versions()[0],
+                                      quic::Perspective::IS_SERVER,
+                                      reinterpret_cast<const uint8_t*>(params_data.data()),
+                                      params_data.size(), params.get(), &error_details)) {
+    ENVOY_LOG(debug, "failed to parse stored transport parameters: {}", error_details);
+    return nullptr;
+  }
+
+  auto state = std::make_unique<quic::QuicResumptionState>();
+  state->tls_session = std::move(session);
+  state->transport_params = std::move(params);
+  if (!application_state_data.empty()) {
+    state->application_state = std::make_unique<quic::ApplicationState>(
+        application_state_data.begin(), application_state_data.end());
+  }
+  return state;
+}
+
+} // namespace Quic
+} // namespace Envoy
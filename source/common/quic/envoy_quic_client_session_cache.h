@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/key_value_store.h"
+
+#include "source/common/common/logger.h"
+
+#include "quiche/quic/core/crypto/quic_client_session_cache.h"
+
+namespace Envoy {
+namespace Quic {
+
+// A QUIC client session cache which keeps resumption state in a bounded in-memory
+// quic::QuicClientSessionCache and, if a key value store is provided, also writes it through to
+// the store so that upstream connections can resume, and send early data, after a restart.
+// Entries are used once, like those of the in-memory cache, so handing out a session also removes
+// it from the store.
+class EnvoyQuicClientSessionCache : public quic::SessionCache,
+                                    protected Logger::Loggable<Logger::Id::quic> {
+public:
+  // store may be null, in which case resumption state is only kept in memory. Otherwise entries
+  // are keyed by key_prefix, which identifies the TLS context, and the server ID. Entries of the
+  // store with another prefix, written under a different TLS context, are removed.
+  EnvoyQuicClientSessionCache(std::shared_ptr<KeyValueStore> store, std::string key_prefix);
+
+  // quic::SessionCache
+  void Insert(const quic::QuicServerId& server_id, bssl::UniquePtr<SSL_SESSION> session,
+              const quic::TransportParameters& params,
+              const quic::ApplicationState* application_state) override;
+  std::unique_ptr<quic::QuicResumptionState> Lookup(const quic::QuicServerId& server_id,
+                                                    quic::QuicWallTime now,
+                                                    const SSL_CTX* ctx) override;
+  void ClearEarlyData(const quic::QuicServerId& server_id) override;
+  void OnNewTokenReceived(const quic::QuicServerId& server_id, absl::string_view token) override;
+  void RemoveExpiredEntries(quic::QuicWallTime now) override;
+  // Also removes all the entries of the key value store.
+  void Clear() override;
+
+private:
+  std::string storeKey(const quic::QuicServerId& server_id) const;
+  // Parses a value written by Insert(), returning nullptr if it is malformed or has expired.
+  std::unique_ptr<quic::QuicResumptionState> parseEntry(absl::string_view value,
+                                                        quic::QuicWallTime now,
+                                                        const SSL_CTX* ctx) const;
+
+  quic::QuicClientSessionCache cache_;
+  const std::shared_ptr<KeyValueStore> store_;
+  const std::string key_prefix_;
+};
+
+} // namespace Quic
+} // namespace Envoy
@@ -2,12 +2,16 @@
 
 #include <memory>
 
+#include "envoy/config/common/key_value/v3/config.pb.h"
+#include "envoy/config/common/key_value/v3/config.pb.validate.h"
 #include "envoy/extensions/transport_sockets/quic/v3/quic_transport.pb.validate.h"
 
+#include "source/common/common/thread.h"
+#include "source/common/config/utility.h"
+#include "source/common/quic/envoy_quic_client_session_cache.h"
 #include "source/common/quic/envoy_quic_proof_verifier.h"
 #include "source/extensions/transport_sockets/tls/context_config_impl.h"
-
-#include "quiche/quic/core/crypto/quic_client_session_cache.h"
+#include "source/extensions/transport_sockets/tls/context_impl.h"
 
 namespace Envoy {
 namespace Quic {
@@ -42,18 +46,47 @@ QuicClientTransportSocketConfigFactory::createTransportSocketFactory(
       config, context.messageValidationVisitor());
   auto client_config = std::make_unique<Extensions::TransportSockets::Tls::ClientContextConfigImpl>(
       quic_transport.upstream_tls_context(), context);
-  auto factory =
-      std::make_unique<QuicClientTransportSocketFactory>(std::move(client_config), context);
+  QuicClientTransportSocketFactory::SessionStoreFactoryCb session_store_cb;
+  if (quic_transport.has_session_cache_key_value_store_config()) {
+    if (context.options().concurrency() != 1) {
+      throw EnvoyException(fmt::format(
+          "QUIC session cache has key value store but Envoy has concurrency = {}",
+          context.options().concurrency()));
+    }
+    envoy::config::common::key_value::v3::KeyValueStoreConfig kv_config;
+    MessageUtil::anyConvertAndValidate(
+        quic_transport.session_cache_key_value_store_config().typed_config(), kv_config,
+        context.messageValidationVisitor());
+    auto& kv_factory =
+        Config::Utility::getAndCheckFactory<KeyValueStoreFactory>(kv_config.config());
+    session_store_cb = [kv_config, &kv_factory,
+                        &validation_visitor = context.messageValidationVisitor(),
+                        &file_system = context.api().fileSystem()](Event::Dispatcher& dispatcher) {
+      return kv_factory.createStore(kv_config, validation_visitor, dispatcher, file_system);
+    };
+  }
+  auto factory = std::make_unique<QuicClientTransportSocketFactory>(
+      std::move(client_config), context, std::move(session_store_cb));
   factory->initialize();
   return factory;
 }
 
 QuicClientTransportSocketFactory::QuicClientTransportSocketFactory(
     Ssl::ClientContextConfigPtr config,
-    Server::Configuration::TransportSocketFactoryContext& factory_context)
+    Server::Configuration::TransportSocketFactoryContext& factory_context,
+    SessionStoreFactoryCb session_store_cb)
     : QuicTransportSocketFactoryBase(factory_context.scope(), "client"),
       fallback_factory_(std::make_unique<Extensions::TransportSockets::Tls::ClientSslSocketFactory>(
-          std::move(config), factory_context.sslContextManager(), factory_context.scope())) {}
+          std::move(config), factory_context.sslContextManager(), factory_context.scope())),
+      session_store_cb_(std::move(session_store_cb)) {
+  if (session_store_cb_ != nullptr) {
+    session_store_slot_ =
+        ThreadLocal::TypedSlot<SessionStoreState>::makeUnique(factory_context.threadLocal());
+    session_store_slot_->set([](Event::Dispatcher& dispatcher) {
+      return std::make_shared<SessionStoreState>(dispatcher);
+    });
+  }
+}
 
 ProtobufTypes::MessagePtr QuicClientTransportSocketConfigFactory::createEmptyConfigProto() {
   return std::make_unique<envoy::extensions::transport_sockets::quic::v3::QuicUpstreamTransport>();
@@ -68,15 +101,53 @@ std::shared_ptr<quic::QuicCryptoClientConfig> QuicClientTransportSocketFactory::
     return nullptr;
   }
 
-  if (client_context_ != context) {
-    // If the context has been updated, update the crypto config.
-    client_context_ = context;
-    crypto_config_ = std::make_shared<quic::QuicCryptoClientConfig>(
-        std::make_unique<Quic::EnvoyQuicProofVerifier>(std::move(context)),
-        std::make_unique<quic::QuicClientSessionCache>());
+  if (session_store_slot_ == nullptr) {
+    if (client_context_ != context) {
+      // If the context has been updated, update the crypto config.
+      client_context_ = context;
+      crypto_config_ = createCryptoConfig(std::move(context), nullptr, "");
+    }
+    // Return the latest crypto config.
+    return crypto_config_;
   }
-  // Return the latest crypto config.
-  return crypto_config_;
+
+  // With a key value store, each thread has a crypto config of its own, so that the store is only
+  // used from the thread whose dispatcher it flushes on.
+  SessionStoreState& state = **session_store_slot_;
+  if (state.client_context_ != context) {
+    std::shared_ptr<KeyValueStore> session_store;
+    std::string store_key_prefix;
+    // Only the worker writes to the store, as a second store of the main thread would overwrite
+    // its entries. Connections made from the main thread, such as HTTP/3 health checks, resume
+    // sessions from memory only.
+    if (!Thread::MainThread::isMainThread()) {
+      if (state.store_ == nullptr) {
+        state.store_ = session_store_cb_(state.dispatcher_);
+      }
+      session_store = state.store_;
+      // Stored sessions are only resumed by contexts with the same certificates and validation
+      // configuration, as with the TLS session cache shared across contexts. Other context
+      // implementations share the entries stored without a prefix.
+      const auto* client_context =
+          dynamic_cast<const Extensions::TransportSockets::Tls::ClientContextImpl*>(context.get());
+      if (client_context != nullptr) {
+        store_key_prefix = client_context->sessionCacheKeyPrefix();
+      }
+    }
+    state.client_context_ = context;
+    state.crypto_config_ = createCryptoConfig(std::move(context), std::move(session_store),
+                                              std::move(store_key_prefix));
+  }
+  return state.crypto_config_;
+}
+
+std::shared_ptr<quic::QuicCryptoClientConfig> QuicClientTransportSocketFactory::createCryptoConfig(
+    Envoy::Ssl::ClientContextSharedPtr context, std::shared_ptr<KeyValueStore> session_store,
+    std::string store_key_prefix) {
+  return std::make_shared<quic::QuicCryptoClientConfig>(
+      std::make_unique<Quic::EnvoyQuicProofVerifier>(std::move(context)),
+      std::make_unique<EnvoyQuicClientSessionCache>(std::move(session_store),
+                                                    std::move(store_key_prefix)));
 }
 
 REGISTER_FACTORY(QuicServerTransportSocketConfigFactory,
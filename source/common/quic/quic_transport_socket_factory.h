@@ -1,9 +1,11 @@
 #pragma once
 
+#include "envoy/common/key_value_store.h"
 #include "envoy/extensions/transport_sockets/quic/v3/quic_transport.pb.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/server/transport_socket_config.h"
 #include "envoy/ssl/context_config.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "source/common/common/assert.h"
 #include "source/common/network/transport_socket_options_impl.h"
@@ -99,9 +101,15 @@ private:
 class QuicClientTransportSocketFactory : public Network::CommonUpstreamTransportSocketFactory,
                                          public QuicTransportSocketFactoryBase {
 public:
+  // Creates the key value store QUIC resumption state is also written to, see
+  // EnvoyQuicClientSessionCache, on the dispatcher of the thread using it.
+  using SessionStoreFactoryCb = std::function<KeyValueStorePtr(Event::Dispatcher&)>;
+
+  // If session_store_cb is not null, QUIC resumption state is also written to a key value store.
   QuicClientTransportSocketFactory(
       Ssl::ClientContextConfigPtr config,
-      Server::Configuration::TransportSocketFactoryContext& factory_context);
+      Server::Configuration::TransportSocketFactoryContext& factory_context,
+      SessionStoreFactoryCb session_store_cb = nullptr);
 
   void initialize() override {}
   bool implementsSecureTransport() const override { return true; }
@@ -137,13 +145,32 @@ protected:
   void onSecretUpdated() override {}
 
 private:
+  // Per-thread state, the key value store is created lazily on the worker using it.
+  struct SessionStoreState : public ThreadLocal::ThreadLocalObject {
+    explicit SessionStoreState(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+    Event::Dispatcher& dispatcher_;
+    std::shared_ptr<KeyValueStore> store_;
+    // The latest client context and the crypto config of this thread created from it.
+    Envoy::Ssl::ClientContextSharedPtr client_context_;
+    std::shared_ptr<quic::QuicCryptoClientConfig> crypto_config_;
+  };
+
+  static std::shared_ptr<quic::QuicCryptoClientConfig>
+  createCryptoConfig(Envoy::Ssl::ClientContextSharedPtr context,
+                     std::shared_ptr<KeyValueStore> session_store, std::string store_key_prefix);
+
   // The QUIC client transport socket can create TLS sockets for fallback to TCP.
   std::unique_ptr<Extensions::TransportSockets::Tls::ClientSslSocketFactory> fallback_factory_;
   // Latch the latest client context, to determine if it has updated since last
-  // checked.
+  // checked. Only used without a key value store, in which case the crypto config is shared by all
+  // the threads.
   Envoy::Ssl::ClientContextSharedPtr client_context_;
   // If client_context_ changes, client config will be updated as well.
   std::shared_ptr<quic::QuicCryptoClientConfig> crypto_config_;
+  const SessionStoreFactoryCb session_store_cb_;
+  // Holds the crypto config of each thread and the key value store, which is shared with the
+  // session caches of the crypto configs as they may outlive this factory.
+  ThreadLocal::TypedSlotPtr<SessionStoreState> session_store_slot_;
 };
 
 // Base class to create above QuicTransportSocketFactory for server and client
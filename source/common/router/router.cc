@@ -34,6 +34,7 @@
 #include "source/common/network/upstream_server_name.h"
 #include "source/common/network/upstream_socket_options_filter_state.h"
 #include "source/common/network/upstream_subject_alt_names.h"
+#include "source/common/orca/orca_parser.h"
 #include "source/common/router/config_impl.h"
 #include "source/common/router/debug_config.h"
 #include "source/common/router/retry_state_impl.h"
@@ -1391,6 +1392,8 @@ void Filter::onUpstreamHeaders(uint64_t response_code, Http::ResponseHeaderMapPt
         Upstream::HealthCheckHostMonitor::UnhealthyType::ImmediateHealthCheckFail);
   }
 
+  maybeRecordOrcaLoadReport(*headers, upstream_request);
+
   bool could_not_retry = false;
 
   // Check if this upstream request was already retried, for instance after
@@ -1542,6 +1545,8 @@ void Filter::onUpstreamTrailers(Http::ResponseTrailerMapPtr&& trailers,
   // streams.
   ASSERT(upstream_requests_.size() == 1);
 
+  maybeRecordOrcaLoadReport(*trailers, upstream_request);
+
   if (upstream_request.grpcRqSuccessDeferred()) {
     absl::optional<Grpc::Status::GrpcStatus> grpc_status = Grpc::Common::getGrpcStatus(*trailers);
     if (grpc_status &&
@@ -1557,6 +1562,22 @@ void Filter::onUpstreamTrailers(Http::ResponseTrailerMapPtr&& trailers,
   callbacks_->encodeTrailers(std::move(trailers));
 }
 
+void Filter::maybeRecordOrcaLoadReport(const Http::HeaderMap& headers_or_trailers,
+                                       UpstreamRequest& upstream_request) {
+  if (cluster_->lbType() != Upstream::LoadBalancerType::OrcaWeightedRoundRobin) {
+    return;
+  }
+  const auto load_report = Orca::parseOrcaLoadReportHeaders(headers_or_trailers);
+  if (!load_report.ok()) {
+    if (load_report.status().code() != absl::StatusCode::kNotFound) {
+      ENVOY_STREAM_LOG(debug, "{}", *callbacks_, load_report.status().message());
+    }
+    return;
+  }
+  upstream_request.upstreamHost()->utilizationWeight().update(load_report->rps(),
+                                                              load_report->cpu_utilization());
+}
+
 void Filter::onUpstreamMetadata(Http::MetadataMapPtr&& metadata_map) {
   callbacks_->encodeMetadata(std::move(metadata_map));
 }
@@ -1575,6 +1596,12 @@ void Filter::onUpstreamComplete(UpstreamRequest& upstream_request) {
         FilterUtility::percentageOfTimeout(response_time, timeout_.global_timeout_));
   }
 
+  if (cluster_->lbType() == Upstream::LoadBalancerType::PeakEwma &&
+      !callbacks_->streamInfo().healthCheck() &&
+      DateUtil::timePointValid(downstream_request_complete_time_)) {
+    upstream_request.upstreamHost()->responseTimeEstimator().add(response_time);
+  }
+
   if (config_.emit_dynamic_stats_ && !callbacks_->streamInfo().healthCheck() &&
       DateUtil::timePointValid(downstream_request_complete_time_)) {
     upstream_request.upstreamHost()->outlierDetector().putResponseTime(response_time);
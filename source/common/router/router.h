@@ -555,6 +555,10 @@ private:
                                                 uint64_t status_code);
   void updateOutlierDetection(Upstream::Outlier::Result result, UpstreamRequest& upstream_request,
                               absl::optional<uint64_t> code);
+  // Feeds an ORCA load report carried in the response headers or trailers to the utilization
+  // weight of the upstream host, if the cluster load balancer makes use of it.
+  void maybeRecordOrcaLoadReport(const Http::HeaderMap& headers_or_trailers,
+                                 UpstreamRequest& upstream_request);
   void doRetry(bool can_send_early_data, bool can_use_http3);
   void runRetryOptionsPredicates(UpstreamRequest& retriable_request);
   // Called immediately after a non-5xx header is received from upstream, performs stats accounting
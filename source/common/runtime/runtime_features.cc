@@ -72,11 +72,16 @@ RUNTIME_GUARD(envoy_reloadable_features_strict_check_on_ipv4_compat);
 RUNTIME_GUARD(envoy_reloadable_features_support_locality_update_on_eds_cluster_endpoints);
 RUNTIME_GUARD(envoy_reloadable_features_test_feature_true);
 RUNTIME_GUARD(envoy_reloadable_features_tls_async_cert_validation);
+RUNTIME_GUARD(envoy_reloadable_features_tls_select_certificate_by_sni);
 RUNTIME_GUARD(envoy_reloadable_features_top_level_ecds_stats);
+RUNTIME_GUARD(envoy_reloadable_features_udp_listener_packet_buffer_pool);
 RUNTIME_GUARD(envoy_reloadable_features_udp_proxy_connect);
 RUNTIME_GUARD(envoy_reloadable_features_unified_header_formatter);
 RUNTIME_GUARD(envoy_reloadable_features_use_rfc_connect);
 RUNTIME_GUARD(envoy_reloadable_features_validate_connect);
+RUNTIME_GUARD(envoy_reloadable_features_xds_parallel_resource_decoding);
+RUNTIME_GUARD(envoy_reloadable_features_xds_parse_responses_on_arena);
+RUNTIME_GUARD(envoy_reloadable_features_xds_reuse_unchanged_resources);
 RUNTIME_GUARD(envoy_restart_features_explicit_wildcard_resource);
 RUNTIME_GUARD(envoy_restart_features_remove_runtime_singleton);
 RUNTIME_GUARD(envoy_restart_features_use_apple_api_for_dns_lookups);
@@ -102,6 +107,15 @@ FALSE_RUNTIME_GUARD(envoy_reloadable_features_runtime_initialized);
 // TODO(mattklein123): Also unit test this if this sticks and this becomes the default for Apple &
 // Android.
 FALSE_RUNTIME_GUARD(envoy_reloadable_features_always_use_v6);
+// TODO(envoy-maintainers): Opt-in for one release. Flip to true in the next release if deployments
+// enabling it report no drop in the ssl.session_cache_hit ratio and no memory growth beyond
+// tls.shared_session_cache.max_sessions, then remove the guard and the per-context session caches
+// one release after that.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_tls_shared_session_cache);
+// TODO(envoy-maintainers): Every TLS connection through the inspector pays for storing the
+// ClientHello info, but only connections whose filter chain terminates TLS save a parse. Flip to
+// true once tls_inspector_benchmark shows a net saving for listeners which mostly terminate TLS.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_tls_inspector_share_client_hello);
 
 // Block of non-boolean flags. These are deprecated. Do not add more.
 ABSL_FLAG(uint64_t, envoy_headermap_lazy_map_min_size, 3, "");  // NOLINT
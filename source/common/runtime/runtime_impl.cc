@@ -1,7 +1,10 @@
 #include "source/common/runtime/runtime_impl.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/config/bootstrap/v3/bootstrap.pb.h"
 #include "envoy/config/core/v3/config_source.pb.h"
@@ -42,18 +45,18 @@ void countDeprecatedFeatureUseInternal(const RuntimeStats& stats) {
   stats.deprecated_feature_seen_since_process_start_.inc();
 }
 
-void refreshReloadableFlags(const Snapshot::EntryMap& flag_map) {
+void refreshReloadableFlags(const SnapshotImpl::EntryIndex& flag_map) {
   absl::flat_hash_map<std::string, bool> quiche_flags_override;
   for (const auto& it : flag_map) {
 #ifdef ENVOY_ENABLE_QUIC
     if (absl::StartsWith(it.first, quiche::EnvoyQuicheReloadableFlagPrefix) &&
-        it.second.bool_value_.has_value()) {
+        it.second->bool_value_.has_value()) {
       quiche_flags_override[it.first.substr(quiche::EnvoyFeaturePrefix.length())] =
-          it.second.bool_value_.value();
+          it.second->bool_value_.value();
     }
 #endif
-    if (it.second.bool_value_.has_value() && isRuntimeFeature(it.first)) {
-      maybeSetRuntimeGuard(it.first, it.second.bool_value_.value());
+    if (it.second->bool_value_.has_value() && isRuntimeFeature(it.first)) {
+      maybeSetRuntimeGuard(it.first, it.second->bool_value_.value());
     }
   }
 #ifdef ENVOY_ENABLE_QUIC
@@ -61,8 +64,8 @@ void refreshReloadableFlags(const Snapshot::EntryMap& flag_map) {
 #endif
   // Make sure ints are parsed after the flag allowing deprecated ints is parsed.
   for (const auto& it : flag_map) {
-    if (it.second.uint_value_.has_value()) {
-      maybeSetDeprecatedInts(it.first, it.second.uint_value_.value());
+    if (it.second->uint_value_.has_value()) {
+      maybeSetDeprecatedInts(it.first, it.second->uint_value_.value());
     }
   }
   markRuntimeInitialized();
@@ -127,7 +130,7 @@ Snapshot::ConstStringOptRef SnapshotImpl::get(absl::string_view key) const {
   if (entry == values_.end()) {
     return absl::nullopt;
   } else {
-    return entry->second.raw_string_value_;
+    return entry->second->raw_string_value_;
   }
 }
 
@@ -141,20 +144,20 @@ bool SnapshotImpl::featureEnabled(absl::string_view key,
                                   uint64_t random_value) const {
   const auto& entry = key.empty() ? values_.end() : values_.find(key);
   envoy::type::v3::FractionalPercent percent;
-  if (entry != values_.end() && entry->second.fractional_percent_value_.has_value()) {
-    percent = entry->second.fractional_percent_value_.value();
-  } else if (entry != values_.end() && entry->second.uint_value_.has_value()) {
+  if (entry != values_.end() && entry->second->fractional_percent_value_.has_value()) {
+    percent = entry->second->fractional_percent_value_.value();
+  } else if (entry != values_.end() && entry->second->uint_value_.has_value()) {
     // Check for > 100 because the runtime value is assumed to be specified as
     // an integer, and it also ensures that truncating the uint64_t runtime
     // value into a uint32_t percent numerator later is safe
-    if (entry->second.uint_value_.value() > 100) {
+    if (entry->second->uint_value_.value() > 100) {
       return true;
     }
 
     // The runtime value was specified as an integer rather than a fractional
     // percent proto. To preserve legacy semantics, we treat it as a percentage
     // (i.e. denominator of 100).
-    percent.set_numerator(entry->second.uint_value_.value());
+    percent.set_numerator(entry->second->uint_value_.value());
     percent.set_denominator(envoy::type::v3::FractionalPercent::HUNDRED);
   } else {
     percent = default_value;
@@ -178,48 +181,108 @@ bool SnapshotImpl::featureEnabled(absl::string_view key,
 uint64_t SnapshotImpl::getInteger(absl::string_view key, uint64_t default_value) const {
   ASSERT(!isRuntimeFeature(key));
   const auto& entry = key.empty() ? values_.end() : values_.find(key);
-  if (entry == values_.end() || !entry->second.uint_value_) {
+  if (entry == values_.end() || !entry->second->uint_value_) {
     return default_value;
   } else {
-    return entry->second.uint_value_.value();
+    return entry->second->uint_value_.value();
   }
 }
 
 double SnapshotImpl::getDouble(absl::string_view key, double default_value) const {
   ASSERT(!isRuntimeFeature(key)); // Make sure runtime guarding is only used for getBoolean
   const auto& entry = key.empty() ? values_.end() : values_.find(key);
-  if (entry == values_.end() || !entry->second.double_value_) {
+  if (entry == values_.end() || !entry->second->double_value_) {
     return default_value;
   } else {
-    return entry->second.double_value_.value();
+    return entry->second->double_value_.value();
   }
 }
 
 bool SnapshotImpl::getBoolean(absl::string_view key, bool default_value) const {
   const auto& entry = key.empty() ? values_.end() : values_.find(key);
-  if (entry == values_.end() || !entry->second.bool_value_.has_value()) {
+  if (entry == values_.end() || !entry->second->bool_value_.has_value()) {
     return default_value;
   } else {
-    return entry->second.bool_value_.value();
+    return entry->second->bool_value_.value();
   }
 }
 
-const std::vector<Snapshot::OverrideLayerConstPtr>& SnapshotImpl::getLayers() const {
+const std::vector<Snapshot::OverrideLayerConstSharedPtr>& SnapshotImpl::getLayers() const {
   return layers_;
 }
 
-const Snapshot::EntryMap& SnapshotImpl::values() const { return values_; }
+const SnapshotImpl::EntryIndex& SnapshotImpl::values() const { return values_; }
 
 SnapshotImpl::SnapshotImpl(Random::RandomGenerator& generator, RuntimeStats& stats,
-                           std::vector<OverrideLayerConstPtr>&& layers)
+                           std::vector<OverrideLayerConstSharedPtr>&& layers)
     : layers_{std::move(layers)}, generator_{generator}, stats_{stats} {
+  buildIndex();
+  stats.num_keys_.set(values_.size());
+}
+
+SnapshotImpl::SnapshotImpl(const SnapshotImpl& previous,
+                           std::vector<OverrideLayerConstSharedPtr>&& layers)
+    : layers_{std::move(layers)}, generator_{previous.generator_}, stats_{previous.stats_} {
+  if (layers_.size() != previous.layers_.size()) {
+    // A layer appeared or disappeared, so positions can't be matched up.
+    buildIndex();
+    stats_.num_keys_.set(values_.size());
+    return;
+  }
+
+  // Copying the index only copies pointers; no key or value is copied or parsed again.
+  values_ = previous.values_;
+  for (size_t i = 0; i < layers_.size(); ++i) {
+    const auto& old_layer = previous.layers_[i];
+    const auto& new_layer = layers_[i];
+    if (old_layer == new_layer) {
+      continue;
+    }
+    // Keys provided by the old version of the layer now come from whichever layer has them.
+    for (const auto& kv : old_layer->values()) {
+      const auto it = values_.find(kv.first);
+      if (it != values_.end() && it->second == &kv.second) {
+        values_.erase(it);
+        resolveKey(kv.first);
+      }
+    }
+    for (const auto& kv : new_layer->values()) {
+      if (!overriddenAbove(i, kv.first)) {
+        values_.erase(kv.first);
+        values_.emplace(kv.first, &kv.second);
+      }
+    }
+  }
+  stats_.num_keys_.set(values_.size());
+}
+
+void SnapshotImpl::buildIndex() {
   for (const auto& layer : layers_) {
     for (const auto& kv : layer->values()) {
+      // The key is erased first so that it refers to the string owned by the overriding layer.
       values_.erase(kv.first);
-      values_.emplace(kv.first, kv.second);
+      values_.emplace(kv.first, &kv.second);
     }
   }
-  stats.num_keys_.set(values_.size());
+}
+
+void SnapshotImpl::resolveKey(absl::string_view key) {
+  for (auto layer = layers_.rbegin(); layer != layers_.rend(); ++layer) {
+    const auto it = (*layer)->values().find(key);
+    if (it != (*layer)->values().end()) {
+      values_.emplace(it->first, &it->second);
+      return;
+    }
+  }
+}
+
+bool SnapshotImpl::overriddenAbove(size_t position, absl::string_view key) const {
+  for (size_t i = position + 1; i < layers_.size(); ++i) {
+    if (layers_[i]->values().contains(key)) {
+      return true;
+    }
+  }
+  return false;
 }
 
 SnapshotImpl::Entry SnapshotImpl::createEntry(const std::string& value) {
@@ -410,7 +473,8 @@ LoaderImpl::LoaderImpl(Event::Dispatcher& dispatcher, ThreadLocal::SlotAllocator
       config_(config), service_cluster_(local_info.clusterName()), api_(api),
       init_watcher_("RTDS", [this]() { onRtdsReady(); }), store_(store) {
   absl::node_hash_set<std::string> layer_names;
-  for (const auto& layer : config_.layers()) {
+  for (int i = 0; i < config_.layers_size(); ++i) {
+    const auto& layer = config_.layers(i);
     auto ret = layer_names.insert(layer.name());
     if (!ret.second) {
       throw EnvoyException(absl::StrCat("Duplicate layer name: ", layer.name()));
@@ -431,11 +495,14 @@ LoaderImpl::LoaderImpl(Event::Dispatcher& dispatcher, ThreadLocal::SlotAllocator
         watcher_ = dispatcher.createFilesystemWatcher();
       }
       watcher_->addWatch(layer.disk_layer().symlink_root(), Filesystem::Watcher::Events::MovedTo,
-                         [this](uint32_t) -> void { loadNewSnapshot(); });
+                         [this](uint32_t) -> void {
+                           rebuildLayers(envoy::config::bootstrap::v3::RuntimeLayer::kDiskLayer);
+                           loadNewSnapshot();
+                         });
       break;
     case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kRtdsLayer:
-      subscriptions_.emplace_back(
-          std::make_unique<RtdsSubscription>(*this, layer.rtds_layer(), store, validation_visitor));
+      subscriptions_.emplace_back(std::make_unique<RtdsSubscription>(*this, layer.rtds_layer(), i,
+                                                                     store, validation_visitor));
       init_manager_.add(subscriptions_.back()->init_target_);
       break;
     case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::LAYER_SPECIFIER_NOT_SET:
@@ -443,6 +510,11 @@ LoaderImpl::LoaderImpl(Event::Dispatcher& dispatcher, ThreadLocal::SlotAllocator
     }
   }
 
+  layers_.resize(config_.layers_size());
+  layer_load_errors_.resize(config_.layers_size());
+  for (int i = 0; i < config_.layers_size(); ++i) {
+    rebuildLayer(i);
+  }
   loadNewSnapshot();
 }
 
@@ -466,11 +538,11 @@ void LoaderImpl::onRtdsReady() {
 
 RtdsSubscription::RtdsSubscription(
     LoaderImpl& parent, const envoy::config::bootstrap::v3::RuntimeLayer::RtdsLayer& rtds_layer,
-    Stats::Store& store, ProtobufMessage::ValidationVisitor& validation_visitor)
+    int layer_index, Stats::Store& store, ProtobufMessage::ValidationVisitor& validation_visitor)
     : Envoy::Config::SubscriptionBase<envoy::service::runtime::v3::Runtime>(validation_visitor,
                                                                             "name"),
-      parent_(parent), config_source_(rtds_layer.rtds_config()), store_(store),
-      stats_scope_(store_.createScope("runtime")), resource_name_(rtds_layer.name()),
+      parent_(parent), layer_index_(layer_index), config_source_(rtds_layer.rtds_config()),
+      store_(store), stats_scope_(store_.createScope("runtime")), resource_name_(rtds_layer.name()),
       init_target_("RTDS " + resource_name_, [this]() { start(); }) {}
 
 void RtdsSubscription::createSubscription() {
@@ -491,7 +563,7 @@ void RtdsSubscription::onConfigUpdate(const std::vector<Config::DecodedResourceR
   }
   ENVOY_LOG(debug, "Reloading RTDS snapshot for onConfigUpdate");
   proto_.CopyFrom(runtime.layer());
-  parent_.loadNewSnapshot();
+  onLayerChanged();
   init_target_.ready();
 }
 
@@ -538,12 +610,18 @@ void RtdsSubscription::onConfigRemoved(
   }
   ENVOY_LOG(debug, "Clear RTDS snapshot for onConfigUpdate");
   proto_.Clear();
-  parent_.loadNewSnapshot();
+  onLayerChanged();
   init_target_.ready();
 }
 
+void RtdsSubscription::onLayerChanged() {
+  parent_.rebuildLayer(layer_index_);
+  parent_.loadNewSnapshot();
+}
+
 void LoaderImpl::loadNewSnapshot() {
   std::shared_ptr<SnapshotImpl> ptr = createNewSnapshot();
+  last_snapshot_ = ptr;
   tls_->set([ptr](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::static_pointer_cast<ThreadLocal::ThreadLocalObject>(ptr);
   });
@@ -578,6 +656,7 @@ void LoaderImpl::mergeValues(const absl::node_hash_map<std::string, std::string>
     throw EnvoyException("No admin layer specified");
   }
   admin_layer_->mergeValues(values);
+  rebuildLayers(envoy::config::bootstrap::v3::RuntimeLayer::kAdminLayer);
   loadNewSnapshot();
 }
 
@@ -592,49 +671,75 @@ RuntimeStats LoaderImpl::generateStats(Stats::Store& store) {
   return stats;
 }
 
+void LoaderImpl::rebuildLayer(int index) {
+  const auto& layer = config_.layers(index);
+  layer_load_errors_[index] = false;
+  switch (layer.layer_specifier_case()) {
+  case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kStaticLayer:
+    layers_[index] = std::make_shared<const ProtoLayer>(layer.name(), layer.static_layer());
+    break;
+  case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kDiskLayer: {
+    layers_[index] = nullptr;
+    std::string path = layer.disk_layer().symlink_root() + "/" + layer.disk_layer().subdirectory();
+    if (layer.disk_layer().append_service_cluster()) {
+      path += "/" + service_cluster_;
+    }
+    if (api_.fileSystem().directoryExists(path)) {
+      TRY_ASSERT_MAIN_THREAD {
+        layers_[index] = std::make_shared<const DiskLayer>(layer.name(), path, api_);
+      }
+      END_TRY
+      catch (EnvoyException& e) {
+        // TODO(htuch): Consider latching here, rather than ignoring the
+        // layer. This would be consistent with filesystem RTDS.
+        layer_load_errors_[index] = true;
+        ENVOY_LOG(debug, "error loading runtime values for layer {} from disk: {}",
+                  layer.DebugString(), e.what());
+      }
+    }
+    break;
+  }
+  case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kAdminLayer:
+    layers_[index] = std::make_shared<const AdminLayer>(*admin_layer_);
+    break;
+  case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kRtdsLayer: {
+    auto subscription = std::find_if(
+        subscriptions_.begin(), subscriptions_.end(),
+        [index](const RtdsSubscriptionPtr& s) { return s->layer_index_ == index; });
+    ASSERT(subscription != subscriptions_.end());
+    layers_[index] = std::make_shared<const ProtoLayer>(layer.name(), (*subscription)->proto_);
+    break;
+  }
+  case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::LAYER_SPECIFIER_NOT_SET:
+    PANIC_DUE_TO_PROTO_UNSET;
+  }
+}
+
+void LoaderImpl::rebuildLayers(
+    envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase type) {
+  for (int i = 0; i < config_.layers_size(); ++i) {
+    if (config_.layers(i).layer_specifier_case() == type) {
+      rebuildLayer(i);
+    }
+  }
+}
+
 SnapshotImplPtr LoaderImpl::createNewSnapshot() {
-  std::vector<Snapshot::OverrideLayerConstPtr> layers;
+  std::vector<Snapshot::OverrideLayerConstSharedPtr> layers;
   uint32_t disk_layers = 0;
   uint32_t error_layers = 0;
-  uint32_t rtds_layer = 0;
-  for (const auto& layer : config_.layers()) {
-    switch (layer.layer_specifier_case()) {
-    case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kStaticLayer:
-      layers.emplace_back(std::make_unique<const ProtoLayer>(layer.name(), layer.static_layer()));
-      break;
-    case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kDiskLayer: {
-      std::string path =
-          layer.disk_layer().symlink_root() + "/" + layer.disk_layer().subdirectory();
-      if (layer.disk_layer().append_service_cluster()) {
-        path += "/" + service_cluster_;
-      }
-      if (api_.fileSystem().directoryExists(path)) {
-        TRY_ASSERT_MAIN_THREAD {
-          layers.emplace_back(std::make_unique<DiskLayer>(layer.name(), path, api_));
-          ++disk_layers;
-        }
-        END_TRY
-        catch (EnvoyException& e) {
-          // TODO(htuch): Consider latching here, rather than ignoring the
-          // layer. This would be consistent with filesystem RTDS.
-          ++error_layers;
-          ENVOY_LOG(debug, "error loading runtime values for layer {} from disk: {}",
-                    layer.DebugString(), e.what());
-        }
-      }
-      break;
+  for (int i = 0; i < config_.layers_size(); ++i) {
+    if (layer_load_errors_[i]) {
+      ++error_layers;
     }
-    case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kAdminLayer:
-      layers.push_back(std::make_unique<AdminLayer>(*admin_layer_));
-      break;
-    case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kRtdsLayer: {
-      auto* subscription = subscriptions_[rtds_layer++].get();
-      layers.emplace_back(std::make_unique<const ProtoLayer>(layer.name(), subscription->proto_));
-      break;
+    if (layers_[i] == nullptr) {
+      continue;
     }
-    case envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::LAYER_SPECIFIER_NOT_SET:
-      PANIC_DUE_TO_PROTO_UNSET;
+    if (config_.layers(i).layer_specifier_case() ==
+        envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase::kDiskLayer) {
+      ++disk_layers;
     }
+    layers.push_back(layers_[i]);
   }
   stats_.num_layers_.set(layers.size());
   if (error_layers == 0) {
@@ -647,7 +752,10 @@ SnapshotImplPtr LoaderImpl::createNewSnapshot() {
   } else {
     stats_.override_dir_not_exists_.inc();
   }
-  return std::make_unique<SnapshotImpl>(generator_, stats_, std::move(layers));
+  if (last_snapshot_ == nullptr) {
+    return std::make_unique<SnapshotImpl>(generator_, stats_, std::move(layers));
+  }
+  return std::make_unique<SnapshotImpl>(*last_snapshot_, std::move(layers));
 }
 
 } // namespace Runtime
@@ -29,6 +29,7 @@
 #include "source/common/init/target_impl.h"
 #include "source/common/singleton/threadsafe_singleton.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "spdlog/spdlog.h"
 
@@ -63,8 +64,21 @@ struct RuntimeStats {
  */
 class SnapshotImpl : public Snapshot, Logger::Loggable<Logger::Id::runtime> {
 public:
+  /**
+   * The effective entry of every key, keyed by and pointing into the layer that provides it. The
+   * layers are immutable and kept alive by the snapshot.
+   */
+  using EntryIndex = absl::flat_hash_map<absl::string_view, const Entry*>;
+
   SnapshotImpl(Random::RandomGenerator& generator, RuntimeStats& stats,
-               std::vector<OverrideLayerConstPtr>&& layers);
+               std::vector<OverrideLayerConstSharedPtr>&& layers);
+
+  /**
+   * Builds a snapshot whose layers are mostly shared with a previous snapshot. Only the keys of
+   * layers that are not the same object as the previous snapshot's layer at the same position are
+   * resolved again; the rest of the previous snapshot's index is reused as is.
+   */
+  SnapshotImpl(const SnapshotImpl& previous, std::vector<OverrideLayerConstSharedPtr>&& layers);
 
   // Runtime::Snapshot
   bool deprecatedFeatureEnabled(absl::string_view key, bool default_value) const override;
@@ -83,9 +97,9 @@ public:
   uint64_t getInteger(absl::string_view key, uint64_t default_value) const override;
   double getDouble(absl::string_view key, double default_value) const override;
   bool getBoolean(absl::string_view key, bool value) const override;
-  const std::vector<OverrideLayerConstPtr>& getLayers() const override;
+  const std::vector<OverrideLayerConstSharedPtr>& getLayers() const override;
 
-  const EntryMap& values() const;
+  const EntryIndex& values() const;
 
   static Entry createEntry(const std::string& value);
   static Entry createEntry(const ProtobufWkt::Value& value);
@@ -108,12 +122,18 @@ private:
     parseEntryFractionalPercentValue(entry);
   }
 
+  void buildIndex();
+  // Points the index at the entry of the topmost layer that has the key, if any.
+  void resolveKey(absl::string_view key);
+  // Whether any layer above the given position has the key.
+  bool overriddenAbove(size_t position, absl::string_view key) const;
+
   static bool parseEntryBooleanValue(Entry& entry);
   static bool parseEntryDoubleValue(Entry& entry);
   static void parseEntryFractionalPercentValue(Entry& entry);
 
-  const std::vector<OverrideLayerConstPtr> layers_;
-  EntryMap values_;
+  const std::vector<OverrideLayerConstSharedPtr> layers_;
+  EntryIndex values_;
   Random::RandomGenerator& generator_;
   RuntimeStats& stats_;
 };
@@ -194,7 +214,8 @@ struct RtdsSubscription : Envoy::Config::SubscriptionBase<envoy::service::runtim
                           Logger::Loggable<Logger::Id::runtime> {
   RtdsSubscription(LoaderImpl& parent,
                    const envoy::config::bootstrap::v3::RuntimeLayer::RtdsLayer& rtds_layer,
-                   Stats::Store& store, ProtobufMessage::ValidationVisitor& validation_visitor);
+                   int layer_index, Stats::Store& store,
+                   ProtobufMessage::ValidationVisitor& validation_visitor);
 
   // Config::SubscriptionCallbacks
   void onConfigUpdate(const std::vector<Config::DecodedResourceRef>& resources,
@@ -210,8 +231,11 @@ struct RtdsSubscription : Envoy::Config::SubscriptionBase<envoy::service::runtim
   void validateUpdateSize(uint32_t added_resources_num, uint32_t removed_resources_num);
   void onConfigRemoved(const Protobuf::RepeatedPtrField<std::string>& removed_resources);
   void createSubscription();
+  void onLayerChanged();
 
   LoaderImpl& parent_;
+  // Position of this subscription's layer in the loader's layers.
+  const int layer_index_;
   const envoy::config::core::v3::ConfigSource config_source_;
   Stats::Store& store_;
   Stats::ScopeSharedPtr stats_scope_;
@@ -249,7 +273,11 @@ public:
 private:
   friend RtdsSubscription;
 
-  // Create a new Snapshot
+  // Rebuild the layer at the given position in config_.layers() from its source.
+  void rebuildLayer(int index);
+  // Rebuild all layers of the given type.
+  void rebuildLayers(envoy::config::bootstrap::v3::RuntimeLayer::LayerSpecifierCase type);
+  // Create a new Snapshot from the current layers, sharing unchanged layers with the last one
   SnapshotImplPtr createNewSnapshot();
   // Load a new Snapshot into TLS
   void loadNewSnapshot();
@@ -270,6 +298,12 @@ private:
   std::vector<RtdsSubscriptionPtr> subscriptions_;
   Upstream::ClusterManager* cm_{};
   Stats::Store& store_;
+  // The current layers by position in config_.layers(). Disk layers that are absent or failed to
+  // load are null. A layer is only rebuilt when its source changes, so that consecutive snapshots
+  // share the layers that did not.
+  std::vector<Snapshot::OverrideLayerConstSharedPtr> layers_;
+  std::vector<bool> layer_load_errors_;
+  std::shared_ptr<const SnapshotImpl> last_snapshot_;
 
   absl::Mutex snapshot_mutex_;
   SnapshotConstSharedPtr thread_safe_snapshot_ ABSL_GUARDED_BY(snapshot_mutex_);
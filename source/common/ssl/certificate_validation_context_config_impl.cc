@@ -9,6 +9,7 @@
 #include "source/common/common/fmt.h"
 #include "source/common/common/logger.h"
 #include "source/common/config/datasource.h"
+#include "source/common/protobuf/utility.h"
 
 #include "spdlog/spdlog.h"
 
@@ -16,6 +17,8 @@ namespace Envoy {
 namespace Ssl {
 
 static const std::string INLINE_STRING = "<inline>";
+static constexpr uint32_t DEFAULT_VERIFIED_CERTIFICATE_CACHE_MAX_ENTRIES = 1024;
+static constexpr uint64_t DEFAULT_VERIFIED_CERTIFICATE_CACHE_TTL_MS = 60 * 1000;
 
 CertificateValidationContextConfigImpl::CertificateValidationContextConfigImpl(
     const envoy::extensions::transport_sockets::tls::v3::CertificateValidationContext& config,
@@ -42,7 +45,14 @@ CertificateValidationContextConfigImpl::CertificateValidationContextConfigImpl(
       api_(api), only_verify_leaf_cert_crl_(config.only_verify_leaf_cert_crl()),
       max_verify_depth_(config.has_max_verify_depth()
                             ? absl::optional<uint32_t>(config.max_verify_depth().value())
-                            : absl::nullopt) {
+                            : absl::nullopt),
+      verified_certificate_cache_max_entries_(
+          config.has_verified_certificate_cache()
+              ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.verified_certificate_cache(), max_entries,
+                                                DEFAULT_VERIFIED_CERTIFICATE_CACHE_MAX_ENTRIES)
+              : 0),
+      verified_certificate_cache_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(
+          config.verified_certificate_cache(), ttl, DEFAULT_VERIFIED_CERTIFICATE_CACHE_TTL_MS)) {
   if (ca_cert_.empty() && custom_validator_config_ == absl::nullopt) {
     if (!certificate_revocation_list_.empty()) {
       throw EnvoyException(fmt::format("Failed to load CRL from {} without trusted CA",
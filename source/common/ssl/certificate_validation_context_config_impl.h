@@ -53,6 +53,14 @@ public:
 
   absl::optional<uint32_t> maxVerifyDepth() const override { return max_verify_depth_; }
 
+  uint32_t verifiedCertificateCacheMaxEntries() const override {
+    return verified_certificate_cache_max_entries_;
+  }
+
+  std::chrono::milliseconds verifiedCertificateCacheTtl() const override {
+    return verified_certificate_cache_ttl_;
+  }
+
 private:
   static std::vector<envoy::extensions::transport_sockets::tls::v3::SubjectAltNameMatcher>
   getSubjectAltNameMatchers(
@@ -72,6 +80,8 @@ private:
   Api::Api& api_;
   const bool only_verify_leaf_cert_crl_;
   absl::optional<uint32_t> max_verify_depth_;
+  const uint32_t verified_certificate_cache_max_entries_;
+  const std::chrono::milliseconds verified_certificate_cache_ttl_;
 };
 
 } // namespace Ssl
@@ -0,0 +1,58 @@
+#include "source/common/ssl/client_hello_info.h"
+
+#include "source/common/common/macros.h"
+
+namespace Envoy {
+namespace Ssl {
+namespace {
+
+bool cbsContainsU16(CBS& cbs, uint16_t n) {
+  while (CBS_len(&cbs) > 0) {
+    uint16_t v;
+    if (!CBS_get_u16(&cbs, &v)) {
+      return false;
+    }
+    if (v == n) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace
+
+ClientHelloInfo::ClientHelloInfo(const SSL_CLIENT_HELLO& client_hello)
+    : version_(client_hello.version) {
+  const uint8_t* data;
+  size_t len;
+  has_supported_versions_ = SSL_early_callback_ctx_extension_get(
+      &client_hello, TLSEXT_TYPE_supported_versions, &data, &len);
+
+  if (SSL_early_callback_ctx_extension_get(&client_hello, TLSEXT_TYPE_signature_algorithms, &data,
+                                           &len)) {
+    CBS signature_algorithms_ext, signature_algorithms;
+    CBS_init(&signature_algorithms_ext, data, len);
+    offers_ecdsa_p256_signature_ =
+        CBS_get_u16_length_prefixed(&signature_algorithms_ext, &signature_algorithms) &&
+        CBS_len(&signature_algorithms_ext) == 0 &&
+        cbsContainsU16(signature_algorithms, SSL_SIGN_ECDSA_SECP256R1_SHA256);
+  }
+
+  if (SSL_early_callback_ctx_extension_get(&client_hello, TLSEXT_TYPE_supported_groups, &data,
+                                           &len)) {
+    CBS curvelist;
+    CBS_init(&curvelist, data, len);
+    offers_p256_curve_ = cbsContainsU16(curvelist, SSL_CURVE_SECP256R1);
+  }
+
+  has_status_request_ =
+      SSL_early_callback_ctx_extension_get(&client_hello, TLSEXT_TYPE_status_request, &data, &len);
+}
+
+const std::string& ClientHelloInfo::key() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "envoy.tls.client_hello_info");
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/stream_info/filter_state.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * The parts of a ClientHello a server TLS context looks at to select a certificate. The TLS
+ * inspector stores this in the connection's filter state once it has parsed the ClientHello, so
+ * the TLS transport socket does not need to look the same extensions up again.
+ */
+class ClientHelloInfo : public StreamInfo::FilterState::Object {
+public:
+  explicit ClientHelloInfo(const SSL_CLIENT_HELLO& client_hello);
+
+  static const std::string& key();
+
+  // The legacy version field of the ClientHello.
+  uint16_t version() const { return version_; }
+  // Whether the client sent the supported_versions extension, i.e. may negotiate TLSv1.3.
+  bool hasSupportedVersions() const { return has_supported_versions_; }
+  // Whether the client offered ECDSA with P-256 and SHA-256 in its signature algorithms.
+  bool offersEcdsaP256Signature() const { return offers_ecdsa_p256_signature_; }
+  // Whether the client offered the P-256 curve in its supported groups.
+  bool offersP256Curve() const { return offers_p256_curve_; }
+  // Whether the client asked for an OCSP response to be stapled.
+  bool hasStatusRequest() const { return has_status_request_; }
+
+private:
+  uint16_t version_;
+  bool has_supported_versions_{};
+  bool offers_ecdsa_p256_signature_{};
+  bool offers_p256_curve_{};
+  bool has_status_request_{};
+};
+
+} // namespace Ssl
+} // namespace Envoy
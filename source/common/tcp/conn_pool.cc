@@ -1,5 +1,6 @@
 #include "source/common/tcp/conn_pool.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "envoy/event/dispatcher.h"
@@ -11,6 +12,15 @@
 
 namespace Envoy {
 namespace Tcp {
+namespace {
+
+// Warming connections backs off once this many connection attempts to the host failed in a row,
+// starting at WarmConnectionsBaseBackOff and doubling with every further failure.
+constexpr uint32_t MaxWarmConnectFailures = 3;
+constexpr std::chrono::milliseconds WarmConnectionsBaseBackOff{1000};
+constexpr std::chrono::milliseconds WarmConnectionsMaxBackOff{30000};
+
+} // namespace
 
 ActiveTcpClient::ActiveTcpClient(Envoy::ConnectionPool::ConnPoolImplBase& parent,
                                  const Upstream::HostConstSharedPtr& host,
@@ -57,6 +67,12 @@ void ActiveTcpClient::clearCallbacks() {
   parent_.checkForIdleAndCloseIdleConnsIfDraining();
 }
 
+void ActiveTcpClient::onIdleTimeout() {
+  ENVOY_CONN_LOG(debug, "unclaimed connection idle timeout", *this);
+  parent_.host()->cluster().stats().upstream_cx_idle_timeout_.inc();
+  close();
+}
+
 void ActiveTcpClient::onEvent(Network::ConnectionEvent event) {
   // If this is a newly established TCP connection, readDisable. This is to handle a race condition
   // for TCP for protocols like MySQL where the upstream writes first, and the data needs to be
@@ -68,6 +84,20 @@ void ActiveTcpClient::onEvent(Network::ConnectionEvent event) {
   ENVOY_BUG(event != Network::ConnectionEvent::ConnectedZeroRtt,
             "Unexpected 0-RTT event from the underlying TCP connection.");
   parent_.onConnectionEvent(*this, connection_->transportFailureReason(), event);
+  if (event == Network::ConnectionEvent::LocalClose ||
+      event == Network::ConnectionEvent::RemoteClose) {
+    if (idle_timer_) {
+      idle_timer_->disableTimer();
+    }
+  } else if (event == Network::ConnectionEvent::Connected && connection_ != nullptr &&
+             tcp_connection_data_ == nullptr && state() == ActiveClient::State::Ready) {
+    // The connection is established before any stream claimed it.
+    const auto& warm_tcp_connections = parent_.host()->cluster().warmTcpConnections();
+    if (warm_tcp_connections.has_value() && warm_tcp_connections->idle_timeout_.has_value()) {
+      idle_timer_ = parent_.dispatcher().createTimer([this]() { onIdleTimeout(); });
+      idle_timer_->enableTimer(warm_tcp_connections->idle_timeout_.value());
+    }
+  }
   if (callbacks_) {
     // Do not pass the Connected event to any session which registered during onEvent above.
     // Consumers of connection pool connections assume they are receiving already connected
@@ -85,5 +115,43 @@ void ActiveTcpClient::onEvent(Network::ConnectionEvent event) {
   }
 }
 
+void ConnPoolImpl::onConnectFailed(Envoy::ConnectionPool::ActiveClient&) {
+  consecutive_connect_failures_++;
+  if (consecutive_connect_failures_ < MaxWarmConnectFailures ||
+      !host_->cluster().warmTcpConnections().has_value()) {
+    return;
+  }
+  const uint32_t doublings =
+      std::min<uint32_t>(consecutive_connect_failures_ - MaxWarmConnectFailures, 5);
+  const std::chrono::milliseconds backoff =
+      std::min(WarmConnectionsBaseBackOff * (1 << doublings), WarmConnectionsMaxBackOff);
+  ENVOY_LOG(debug, "{} consecutive connect failures to {}, not warming connections for {}ms",
+            consecutive_connect_failures_, host_->address()->asString(), backoff.count());
+  warm_connections_backoff_until_ = dispatcher().timeSource().monotonicTime() + backoff;
+}
+
+void ConnPoolImpl::maybeWarmConnections() {
+  const auto& warm_tcp_connections = host_->cluster().warmTcpConnections();
+  if (!warm_tcp_connections.has_value() || host_->health() != Upstream::Host::Health::Healthy) {
+    return;
+  }
+  if (consecutive_connect_failures_ >= MaxWarmConnectFailures &&
+      dispatcher().timeSource().monotonicTime() < warm_connections_backoff_until_) {
+    return;
+  }
+
+  // Ready connections are unclaimed, as are connecting ones which no pending stream waits for.
+  uint64_t unclaimed = ready_clients_.size() + connecting_stream_capacity_ -
+                       std::min<uint64_t>(numPendingStreams(), connecting_stream_capacity_);
+  // Unlike connections for pending streams, warm connections never exceed the circuit breakers.
+  while (unclaimed < warm_tcp_connections->connections_ &&
+         host_->canCreateConnection(priority_)) {
+    if (createNewConnection() != ConnectionResult::CreatedNewConnection) {
+      return;
+    }
+    unclaimed++;
+  }
+}
+
 } // namespace Tcp
 } // namespace Envoy
@@ -124,6 +124,8 @@ public:
     }
   }
   virtual void clearCallbacks();
+  // Closes the connection if it is still unclaimed once the warm connection idle timeout passes.
+  void onIdleTimeout();
 
   std::shared_ptr<ConnReadFilter> read_filter_handle_;
   Envoy::ConnectionPool::ConnPoolImplBase& parent_;
@@ -131,6 +133,8 @@ public:
   Network::ClientConnectionPtr connection_;
   ConnectionPool::ConnectionStatePtr connection_state_;
   TcpConnectionData* tcp_connection_data_{};
+  // Only set while an established connection is unclaimed and warm connections are configured.
+  Event::TimerPtr idle_timer_;
   bool associated_before_{};
 };
 
@@ -180,7 +184,10 @@ public:
   ConnectionPool::Cancellable* newConnection(Tcp::ConnectionPool::Callbacks& callbacks) override {
     TcpAttachContext context(&callbacks);
     // TLS early data over TCP is not supported yet.
-    return newStreamImpl(context, /*can_send_early_data=*/false);
+    ConnectionPool::Cancellable* cancellable =
+        newStreamImpl(context, /*can_send_early_data=*/false);
+    maybeWarmConnections();
+    return cancellable;
   }
   bool maybePreconnect(float preconnect_ratio) override {
     return maybePreconnectImpl(preconnect_ratio);
@@ -205,6 +212,7 @@ public:
   void onPoolReady(Envoy::ConnectionPool::ActiveClient& client,
                    Envoy::ConnectionPool::AttachContext& context) override {
     ActiveTcpClient* tcp_client = static_cast<ActiveTcpClient*>(&client);
+    tcp_client->idle_timer_.reset();
     tcp_client->readEnableIfNew();
     auto* callbacks = typedContext<TcpAttachContext>(context).callbacks_;
     std::unique_ptr<Envoy::Tcp::ConnectionPool::ConnectionData> connection_data =
@@ -220,9 +228,22 @@ public:
   }
 
   bool enforceMaxRequests() const override { return false; }
+  void onConnected(Envoy::ConnectionPool::ActiveClient&) override {
+    consecutive_connect_failures_ = 0;
+  }
+  void onConnectFailed(Envoy::ConnectionPool::ActiveClient&) override;
+  // Creates connections until the host has as many unclaimed connections as configured by the
+  // cluster's warm TCP connections, if any. Warming backs off after consecutive connect failures.
+  void maybeWarmConnections();
   // These two functions exist for testing parity between old and new Tcp Connection Pools.
   virtual void onConnReleased(Envoy::ConnectionPool::ActiveClient&) {}
   virtual void onConnDestroyed() {}
+
+private:
+  // Connection attempts which failed since the last one which succeeded.
+  uint32_t consecutive_connect_failures_{};
+  // No connections are warmed before this time once too many connection attempts failed in a row.
+  MonotonicTime warm_connections_backoff_until_;
 };
 
 } // namespace Tcp
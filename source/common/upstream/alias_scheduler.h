@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/random_generator.h"
+#include "envoy/upstream/scheduler.h"
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+// Alias Table Scheduler
+// ---------------------
+// This scheduler performs weighted random selection in O(1) time using Vose's alias method
+// (https://en.wikipedia.org/wiki/Alias_method). The table has one column per object. Each column
+// holds the probability of picking its own object and the index of an "alias" object which is
+// picked otherwise. A pick draws a uniformly random column and a uniformly random number to decide
+// between the column's object and its alias.
+//
+// Adding an object causes the table to be rebuilt on the first pick that follows, which is linear
+// in the number of objects. When the weight returned by calculate_weight for a picked object
+// differs from the weight in the table (like in the least request LB), the new weight is recorded
+// and the table is rebuilt once the number of changed weights reaches the number of objects. This
+// bounds the amortized cost of a pick to O(1) at the expense of selecting with weights that are up
+// to one rebuild stale.
+//
+// Unlike the EDF scheduler, picks are random rather than a deterministic interleaving, so the
+// requested weights are only honored on average.
+template <class C> class AliasScheduler : public Scheduler<C> {
+public:
+  AliasScheduler(Random::RandomGenerator& random) : random_(random) {}
+
+  // See scheduler.h for an explanation of each public method.
+  std::shared_ptr<C> peekAgain(std::function<double(const C&)> calculate_weight) override {
+    std::shared_ptr<C> picked = pickInternal(calculate_weight);
+    if (picked != nullptr) {
+      prepick_queue_.emplace(picked);
+    }
+    return picked;
+  }
+
+  std::shared_ptr<C> pickAndAdd(std::function<double(const C&)> calculate_weight) override {
+    // Burn through the pre-pick queue.
+    while (!prepick_queue_.empty()) {
+      std::shared_ptr<C> prepicked = prepick_queue_.front().lock();
+      prepick_queue_.pop();
+      if (prepicked != nullptr) {
+        return prepicked;
+      }
+    }
+    return pickInternal(calculate_weight);
+  }
+
+  void add(double weight, std::shared_ptr<C> entry) override {
+    ASSERT(weight > 0);
+    entries_.push_back({weight, std::move(entry)});
+    rebuild_ = true;
+  }
+
+  bool empty() const override { return entries_.empty(); }
+
+private:
+  struct Entry {
+    double weight_;
+    // We only hold a weak pointer, since we don't support a remove operator. This allows entries to
+    // be lazily unloaded from the table.
+    std::weak_ptr<C> entry_;
+  };
+
+  struct Column {
+    // Probability of picking the entry at the column's own index rather than alias_.
+    double probability_;
+    uint32_t alias_;
+  };
+
+  // Drops expired entries and rebuilds the alias table if it is stale.
+  void maybeRebuild() {
+    if (!rebuild_) {
+      return;
+    }
+    rebuild_ = false;
+    changed_weights_ = 0;
+
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [](const Entry& entry) { return entry.entry_.expired(); }),
+                   entries_.end());
+    const uint32_t size = entries_.size();
+    table_.resize(size);
+    if (size == 0) {
+      return;
+    }
+
+    double weight_sum = 0;
+    for (const Entry& entry : entries_) {
+      weight_sum += entry.weight_;
+    }
+
+    // Scale the weights so that they average to 1 and split the columns into those which are under
+    // and over full. Each under full column is topped up from an over full one, which becomes its
+    // alias.
+    std::vector<double> scaled(size);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < size; ++i) {
+      scaled[i] = entries_[i].weight_ * size / weight_sum;
+      if (scaled[i] < 1.0) {
+        small.push_back(i);
+      } else {
+        large.push_back(i);
+      }
+    }
+
+    while (!small.empty() && !large.empty()) {
+      const uint32_t less = small.back();
+      small.pop_back();
+      const uint32_t more = large.back();
+      table_[less] = {scaled[less], more};
+      scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+      if (scaled[more] < 1.0) {
+        large.pop_back();
+        small.push_back(more);
+      }
+    }
+
+    // Whatever is left is full up to floating point error.
+    for (const uint32_t i : large) {
+      table_[i] = {1.0, i};
+    }
+    for (const uint32_t i : small) {
+      table_[i] = {1.0, i};
+    }
+  }
+
+  std::shared_ptr<C> pickInternal(std::function<double(const C&)> calculate_weight) {
+    while (true) {
+      maybeRebuild();
+      if (entries_.empty()) {
+        return nullptr;
+      }
+
+      const uint32_t column = random_.random() % table_.size();
+      // Use the top 53 bits of the second random number for a uniform double in [0, 1).
+      const double coin = static_cast<double>(random_.random() >> 11) * 0x1.0p-53;
+      const uint32_t index = coin < table_[column].probability_ ? column : table_[column].alias_;
+
+      Entry& entry = entries_[index];
+      std::shared_ptr<C> ret = entry.entry_.lock();
+      if (ret == nullptr) {
+        // The entry has been removed; purge it and pick again.
+        rebuild_ = true;
+        continue;
+      }
+
+      if (calculate_weight) {
+        const double new_weight = calculate_weight(*ret);
+        ASSERT(new_weight > 0);
+        if (new_weight != entry.weight_) {
+          entry.weight_ = new_weight;
+          if (++changed_weights_ >= entries_.size()) {
+            rebuild_ = true;
+          }
+        }
+      }
+      return ret;
+    }
+  }
+
+  Random::RandomGenerator& random_;
+  std::vector<Entry> entries_;
+  std::vector<Column> table_;
+  // Objects already picked via peekAgain().
+  std::queue<std::weak_ptr<C>> prepick_queue_;
+  // Number of entries whose weight changed since the table was last built.
+  size_t changed_weights_{};
+  bool rebuild_{true};
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -1,10 +1,12 @@
 #include "source/common/upstream/cluster_manager_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "envoy/admin/v3/config_dump.pb.h"
@@ -21,6 +23,8 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/enum_to_int.h"
 #include "source/common/common/fmt.h"
+#include "source/common/common/hash.h"
+#include "source/common/common/thread.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/custom_config_validators_impl.h"
 #include "source/common/config/new_grpc_mux_impl.h"
@@ -46,6 +50,9 @@
 #include "source/common/upstream/ring_hash_lb.h"
 #include "source/common/upstream/subset_lb.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/strip.h"
+
 #ifdef ENVOY_ENABLE_QUIC
 #include "source/common/http/conn_pool_grid.h"
 #include "source/common/http/http3/conn_pool.h"
@@ -56,6 +63,20 @@ namespace Envoy {
 namespace Upstream {
 namespace {
 
+// Hashing a cluster prints its whole config, including typed extension configs, so bootstraps with
+// many static clusters hash them on several threads, each hashing at least this many clusters.
+constexpr size_t MinStaticClustersPerHashThread = 64;
+
+// Returns the index of a worker from the name of its dispatcher, see ListenerManagerImpl.
+absl::optional<uint32_t> workerIndex(absl::string_view dispatcher_name) {
+  uint32_t index;
+  if (!absl::ConsumePrefix(&dispatcher_name, "worker_") ||
+      !absl::SimpleAtoi(dispatcher_name, &index)) {
+    return absl::nullopt;
+  }
+  return index;
+}
+
 void addOptionsIfNotNull(Network::Socket::OptionsSharedPtr& options,
                          const Network::Socket::OptionsSharedPtr& to_add) {
   if (to_add != nullptr) {
@@ -64,7 +85,7 @@ void addOptionsIfNotNull(Network::Socket::OptionsSharedPtr& options,
 }
 
 // Helper function to make sure each protocol in expected_protocols is present
-// in protocols (only used for an ASSERT in debug builds)
+// in protocols.
 bool contains(const std::vector<Http::Protocol>& protocols,
               const std::vector<Http::Protocol>& expected_protocols) {
   for (auto protocol : expected_protocols) {
@@ -286,7 +307,7 @@ ClusterManagerImpl::ClusterManagerImpl(
     Event::Dispatcher& main_thread_dispatcher, Server::Admin& admin,
     ProtobufMessage::ValidationContext& validation_context, Api::Api& api,
     Http::Context& http_context, Grpc::Context& grpc_context, Router::Context& router_context,
-    const Server::Instance& server)
+    Server::Instance& server)
     : factory_(factory), runtime_(runtime), stats_(stats), tls_(tls),
       random_(api.randomGenerator()),
       bind_config_(bootstrap.cluster_manager().upstream_bind_config()), local_info_(local_info),
@@ -303,7 +324,8 @@ ClusterManagerImpl::ClusterManagerImpl(
       cluster_load_report_stat_names_(stats.symbolTable()),
       cluster_circuit_breakers_stat_names_(stats.symbolTable()),
       cluster_request_response_size_stat_names_(stats.symbolTable()),
-      cluster_timeout_budget_stat_names_(stats.symbolTable()) {
+      cluster_timeout_budget_stat_names_(stats.symbolTable()),
+      concurrency_(server.options().concurrency()), shared_conn_pool_threads_(concurrency_) {
   async_client_manager_ = std::make_unique<Grpc::AsyncClientManagerImpl>(
       *this, tls, time_source_, api, grpc_context.statNames());
   const auto& cm_config = bootstrap.cluster_manager();
@@ -351,15 +373,26 @@ ClusterManagerImpl::ClusterManagerImpl(
   };
   // Build book-keeping for which clusters are primary. This is useful when we
   // invoke loadCluster() below and it needs the complete set of primaries.
-  for (const auto& cluster : bootstrap.static_resources().clusters()) {
+  const auto& static_clusters = bootstrap.static_resources().clusters();
+  for (const auto& cluster : static_clusters) {
     if (is_primary_cluster(cluster)) {
       primary_clusters_.insert(cluster.name());
     }
   }
+  // Only the hashes are computed off the main thread. Clusters are still loaded in order on the
+  // main thread, as loading them creates timers, subscriptions, etc.
+  std::vector<uint64_t> static_cluster_hashes(static_clusters.size());
+  Thread::parallelFor(
+      api.threadFactory(),
+      std::min<size_t>(std::thread::hardware_concurrency(),
+                       static_clusters.size() / MinStaticClustersPerHashThread),
+      static_clusters.size(), [&static_clusters, &static_cluster_hashes](size_t index) {
+        static_cluster_hashes[index] = MessageUtil::hash(static_clusters[index]);
+      });
   // Load all the primary clusters.
-  for (const auto& cluster : bootstrap.static_resources().clusters()) {
-    if (is_primary_cluster(cluster)) {
-      loadCluster(cluster, MessageUtil::hash(cluster), "", false, active_clusters_);
+  for (int i = 0; i < static_clusters.size(); ++i) {
+    if (is_primary_cluster(static_clusters[i])) {
+      loadCluster(static_clusters[i], static_cluster_hashes[i], "", false, active_clusters_);
     }
   }
 
@@ -426,7 +459,7 @@ ClusterManagerImpl::ClusterManagerImpl(
             Config::Utility::factoryForGrpcApiConfigSource(*async_client_manager_,
                                                            dyn_resources.ads_config(), stats, false)
                 ->createUncachedRawAsyncClient(),
-            main_thread_dispatcher,
+            main_thread_dispatcher, api.threadFactory(),
             *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
                 "envoy.service.discovery.v3.AggregatedDiscoveryService.StreamAggregatedResources"),
             random_, stats_,
@@ -440,12 +473,10 @@ ClusterManagerImpl::ClusterManagerImpl(
   }
 
   // After ADS is initialized, load EDS static clusters as EDS config may potentially need ADS.
-  for (const auto& cluster : bootstrap.static_resources().clusters()) {
+  for (int i = 0; i < static_clusters.size(); ++i) {
     // Now load all the secondary clusters.
-    if (cluster.type() == envoy::config::cluster::v3::Cluster::EDS &&
-        !Config::SubscriptionFactory::isPathBasedConfigSource(
-            cluster.eds_cluster_config().eds_config().config_source_specifier_case())) {
-      loadCluster(cluster, MessageUtil::hash(cluster), "", false, active_clusters_);
+    if (!is_primary_cluster(static_clusters[i])) {
+      loadCluster(static_clusters[i], static_cluster_hashes[i], "", false, active_clusters_);
     }
   }
 
@@ -1379,10 +1410,46 @@ ClusterManagerImpl::dumpClusterConfigs(const Matchers::StringMatcher& name_match
   return config_dump;
 }
 
+void ClusterManagerImpl::addSharedConnPoolThread(Event::Dispatcher& dispatcher,
+                                                 Http::SharedConnPoolThreadSharedPtr thread) {
+  const absl::optional<uint32_t> index = workerIndex(dispatcher.name());
+  if (!index.has_value() || index.value() >= concurrency_) {
+    return;
+  }
+  absl::MutexLock lock(&shared_conn_pool_threads_lock_);
+  ASSERT(shared_conn_pool_threads_[index.value()] == nullptr);
+  shared_conn_pool_threads_[index.value()] = std::move(thread);
+  ++registered_shared_conn_pool_threads_;
+}
+
+void ClusterManagerImpl::removeSharedConnPoolThread(Event::Dispatcher& dispatcher) {
+  const absl::optional<uint32_t> index = workerIndex(dispatcher.name());
+  if (!index.has_value() || index.value() >= concurrency_) {
+    return;
+  }
+  absl::MutexLock lock(&shared_conn_pool_threads_lock_);
+  if (shared_conn_pool_threads_[index.value()] != nullptr) {
+    shared_conn_pool_threads_[index.value()] = nullptr;
+    --registered_shared_conn_pool_threads_;
+  }
+}
+
+Http::SharedConnPoolThreadSharedPtr
+ClusterManagerImpl::sharedConnPoolOwner(const Host& host, uint32_t owner_threads) {
+  absl::ReaderMutexLock lock(&shared_conn_pool_threads_lock_);
+  if (concurrency_ == 0 || registered_shared_conn_pool_threads_ < concurrency_) {
+    return nullptr;
+  }
+  const uint64_t owners = std::min<uint64_t>(owner_threads, concurrency_);
+  return shared_conn_pool_threads_[HashUtil::xxHash64(host.address()->asStringView()) % owners];
+}
+
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl(
     ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
     const absl::optional<LocalClusterParams>& local_cluster_params)
-    : parent_(parent), thread_local_dispatcher_(dispatcher), cdm_(dispatcher.name(), *this) {
+    : parent_(parent), thread_local_dispatcher_(dispatcher),
+      shared_conn_pool_thread_(std::make_shared<Http::SharedConnPoolThread>(dispatcher)),
+      cdm_(dispatcher.name(), *this) {
   // If local cluster is defined then we need to initialize it first.
   if (local_cluster_params.has_value()) {
     const auto& local_cluster_name = local_cluster_params->info_->name();
@@ -1391,6 +1458,10 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl
         *this, local_cluster_params->info_, local_cluster_params->load_balancer_factory_);
     local_priority_set_ = &thread_local_clusters_[local_cluster_name]->prioritySet();
   }
+
+  if (!Thread::MainThread::isMainOrTestThread()) {
+    parent_.addSharedConnPoolThread(dispatcher, shared_conn_pool_thread_);
+  }
 }
 
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImpl() {
@@ -1400,6 +1471,9 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
   // member update callback registered with the local cluster.
   ENVOY_LOG(debug, "shutting down thread local cluster manager");
   destroying_ = true;
+  if (!Thread::MainThread::isMainOrTestThread()) {
+    parent_.removeSharedConnPoolThread(thread_local_dispatcher_);
+  }
   host_http_conn_pool_map_.clear();
   host_tcp_conn_pool_map_.clear();
   ASSERT(host_tcp_conn_map_.empty());
@@ -1412,6 +1486,9 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
 
   // Ensure that all pools are completely destructed.
   thread_local_dispatcher_.clearDeferredDeleteList();
+  // Events of shared connection pools posted to this thread from now on are dropped, which fails or
+  // resets their streams on the other threads.
+  shared_conn_pool_thread_->shutdown();
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeTcpConn(
@@ -1530,6 +1607,22 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
           parent.thread_local_dispatcher_.timeSource());
       break;
     }
+    case LoadBalancerType::PeakEwma: {
+      ASSERT(lb_factory_ == nullptr);
+      lb_ = std::make_unique<PeakEwmaLoadBalancer>(
+          priority_set_, parent_.local_priority_set_, cluster->stats(), parent.parent_.runtime_,
+          parent.parent_.random_, cluster->lbConfig(), cluster->lbPeakEwmaConfig(),
+          parent.thread_local_dispatcher_.timeSource());
+      break;
+    }
+    case LoadBalancerType::OrcaWeightedRoundRobin: {
+      ASSERT(lb_factory_ == nullptr);
+      lb_ = std::make_unique<OrcaWeightedRoundRobinLoadBalancer>(
+          priority_set_, parent_.local_priority_set_, cluster->stats(), parent.parent_.runtime_,
+          parent.parent_.random_, cluster->lbConfig(), cluster->lbOrcaWeightedRoundRobinConfig(),
+          parent.thread_local_dispatcher_.timeSource());
+      break;
+    }
     case LoadBalancerType::Random: {
       ASSERT(lb_factory_ == nullptr);
       lb_ = std::make_unique<RandomLoadBalancer>(priority_set_, parent_.local_priority_set_,
@@ -1638,8 +1731,6 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
     hash_key.push_back(uint8_t(protocol));
   }
 
-  absl::optional<envoy::config::core::v3::AlternateProtocolsCacheOptions>
-      alternate_protocol_options = host->cluster().alternateProtocolsCacheOptions();
   Network::Socket::OptionsSharedPtr upstream_options(std::make_shared<Network::Socket::Options>());
   if (context) {
     // Inherit socket options from downstream connection, if set.
@@ -1668,17 +1759,62 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
     context->downstreamConnection()->hashKey(hash_key);
   }
 
+  // Streams which need connections of their own can not use connections owned by another worker.
+  const bool shareable = cluster_info_->sharedConnectionPoolOwnerThreads() > 0 &&
+                         !contains(upstream_protocols, {Http::Protocol::Http11}) &&
+                         upstream_options->empty() && !have_transport_socket_options &&
+                         !cluster_info_->connectionPoolPerDownstreamConnection();
+
+  return httpConnPoolForKey(
+      host, priority, upstream_protocols, hash_key,
+      !upstream_options->empty() ? upstream_options : nullptr,
+      have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr,
+      shareable);
+}
+
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolForKey(
+    const HostConstSharedPtr& host, ResourcePriority priority,
+    std::vector<Http::Protocol>& upstream_protocols, const std::vector<uint8_t>& hash_key,
+    const Network::Socket::OptionsSharedPtr& upstream_options,
+    const Network::TransportSocketOptionsConstSharedPtr& transport_socket_options,
+    bool shareable) {
   ConnPoolsContainer& container = *parent_.getHttpConnPoolsContainer(host, true);
 
   // Note: to simplify this, we assume that the factory is only called in the scope of this
   // function. Otherwise, we'd need to capture a few of these variables by value.
   ConnPoolsContainer::ConnPools::PoolOptRef pool =
       container.pools_->getPool(priority, hash_key, [&]() {
-        auto pool = parent_.parent_.factory_.allocateConnPool(
-            parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
-            alternate_protocol_options, !upstream_options->empty() ? upstream_options : nullptr,
-            have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr,
-            parent_.parent_.time_source_, parent_.cluster_manager_state_, quic_info_);
+        Http::ConnectionPool::InstancePtr pool;
+        Http::SharedConnPoolThreadSharedPtr owner =
+            shareable ? parent_.parent_.sharedConnPoolOwner(
+                            *host, cluster_info_->sharedConnectionPoolOwnerThreads())
+                      : nullptr;
+        if (owner != nullptr && owner != parent_.shared_conn_pool_thread_) {
+          // The owner allocates its pool the same way, but never hands its streams off again.
+          pool = std::make_unique<Http::SharedConnPoolImpl>(
+              parent_.thread_local_dispatcher_, parent_.shared_conn_pool_thread_, owner, host,
+              [&cluster_manager = parent_.parent_, cluster_name = cluster_info_->name(), host,
+               priority, upstream_protocols,
+               hash_key]() mutable -> Http::ConnectionPool::Instance* {
+                OptRef<ThreadLocalClusterManagerImpl> owner_cm = cluster_manager.tls_.get();
+                if (!owner_cm.has_value()) {
+                  return nullptr;
+                }
+                auto entry = owner_cm->thread_local_clusters_.find(cluster_name);
+                if (entry == owner_cm->thread_local_clusters_.end()) {
+                  return nullptr;
+                }
+                return entry->second->httpConnPoolForKey(host, priority, upstream_protocols,
+                                                         hash_key, nullptr, nullptr, false);
+              });
+        } else {
+          pool = parent_.parent_.factory_.allocateConnPool(
+              parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
+              host->cluster().alternateProtocolsCacheOptions(), upstream_options,
+              transport_socket_options, parent_.parent_.time_source_,
+              parent_.cluster_manager_state_, quic_info_);
+        }
 
         pool->addIdleCallback([&parent = parent_, host, priority, hash_key]() {
           parent.httpConnPoolIsIdle(host, priority, hash_key);
@@ -33,6 +33,7 @@
 #include "source/common/http/async_client_impl.h"
 #include "source/common/http/http_server_properties_cache_impl.h"
 #include "source/common/http/http_server_properties_cache_manager_impl.h"
+#include "source/common/http/shared_conn_pool.h"
 #include "source/common/quic/quic_stat_names.h"
 #include "source/common/upstream/cluster_discovery_manager.h"
 #include "source/common/upstream/load_stats_reporter.h"
@@ -41,6 +42,8 @@
 #include "source/common/upstream/upstream_impl.h"
 #include "source/server/factory_context_base_impl.h"
 
+#include "absl/synchronization/mutex.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -58,7 +61,7 @@ public:
       Api::Api& api, Http::Context& http_context, Grpc::Context& grpc_context,
       Router::Context& router_context, AccessLog::AccessLogManager& log_manager,
       Singleton::Manager& singleton_manager, const Server::Options& options,
-      Quic::QuicStatNames& quic_stat_names, const Server::Instance& server)
+      Quic::QuicStatNames& quic_stat_names, Server::Instance& server)
       : server_context_(server_context),
         context_(options, main_thread_dispatcher, api, local_info, admin, runtime,
                  singleton_manager, validation_context.staticValidationVisitor(), stats, tls),
@@ -116,7 +119,7 @@ protected:
   Quic::QuicStatNames& quic_stat_names_;
   Http::HttpServerPropertiesCacheManagerFactoryImpl alternate_protocols_cache_manager_factory_;
   Http::HttpServerPropertiesCacheManagerSharedPtr alternate_protocols_cache_manager_;
-  const Server::Instance& server_;
+  Server::Instance& server_;
 };
 
 // For friend declaration in ClusterManagerInitHelper.
@@ -248,7 +251,7 @@ public:
                      Event::Dispatcher& main_thread_dispatcher, Server::Admin& admin,
                      ProtobufMessage::ValidationContext& validation_context, Api::Api& api,
                      Http::Context& http_context, Grpc::Context& grpc_context,
-                     Router::Context& router_context, const Server::Instance& server);
+                     Router::Context& router_context, Server::Instance& server);
 
   std::size_t warmingClusterCount() const { return warming_clusters_.size(); }
 
@@ -425,6 +428,20 @@ protected:
    */
   ClusterDiscoveryManager createAndSwapClusterDiscoveryManager(std::string thread_name);
 
+  /**
+   * Registers the thread of a worker for owning shared connection pools. Only dispatchers named
+   * "worker_N", with N below the concurrency, are registered.
+   *
+   * Protected, so tests can use it.
+   */
+  void addSharedConnPoolThread(Event::Dispatcher& dispatcher,
+                               Http::SharedConnPoolThreadSharedPtr thread);
+  void removeSharedConnPoolThread(Event::Dispatcher& dispatcher);
+  // Returns the worker owning the connections to host for clusters with a shared connection pool,
+  // or nullptr while not all the workers are running.
+  Http::SharedConnPoolThreadSharedPtr sharedConnPoolOwner(const Host& host,
+                                                          uint32_t owner_threads);
+
 private:
   /**
    * Thread local cached cluster data. Each thread local cluster gets updates from the parent
@@ -535,6 +552,15 @@ private:
                        absl::optional<Http::Protocol> downstream_protocol,
                        LoadBalancerContext* context, bool peek);
 
+      // Finds or creates the pool for the given host and pool hash key. If shareable is true and
+      // the host's connections are owned by another worker, the pool hands streams off to it.
+      Http::ConnectionPool::Instance* httpConnPoolForKey(
+          const HostConstSharedPtr& host, ResourcePriority priority,
+          std::vector<Http::Protocol>& upstream_protocols, const std::vector<uint8_t>& hash_key,
+          const Network::Socket::OptionsSharedPtr& upstream_options,
+          const Network::TransportSocketOptionsConstSharedPtr& transport_socket_options,
+          bool shareable);
+
       Tcp::ConnectionPool::Instance* tcpConnPoolImpl(ResourcePriority priority,
                                                      LoadBalancerContext* context, bool peek);
 
@@ -590,6 +616,8 @@ private:
 
     ClusterManagerImpl& parent_;
     Event::Dispatcher& thread_local_dispatcher_;
+    // Used by the shared connection pools of this thread and, on workers, of the others.
+    const Http::SharedConnPoolThreadSharedPtr shared_conn_pool_thread_;
     absl::flat_hash_map<std::string, ClusterEntryPtr> thread_local_clusters_;
 
     ClusterConnectivityState cluster_manager_state_;
@@ -774,6 +802,16 @@ private:
   ClusterSet primary_clusters_;
 
   std::unique_ptr<Config::XdsResourcesDelegate> xds_resources_delegate_;
+
+  // The threads of the workers, indexed by worker index. The hosts of clusters with a shared
+  // connection pool are spread over the first shared_connection_pool.owner_threads of them. Owners
+  // are only handed out while all the workers are registered, so that every worker picks the same
+  // owner for a host regardless of the order in which the workers started.
+  const uint32_t concurrency_;
+  absl::Mutex shared_conn_pool_threads_lock_;
+  std::vector<Http::SharedConnPoolThreadSharedPtr>
+      shared_conn_pool_threads_ ABSL_GUARDED_BY(shared_conn_pool_threads_lock_);
+  uint32_t registered_shared_conn_pool_threads_ ABSL_GUARDED_BY(shared_conn_pool_threads_lock_){};
 };
 
 } // namespace Upstream
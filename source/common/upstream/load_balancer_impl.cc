@@ -795,7 +795,7 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
     TimeSource& time_source)
     : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
                                 common_config),
-      seed_(random_.random()),
+      seed_(random_.random()), weighted_scheduler_(common_config.weighted_scheduler()),
       slow_start_window_(slow_start_config.has_value()
                              ? std::chrono::milliseconds(DurationUtil::durationToMilliseconds(
                                    slow_start_config.value().slow_start_window()))
@@ -859,11 +859,15 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
     // case EDF creation is skipped. When all original weights are equal and no hosts are in slow
     // start mode we can rely on unweighted host pick to do optimal round robin and least-loaded
     // host selection with lower memory and CPU overhead.
-    if (hostWeightsAreEqual(hosts) && noHostsAreInSlowStart()) {
+    if (!alwaysUseEdfScheduler() && hostWeightsAreEqual(hosts) && noHostsAreInSlowStart()) {
       // Skip edf creation.
       return;
     }
-    scheduler.edf_ = std::make_unique<EdfScheduler<const Host>>();
+    if (weighted_scheduler_ == envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS_TABLE) {
+      scheduler.edf_ = std::make_unique<AliasScheduler<const Host>>(random_);
+    } else {
+      scheduler.edf_ = std::make_unique<EdfScheduler<const Host>>();
+    }
 
     // Populate scheduler with host list.
     // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
@@ -1047,6 +1051,112 @@ HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector
   return candidate_host;
 }
 
+double PeakEwmaLoadBalancer::hostCost(const Host& host) {
+  const uint64_t active_rq = host.stats().rq_active_.value();
+  const double estimate = host.responseTimeEstimator().estimate();
+  if (estimate == 0 && active_rq != 0) {
+    return UnknownResponseTimePenalty + active_rq;
+  }
+  return estimate * (active_rq + 1);
+}
+
+HostConstSharedPtr PeakEwmaLoadBalancer::unweightedHostPeek(const HostVector&,
+                                                            const HostsSource&) {
+  // Like LeastRequestLoadBalancer, the cost of a host may be changed by other threads between
+  // preconnect and host-pick, so deterministic preconnecting is not possible.
+  return nullptr;
+}
+
+HostConstSharedPtr PeakEwmaLoadBalancer::unweightedHostPick(const HostVector& hosts_to_use,
+                                                            const HostsSource&) {
+  HostSharedPtr candidate_host = nullptr;
+  double candidate_cost = 0;
+
+  for (uint32_t choice_idx = 0; choice_idx < choice_count_; ++choice_idx) {
+    const int rand_idx = random_.random() % hosts_to_use.size();
+    const HostSharedPtr& sampled_host = hosts_to_use[rand_idx];
+    const double sampled_cost = hostCost(*sampled_host);
+
+    if (candidate_host == nullptr || sampled_cost < candidate_cost) {
+      candidate_host = sampled_host;
+      candidate_cost = sampled_cost;
+    }
+  }
+
+  return candidate_host;
+}
+
+OrcaWeightedRoundRobinLoadBalancer::OrcaWeightedRoundRobinLoadBalancer(
+    const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
+    Runtime::Loader& runtime, Random::RandomGenerator& random,
+    const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config,
+    const absl::optional<envoy::config::cluster::v3::Cluster::OrcaWeightedRoundRobinLbConfig>
+        orca_config,
+    TimeSource& time_source)
+    : EdfLoadBalancerBase(
+          priority_set, local_priority_set, stats, runtime, random, common_config,
+          (orca_config.has_value() && orca_config.value().has_slow_start_config())
+              ? absl::optional<envoy::config::cluster::v3::Cluster::SlowStartConfig>(
+                    orca_config.value().slow_start_config())
+              : absl::nullopt,
+          time_source),
+      blackout_period_(orca_config.has_value() ? PROTOBUF_GET_MS_OR_DEFAULT(orca_config.value(),
+                                                                            blackout_period, 10000)
+                                               : 10000),
+      weight_expiration_period_(orca_config.has_value()
+                                    ? PROTOBUF_GET_MS_OR_DEFAULT(orca_config.value(),
+                                                                 weight_expiration_period, 180000)
+                                    : 180000),
+      weight_update_period_(orca_config.has_value()
+                                ? PROTOBUF_GET_MS_OR_DEFAULT(orca_config.value(),
+                                                             weight_update_period, 1000)
+                                : 1000) {
+  initialize();
+}
+
+void OrcaWeightedRoundRobinLoadBalancer::refresh(uint32_t priority) {
+  updateMeanWeight(time_source_.monotonicTime());
+  EdfLoadBalancerBase::refresh(priority);
+}
+
+HostConstSharedPtr OrcaWeightedRoundRobinLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (now >= next_mean_weight_update_) {
+    updateMeanWeight(now);
+  }
+  return EdfLoadBalancerBase::chooseHostOnce(context);
+}
+
+void OrcaWeightedRoundRobinLoadBalancer::updateMeanWeight(MonotonicTime now) {
+  double total_weight = 0;
+  uint64_t hosts_with_weight = 0;
+  for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
+    for (const auto& host : host_set->hosts()) {
+      const double weight =
+          host->utilizationWeight().weight(blackout_period_, weight_expiration_period_);
+      if (weight > 0) {
+        total_weight += weight;
+        ++hosts_with_weight;
+      }
+    }
+  }
+  mean_weight_ = hosts_with_weight > 0 ? total_weight / hosts_with_weight : 1.0;
+  next_mean_weight_update_ = now + weight_update_period_;
+}
+
+double OrcaWeightedRoundRobinLoadBalancer::hostWeight(const Host& host) {
+  double utilization_weight =
+      host.utilizationWeight().weight(blackout_period_, weight_expiration_period_);
+  if (utilization_weight == 0) {
+    utilization_weight = mean_weight_;
+  }
+  const double host_weight = host.weight() * utilization_weight;
+  if (!noHostsAreInSlowStart()) {
+    return applySlowStartFactor(host_weight, host);
+  }
+  return host_weight;
+}
+
 HostConstSharedPtr RandomLoadBalancer::peekAnotherHost(LoadBalancerContext* context) {
   if (tooManyPreconnects(stashed_random_.size(), total_healthy_hosts_)) {
     return nullptr;
@@ -17,6 +17,7 @@
 
 #include "source/common/protobuf/utility.h"
 #include "source/common/runtime/runtime_protos.h"
+#include "source/common/upstream/alias_scheduler.h"
 #include "source/common/upstream/edf_scheduler.h"
 
 namespace Envoy {
@@ -412,7 +413,9 @@ private:
  * with 1 / weight deadline, we will achieve the desired pick frequency for weighted RR in a given
  * interval. Naive implementations of weighted RR are either O(n) pick time or O(m * n) memory use,
  * where m is the weight range. We also explicitly check for the unweighted special case and use a
- * simple index to achieve O(1) scheduling in that case.
+ * simple index to achieve O(1) scheduling in that case. Clusters with many weighted hosts can opt
+ * into an AliasScheduler instead, trading the deterministic EDF interleaving for O(1) weighted
+ * random picks and O(n) construction.
  * TODO(htuch): We use EDF at Google, but the EDF scheduler may be overkill if we don't want to
  * support large ranges of weights or arbitrary precision floating weights, we could construct an
  * explicit schedule, since m will be a small constant factor in O(m * n). This
@@ -438,10 +441,11 @@ public:
 
 protected:
   struct Scheduler {
-    // EdfScheduler for weighted LB. The edf_ is only created when the original
-    // host weights of 2 or more hosts differ. When not present, the
-    // implementation of chooseHostOnce falls back to unweightedHostPick.
-    std::unique_ptr<EdfScheduler<const Host>> edf_;
+    // Scheduler for weighted LB, an EdfScheduler unless the cluster is configured to use the
+    // AliasScheduler. The edf_ is only created when the original host weights of 2 or more hosts
+    // differ. When not present, the implementation of chooseHostOnce falls back to
+    // unweightedHostPick.
+    std::unique_ptr<Upstream::Scheduler<const Host>> edf_;
   };
 
   void initialize();
@@ -451,6 +455,11 @@ protected:
   bool isSlowStartEnabled();
   bool noHostsAreInSlowStart();
 
+  // Derived classes whose host weights change independently of the configured host weights
+  // return true here so that the EDF scheduler is built even when all configured weights are
+  // equal.
+  virtual bool alwaysUseEdfScheduler() const { return false; }
+
   virtual void recalculateHostsInSlowStart(const HostVector& hosts_added);
 
   // Seed to allow us to desynchronize load balancers across a fleet. If we don't
@@ -474,6 +483,7 @@ private:
 
   // Scheduler for each valid HostsSource.
   absl::node_hash_map<HostsSource, Scheduler, HostsSourceHash> scheduler_;
+  const envoy::config::cluster::v3::Cluster::CommonLbConfig::WeightedScheduler weighted_scheduler_;
   Common::CallbackHandlePtr priority_update_cb_;
   Common::CallbackHandlePtr member_update_cb_;
 
@@ -665,6 +675,115 @@ private:
   const absl::optional<Runtime::Double> active_request_bias_runtime_;
 };
 
+/**
+ * Peak EWMA load balancer.
+ *
+ * A latency aware variant of the least request load balancer. The cost of a host is its peak
+ * sensitive EWMA response time (see ResponseTimeEstimator) multiplied by its number of active
+ * requests plus one. When all hosts have the same weight, N random healthy hosts are sampled and
+ * the cheapest one is picked (P2C). When hosts have different weights, an EDF schedule is used and
+ * the host weight is divided by its cost at pick/insert time.
+ *
+ * Hosts that never reported a response time have an estimate of zero. They are preferred while
+ * they have no active requests and are otherwise charged a large penalty, so that a new host that
+ * never completes a request does not attract all of the traffic.
+ */
+class PeakEwmaLoadBalancer : public EdfLoadBalancerBase {
+public:
+  PeakEwmaLoadBalancer(
+      const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
+      Runtime::Loader& runtime, Random::RandomGenerator& random,
+      const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config,
+      const absl::optional<envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig> peak_ewma_config,
+      TimeSource& time_source)
+      : EdfLoadBalancerBase(
+            priority_set, local_priority_set, stats, runtime, random, common_config,
+            (peak_ewma_config.has_value() && peak_ewma_config.value().has_slow_start_config())
+                ? absl::optional<envoy::config::cluster::v3::Cluster::SlowStartConfig>(
+                      peak_ewma_config.value().slow_start_config())
+                : absl::nullopt,
+            time_source),
+        choice_count_(peak_ewma_config.has_value()
+                          ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(peak_ewma_config.value(), choice_count, 2)
+                          : 2) {
+    initialize();
+  }
+
+  /**
+   * @return the cost of sending a request to the given host. Lower is better.
+   */
+  static double hostCost(const Host& host);
+
+  // Cost charged to a host that has active requests but never reported a response time.
+  static constexpr double UnknownResponseTimePenalty = 1e6;
+
+private:
+  void refreshHostSource(const HostsSource&) override {}
+  double hostWeight(const Host& host) override {
+    // Add 1 to the cost to avoid division by 0 for hosts without samples nor active requests.
+    const double host_weight = static_cast<double>(host.weight()) / (hostCost(host) + 1);
+    if (!noHostsAreInSlowStart()) {
+      return applySlowStartFactor(host_weight, host);
+    }
+    return host_weight;
+  }
+  HostConstSharedPtr unweightedHostPeek(const HostVector& hosts_to_use,
+                                        const HostsSource& source) override;
+  HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
+                                        const HostsSource& source) override;
+
+  const uint32_t choice_count_;
+};
+
+/**
+ * ORCA weighted round robin load balancer.
+ *
+ * Weighted round robin where the weight of a host is its configured load balancing weight
+ * multiplied by rps / utilization, as last reported by the host through ORCA load reports (see
+ * UtilizationWeight). Reports are recorded on the host by whichever worker received them, and the
+ * EDF scheduler of each worker uses the new weight the next time the host is picked, so weight
+ * updates don't require a main thread round trip nor a host set update.
+ *
+ * Hosts without a usable utilization weight are weighted with the mean utilization weight of the
+ * hosts that have one. The mean is recomputed by each worker at most once per weight update period.
+ */
+class OrcaWeightedRoundRobinLoadBalancer : public EdfLoadBalancerBase {
+public:
+  OrcaWeightedRoundRobinLoadBalancer(
+      const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
+      Runtime::Loader& runtime, Random::RandomGenerator& random,
+      const envoy::config::cluster::v3::Cluster::CommonLbConfig& common_config,
+      const absl::optional<envoy::config::cluster::v3::Cluster::OrcaWeightedRoundRobinLbConfig>
+          orca_config,
+      TimeSource& time_source);
+
+  // Upstream::ZoneAwareLoadBalancerBase
+  HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
+
+protected:
+  void refresh(uint32_t priority) override;
+  bool alwaysUseEdfScheduler() const override { return true; }
+
+private:
+  void refreshHostSource(const HostsSource&) override {}
+  double hostWeight(const Host& host) override;
+  HostConstSharedPtr unweightedHostPeek(const HostVector&, const HostsSource&) override {
+    return nullptr;
+  }
+  HostConstSharedPtr unweightedHostPick(const HostVector&, const HostsSource&) override {
+    // The EDF scheduler is always used.
+    return nullptr;
+  }
+  void updateMeanWeight(MonotonicTime now);
+
+  const std::chrono::milliseconds blackout_period_;
+  const std::chrono::milliseconds weight_expiration_period_;
+  const std::chrono::milliseconds weight_update_period_;
+  // Weight used for hosts without a usable utilization weight.
+  double mean_weight_{1.0};
+  MonotonicTime next_mean_weight_update_;
+};
+
 /**
  * Random load balancer that picks a random host out of all hosts.
  */
@@ -727,7 +846,10 @@ public:
         default_subset_(subset_config.default_subset()),
         locality_weight_aware_(subset_config.locality_weight_aware()),
         scale_locality_weight_(subset_config.scale_locality_weight()),
-        panic_mode_any_(subset_config.panic_mode_any()), list_as_any_(subset_config.list_as_any()) {
+        panic_mode_any_(subset_config.panic_mode_any()), list_as_any_(subset_config.list_as_any()),
+        lazy_subset_creation_(subset_config.has_lazy_subset_config()),
+        lazy_subset_idle_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(subset_config.lazy_subset_config(),
+                                                             idle_timeout, 300000)) {
     for (const auto& subset : subset_config.subset_selectors()) {
       if (!subset.keys().empty()) {
         subset_selectors_.emplace_back(std::make_shared<SubsetSelectorImpl>(
@@ -755,6 +877,10 @@ public:
   bool scaleLocalityWeight() const override { return scale_locality_weight_; }
   bool panicModeAny() const override { return panic_mode_any_; }
   bool listAsAny() const override { return list_as_any_; }
+  bool lazySubsetCreation() const override { return lazy_subset_creation_; }
+  std::chrono::milliseconds lazySubsetIdleTimeout() const override {
+    return lazy_subset_idle_timeout_;
+  }
 
 private:
   const bool enabled_;
@@ -768,6 +894,8 @@ private:
   const bool scale_locality_weight_;
   const bool panic_mode_any_;
   const bool list_as_any_;
+  const bool lazy_subset_creation_;
+  const std::chrono::milliseconds lazy_subset_idle_timeout_;
 };
 
 } // namespace Upstream
@@ -102,6 +102,12 @@ public:
   }
   HostStats& stats() const override { return logical_host_->stats(); }
   LoadMetricStats& loadMetricStats() const override { return logical_host_->loadMetricStats(); }
+  ResponseTimeEstimator& responseTimeEstimator() const override {
+    return logical_host_->responseTimeEstimator();
+  }
+  UtilizationWeight& utilizationWeight() const override {
+    return logical_host_->utilizationWeight();
+  }
   const std::string& hostnameForHealthChecks() const override {
     return logical_host_->hostnameForHealthChecks();
   }
@@ -1,5 +1,7 @@
 #include "source/common/upstream/subset_lb.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
@@ -46,7 +48,12 @@ SubsetLoadBalancer::SubsetLoadBalancer(
       locality_weight_aware_(subsets.localityWeightAware()),
       scale_locality_weight_(subsets.scaleLocalityWeight()), list_as_any_(subsets.listAsAny()),
       time_source_(time_source),
-      override_host_status_(LoadBalancerContextBase::createOverrideHostStatus(common_config)) {
+      override_host_status_(LoadBalancerContextBase::createOverrideHostStatus(common_config)),
+      lazy_subset_creation_(subsets.lazySubsetCreation()),
+      lazy_subset_idle_timeout_(subsets.lazySubsetIdleTimeout()),
+      next_idle_subset_sweep_(time_source.monotonicTime() + lazy_subset_idle_timeout_),
+      subset_lb_stats_({ALL_SUBSET_LB_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope),
+                                            POOL_HISTOGRAM(scope))}) {
   ASSERT(subsets.isEnabled());
 
   if (fallback_policy_ != envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK) {
@@ -71,6 +78,7 @@ SubsetLoadBalancer::SubsetLoadBalancer(
 
   // Create filtered default subset (if necessary) and other subsets based on current hosts.
   refreshSubsets();
+  updateSubsetHostsStat();
 
   // Configure future updates.
   original_priority_set_callback_handle_ = priority_set.addPriorityUpdateCb(
@@ -80,10 +88,20 @@ SubsetLoadBalancer::SubsetLoadBalancer(
 
         refreshSubsets(priority);
         purgeEmptySubsets(subsets_);
+        updateSubsetHostsStat();
+
+        if (lazy_subset_creation_) {
+          const MonotonicTime now = time_source_.monotonicTime();
+          if (now >= next_idle_subset_sweep_) {
+            expireIdleSubsets(now);
+          }
+        }
       });
 }
 
 SubsetLoadBalancer::~SubsetLoadBalancer() {
+  subset_lb_stats_.lb_subsets_hosts_.sub(subset_hosts_);
+
   // Ensure gauges reflect correct values.
   forEachSubset(subsets_, [&](LbSubsetEntryPtr entry) {
     if (entry->active()) {
@@ -346,7 +364,9 @@ HostConstSharedPtr SubsetLoadBalancer::tryChooseHostFromContext(LoadBalancerCont
   }
 
   // Route has metadata match criteria defined, see if we have a matching subset.
-  LbSubsetEntryPtr entry = findSubset(match_criteria->metadataMatchCriteria());
+  LbSubsetEntryPtr entry = lazy_subset_creation_
+                               ? findOrCreateLazySubset(match_criteria->metadataMatchCriteria())
+                               : findSubset(match_criteria->metadataMatchCriteria());
   if (entry == nullptr || !entry->active()) {
     // No matching subset or subset not active: use fallback policy.
     return nullptr;
@@ -396,6 +416,117 @@ SubsetLoadBalancer::LbSubsetEntryPtr SubsetLoadBalancer::findSubset(
   return nullptr;
 }
 
+// Finds the subset selected by the given metadata match criteria, creating it from the current
+// hosts if it does not exist yet and the criteria keys are the keys of a subset selector. Also
+// expires subsets which have not been selected for the idle timeout.
+SubsetLoadBalancer::LbSubsetEntryPtr SubsetLoadBalancer::findOrCreateLazySubset(
+    const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (now >= next_idle_subset_sweep_) {
+    expireIdleSubsets(now);
+  }
+
+  LbSubsetEntryPtr entry = findSubset(match_criteria);
+  if (entry == nullptr || !entry->initialized()) {
+    const SubsetSelector* subset_selector = findSubsetSelector(match_criteria);
+    if (subset_selector == nullptr) {
+      // No subset can ever match these criteria.
+      return nullptr;
+    }
+
+    const MonotonicTime start = time_source_.monotonicTime();
+    SubsetMetadata kvs;
+    kvs.reserve(match_criteria.size());
+    for (const auto& match_criterion : match_criteria) {
+      kvs.emplace_back(match_criterion->name(), match_criterion->value().value());
+    }
+
+    ENVOY_LOG(debug, "subset lb: creating subset for {}", describeMetadata(kvs));
+    entry = findOrCreateLbSubsetEntry(subsets_, kvs, 0);
+    initLbSubsetEntryOnce(entry, subset_selector->singleHostPerSubset());
+    for (const auto& host_set : original_priority_set_.hostSetsPerPriority()) {
+      const uint32_t priority = host_set->priority();
+      for (const auto& host : host_set->hosts()) {
+        if (hostMatches(kvs, *host)) {
+          entry->lb_subset_->pushHost(priority, host);
+          if (entry->single_host_subset_) {
+            break;
+          }
+        }
+      }
+      entry->lb_subset_->finalize(priority);
+    }
+    recordBuildTime(start);
+
+    // Subsets without hosts are kept until the next host update so that repeated requests for
+    // them do not rescan the hosts.
+    subset_hosts_ += entry->lb_subset_->hostCount();
+    subset_lb_stats_.lb_subsets_hosts_.add(entry->lb_subset_->hostCount());
+  }
+
+  entry->last_selected_ = now;
+  return entry;
+}
+
+// Returns the subset selector whose keys are exactly the keys of the given metadata match criteria,
+// if any. Both are lexically sorted.
+const SubsetSelector* SubsetLoadBalancer::findSubsetSelector(
+    const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) {
+  for (const auto& subset_selector : subset_selectors_) {
+    const auto& keys = subset_selector->selectorKeys();
+    if (keys.size() == match_criteria.size() &&
+        std::equal(keys.begin(), keys.end(), match_criteria.begin(),
+                   [](const std::string& key,
+                      const Router::MetadataMatchCriterionConstSharedPtr& match_criterion) {
+                     return key == match_criterion->name();
+                   })) {
+      return subset_selector.get();
+    }
+  }
+  return nullptr;
+}
+
+// Removes lazily created subsets which have not been selected for the idle timeout. Idle subsets
+// are swept at most once per idle timeout, so a subset lives for up to twice the idle timeout
+// after it was last selected.
+void SubsetLoadBalancer::expireIdleSubsets(MonotonicTime now) {
+  next_idle_subset_sweep_ = now + lazy_subset_idle_timeout_;
+
+  forEachSubset(subsets_, [this, now](LbSubsetEntryPtr& entry) {
+    if (entry->initialized() && now - entry->last_selected_ >= lazy_subset_idle_timeout_) {
+      entry->lb_subset_.reset();
+      stats_.lb_subsets_active_.dec();
+      stats_.lb_subsets_removed_.inc();
+      subset_lb_stats_.lb_subsets_expired_.inc();
+    }
+  });
+  purgeEmptySubsets(subsets_);
+  updateSubsetHostsStat();
+}
+
+void SubsetLoadBalancer::updateSubsetHostsStat() {
+  uint64_t subset_hosts = 0;
+  forEachSubset(subsets_, [&subset_hosts](LbSubsetEntryPtr& entry) {
+    if (entry->initialized()) {
+      subset_hosts += entry->lb_subset_->hostCount();
+    }
+  });
+
+  // The gauge is shared by the load balancers of all workers, so only apply the difference.
+  if (subset_hosts > subset_hosts_) {
+    subset_lb_stats_.lb_subsets_hosts_.add(subset_hosts - subset_hosts_);
+  } else {
+    subset_lb_stats_.lb_subsets_hosts_.sub(subset_hosts_ - subset_hosts);
+  }
+  subset_hosts_ = subset_hosts;
+}
+
+void SubsetLoadBalancer::recordBuildTime(MonotonicTime start) {
+  subset_lb_stats_.lb_subsets_build_time_us_.recordValue(
+      std::chrono::duration_cast<std::chrono::microseconds>(time_source_.monotonicTime() - start)
+          .count());
+}
+
 void SubsetLoadBalancer::updateFallbackSubset(uint32_t priority, const HostVector& all_hosts) {
   auto update_func = [priority, &all_hosts](LbSubsetPtr& subset, const HostPredicate& predicate) {
     for (const auto& host : all_hosts) {
@@ -458,9 +589,18 @@ void SubsetLoadBalancer::processSubsets(uint32_t priority, const HostVector& all
       // key from the host.
       std::vector<SubsetMetadata> all_kvs = extractSubsetMetadata(keys, *host);
       for (const auto& kvs : all_kvs) {
-        // The host has metadata for each key, find or create its subset.
-        auto entry = findOrCreateLbSubsetEntry(subsets_, kvs, 0);
-        initLbSubsetEntryOnce(entry, subset_selector->singleHostPerSubset());
+        LbSubsetEntryPtr entry;
+        if (lazy_subset_creation_) {
+          // Only subsets which were already created by a request are kept up to date.
+          entry = findLbSubsetEntry(kvs);
+          if (entry == nullptr || !entry->initialized()) {
+            continue;
+          }
+        } else {
+          // The host has metadata for each key, find or create its subset.
+          entry = findOrCreateLbSubsetEntry(subsets_, kvs, 0);
+          initLbSubsetEntryOnce(entry, subset_selector->singleHostPerSubset());
+        }
 
         if (entry->single_host_subset_) {
           if (single_host_entries.contains(entry.get())) {
@@ -498,8 +638,10 @@ void SubsetLoadBalancer::processSubsets(uint32_t priority, const HostVector& all
 // Given the latest all hosts, update all subsets for this priority level, creating new subsets as
 // necessary.
 void SubsetLoadBalancer::update(uint32_t priority, const HostVector& all_hosts) {
+  const MonotonicTime start = time_source_.monotonicTime();
   updateFallbackSubset(priority, all_hosts);
   processSubsets(priority, all_hosts);
+  recordBuildTime(start);
 }
 
 bool SubsetLoadBalancer::hostMatches(const SubsetMetadata& kvs, const Host& host) {
@@ -635,6 +777,30 @@ SubsetLoadBalancer::findOrCreateLbSubsetEntry(LbSubsetMap& subsets, const Subset
   return findOrCreateLbSubsetEntry(entry->children_, kvs, idx);
 }
 
+// Given a vector of key-values (from extractSubsetMetadata), finds the matching LbSubsetEntryPtr
+// without creating it.
+SubsetLoadBalancer::LbSubsetEntryPtr
+SubsetLoadBalancer::findLbSubsetEntry(const SubsetMetadata& kvs) {
+  const LbSubsetMap* subsets = &subsets_;
+  for (uint32_t i = 0; i < kvs.size(); i++) {
+    const auto kv_it = subsets->find(kvs[i].first);
+    if (kv_it == subsets->end()) {
+      return nullptr;
+    }
+
+    const auto vs_it = kv_it->second.find(HashedValue(kvs[i].second));
+    if (vs_it == kv_it->second.end()) {
+      return nullptr;
+    }
+
+    if (i + 1 == kvs.size()) {
+      return vs_it->second;
+    }
+    subsets = &vs_it->second->children_;
+  }
+  return nullptr;
+}
+
 // Invokes cb for each LbSubsetEntryPtr in subsets.
 void SubsetLoadBalancer::forEachSubset(LbSubsetMap& subsets,
                                        std::function<void(LbSubsetEntryPtr&)> cb) {
@@ -736,6 +902,8 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
   case LoadBalancerType::OriginalDst:
   case LoadBalancerType::ClusterProvided:
   case LoadBalancerType::LoadBalancingPolicyConfig:
+  case LoadBalancerType::PeakEwma:
+  case LoadBalancerType::OrcaWeightedRoundRobin:
     // These load balancer types can only be created when there is no subset configuration.
     PANIC("not implemented");
   }
@@ -7,9 +7,11 @@
 #include <memory>
 #include <string>
 
+#include "envoy/common/time.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/upstream/load_balancer.h"
 
 #include "source/common/common/macros.h"
@@ -26,6 +28,22 @@ namespace Upstream {
 
 using HostHashSet = absl::flat_hash_set<HostSharedPtr>;
 
+/**
+ * Subset load balancer stats which are not part of ClusterStats because they are only used by
+ * clusters with subsets. @see stats_macros.h
+ */
+#define ALL_SUBSET_LB_STATS(COUNTER, GAUGE, HISTOGRAM)                                             \
+  COUNTER(lb_subsets_expired)                                                                      \
+  GAUGE(lb_subsets_hosts, Accumulate)                                                              \
+  HISTOGRAM(lb_subsets_build_time_us, Microseconds)
+
+/**
+ * Struct definition for subset load balancer stats. @see stats_macros.h
+ */
+struct SubsetLbStats {
+  ALL_SUBSET_LB_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
 class SubsetLoadBalancer : public LoadBalancer, Logger::Loggable<Logger::Id::upstream> {
 public:
   SubsetLoadBalancer(
@@ -213,6 +231,8 @@ private:
     virtual void pushHost(uint32_t priority, HostSharedPtr host) PURE;
     virtual void finalize(uint32_t priority) PURE;
     virtual bool active() const PURE;
+    // Number of hosts across all priorities, used to estimate the memory held by subsets.
+    virtual uint64_t hostCount() const PURE;
   };
   using LbSubsetPtr = std::unique_ptr<LbSubset>;
 
@@ -263,6 +283,14 @@ private:
 
     bool active() const override { return !subset_.empty(); }
 
+    uint64_t hostCount() const override {
+      uint64_t count = 0;
+      for (const auto& host_set : host_sets_) {
+        count += host_set.first.size();
+      }
+      return count;
+    }
+
     std::vector<std::pair<HostHashSet, HostHashSet>> host_sets_;
     PrioritySubsetImpl subset_;
   };
@@ -294,6 +322,7 @@ private:
       subset_ = hosts_.begin()->second;
     }
     bool active() const override { return subset_ != nullptr; }
+    uint64_t hostCount() const override { return hosts_.size(); }
 
     // We will update subsets for every priority separately and these simple map can help us
     // to ensure which priority has valid host quickly.
@@ -318,6 +347,9 @@ private:
 
     // Used to quick check if entry is single host subset entry or not.
     bool single_host_subset_{};
+
+    // Last time a request selected this subset. Only tracked when subsets are created lazily.
+    MonotonicTime last_selected_;
   };
 
   void initLbSubsetEntryOnce(LbSubsetEntryPtr& entry, bool single_host_subset);
@@ -344,9 +376,17 @@ private:
 
   LbSubsetEntryPtr
   findSubset(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
+  LbSubsetEntryPtr
+  findOrCreateLazySubset(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
+  const SubsetSelector*
+  findSubsetSelector(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
+  void expireIdleSubsets(MonotonicTime now);
+  void updateSubsetHostsStat();
+  void recordBuildTime(MonotonicTime start);
 
   LbSubsetEntryPtr findOrCreateLbSubsetEntry(LbSubsetMap& subsets, const SubsetMetadata& kvs,
                                              uint32_t idx);
+  LbSubsetEntryPtr findLbSubsetEntry(const SubsetMetadata& kvs);
   void forEachSubset(LbSubsetMap& subsets, std::function<void(LbSubsetEntryPtr&)> cb);
   void purgeEmptySubsets(LbSubsetMap& subsets);
 
@@ -408,6 +448,15 @@ private:
 
   const HostStatusSet override_host_status_{};
 
+  // When set, subsets are only created once a request selects them and expire when idle.
+  const bool lazy_subset_creation_;
+  const std::chrono::milliseconds lazy_subset_idle_timeout_;
+  MonotonicTime next_idle_subset_sweep_;
+
+  SubsetLbStats subset_lb_stats_;
+  // This load balancer's contribution to the lb_subsets_hosts gauge.
+  uint64_t subset_hosts_{};
+
   friend class SubsetLoadBalancerDescribeMetadataTester;
 };
 
@@ -1,6 +1,7 @@
 #include "source/common/upstream/upstream_impl.h"
 
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <limits>
 #include <list>
@@ -293,6 +294,15 @@ HostVector filterHosts(const absl::node_hash_set<HostSharedPtr>& hosts,
   return net_hosts;
 }
 
+// Throws if the cluster configures load balancer subsets, for LB policies that do not support them.
+void rejectLbSubsetConfig(const envoy::config::cluster::v3::Cluster& config) {
+  if (config.has_lb_subset_config()) {
+    throw EnvoyException(
+        fmt::format("cluster: LB policy {} cannot be combined with lb_subset_config",
+                    envoy::config::cluster::v3::Cluster::LbPolicy_Name(config.lb_policy())));
+  }
+}
+
 } // namespace
 
 // TODO(pianiststickman): this implementation takes a lock on the hot path and puts a copy of the
@@ -316,6 +326,72 @@ LoadMetricStats::StatMapPtr LoadMetricStatsImpl::latch() {
   return latched;
 }
 
+void ResponseTimeEstimatorImpl::add(std::chrono::milliseconds response_time) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  const double sample = response_time.count();
+  const double current = decayedEstimate(now);
+  if (sample > current || last_update_ns_.load(std::memory_order_relaxed) == 0) {
+    // Peak sensitivity: a slower response than what we currently estimate is taken as is, so that
+    // a host which suddenly slows down is penalized immediately.
+    estimate_ms_.store(sample, std::memory_order_relaxed);
+  } else {
+    const int64_t last_ns = last_update_ns_.load(std::memory_order_relaxed);
+    const double elapsed_ms = (now.time_since_epoch().count() - last_ns) / 1e6;
+    const double w = std::exp(-std::max(elapsed_ms, 0.0) / decay_time_ms_);
+    estimate_ms_.store(estimate_ms_.load(std::memory_order_relaxed) * w + sample * (1.0 - w),
+                       std::memory_order_relaxed);
+  }
+  // Avoid storing 0 since it is used to indicate that no sample was recorded yet.
+  last_update_ns_.store(std::max<int64_t>(now.time_since_epoch().count(), 1),
+                        std::memory_order_relaxed);
+}
+
+double ResponseTimeEstimatorImpl::estimate() const {
+  return decayedEstimate(time_source_.monotonicTime());
+}
+
+double ResponseTimeEstimatorImpl::decayedEstimate(MonotonicTime now) const {
+  const int64_t last_ns = last_update_ns_.load(std::memory_order_relaxed);
+  if (last_ns == 0) {
+    return 0;
+  }
+  const double elapsed_ms = (now.time_since_epoch().count() - last_ns) / 1e6;
+  return estimate_ms_.load(std::memory_order_relaxed) *
+         std::exp(-std::max(elapsed_ms, 0.0) / decay_time_ms_);
+}
+
+void UtilizationWeightImpl::update(double rps, double utilization) {
+  if (!(rps > 0) || !(utilization > 0)) {
+    return;
+  }
+  const int64_t now_ns =
+      std::max<int64_t>(time_source_.monotonicTime().time_since_epoch().count(), 1);
+  int64_t expected = 0;
+  non_empty_since_ns_.compare_exchange_strong(expected, now_ns, std::memory_order_relaxed);
+  weight_.store(rps / utilization, std::memory_order_relaxed);
+  last_update_ns_.store(now_ns, std::memory_order_relaxed);
+}
+
+double UtilizationWeightImpl::weight(std::chrono::milliseconds blackout_period,
+                                     std::chrono::milliseconds expiration_period) {
+  const int64_t now_ns = time_source_.monotonicTime().time_since_epoch().count();
+  const int64_t last_update_ns = last_update_ns_.load(std::memory_order_relaxed);
+  if (last_update_ns == 0) {
+    return 0;
+  }
+  if (now_ns - last_update_ns >= std::chrono::nanoseconds(expiration_period).count()) {
+    // Start the blackout period over with the next report.
+    non_empty_since_ns_.store(0, std::memory_order_relaxed);
+    return 0;
+  }
+  const int64_t non_empty_since_ns = non_empty_since_ns_.load(std::memory_order_relaxed);
+  if (non_empty_since_ns == 0 ||
+      now_ns - non_empty_since_ns < std::chrono::nanoseconds(blackout_period).count()) {
+    return 0;
+  }
+  return weight_.load(std::memory_order_relaxed);
+}
+
 HostDescriptionImpl::HostDescriptionImpl(
     ClusterInfoConstSharedPtr cluster, const std::string& hostname,
     Network::Address::InstanceConstSharedPtr dest_address, MetadataConstSharedPtr metadata,
@@ -330,7 +406,13 @@ HostDescriptionImpl::HostDescriptionImpl(
                   .bool_value()),
       metadata_(metadata), locality_(locality),
       locality_zone_stat_name_(locality.zone(), cluster->statsScope().symbolTable()),
-      priority_(priority),
+      response_time_estimator_(
+          time_source, std::chrono::milliseconds(
+                           cluster->lbPeakEwmaConfig().has_value()
+                               ? PROTOBUF_GET_MS_OR_DEFAULT(cluster->lbPeakEwmaConfig().value(),
+                                                            decay_time, 10000)
+                               : 10000)),
+      utilization_weight_(time_source), priority_(priority),
       socket_factory_(resolveTransportSocketFactory(dest_address, metadata_.get())),
       creation_time_(time_source.monotonicTime()) {
   if (health_check_config.port_value() != 0 && dest_address->type() != Network::Address::Type::Ip) {
@@ -926,6 +1008,8 @@ ClusterInfoImpl::ClusterInfoImpl(
       source_address_fn_(getSourceAddressFn(config, bind_config)),
       lb_round_robin_config_(config.round_robin_lb_config()),
       lb_least_request_config_(config.least_request_lb_config()),
+      lb_peak_ewma_config_(config.peak_ewma_lb_config()),
+      lb_orca_weighted_round_robin_config_(config.orca_weighted_round_robin_lb_config()),
       lb_ring_hash_config_(config.ring_hash_lb_config()),
       lb_maglev_config_(config.maglev_lb_config()),
       lb_original_dst_config_(config.original_dst_lb_config()),
@@ -941,6 +1025,10 @@ ClusterInfoImpl::ClusterInfoImpl(
       drain_connections_on_host_removal_(config.ignore_health_on_host_removal()),
       connection_pool_per_downstream_connection_(
           config.connection_pool_per_downstream_connection()),
+      shared_connection_pool_owner_threads_(
+          config.has_shared_connection_pool()
+              ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.shared_connection_pool(), owner_threads, 1)
+              : 0),
       warm_hosts_(!config.health_checks().empty() &&
                   common_lb_config_.ignore_new_hosts_until_first_hc()),
       set_local_interface_name_on_upstream_connections_(
@@ -981,6 +1069,14 @@ ClusterInfoImpl::ClusterInfoImpl(
     case envoy::config::cluster::v3::Cluster::RANDOM:
       lb_type_ = LoadBalancerType::Random;
       break;
+    case envoy::config::cluster::v3::Cluster::PEAK_EWMA:
+      rejectLbSubsetConfig(config);
+      lb_type_ = LoadBalancerType::PeakEwma;
+      break;
+    case envoy::config::cluster::v3::Cluster::ORCA_WEIGHTED_ROUND_ROBIN:
+      rejectLbSubsetConfig(config);
+      lb_type_ = LoadBalancerType::OrcaWeightedRoundRobin;
+      break;
     case envoy::config::cluster::v3::Cluster::RING_HASH:
       lb_type_ = LoadBalancerType::RingHash;
       break;
@@ -988,12 +1084,7 @@ ClusterInfoImpl::ClusterInfoImpl(
       lb_type_ = LoadBalancerType::Maglev;
       break;
     case envoy::config::cluster::v3::Cluster::CLUSTER_PROVIDED:
-      if (config.has_lb_subset_config()) {
-        throw EnvoyException(
-            fmt::format("cluster: LB policy {} cannot be combined with lb_subset_config",
-                        envoy::config::cluster::v3::Cluster::LbPolicy_Name(config.lb_policy())));
-      }
-
+      rejectLbSubsetConfig(config);
       lb_type_ = LoadBalancerType::ClusterProvided;
       break;
     case envoy::config::cluster::v3::Cluster::LOAD_BALANCING_POLICY_CONFIG: {
@@ -1030,6 +1121,26 @@ ClusterInfoImpl::ClusterInfoImpl(
     max_connection_duration_ = absl::nullopt;
   }
 
+  if (config.preconnect_policy().has_rate_predictive_preconnect()) {
+    const auto& rate_predictive_preconnect =
+        config.preconnect_policy().rate_predictive_preconnect();
+    rate_predictive_preconnect_ = RatePredictivePreconnect{
+        std::max(std::chrono::milliseconds(1),
+                 std::chrono::milliseconds(
+                     PROTOBUF_GET_MS_OR_DEFAULT(rate_predictive_preconnect, interval, 1000))),
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(rate_predictive_preconnect, smoothing_factor, 0.3)};
+  }
+
+  if (config.preconnect_policy().has_warm_tcp_connections()) {
+    const auto& warm_tcp_connections = config.preconnect_policy().warm_tcp_connections();
+    absl::optional<std::chrono::milliseconds> idle_timeout = std::chrono::milliseconds(
+        PROTOBUF_GET_MS_OR_DEFAULT(warm_tcp_connections, idle_timeout, 3600000));
+    if (idle_timeout.value().count() == 0) {
+      idle_timeout = absl::nullopt;
+    }
+    warm_tcp_connections_ = WarmTcpConnections{warm_tcp_connections.connections(), idle_timeout};
+  }
+
   if (config.has_eds_cluster_config()) {
     if (config.type() != envoy::config::cluster::v3::Cluster::EDS) {
       throw EnvoyException("eds_cluster_config set in a non-EDS cluster");
@@ -1087,11 +1198,7 @@ ClusterInfoImpl::ClusterInfoImpl(
 
 // Configures the load balancer based on config.load_balancing_policy
 void ClusterInfoImpl::configureLbPolicies(const envoy::config::cluster::v3::Cluster& config) {
-  if (config.has_lb_subset_config()) {
-    throw EnvoyException(
-        fmt::format("cluster: LB policy {} cannot be combined with lb_subset_config",
-                    envoy::config::cluster::v3::Cluster::LbPolicy_Name(config.lb_policy())));
-  }
+  rejectLbSubsetConfig(config);
 
   if (config.has_common_lb_config()) {
     throw EnvoyException(
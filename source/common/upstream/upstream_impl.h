@@ -86,6 +86,52 @@ private:
   StatMapPtr map_ ABSL_GUARDED_BY(mu_);
 };
 
+/**
+ * Implementation of ResponseTimeEstimator. Samples may be recorded concurrently by several workers.
+ * The estimate and the time of the last sample are kept in separate atomics rather than behind a
+ * lock, so concurrent updates may occasionally lose a sample. This is acceptable for load
+ * balancing purposes and keeps the per-request cost to a handful of atomic operations.
+ */
+class ResponseTimeEstimatorImpl : public ResponseTimeEstimator {
+public:
+  ResponseTimeEstimatorImpl(TimeSource& time_source, std::chrono::milliseconds decay_time)
+      : time_source_(time_source), decay_time_ms_(decay_time.count()) {}
+
+  // Upstream::ResponseTimeEstimator
+  void add(std::chrono::milliseconds response_time) override;
+  double estimate() const override;
+
+private:
+  double decayedEstimate(MonotonicTime now) const;
+
+  TimeSource& time_source_;
+  const double decay_time_ms_;
+  std::atomic<double> estimate_ms_{0};
+  std::atomic<int64_t> last_update_ns_{0};
+};
+
+/**
+ * Implementation of UtilizationWeight. Like ResponseTimeEstimatorImpl, the state is kept in
+ * relaxed atomics since concurrent reports from different workers carry similar values.
+ */
+class UtilizationWeightImpl : public UtilizationWeight {
+public:
+  UtilizationWeightImpl(TimeSource& time_source) : time_source_(time_source) {}
+
+  // Upstream::UtilizationWeight
+  void update(double rps, double utilization) override;
+  double weight(std::chrono::milliseconds blackout_period,
+                std::chrono::milliseconds expiration_period) override;
+
+private:
+  TimeSource& time_source_;
+  std::atomic<double> weight_{0};
+  // Time of the most recent report.
+  std::atomic<int64_t> last_update_ns_{0};
+  // Time of the first report since the weight was last expired, 0 if there is none.
+  std::atomic<int64_t> non_empty_since_ns_{0};
+};
+
 /**
  * Implementation of Upstream::HostDescription.
  */
@@ -156,6 +202,10 @@ public:
   }
   HostStats& stats() const override { return stats_; }
   LoadMetricStats& loadMetricStats() const override { return load_metric_stats_; }
+  ResponseTimeEstimator& responseTimeEstimator() const override {
+    return response_time_estimator_;
+  }
+  UtilizationWeight& utilizationWeight() const override { return utilization_weight_; }
   const std::string& hostnameForHealthChecks() const override { return health_checks_hostname_; }
   const std::string& hostname() const override { return hostname_; }
   Network::Address::InstanceConstSharedPtr address() const override { return address_; }
@@ -209,6 +259,8 @@ private:
   Stats::StatNameDynamicStorage locality_zone_stat_name_;
   mutable HostStats stats_;
   mutable LoadMetricStatsImpl load_metric_stats_;
+  mutable ResponseTimeEstimatorImpl response_time_estimator_;
+  mutable UtilizationWeightImpl utilization_weight_;
   Outlier::DetectorHostMonitorPtr outlier_detector_;
   HealthCheckHostMonitorPtr health_checker_;
   std::atomic<uint32_t> priority_;
@@ -677,6 +729,12 @@ public:
   }
   float perUpstreamPreconnectRatio() const override { return per_upstream_preconnect_ratio_; }
   float peekaheadRatio() const override { return peekahead_ratio_; }
+  const absl::optional<RatePredictivePreconnect>& ratePredictivePreconnect() const override {
+    return rate_predictive_preconnect_;
+  }
+  const absl::optional<WarmTcpConnections>& warmTcpConnections() const override {
+    return warm_tcp_connections_;
+  }
   uint32_t perConnectionBufferLimitBytes() const override {
     return per_connection_buffer_limit_bytes_;
   }
@@ -710,6 +768,14 @@ public:
   lbLeastRequestConfig() const override {
     return lb_least_request_config_;
   }
+  const absl::optional<envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig>&
+  lbPeakEwmaConfig() const override {
+    return lb_peak_ewma_config_;
+  }
+  const absl::optional<envoy::config::cluster::v3::Cluster::OrcaWeightedRoundRobinLbConfig>&
+  lbOrcaWeightedRoundRobinConfig() const override {
+    return lb_orca_weighted_round_robin_config_;
+  }
   const absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig>&
   lbRingHashConfig() const override {
     return lb_ring_hash_config_;
@@ -769,6 +835,9 @@ public:
   bool connectionPoolPerDownstreamConnection() const override {
     return connection_pool_per_downstream_connection_;
   }
+  uint32_t sharedConnectionPoolOwnerThreads() const override {
+    return shared_connection_pool_owner_threads_;
+  }
   bool warmHosts() const override { return warm_hosts_; }
   bool setLocalInterfaceNameOnUpstreamConnections() const override {
     return set_local_interface_name_on_upstream_connections_;
@@ -846,6 +915,8 @@ private:
   absl::optional<std::chrono::milliseconds> max_connection_duration_;
   const float per_upstream_preconnect_ratio_;
   const float peekahead_ratio_;
+  absl::optional<RatePredictivePreconnect> rate_predictive_preconnect_;
+  absl::optional<WarmTcpConnections> warm_tcp_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
   TransportSocketMatcherPtr socket_matcher_;
   Stats::ScopeSharedPtr stats_scope_;
@@ -861,6 +932,9 @@ private:
   absl::optional<envoy::config::cluster::v3::Cluster::RoundRobinLbConfig> lb_round_robin_config_;
   absl::optional<envoy::config::cluster::v3::Cluster::LeastRequestLbConfig>
       lb_least_request_config_;
+  absl::optional<envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig> lb_peak_ewma_config_;
+  absl::optional<envoy::config::cluster::v3::Cluster::OrcaWeightedRoundRobinLbConfig>
+      lb_orca_weighted_round_robin_config_;
   absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig> lb_ring_hash_config_;
   absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig> lb_maglev_config_;
   absl::optional<envoy::config::cluster::v3::Cluster::OriginalDstLbConfig> lb_original_dst_config_;
@@ -875,6 +949,7 @@ private:
   const Network::ConnectionSocket::OptionsSharedPtr cluster_socket_options_;
   const bool drain_connections_on_host_removal_;
   const bool connection_pool_per_downstream_connection_;
+  const uint32_t shared_connection_pool_owner_threads_;
   const bool warm_hosts_;
   const bool set_local_interface_name_on_upstream_connections_;
   const absl::optional<envoy::config::core::v3::UpstreamHttpProtocolOptions>
@@ -30,6 +30,9 @@ DnsCacheImpl::DnsCacheImpl(
       refresh_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, dns_refresh_rate, 60000)),
       min_refresh_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, dns_min_refresh_rate, 5000)),
       timeout_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, dns_query_timeout, 5000)),
+      refresh_ahead_ratio_(config.has_dns_refresh_ahead_ratio()
+                               ? absl::make_optional(config.dns_refresh_ahead_ratio().value())
+                               : absl::nullopt),
       file_system_(context.api().fileSystem()),
       validation_visitor_(context.messageValidationVisitor()),
       host_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, host_ttl, 300000)),
@@ -259,9 +262,22 @@ void DnsCacheImpl::onReResolve(const std::string& host) {
       primary_hosts_.erase(host_it);
     }
     notifyThreads(host, primary_host.host_info_);
-  } else {
-    startResolve(host, primary_host);
+    return;
+  }
+
+  if (primary_host.refresh_ahead_) {
+    primary_host.refresh_ahead_ = false;
+    // Hosts which have not been used since they were last resolved are not worth refreshing ahead
+    // of their DNS TTL expiring. They are resolved once it has expired instead.
+    if (!primary_host.host_info_->usedSinceResolution()) {
+      ENVOY_LOG(debug, "host='{}' unused since last resolution, skipping refresh ahead", host);
+      primary_host.refresh_timer_->enableTimer(
+          std::max(min_refresh_interval_, primary_host.host_info_->timeUntilStale()));
+      return;
+    }
+    stats_.dns_query_refresh_ahead_.inc();
   }
+  startResolve(host, primary_host);
 }
 
 void DnsCacheImpl::forceRefreshHosts() {
@@ -283,6 +299,7 @@ void DnsCacheImpl::forceRefreshHosts() {
     }
 
     ASSERT(!primary_host.second->timeout_timer_->enabled());
+    primary_host.second->refresh_ahead_ = false;
     primary_host.second->refresh_timer_->enableTimer(std::chrono::milliseconds(0), nullptr);
     ENVOY_LOG_EVENT(debug, "force_refresh_host", "force refreshing host='{}'", primary_host.first);
   }
@@ -376,6 +393,13 @@ void DnsCacheImpl::finishResolve(const std::string& host,
     primary_host_info->host_info_->updateStale(resolution_time.value(), dns_ttl);
   }
 
+  if (new_address == nullptr && current_address != nullptr) {
+    // Keep serving the previously resolved addresses until a resolution succeeds again.
+    ENVOY_LOG(debug, "host '{}' failed to re-resolve, serving previous address {}", host,
+              current_address->asStringView());
+    stats_.host_stale_serve_.inc();
+  }
+
   bool changed_to_non_null_address =
       (new_address != nullptr &&
        (current_address == nullptr || *current_address != *new_address ||
@@ -409,9 +433,27 @@ void DnsCacheImpl::finishResolve(const std::string& host,
   if (status == Network::DnsResolver::ResolutionStatus::Success) {
     primary_host_info->failure_backoff_strategy_->reset(
         std::chrono::duration_cast<std::chrono::milliseconds>(dns_ttl).count());
-    primary_host_info->refresh_timer_->enableTimer(dns_ttl);
+    std::chrono::milliseconds refresh_interval = dns_ttl;
+    if (from_cache) {
+      // Entries loaded from the key value store were resolved before this process started, so
+      // refresh them once their remaining TTL expires. Until then, and until the refresh
+      // completes, they are served as loaded so that requests do not wait for DNS. All entries
+      // are loaded at once and many may already be stale, so the refreshes are spread over
+      // min_refresh_interval_ after the earliest one rather than all started right away.
+      refresh_interval =
+          std::max(min_refresh_interval_, primary_host_info->host_info_->timeUntilStale()) +
+          std::chrono::milliseconds(random_generator_.random() %
+                                    (min_refresh_interval_.count() + 1));
+    } else if (refresh_ahead_ratio_.has_value() && new_address != nullptr) {
+      refresh_interval = std::min<std::chrono::milliseconds>(
+          refresh_interval, std::max(min_refresh_interval_,
+                                     std::chrono::milliseconds(static_cast<uint64_t>(
+                                         refresh_ahead_ratio_.value() * refresh_interval.count()))));
+      primary_host_info->refresh_ahead_ = refresh_interval < dns_ttl;
+    }
+    primary_host_info->refresh_timer_->enableTimer(refresh_interval);
     ENVOY_LOG(debug, "DNS refresh rate reset for host '{}', refresh rate {} ms", host,
-              dns_ttl.count() * 1000);
+              refresh_interval.count());
   } else {
     const uint64_t refresh_interval = primary_host_info->failure_backoff_strategy_->nextBackOffMs();
     primary_host_info->refresh_timer_->enableTimer(std::chrono::milliseconds(refresh_interval));
@@ -26,12 +26,14 @@ namespace DynamicForwardProxy {
   COUNTER(cache_load)                                                                              \
   COUNTER(dns_query_attempt)                                                                       \
   COUNTER(dns_query_failure)                                                                       \
+  COUNTER(dns_query_refresh_ahead)                                                                 \
   COUNTER(dns_query_success)                                                                       \
   COUNTER(dns_query_timeout)                                                                       \
   COUNTER(host_added)                                                                              \
   COUNTER(host_address_changed)                                                                    \
   COUNTER(host_overflow)                                                                           \
   COUNTER(host_removed)                                                                            \
+  COUNTER(host_stale_serve)                                                                        \
   COUNTER(dns_rq_pending_overflow)                                                                 \
   GAUGE(num_hosts, NeverImport)
 
@@ -123,11 +125,22 @@ private:
     bool isIpAddress() const override { return is_ip_address_; }
     void touch() final { last_used_time_ = time_source_.monotonicTime().time_since_epoch(); }
     void updateStale(MonotonicTime resolution_time, std::chrono::seconds ttl) {
+      resolution_time_ = resolution_time;
       stale_at_time_ = resolution_time + ttl;
     }
     bool isStale() {
       return time_source_.monotonicTime() > static_cast<MonotonicTime>(stale_at_time_);
     }
+    std::chrono::milliseconds timeUntilStale() const {
+      return std::max(std::chrono::milliseconds(0),
+                      std::chrono::duration_cast<std::chrono::milliseconds>(
+                          static_cast<MonotonicTime>(stale_at_time_) -
+                          time_source_.monotonicTime()));
+    }
+    // Only called on the main thread, which is the only one updating resolution_time_.
+    bool usedSinceResolution() const {
+      return lastUsedTime() >= resolution_time_.time_since_epoch();
+    }
 
     void setAddresses(Network::Address::InstanceConstSharedPtr address,
                       std::vector<Network::Address::InstanceConstSharedPtr>&& list) {
@@ -163,6 +176,7 @@ private:
     // using MonotonicTime.
     std::atomic<std::chrono::steady_clock::duration> last_used_time_;
     std::atomic<MonotonicTime> stale_at_time_;
+    MonotonicTime resolution_time_;
     bool first_resolve_complete_ ABSL_GUARDED_BY(resolve_lock_){false};
   };
 
@@ -180,6 +194,8 @@ private:
     const DnsHostInfoImplSharedPtr host_info_;
     const BackOffStrategyPtr failure_backoff_strategy_;
     Network::ActiveDnsQuery* active_query_{};
+    // Whether the refresh timer is set to refresh ahead of the DNS TTL expiring.
+    bool refresh_ahead_{};
   };
 
   // Hold PrimaryHostInfo by shared_ptr to avoid having to hold the map mutex while updating
@@ -242,6 +258,7 @@ private:
   const std::chrono::milliseconds refresh_interval_;
   const std::chrono::milliseconds min_refresh_interval_;
   const std::chrono::milliseconds timeout_interval_;
+  const absl::optional<double> refresh_ahead_ratio_;
   Filesystem::Instance& file_system_;
   ProtobufMessage::ValidationVisitor& validation_visitor_;
   const std::chrono::milliseconds host_ttl_;
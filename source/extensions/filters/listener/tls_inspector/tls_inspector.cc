@@ -16,6 +16,8 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/hex.h"
 #include "source/common/protobuf/utility.h"
+#include "source/common/runtime/runtime_features.h"
+#include "source/common/ssl/client_hello_info.h"
 
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -54,6 +56,7 @@ Config::Config(
       ssl_ctx_.get(), [](const SSL_CLIENT_HELLO* client_hello) -> ssl_select_cert_result_t {
         Filter* filter = static_cast<Filter*>(SSL_get_app_data(client_hello->ssl));
         filter->createJA3Hash(client_hello);
+        filter->setClientHelloInfo(*client_hello);
 
         const uint8_t* data;
         size_t len;
@@ -121,6 +124,20 @@ void Filter::onServername(absl::string_view name) {
   clienthello_success_ = true;
 }
 
+void Filter::setClientHelloInfo(const SSL_CLIENT_HELLO& client_hello) {
+  if (!Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.tls_inspector_share_client_hello") ||
+      cb_->filterState().hasDataWithName(Ssl::ClientHelloInfo::key())) {
+    return;
+  }
+  // Lets a TLS transport socket selecting a certificate for this connection skip looking up the
+  // same extensions again.
+  cb_->filterState().setData(Ssl::ClientHelloInfo::key(),
+                             std::make_shared<Ssl::ClientHelloInfo>(client_hello),
+                             StreamInfo::FilterState::StateType::ReadOnly,
+                             StreamInfo::FilterState::LifeSpan::Connection);
+}
+
 Network::FilterStatus Filter::onData(Network::ListenerFilterBuffer& buffer) {
   auto raw_slice = buffer.rawSlice();
   ENVOY_LOG(trace, "tls inspector: recv: {}", raw_slice.len_);
@@ -88,6 +88,7 @@ private:
   void onALPN(const unsigned char* data, unsigned int len);
   void onServername(absl::string_view name);
   void createJA3Hash(const SSL_CLIENT_HELLO* ssl_client_hello);
+  void setClientHelloInfo(const SSL_CLIENT_HELLO& client_hello);
 
   ConfigSharedPtr config_;
   Network::ListenerFilterCallbacks* cb_{};
@@ -13,7 +13,8 @@ UdpProxyFilter::UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
                                const UdpProxyFilterConfigSharedPtr& config)
     : UdpListenerReadFilter(callbacks), config_(config),
       cluster_update_callbacks_(
-          config->clusterManager().addThreadLocalClusterUpdateCallbacks(*this)) {
+          config->clusterManager().addThreadLocalClusterUpdateCallbacks(*this)),
+      idle_timer_(callbacks.udpListener().dispatcher().createTimer([this] { onIdleTimer(); })) {
   for (const auto& entry : config_->allClusterNames()) {
     Upstream::ThreadLocalCluster* cluster = config->clusterManager().getThreadLocalCluster(entry);
     if (cluster != nullptr) {
@@ -62,6 +63,44 @@ Network::FilterStatus UdpProxyFilter::onReceiveError(Api::IoError::IoErrorCode)
   return Network::FilterStatus::StopIteration;
 }
 
+void UdpProxyFilter::scheduleUpstreamFlush(ActiveSession& session) {
+  sessions_pending_flush_.insert(&session);
+  if (upstream_flush_cb_ == nullptr) {
+    upstream_flush_cb_ = read_callbacks_->udpListener().dispatcher().createSchedulableCallback(
+        [this]() { flushUpstreamWrites(); });
+  }
+  // The listener delivers all the datagrams it reads for one socket event before the callback
+  // runs, so these are sent together at the end of the current event loop iteration.
+  if (!upstream_flush_cb_->enabled()) {
+    upstream_flush_cb_->scheduleCallbackCurrentIteration();
+  }
+}
+
+void UdpProxyFilter::flushUpstreamWrites() {
+  for (ActiveSession* session : sessions_pending_flush_) {
+    session->flush();
+  }
+  sessions_pending_flush_.clear();
+}
+
+void UdpProxyFilter::enableIdleTimer() {
+  if (!idle_timer_->enabled()) {
+    idle_timer_->enableTimer(config_->idleScanInterval());
+  }
+}
+
+void UdpProxyFilter::onIdleTimer() {
+  const MonotonicTime now = approximateMonotonicTime();
+  bool has_sessions = false;
+  for (const auto& cluster_info : cluster_infos_) {
+    cluster_info.second->removeIdleSessions(now);
+    has_sessions |= cluster_info.second->hasSessions();
+  }
+  if (has_sessions) {
+    enableIdleTimer();
+  }
+}
+
 UdpProxyFilter::ClusterInfo::ClusterInfo(UdpProxyFilter& filter,
                                          Upstream::ThreadLocalCluster& cluster,
                                          SessionStorageType&& sessions)
@@ -93,6 +132,21 @@ UdpProxyFilter::ClusterInfo::~ClusterInfo() {
   ASSERT(host_to_sessions_.empty());
 }
 
+void UdpProxyFilter::ClusterInfo::removeIdleSessions(MonotonicTime now) {
+  // Only the sessions at the front can be idle, the scan stops at the first active one.
+  while (!sessions_by_activity_.empty()) {
+    const ActiveSession* session = sessions_by_activity_.front();
+    if (now - session->lastActivity() < filter_.config_->sessionTimeout()) {
+      break;
+    }
+    ENVOY_LOG(debug, "session idle timeout: downstream={} local={}",
+              session->addresses().peer_->asStringView(),
+              session->addresses().local_->asStringView());
+    filter_.config_->stats().idle_timeout_.inc();
+    removeSession(session);
+  }
+}
+
 void UdpProxyFilter::ClusterInfo::removeSession(const ActiveSession* session) {
   // First remove from the host to sessions map.
   ASSERT(host_to_sessions_[&session->host()].count(session) == 1);
@@ -229,11 +283,14 @@ UdpProxyFilter::ActiveSession::ActiveSession(ClusterInfo& cluster,
                                              const Upstream::HostConstSharedPtr& host)
     : cluster_(cluster), use_original_src_ip_(cluster_.filter_.config_->usingOriginalSrcIp()),
       addresses_(std::move(addresses)), host_(host),
-      idle_timer_(cluster.filter_.read_callbacks_->udpListener().dispatcher().createTimer(
-          [this] { onIdleTimer(); })),
+      last_activity_(cluster.filter_.approximateMonotonicTime()),
+      activity_it_(cluster.sessions_by_activity_.insert(cluster.sessions_by_activity_.end(), this)),
       // NOTE: The socket call can only fail due to memory/fd exhaustion. No local ephemeral port
       //       is bound until the first packet is sent to the upstream host.
-      socket_(cluster.filter_.createSocket(host)) {
+      socket_(cluster.filter_.createSocket(host)),
+      upstream_writer_(
+          cluster.filter_.config_->upstreamPacketWriterFactory().createUdpPacketWriter(
+              socket_->ioHandle(), cluster.filter_.config_->scope())) {
   if (!cluster_.filter_.config_->accessLogs().empty()) {
     udp_sess_stats_.emplace(
         StreamInfo::StreamInfoImpl(cluster_.filter_.config_->timeSource(), nullptr));
@@ -241,13 +298,21 @@ UdpProxyFilter::ActiveSession::ActiveSession(ClusterInfo& cluster,
 
   socket_->ioHandle().initializeFileEvent(
       cluster.filter_.read_callbacks_->udpListener().dispatcher(),
-      [this](uint32_t) { onReadReady(); }, Event::PlatformDefaultTriggerType,
-      Event::FileReadyType::Read);
+      [this](uint32_t events) {
+        if (events & Event::FileReadyType::Read) {
+          onReadReady();
+        }
+        if (events & Event::FileReadyType::Write) {
+          onWriteReady();
+        }
+      },
+      Event::PlatformDefaultTriggerType, Event::FileReadyType::Read);
   ENVOY_LOG(debug, "creating new session: downstream={} local={} upstream={}",
             addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
             host->address()->asStringView());
   cluster_.filter_.config_->stats().downstream_sess_total_.inc();
   cluster_.filter_.config_->stats().downstream_sess_active_.inc();
+  cluster_.filter_.enableIdleTimer();
   cluster_.cluster_.info()
       ->resourceManager(Upstream::ResourcePriority::Default)
       .connections()
@@ -275,6 +340,9 @@ UdpProxyFilter::ActiveSession::~ActiveSession() {
   ENVOY_LOG(debug, "deleting the session: downstream={} local={} upstream={}",
             addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
             host_->address()->asStringView());
+  // Datagrams still buffered by the writer are dropped along with the session.
+  cluster_.filter_.sessions_pending_flush_.erase(this);
+  cluster_.sessions_by_activity_.erase(activity_it_);
   cluster_.filter_.config_->stats().downstream_sess_active_.dec();
   cluster_.cluster_.info()
       ->resourceManager(Upstream::ResourcePriority::Default)
@@ -306,15 +374,14 @@ void UdpProxyFilter::ActiveSession::fillStreamInfo() {
   udp_sess_stats_.value().setDynamicMetadata("udp.proxy", stats_obj);
 }
 
-void UdpProxyFilter::ActiveSession::onIdleTimer() {
-  ENVOY_LOG(debug, "session idle timeout: downstream={} local={}", addresses_.peer_->asStringView(),
-            addresses_.local_->asStringView());
-  cluster_.filter_.config_->stats().idle_timeout_.inc();
-  cluster_.removeSession(this);
+void UdpProxyFilter::ActiveSession::onActivity() {
+  last_activity_ = cluster_.filter_.approximateMonotonicTime();
+  cluster_.sessions_by_activity_.splice(cluster_.sessions_by_activity_.end(),
+                                        cluster_.sessions_by_activity_, activity_it_);
 }
 
 void UdpProxyFilter::ActiveSession::onReadReady() {
-  idle_timer_->enableTimer(cluster_.filter_.config_->sessionTimeout());
+  onActivity();
 
   // TODO(mattklein123): We should not be passing *addresses_.local_ to this function as we are
   //                     not trying to populate the local address for received packets.
@@ -324,12 +391,11 @@ void UdpProxyFilter::ActiveSession::onReadReady() {
       cluster_.filter_.config_->upstreamSocketConfig().prefer_gro_, packets_dropped);
   if (result == nullptr) {
     socket_->ioHandle().activateFileEvents(Event::FileReadyType::Read);
-    return;
-  }
-  if (result->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+  } else if (result->getErrorCode() != Api::IoError::IoErrorCode::Again) {
     cluster_.cluster_stats_.sess_rx_errors_.inc();
   }
-  // Flush out buffered data at the end of IO event.
+  // Flush out buffered data at the end of IO event, including when the read was cut short by the
+  // per event loop packet limit.
   cluster_.filter_.read_callbacks_->udpListener().flush();
 }
 
@@ -343,7 +409,7 @@ void UdpProxyFilter::ActiveSession::write(const Buffer::Instance& buffer) {
   cluster_.filter_.config_->stats().downstream_sess_rx_datagrams_.inc();
   ++session_stats_.downstream_sess_rx_datagrams_;
 
-  idle_timer_->enableTimer(cluster_.filter_.config_->sessionTimeout());
+  onActivity();
 
   // NOTE: On the first write, a local ephemeral port is bound, and thus this write can fail due to
   //       port exhaustion. To avoid exhaustion, UDP sockets will be connected and associated with
@@ -366,13 +432,54 @@ void UdpProxyFilter::ActiveSession::write(const Buffer::Instance& buffer) {
 
     skip_connect_ = true;
   }
-  Api::IoCallUint64Result rc =
-      Network::Utility::writeToSocket(socket_->ioHandle(), buffer, local_ip, *host_->address());
-  if (!rc.ok()) {
-    cluster_.cluster_stats_.sess_tx_errors_.inc();
-  } else {
+  if (upstream_writer_->isWriteBlocked()) {
+    // Writers must not be written to while blocked. Whatever a batching writer has buffered stays
+    // buffered and is sent by onWriteReady(), only this datagram is dropped.
+    cluster_.cluster_stats_.sess_tx_writer_blocked_.inc();
+    return;
+  }
+  Api::IoCallUint64Result rc = upstream_writer_->writePacket(buffer, local_ip, *host_->address());
+  if (rc.ok()) {
     cluster_.cluster_stats_.sess_tx_datagrams_.inc();
     cluster_.cluster_.info()->stats().upstream_cx_tx_bytes_total_.add(buffer_length);
+  } else if (rc.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+    cluster_.cluster_stats_.sess_tx_writer_blocked_.inc();
+  } else {
+    cluster_.cluster_stats_.sess_tx_errors_.inc();
+  }
+
+  if (upstream_writer_->isWriteBlocked()) {
+    waitForWritable();
+  } else if (upstream_writer_->isBatchMode()) {
+    cluster_.filter_.scheduleUpstreamFlush(*this);
+  }
+}
+
+void UdpProxyFilter::ActiveSession::flush() {
+  if (upstream_writer_->isWriteBlocked()) {
+    // onWriteReady() flushes the buffered datagrams once the socket is writable.
+    return;
+  }
+  const Api::IoCallUint64Result rc = upstream_writer_->flush();
+  if (!rc.ok() && rc.err_->getErrorCode() != Api::IoError::IoErrorCode::Again) {
+    ENVOY_LOG(debug, "cannot flush upstream datagrams: {}", rc.err_->getErrorDetails());
+    cluster_.cluster_stats_.sess_tx_errors_.inc();
+  }
+  if (upstream_writer_->isWriteBlocked()) {
+    waitForWritable();
+  }
+}
+
+void UdpProxyFilter::ActiveSession::waitForWritable() {
+  socket_->ioHandle().enableFileEvents(Event::FileReadyType::Read | Event::FileReadyType::Write);
+}
+
+void UdpProxyFilter::ActiveSession::onWriteReady() {
+  // Stop watching for writability until the writer blocks again.
+  socket_->ioHandle().enableFileEvents(Event::FileReadyType::Read);
+  upstream_writer_->setWritable();
+  if (upstream_writer_->isBatchMode()) {
+    flush();
   }
 }
 
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <list>
+
 #include "envoy/access_log/access_log.h"
 #include "envoy/config/accesslog/v3/accesslog.pb.h"
 #include "envoy/event/file_event.h"
+#include "envoy/event/schedulable_cb.h"
 #include "envoy/event/timer.h"
 #include "envoy/extensions/filters/udp/udp_proxy/v3/udp_proxy.pb.h"
 #include "envoy/network/filter.h"
+#include "envoy/network/udp_packet_writer_handler.h"
 #include "envoy/stream_info/stream_info.h"
 #include "envoy/upstream/cluster_manager.h"
 
@@ -13,8 +17,10 @@
 #include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/common/empty_string.h"
 #include "source/common/common/random_generator.h"
+#include "source/common/config/utility.h"
 #include "source/common/network/socket_impl.h"
 #include "source/common/network/socket_interface.h"
+#include "source/common/network/udp_packet_writer_handler_impl.h"
 #include "source/common/network/utility.h"
 #include "source/common/protobuf/utility.h"
 #include "source/common/stream_info/stream_info_impl.h"
@@ -62,7 +68,8 @@ struct UdpProxyDownstreamStats {
   COUNTER(sess_rx_datagrams_dropped)                                                               \
   COUNTER(sess_rx_errors)                                                                          \
   COUNTER(sess_tx_datagrams)                                                                       \
-  COUNTER(sess_tx_errors)
+  COUNTER(sess_tx_errors)                                                                          \
+  COUNTER(sess_tx_writer_blocked)
 
 /**
  * Struct definition for all UDP proxy upstream stats. @see stats_macros.h
@@ -83,7 +90,7 @@ public:
         stats_(generateStats(config.stat_prefix(), context.scope())),
         // Default prefer_gro to true for upstream client traffic.
         upstream_socket_config_(config.upstream_socket_config(), true),
-        random_(context.api().randomGenerator()) {
+        scope_(context.scope()), random_(context.api().randomGenerator()) {
     if (use_original_src_ip_ && !Api::OsSysCallsSingleton::get().supportsIpTransparent()) {
       ExceptionUtil::throwEnvoyException(
           "The platform does not support either IP_TRANSPARENT or IPV6_TRANSPARENT. Or the envoy "
@@ -98,6 +105,17 @@ public:
     if (!config.hash_policies().empty()) {
       hash_policy_ = std::make_unique<HashPolicyImpl>(config.hash_policies());
     }
+
+    if (config.has_upstream_packet_writer_config()) {
+      auto& factory_factory =
+          Config::Utility::getAndCheckFactory<Network::UdpPacketWriterFactoryFactory>(
+              config.upstream_packet_writer_config());
+      upstream_packet_writer_factory_ =
+          factory_factory.createUdpPacketWriterFactory(config.upstream_packet_writer_config());
+    }
+    if (upstream_packet_writer_factory_ == nullptr) {
+      upstream_packet_writer_factory_ = std::make_unique<Network::UdpDefaultWriterFactory>();
+    }
   }
 
   const std::string route(const Network::Address::Instance& destination_address,
@@ -107,6 +125,11 @@ public:
   const std::vector<std::string>& allClusterNames() const { return router_->allClusterNames(); }
   Upstream::ClusterManager& clusterManager() const { return cluster_manager_; }
   std::chrono::milliseconds sessionTimeout() const { return session_timeout_; }
+  // Idle sessions are looked for at this interval, so a session is removed at most this long after
+  // it reached the session timeout.
+  std::chrono::milliseconds idleScanInterval() const {
+    return std::min(session_timeout_, MaxIdleScanInterval);
+  }
   bool usingOriginalSrcIp() const { return use_original_src_ip_; }
   bool usingPerPacketLoadBalancing() const { return use_per_packet_load_balancing_; }
   const Udp::HashPolicy* hashPolicy() const { return hash_policy_.get(); }
@@ -117,8 +140,14 @@ public:
     return upstream_socket_config_;
   }
   const std::vector<AccessLog::InstanceSharedPtr>& accessLogs() const { return access_logs_; }
+  Network::UdpPacketWriterFactory& upstreamPacketWriterFactory() const {
+    return *upstream_packet_writer_factory_;
+  }
+  Stats::Scope& scope() const { return scope_; }
 
 private:
+  static constexpr std::chrono::milliseconds MaxIdleScanInterval{1000};
+
   static UdpProxyDownstreamStats generateStats(const std::string& stat_prefix,
                                                Stats::Scope& scope) {
     const auto final_prefix = absl::StrCat("udp.", stat_prefix);
@@ -136,6 +165,8 @@ private:
   mutable UdpProxyDownstreamStats stats_;
   const Network::ResolvedUdpSocketConfig upstream_socket_config_;
   std::vector<AccessLog::InstanceSharedPtr> access_logs_;
+  Network::UdpPacketWriterFactoryPtr upstream_packet_writer_factory_;
+  Stats::Scope& scope_;
   Random::RandomGenerator& random_;
 };
 
@@ -188,11 +219,18 @@ private:
     ~ActiveSession() override;
     const Network::UdpRecvData::LocalPeerAddresses& addresses() const { return addresses_; }
     const Upstream::Host& host() const { return *host_; }
+    MonotonicTime lastActivity() const { return last_activity_; }
     void write(const Buffer::Instance& buffer);
+    // Sends the datagrams buffered by a batching writer, unless the writer is blocked.
+    void flush();
 
   private:
-    void onIdleTimer();
     void onReadReady();
+    void onWriteReady();
+    // Watches socket_ for writability while upstream_writer_ is blocked.
+    void waitForWritable();
+    // Records traffic in either direction, making this the most recently active session.
+    void onActivity();
     void fillStreamInfo();
 
     // Network::UdpPacketProcessor
@@ -226,12 +264,13 @@ private:
     const bool use_original_src_ip_;
     const Network::UdpRecvData::LocalPeerAddresses addresses_;
     const Upstream::HostConstSharedPtr host_;
-    // TODO(mattklein123): Consider replacing an idle timer for each session with a last used
-    // time stamp and a periodic scan of all sessions to look for timeouts. This solution is simple,
-    // though it might not perform well for high volume traffic. Note that this is how TCP proxy
-    // idle timeouts work so we should consider unifying the implementation if we move to a time
-    // stamp and scan approach.
-    const Event::TimerPtr idle_timer_;
+    // The last time a datagram was forwarded in either direction. Rather than each session
+    // re-arming a timer of its own for every datagram, the filter periodically expires the sessions
+    // that have been idle for longer than the session timeout, from the front of
+    // ClusterInfo::sessions_by_activity_.
+    MonotonicTime last_activity_;
+    // This session's entry in ClusterInfo::sessions_by_activity_.
+    const std::list<ActiveSession*>::iterator activity_it_;
     // The socket is used for writing packets to the selected upstream host as well as receiving
     // packets from the upstream host. Note that a a local ephemeral port is bound on the first
     // write to the upstream host.
@@ -240,6 +279,12 @@ private:
     // envoy.reloadable_features.udp_proxy_connect is unset or use_original_src_ip_ is set. If it
     // is true, there will be no calling `connect()` on the socket.
     bool skip_connect_{};
+    // Writes datagrams to the upstream host through socket_. Batching writers buffer the datagrams
+    // until the filter flushes them at the end of the event loop iteration. Once the writer is
+    // blocked, socket_ is watched for writability and onWriteReady() unblocks it. The writer is
+    // bound to socket_, so it can't be shared between sessions: each session pays for the writer's
+    // own buffer (64 KiB for the GSO batch writer) and for looking up its stats.
+    const Network::UdpPacketWriterPtr upstream_writer_;
 
     UdpProxySessionStats session_stats_{};
     absl::optional<StreamInfo::StreamInfoImpl> udp_sess_stats_;
@@ -325,10 +370,15 @@ private:
     virtual ~ClusterInfo();
     virtual Network::FilterStatus onData(Network::UdpRecvData& data) PURE;
     void removeSession(const ActiveSession* session);
+    void removeIdleSessions(MonotonicTime now);
+    bool hasSessions() const { return !sessions_.empty(); }
 
     UdpProxyFilter& filter_;
     Upstream::ThreadLocalCluster& cluster_;
     UdpProxyUpstreamStats cluster_stats_;
+    // The sessions from the least to the most recently active. Each session adds itself on
+    // creation, moves itself to the back on traffic and removes itself on destruction.
+    std::list<ActiveSession*> sessions_by_activity_;
 
   protected:
     ActiveSession* createSession(Network::UdpRecvData::LocalPeerAddresses&& addresses,
@@ -384,8 +434,23 @@ private:
   void onClusterAddOrUpdate(Upstream::ThreadLocalCluster& cluster) final;
   void onClusterRemoval(const std::string& cluster_name) override;
 
+  void scheduleUpstreamFlush(ActiveSession& session);
+  void flushUpstreamWrites();
+  void enableIdleTimer();
+  void onIdleTimer();
+  MonotonicTime approximateMonotonicTime() const {
+    return read_callbacks_->udpListener().dispatcher().approximateMonotonicTime();
+  }
+
   const UdpProxyFilterConfigSharedPtr config_;
   const Upstream::ClusterUpdateCallbacksHandlePtr cluster_update_callbacks_;
+  // Expires the idle sessions of all the clusters. It is enabled while there are sessions.
+  const Event::TimerPtr idle_timer_;
+  // Sessions with datagrams buffered by a batching upstream writer, flushed by
+  // upstream_flush_cb_ at the end of the current event loop iteration. This must outlive
+  // cluster_infos_ as sessions remove themselves from it on destruction.
+  absl::flat_hash_set<ActiveSession*> sessions_pending_flush_;
+  Event::SchedulableCallbackPtr upstream_flush_cb_;
   // Map for looking up cluster info with its name.
   absl::flat_hash_map<std::string, ClusterInfoPtr> cluster_infos_;
 };
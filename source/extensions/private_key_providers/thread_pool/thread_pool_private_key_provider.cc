@@ -0,0 +1,387 @@
+#include "source/extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include <cstring>
+#include <thread>
+
+#include "envoy/singleton/manager.h"
+
+#include "source/common/config/datasource.h"
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+SINGLETON_MANAGER_REGISTRATION(thread_pool_private_key_operation_pool);
+
+namespace {
+
+constexpr uint32_t DefaultMaxPendingOperations = 1024;
+
+ThreadPoolPrivateKeyConnection* getConnection(SSL* ssl) {
+  return ssl == nullptr ? nullptr
+                        : static_cast<ThreadPoolPrivateKeyConnection*>(SSL_get_ex_data(
+                              ssl, ThreadPoolPrivateKeyMethodProvider::connectionIndex()));
+}
+
+ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                        uint16_t signature_algorithm, const uint8_t* in,
+                                        size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl);
+  return connection == nullptr
+             ? ssl_private_key_failure
+             : connection->start(PrivateKeyOperation::Type::Sign, signature_algorithm, in, in_len,
+                                 out, out_len, max_out);
+}
+
+ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                           const uint8_t* in, size_t in_len) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl);
+  return connection == nullptr ? ssl_private_key_failure
+                               : connection->start(PrivateKeyOperation::Type::Decrypt, 0, in,
+                                                   in_len, out, out_len, max_out);
+}
+
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                            size_t max_out) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl);
+  return connection == nullptr ? ssl_private_key_failure
+                               : connection->complete(out, out_len, max_out);
+}
+
+ThreadPoolPrivateKeyStats generateStats(Stats::Scope& scope) {
+  const std::string prefix = "thread_pool_private_key";
+  return {ALL_THREAD_POOL_PRIVATE_KEY_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                            POOL_GAUGE_PREFIX(scope, prefix),
+                                            POOL_HISTOGRAM_PREFIX(scope, prefix))};
+}
+
+int createIndex() {
+  int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+  return index;
+}
+
+} // namespace
+
+PrivateKeyOperation::PrivateKeyOperation(Type type, ThreadPoolPrivateKeyMethodProvider& provider,
+                                         uint16_t signature_algorithm, const uint8_t* in,
+                                         size_t in_len, ThreadPoolPrivateKeyConnection& connection,
+                                         Event::Dispatcher& dispatcher)
+    : type_(type), provider_(provider), pkey_(bssl::UpRef(provider.privateKey())),
+      signature_algorithm_(signature_algorithm), input_(in, in + in_len), connection_(&connection),
+      dispatcher_(dispatcher) {}
+
+bool PrivateKeyOperation::perform() {
+  succeeded_ = type_ == Type::Sign ? sign() : decrypt();
+  return succeeded_;
+}
+
+void PrivateKeyOperation::performOnPool() {
+  bool abandoned;
+  {
+    absl::MutexLock lock(&mutex_);
+    abandoned = connection_ == nullptr;
+  }
+  // The operation is skipped if the connection went away while it was queued.
+  if (!abandoned) {
+    perform();
+  }
+  provider_.releaseOperation();
+
+  absl::MutexLock lock(&mutex_);
+  if (connection_ != nullptr) {
+    dispatcher_.post([operation = shared_from_this()]() {
+      ThreadPoolPrivateKeyConnection* connection;
+      {
+        absl::MutexLock lock(&operation->mutex_);
+        connection = operation->connection_;
+      }
+      // The connection is only detached on this thread, so it can't go away before the call.
+      if (connection != nullptr) {
+        connection->onOperationPerformed();
+      }
+    });
+  }
+}
+
+void PrivateKeyOperation::abandon() {
+  absl::MutexLock lock(&mutex_);
+  connection_ = nullptr;
+}
+
+bool PrivateKeyOperation::sign() {
+  if (EVP_PKEY_id(pkey_.get()) != SSL_get_signature_algorithm_key_type(signature_algorithm_)) {
+    return false;
+  }
+  const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm_);
+  if (md == nullptr) {
+    return false;
+  }
+
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pctx;
+  if (!EVP_DigestSignInit(ctx.get(), &pctx, md, nullptr, pkey_.get())) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm_) &&
+      (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+       !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+    return false;
+  }
+
+  size_t out_len = 0;
+  if (!EVP_DigestSign(ctx.get(), nullptr, &out_len, input_.data(), input_.size())) {
+    return false;
+  }
+  output_.resize(out_len);
+  if (!EVP_DigestSign(ctx.get(), output_.data(), &out_len, input_.data(), input_.size())) {
+    return false;
+  }
+  output_.resize(out_len);
+  return true;
+}
+
+bool PrivateKeyOperation::decrypt() {
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+  if (rsa == nullptr) {
+    return false;
+  }
+  output_.resize(RSA_size(rsa));
+  size_t out_len = 0;
+  if (!RSA_decrypt(rsa, &out_len, output_.data(), output_.size(), input_.data(), input_.size(),
+                   RSA_NO_PADDING)) {
+    return false;
+  }
+  output_.resize(out_len);
+  return true;
+}
+
+ThreadPoolPrivateKeyConnection::ThreadPoolPrivateKeyConnection(
+    ThreadPoolPrivateKeyMethodProvider& provider, Ssl::PrivateKeyConnectionCallbacks& cb,
+    Event::Dispatcher& dispatcher)
+    : provider_(provider), cb_(cb), dispatcher_(dispatcher) {}
+
+ThreadPoolPrivateKeyConnection::~ThreadPoolPrivateKeyConnection() {
+  if (operation_ != nullptr) {
+    operation_->abandon();
+  }
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyConnection::start(PrivateKeyOperation::Type type,
+                                                               uint16_t signature_algorithm,
+                                                               const uint8_t* in, size_t in_len,
+                                                               uint8_t* out, size_t* out_len,
+                                                               size_t max_out) {
+  if (operation_ != nullptr) {
+    return ssl_private_key_failure;
+  }
+
+  auto operation = std::make_shared<PrivateKeyOperation>(type, provider_, signature_algorithm, in,
+                                                         in_len, *this, dispatcher_);
+  if (provider_.tryEnqueue(operation)) {
+    operation_ = std::move(operation);
+    performed_ = false;
+    return ssl_private_key_retry;
+  }
+
+  // Too many operations are already pending, so rather than queuing yet another one behind them
+  // perform it on this thread, as if there was no provider.
+  ENVOY_LOG(debug, "thread pool private key provider: performing operation inline");
+  provider_.stats().inline_operations_.inc();
+  operation->perform();
+  return copyOutput(*operation, out, out_len, max_out);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyConnection::complete(uint8_t* out, size_t* out_len,
+                                                                  size_t max_out) {
+  if (operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (!performed_) {
+    return ssl_private_key_retry;
+  }
+
+  PrivateKeyOperationSharedPtr operation = std::move(operation_);
+  return copyOutput(*operation, out, out_len, max_out);
+}
+
+void ThreadPoolPrivateKeyConnection::onOperationPerformed() {
+  ASSERT(operation_ != nullptr);
+  performed_ = true;
+  // This may close the connection and destroy this object.
+  cb_.onPrivateKeyMethodComplete();
+}
+
+ssl_private_key_result_t
+ThreadPoolPrivateKeyConnection::copyOutput(const PrivateKeyOperation& operation, uint8_t* out,
+                                           size_t* out_len, size_t max_out) {
+  const std::vector<uint8_t>& output = operation.output();
+  if (!operation.succeeded() || output.size() > max_out) {
+    ENVOY_LOG(debug, "thread pool private key provider: private key operation failed");
+    provider_.stats().failed_operations_.inc();
+    return ssl_private_key_failure;
+  }
+  memcpy(out, output.data(), output.size()); // NOLINT(safe-memcpy)
+  *out_len = output.size();
+  return ssl_private_key_success;
+}
+
+PrivateKeyOperationPool::PrivateKeyOperationPool(Thread::ThreadFactory& thread_factory,
+                                                 uint32_t thread_count) {
+  ENVOY_LOG(debug, "thread pool private key provider: starting {} threads", thread_count);
+  threads_.reserve(thread_count);
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    threads_.push_back(thread_factory.createThread([this]() { threadRoutine(); },
+                                                   Thread::Options{"tls_key_pool"}));
+  }
+}
+
+PrivateKeyOperationPool::~PrivateKeyOperationPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    terminate_ = true;
+  }
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+uint64_t PrivateKeyOperationPool::enqueue(PrivateKeyOperationSharedPtr operation) {
+  absl::MutexLock lock(&mutex_);
+  queue_.push(std::move(operation));
+  return queue_.size();
+}
+
+void PrivateKeyOperationPool::threadRoutine() {
+  while (true) {
+    PrivateKeyOperationSharedPtr operation;
+    {
+      absl::MutexLock lock(&mutex_);
+      const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return !queue_.empty() || terminate_;
+      };
+      mutex_.Await(absl::Condition(&condition));
+      // Operations queued before termination are still performed, or skipped if abandoned, so
+      // that their slots are freed.
+      if (queue_.empty()) {
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop();
+    }
+    operation->performOnPool();
+  }
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const envoy::extensions::private_key_providers::thread_pool::v3::
+        ThreadPoolPrivateKeyMethodConfig& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context)
+    : max_pending_operations_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pending_operations,
+                                                              DefaultMaxPendingOperations)),
+      stats_(generateStats(factory_context.scope())) {
+  const std::string private_key =
+      Config::DataSource::read(config.private_key(), false, factory_context.api());
+  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(private_key.data(), private_key.size()));
+  bssl::UniquePtr<EVP_PKEY> pkey(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey == nullptr) {
+    throw EnvoyException("Failed to read private key.");
+  }
+  if (EVP_PKEY_id(pkey.get()) != EVP_PKEY_RSA && EVP_PKEY_id(pkey.get()) != EVP_PKEY_EC) {
+    throw EnvoyException("Not supported key type, only EC and RSA are supported.");
+  }
+  pkey_ = std::move(pkey);
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  method_->sign = privateKeySign;
+  method_->decrypt = privateKeyDecrypt;
+  method_->complete = privateKeyComplete;
+
+  uint32_t thread_count = config.thread_count();
+  if (thread_count == 0) {
+    thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  Thread::ThreadFactory& thread_factory = factory_context.api().threadFactory();
+  pool_ = factory_context.singletonManager().getTyped<PrivateKeyOperationPool>(
+      SINGLETON_MANAGER_REGISTERED_NAME(thread_pool_private_key_operation_pool),
+      [&thread_factory, thread_count] {
+        return std::make_shared<PrivateKeyOperationPool>(thread_factory, thread_count);
+      });
+  if (pool_->threadCount() != thread_count) {
+    ENVOY_LOG(warn,
+              "thread pool private key provider: using the existing pool of {} threads rather "
+              "than {} threads",
+              pool_->threadCount(), thread_count);
+  }
+}
+
+ThreadPoolPrivateKeyMethodProvider::~ThreadPoolPrivateKeyMethodProvider() {
+  // The operations still queued have been abandoned by their connections, so this only waits for
+  // the ones being performed.
+  absl::MutexLock lock(&mutex_);
+  const auto condition = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return pending_operations_ == 0;
+  };
+  mutex_.Await(absl::Condition(&condition));
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  if (SSL_get_ex_data(ssl, connectionIndex()) != nullptr) {
+    throw EnvoyException("Not registering the thread pool provider twice for same context");
+  }
+  SSL_set_ex_data(ssl, connectionIndex(),
+                  new ThreadPoolPrivateKeyConnection(*this, cb, dispatcher));
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  ThreadPoolPrivateKeyConnection* connection = getConnection(ssl);
+  SSL_set_ex_data(ssl, connectionIndex(), nullptr);
+  delete connection;
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::checkFips() {
+  if (EVP_PKEY_id(pkey_.get()) == EVP_PKEY_RSA) {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa != nullptr && RSA_check_fips(rsa);
+  }
+  const EC_KEY* ec_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+  return ec_key != nullptr && EC_KEY_check_fips(ec_key);
+}
+
+Ssl::BoringSslPrivateKeyMethodSharedPtr
+ThreadPoolPrivateKeyMethodProvider::getBoringSslPrivateKeyMethod() {
+  return method_;
+}
+
+int ThreadPoolPrivateKeyMethodProvider::connectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::tryEnqueue(PrivateKeyOperationSharedPtr operation) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (pending_operations_ >= max_pending_operations_) {
+      return false;
+    }
+    ++pending_operations_;
+  }
+  stats_.pending_operations_.inc();
+  stats_.offloaded_operations_.inc();
+  stats_.queue_depth_.recordValue(pool_->enqueue(std::move(operation)));
+  return true;
+}
+
+void ThreadPoolPrivateKeyMethodProvider::releaseOperation() {
+  stats_.pending_operations_.dec();
+  absl::MutexLock lock(&mutex_);
+  ASSERT(pending_operations_ > 0);
+  --pending_operations_;
+}
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/private_key/private_key_callbacks.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/common/logger.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+/**
+ * All thread pool private key provider stats. @see stats_macros.h
+ */
+#define ALL_THREAD_POOL_PRIVATE_KEY_STATS(COUNTER, GAUGE, HISTOGRAM)                               \
+  COUNTER(failed_operations)                                                                       \
+  COUNTER(inline_operations)                                                                       \
+  COUNTER(offloaded_operations)                                                                    \
+  GAUGE(pending_operations, Accumulate)                                                            \
+  HISTOGRAM(queue_depth, Unspecified)
+
+/**
+ * Struct definition for all thread pool private key provider stats. @see stats_macros.h
+ */
+struct ThreadPoolPrivateKeyStats {
+  ALL_THREAD_POOL_PRIVATE_KEY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                                    GENERATE_HISTOGRAM_STRUCT)
+};
+
+class ThreadPoolPrivateKeyConnection;
+class ThreadPoolPrivateKeyMethodProvider;
+
+// A single sign or decrypt operation. It is created on the worker thread running the handshake,
+// performed on a pool thread, and its result is consumed back on the worker thread.
+class PrivateKeyOperation : public std::enable_shared_from_this<PrivateKeyOperation> {
+public:
+  enum class Type { Sign, Decrypt };
+
+  PrivateKeyOperation(Type type, ThreadPoolPrivateKeyMethodProvider& provider,
+                      uint16_t signature_algorithm, const uint8_t* in, size_t in_len,
+                      ThreadPoolPrivateKeyConnection& connection, Event::Dispatcher& dispatcher);
+
+  /**
+   * Performs the operation on the calling thread.
+   * @return whether the operation succeeded.
+   */
+  bool perform();
+
+  /**
+   * Performs the operation on a pool thread, unless the connection has gone away, frees its slot
+   * in the provider and posts its completion to the worker thread of the connection.
+   */
+  void performOnPool();
+
+  /**
+   * Detaches the operation from its connection, which is being destroyed, so that its result is
+   * discarded. Must be called on the worker thread of the connection.
+   */
+  void abandon();
+
+  const std::vector<uint8_t>& output() const { return output_; }
+  bool succeeded() const { return succeeded_; }
+
+private:
+  bool sign();
+  bool decrypt();
+
+  const Type type_;
+  // Only used until the slot of the operation has been freed, as the provider may go away then.
+  ThreadPoolPrivateKeyMethodProvider& provider_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> input_;
+  // Written by the thread performing the operation before the completion is posted to the worker.
+  std::vector<uint8_t> output_;
+  bool succeeded_{false};
+
+  // The connection is only nulled on its worker thread, and the pool thread only posts to the
+  // worker's dispatcher while holding the mutex with the connection set, which guarantees that
+  // the dispatcher is still alive.
+  absl::Mutex mutex_;
+  ThreadPoolPrivateKeyConnection* connection_ ABSL_GUARDED_BY(mutex_);
+  Event::Dispatcher& dispatcher_;
+};
+
+using PrivateKeyOperationSharedPtr = std::shared_ptr<PrivateKeyOperation>;
+
+// PrivateKeyOperationPool is the pool of threads performing the private key operations of all
+// the thread pool private key providers of the process.
+class PrivateKeyOperationPool : public Singleton::Instance,
+                                public Logger::Loggable<Logger::Id::connection> {
+public:
+  PrivateKeyOperationPool(Thread::ThreadFactory& thread_factory, uint32_t thread_count);
+  // Performs the operations which are still queued before joining the threads.
+  ~PrivateKeyOperationPool() override;
+
+  /**
+   * Queues an operation.
+   * @return the number of operations queued, including this one.
+   */
+  uint64_t enqueue(PrivateKeyOperationSharedPtr operation);
+
+  uint32_t threadCount() const { return threads_.size(); }
+
+private:
+  void threadRoutine();
+
+  absl::Mutex mutex_;
+  std::queue<PrivateKeyOperationSharedPtr> queue_ ABSL_GUARDED_BY(mutex_);
+  bool terminate_ ABSL_GUARDED_BY(mutex_){false};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+// ThreadPoolPrivateKeyConnection holds the state of the private key operation of an SSL
+// connection.
+class ThreadPoolPrivateKeyConnection : public Logger::Loggable<Logger::Id::connection> {
+public:
+  ThreadPoolPrivateKeyConnection(ThreadPoolPrivateKeyMethodProvider& provider,
+                                 Ssl::PrivateKeyConnectionCallbacks& cb,
+                                 Event::Dispatcher& dispatcher);
+  ~ThreadPoolPrivateKeyConnection();
+
+  /**
+   * Starts an operation, offloading it to the pool unless too many operations are pending, in
+   * which case it is performed right away.
+   */
+  ssl_private_key_result_t start(PrivateKeyOperation::Type type, uint16_t signature_algorithm,
+                                 const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_len,
+                                 size_t max_out);
+
+  /**
+   * Completes an offloaded operation once it has been performed.
+   */
+  ssl_private_key_result_t complete(uint8_t* out, size_t* out_len, size_t max_out);
+
+  /**
+   * Called on the worker thread once the pool has performed the current operation.
+   */
+  void onOperationPerformed();
+
+private:
+  ssl_private_key_result_t copyOutput(const PrivateKeyOperation& operation, uint8_t* out,
+                                      size_t* out_len, size_t max_out);
+
+  ThreadPoolPrivateKeyMethodProvider& provider_;
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  PrivateKeyOperationSharedPtr operation_;
+  bool performed_{false};
+};
+
+// ThreadPoolPrivateKeyMethodProvider performs the private key operations of TLS handshakes on the
+// process-wide PrivateKeyOperationPool, so that expensive signatures don't block the workers.
+class ThreadPoolPrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider,
+                                           public Logger::Loggable<Logger::Id::connection> {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::extensions::private_key_providers::thread_pool::v3::
+          ThreadPoolPrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context);
+  // Waits for the pool to be done with the operations of this provider.
+  ~ThreadPoolPrivateKeyMethodProvider() override;
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override;
+
+  static int connectionIndex();
+
+  /**
+   * Queues an operation for the pool.
+   * @return false, without queuing the operation, if max_pending_operations operations are
+   *         already queued or being performed.
+   */
+  bool tryEnqueue(PrivateKeyOperationSharedPtr operation);
+
+  /**
+   * Frees the slot of an offloaded operation once the pool is done with it. Called on the pool
+   * thread which dequeued the operation.
+   */
+  void releaseOperation();
+
+  EVP_PKEY* privateKey() const { return pkey_.get(); }
+  ThreadPoolPrivateKeyStats& stats() { return stats_; }
+
+private:
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  const uint32_t max_pending_operations_;
+  ThreadPoolPrivateKeyStats stats_;
+  std::shared_ptr<PrivateKeyOperationPool> pool_;
+
+  absl::Mutex mutex_;
+  // Operations which have been offloaded and which the pool is not done with yet.
+  uint32_t pending_operations_ ABSL_GUARDED_BY(mutex_){0};
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
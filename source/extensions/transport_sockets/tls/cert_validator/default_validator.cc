@@ -31,6 +31,7 @@
 #include "source/extensions/transport_sockets/tls/stats.h"
 #include "source/extensions/transport_sockets/tls/utility.h"
 
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
 #include "openssl/x509v3.h"
@@ -48,6 +49,12 @@ DefaultCertValidator::DefaultCertValidator(
     allow_untrusted_certificate_ = config_->trustChainVerification() ==
                                    envoy::extensions::transport_sockets::tls::v3::
                                        CertificateValidationContext::ACCEPT_UNTRUSTED;
+    // Untrusted certificates are accepted anyway, so there is nothing worth caching.
+    if (config_->verifiedCertificateCacheMaxEntries() > 0 && !allow_untrusted_certificate_) {
+      verified_certificate_cache_ = std::make_unique<VerifiedCertificateCache>(
+          config_->verifiedCertificateCacheMaxEntries(), config_->verifiedCertificateCacheTtl(),
+          config_->allowExpiredCertificate(), time_source_);
+    }
   }
 };
 
@@ -324,6 +331,26 @@ ValidationResults DefaultCertValidator::doVerifyCertChain(
   }
   X509* leaf_cert = sk_X509_value(&cert_chain, 0);
   ASSERT(leaf_cert);
+
+  std::string cache_key;
+  if (verified_certificate_cache_ != nullptr) {
+    // The result also depends on the SAN list a connection may override.
+    const std::string overrides =
+        transport_socket_options != nullptr
+            ? absl::StrJoin(transport_socket_options->verifySubjectAltNameListOverride(), "\n")
+            : "";
+    cache_key = VerifiedCertificateCache::key(cert_chain, overrides);
+    if (verified_certificate_cache_->contains(cache_key)) {
+      stats_.verified_certificate_cache_hit_.inc();
+      if (ssl_extended_info) {
+        ssl_extended_info->setCertificateValidationStatus(
+            Envoy::Ssl::ClientValidationStatus::Validated);
+      }
+      return {ValidationResults::ValidationStatus::Successful, absl::nullopt, absl::nullopt};
+    }
+    stats_.verified_certificate_cache_miss_.inc();
+  }
+
   if (verify_trusted_ca_) {
     X509_STORE* verify_store = SSL_CTX_get_cert_store(&ssl_ctx);
     ASSERT(verify_store);
@@ -363,6 +390,9 @@ ValidationResults DefaultCertValidator::doVerifyCertChain(
   uint8_t tls_alert = SSL_AD_CERTIFICATE_UNKNOWN;
   const bool succeeded = verifyCertAndUpdateStatus(
       ssl_extended_info, leaf_cert, transport_socket_options.get(), &error_details, &tls_alert);
+  if (succeeded && verified_certificate_cache_ != nullptr) {
+    verified_certificate_cache_->insert(cache_key, cert_chain);
+  }
   return succeeded ? ValidationResults{ValidationResults::ValidationStatus::Successful,
                                        absl::nullopt, absl::nullopt}
                    : ValidationResults{ValidationResults::ValidationStatus::Failed, tls_alert,
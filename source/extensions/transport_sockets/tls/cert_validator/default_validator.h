@@ -21,6 +21,7 @@
 #include "source/common/stats/symbol_table.h"
 #include "source/extensions/transport_sockets/tls/cert_validator/cert_validator.h"
 #include "source/extensions/transport_sockets/tls/cert_validator/san_matcher.h"
+#include "source/extensions/transport_sockets/tls/cert_validator/verified_certificate_cache.h"
 #include "source/extensions/transport_sockets/tls/stats.h"
 
 #include "absl/synchronization/mutex.h"
@@ -125,6 +126,7 @@ private:
   std::vector<std::vector<uint8_t>> verify_certificate_hash_list_;
   std::vector<std::vector<uint8_t>> verify_certificate_spki_list_;
   bool verify_trusted_ca_{false};
+  VerifiedCertificateCachePtr verified_certificate_cache_;
 };
 
 DECLARE_FACTORY(DefaultCertValidatorFactory);
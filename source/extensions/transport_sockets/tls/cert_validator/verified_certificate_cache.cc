@@ -0,0 +1,94 @@
+#include "source/extensions/transport_sockets/tls/cert_validator/verified_certificate_cache.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+#include "source/extensions/transport_sockets/tls/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "openssl/sha.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+VerifiedCertificateCache::VerifiedCertificateCache(uint32_t max_entries,
+                                                   std::chrono::milliseconds ttl,
+                                                   bool allow_expired_certificate,
+                                                   TimeSource& time_source)
+    : max_entries_(max_entries), ttl_(ttl), allow_expired_certificate_(allow_expired_certificate),
+      time_source_(time_source) {
+  ASSERT(max_entries_ > 0);
+}
+
+std::string VerifiedCertificateCache::key(STACK_OF(X509)& cert_chain,
+                                          absl::string_view overrides) {
+  // The number of certificates and the length of the overrides prefix the key, so that the end of
+  // the digests can't be mistaken for the start of the overrides and vice versa.
+  const size_t chain_length = sk_X509_num(&cert_chain);
+  std::string key = absl::StrCat(chain_length, ":", overrides.size(), ":");
+  key.reserve(key.size() + chain_length * SHA256_DIGEST_LENGTH + overrides.size());
+  for (const X509* cert : &cert_chain) {
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    unsigned hash_length = 0;
+    const int rc = X509_digest(cert, EVP_sha256(), hash, &hash_length);
+    RELEASE_ASSERT(rc == 1 && hash_length == SHA256_DIGEST_LENGTH, "");
+    key.append(reinterpret_cast<const char*>(hash), hash_length);
+  }
+  key.append(overrides.data(), overrides.size());
+  return key;
+}
+
+bool VerifiedCertificateCache::contains(absl::string_view key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  if (it->second->expiry_ <= time_source_.monotonicTime()) {
+    erase(it->second);
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return true;
+}
+
+void VerifiedCertificateCache::insert(absl::string_view key, STACK_OF(X509)& cert_chain) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  std::chrono::milliseconds ttl = ttl_;
+  if (!allow_expired_certificate_) {
+    const SystemTime system_now = time_source_.systemTime();
+    for (const X509* cert : &cert_chain) {
+      ttl = std::min(ttl, std::chrono::duration_cast<std::chrono::milliseconds>(
+                              Utility::getExpirationTime(*cert) - system_now));
+    }
+  }
+  if (ttl.count() <= 0) {
+    return;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    it->second->expiry_ = now + ttl;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return;
+  }
+  while (lru_.size() >= max_entries_) {
+    erase(std::prev(lru_.end()));
+  }
+  lru_.push_front(Entry{std::string(key), now + ttl});
+  entries_.emplace(lru_.front().key_, lru_.begin());
+}
+
+void VerifiedCertificateCache::erase(std::list<Entry>::iterator it) {
+  // The map is keyed by a view of the entry's key, so it must be erased first.
+  entries_.erase(it->key_);
+  lru_.erase(it);
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
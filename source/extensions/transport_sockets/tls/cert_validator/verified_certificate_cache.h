@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * A bounded LRU cache of the certificate chains a validator successfully verified, so that
+ * handshakes with peers which were recently verified skip chain building and the other checks.
+ * It is shared by all the workers using the validator.
+ */
+class VerifiedCertificateCache {
+public:
+  VerifiedCertificateCache(uint32_t max_entries, std::chrono::milliseconds ttl,
+                           bool allow_expired_certificate, TimeSource& time_source);
+
+  /**
+   * @return the key identifying a certificate chain, along with the per connection verification
+   *         overrides. Distinct chain and overrides pairs have distinct keys.
+   */
+  static std::string key(STACK_OF(X509)& cert_chain, absl::string_view overrides);
+
+  /**
+   * @return whether the chain with the given key was verified and has not expired since.
+   */
+  bool contains(absl::string_view key);
+
+  /**
+   * Records that a chain was verified. The entry expires after the TTL, or when the first
+   * certificate of the chain expires if sooner.
+   */
+  void insert(absl::string_view key, STACK_OF(X509)& cert_chain);
+
+private:
+  struct Entry {
+    std::string key_;
+    MonotonicTime expiry_;
+  };
+
+  void erase(std::list<Entry>::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const uint32_t max_entries_;
+  const std::chrono::milliseconds ttl_;
+  const bool allow_expired_certificate_;
+  TimeSource& time_source_;
+
+  absl::Mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> lru_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator>
+      entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+using VerifiedCertificateCachePtr = std::unique_ptr<VerifiedCertificateCache>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -51,8 +51,9 @@ ProtobufTypes::MessagePtr DownstreamSslSocketFactory::createEmptyConfigProto() {
 REGISTER_FACTORY(DownstreamSslSocketFactory,
                  Server::Configuration::DownstreamTransportSocketConfigFactory){"tls"};
 
-Ssl::ContextManagerPtr SslContextManagerFactory::createContextManager(TimeSource& time_source) {
-  return std::make_unique<ContextManagerImpl>(time_source);
+Ssl::ContextManagerPtr SslContextManagerFactory::createContextManager(TimeSource& time_source,
+                                                                      Runtime::Loader& runtime) {
+  return std::make_unique<ContextManagerImpl>(time_source, runtime);
 }
 
 static Envoy::Registry::RegisterInternalFactory<SslContextManagerFactory,
@@ -44,7 +44,8 @@ DECLARE_FACTORY(DownstreamSslSocketFactory);
 
 class SslContextManagerFactory : public Ssl::ContextManagerFactory {
 public:
-  Ssl::ContextManagerPtr createContextManager(TimeSource& time_source) override;
+  Ssl::ContextManagerPtr createContextManager(TimeSource& time_source,
+                                              Runtime::Loader& runtime) override;
 };
 
 DECLARE_FACTORY(SslContextManagerFactory);
@@ -163,6 +163,18 @@ bool getStatelessSessionResumptionDisabled(
   }
 }
 
+absl::optional<Ssl::DynamicRecordSizing> getDynamicRecordSizing(
+    const envoy::extensions::transport_sockets::tls::v3::CommonTlsContext& config) {
+  if (!config.has_dynamic_record_sizing()) {
+    return absl::nullopt;
+  }
+  const auto& sizing = config.dynamic_record_sizing();
+  return Ssl::DynamicRecordSizing{
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(sizing, initial_record_size, 1400),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(sizing, ramp_up_bytes, 64 * 1024),
+      std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(sizing, idle_timeout, 1000))};
+}
+
 } // namespace
 
 ContextConfigImpl::ContextConfigImpl(
@@ -186,7 +198,8 @@ ContextConfigImpl::ContextConfigImpl(
                                                 default_max_protocol_version)),
       factory_context_(factory_context), tls_keylog_path_(config.key_log().path()),
       tls_keylog_local_(config.key_log().local_address_range()),
-      tls_keylog_remote_(config.key_log().remote_address_range()) {
+      tls_keylog_remote_(config.key_log().remote_address_range()),
+      dynamic_record_sizing_(getDynamicRecordSizing(config)) {
   if (certificate_validation_context_provider_ != nullptr) {
     if (default_cvc_) {
       // We need to validate combined certificate validation context.
@@ -47,6 +47,9 @@ public:
   AccessLog::AccessLogManager& accessLogManager() const override {
     return factory_context_.accessLogManager();
   }
+  absl::optional<Ssl::DynamicRecordSizing> dynamicRecordSizing() const override {
+    return dynamic_record_sizing_;
+  }
 
   bool isReady() const override {
     const bool tls_is_ready =
@@ -111,6 +114,7 @@ private:
   const std::string tls_keylog_path_;
   const Network::Address::IpList tls_keylog_local_;
   const Network::Address::IpList tls_keylog_remote_;
+  const absl::optional<Ssl::DynamicRecordSizing> dynamic_record_sizing_;
 };
 
 class ClientContextConfigImpl : public ContextConfigImpl, public Envoy::Ssl::ClientContextConfig {
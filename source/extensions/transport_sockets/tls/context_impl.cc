@@ -29,6 +29,7 @@
 #include "source/extensions/transport_sockets/tls/utility.h"
 
 #include "absl/container/node_hash_set.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 #include "cert_validator/cert_validator.h"
@@ -44,18 +45,23 @@ namespace Tls {
 
 namespace {
 
-bool cbsContainsU16(CBS& cbs, uint16_t n) {
-  while (CBS_len(&cbs) > 0) {
-    uint16_t v;
-    if (!CBS_get_u16(&cbs, &v)) {
-      return false;
-    }
-    if (v == n) {
-      return true;
+// Returns the lowercase DNS names a certificate is valid for: its DNS SANs, or its subject CN if it
+// has none, as clients fall back on it.
+std::vector<std::string> getCertificateServerNames(X509& cert) {
+  std::vector<std::string> names = Utility::getSubjectAltNames(cert, GEN_DNS);
+  if (names.empty()) {
+    X509_NAME* subject = X509_get_subject_name(&cert);
+    const int cn_index = X509_NAME_get_index_by_NID(subject, NID_commonName, -1);
+    if (cn_index >= 0) {
+      const ASN1_STRING* cn = X509_NAME_ENTRY_get_data(X509_NAME_get_entry(subject, cn_index));
+      names.emplace_back(reinterpret_cast<const char*>(ASN1_STRING_get0_data(cn)),
+                         ASN1_STRING_length(cn));
     }
   }
-
-  return false;
+  for (std::string& name : names) {
+    absl::AsciiStrToLower(&name);
+  }
+  return names;
 }
 
 void logSslErrorChain() {
@@ -78,8 +84,13 @@ int ContextImpl::sslExtendedSocketInfoIndex() {
 }
 
 ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& config,
-                         TimeSource& time_source)
-    : scope_(scope), stats_(generateSslStats(scope)), time_source_(time_source),
+                         TimeSource& time_source, SessionCacheSharedPtr session_cache)
+    : ContextImpl(scope, generateSslStats(scope), config, time_source, std::move(session_cache)) {}
+
+ContextImpl::ContextImpl(Stats::Scope& scope, const SslStats& stats,
+                         const Envoy::Ssl::ContextConfig& config, TimeSource& time_source,
+                         SessionCacheSharedPtr session_cache)
+    : scope_(scope), stats_(stats), time_source_(time_source),
       tls_max_version_(config.maxProtocolVersion()),
       stat_name_set_(scope.symbolTable().makeSet("TransportSockets::Tls")),
       unknown_ssl_cipher_(stat_name_set_->add("unknown_ssl_cipher")),
@@ -90,7 +101,9 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
       ssl_versions_(stat_name_set_->add("ssl.versions")),
       ssl_curves_(stat_name_set_->add("ssl.curves")),
       ssl_sigalgs_(stat_name_set_->add("ssl.sigalgs")), capabilities_(config.capabilities()),
-      tls_keylog_local_(config.tlsKeyLogLocal()), tls_keylog_remote_(config.tlsKeyLogRemote()) {
+      tls_keylog_local_(config.tlsKeyLogLocal()), tls_keylog_remote_(config.tlsKeyLogRemote()),
+      session_cache_(std::move(session_cache)),
+      dynamic_record_sizing_(config.dynamicRecordSizing()) {
 
   auto cert_validator_name = getCertValidatorName(config.certificateValidationContext());
   auto cert_validator_factory =
@@ -214,7 +227,11 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
 
       bssl::UniquePtr<EVP_PKEY> public_key(X509_get_pubkey(ctx.cert_chain_.get()));
       const int pkey_id = EVP_PKEY_id(public_key.get());
-      if (!cert_pkey_ids.insert(pkey_id).second) {
+      // With certificate selection by SNI, ServerContextImpl instead checks that there is at most
+      // one certificate of a given type for each server name.
+      if (!cert_pkey_ids.insert(pkey_id).second &&
+          !Runtime::runtimeFeatureEnabled(
+              "envoy.reloadable_features.tls_select_certificate_by_sni")) {
         throw EnvoyException(fmt::format("Failed to load certificate chain from {}, at most one "
                                          "certificate of a given type may be specified",
                                          ctx.cert_chain_file_path_));
@@ -631,8 +648,8 @@ std::vector<Envoy::Ssl::CertificateDetailsPtr> ContextImpl::getCertChainInformat
 
 ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ClientContextConfig& config,
-                                     TimeSource& time_source)
-    : ContextImpl(scope, config, time_source),
+                                     TimeSource& time_source, SessionCacheSharedPtr session_cache)
+    : ContextImpl(scope, config, time_source, std::move(session_cache)),
       server_name_indication_(config.serverNameIndication()),
       allow_renegotiation_(config.allowRenegotiation()),
       max_session_keys_(config.maxSessionKeys()) {
@@ -657,6 +674,7 @@ ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
     }
   }
 
+  session_cache_key_prefix_ = generateSessionCacheKeyPrefix();
   if (max_session_keys_ > 0) {
     SSL_CTX_set_session_cache_mode(tls_contexts_[0].ssl_ctx_.get(), SSL_SESS_CACHE_CLIENT);
     SSL_CTX_sess_set_new_cb(
@@ -665,11 +683,48 @@ ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
               static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
           ClientContextImpl* client_context_impl = dynamic_cast<ClientContextImpl*>(context_impl);
           RELEASE_ASSERT(client_context_impl != nullptr, ""); // for Coverity
-          return client_context_impl->newSessionKey(session);
+          return client_context_impl->newSessionKey(ssl, session);
         });
   }
 }
 
+int ClientContextImpl::sessionCacheKeyIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int index = SSL_get_ex_new_index(
+        0, nullptr, nullptr, nullptr,
+        [](void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) { // NOLINT(google-runtime-int)
+          delete static_cast<std::string*>(ptr);
+        });
+    RELEASE_ASSERT(index >= 0, "");
+    return index;
+  }());
+}
+
+std::string ClientContextImpl::generateSessionCacheKeyPrefix() {
+  uint8_t hash_buffer[EVP_MAX_MD_SIZE];
+  unsigned hash_length = 0;
+
+  bssl::ScopedEVP_MD_CTX md;
+  int rc = EVP_DigestInit(md.get(), EVP_sha256());
+  RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+
+  // A resumed session skips the validation of the server certificate and keeps the client
+  // certificate of the full handshake, so both must match for contexts to share sessions.
+  for (const auto& ctx : tls_contexts_) {
+    if (ctx.cert_chain_ != nullptr) {
+      rc = X509_digest(ctx.cert_chain_.get(), EVP_sha256(), hash_buffer, &hash_length);
+      RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+      rc = EVP_DigestUpdate(md.get(), hash_buffer, hash_length);
+      RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+    }
+  }
+  cert_validator_->updateDigestForSessionId(md, hash_buffer, hash_length);
+
+  rc = EVP_DigestFinal(md.get(), hash_buffer, &hash_length);
+  RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  return absl::StrCat("client:", Hex::encode(hash_buffer, hash_length));
+}
+
 bool ContextImpl::parseAndSetAlpn(const std::vector<std::string>& alpn, SSL& ssl) {
   std::vector<uint8_t> parsed_alpn = parseAlpnProtocols(absl::StrJoin(alpn, ","));
   if (!parsed_alpn.empty()) {
@@ -721,7 +776,25 @@ ClientContextImpl::newSsl(const Network::TransportSocketOptionsConstSharedPtr& o
     SSL_set_renegotiate_mode(ssl_con.get(), ssl_renegotiate_freely);
   }
 
-  if (max_session_keys_ > 0) {
+  if (max_session_keys_ > 0 && session_cache_ != nullptr) {
+    // Sessions are shared with the other contexts validating the server the same way, and are
+    // only resumed to the same server name, with the same per connection validation overrides.
+    auto key = std::make_unique<std::string>(absl::StrCat(session_cache_key_prefix_, "\n",
+                                                          server_name_indication));
+    if (options != nullptr) {
+      absl::StrAppend(key.get(), "\n",
+                      absl::StrJoin(options->verifySubjectAltNameListOverride(), ","));
+    }
+    bssl::UniquePtr<SSL_SESSION> session = session_cache_->lookup(*key);
+    if (session != nullptr) {
+      stats_.session_cache_hit_.inc();
+      SSL_set_session(ssl_con.get(), session.get());
+    } else {
+      stats_.session_cache_miss_.inc();
+    }
+    const int rc = SSL_set_ex_data(ssl_con.get(), sessionCacheKeyIndex(), key.release());
+    RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
+  } else if (max_session_keys_ > 0) {
     if (session_keys_single_use_) {
       // Stored single-use session keys, use write/write locks.
       absl::WriterMutexLock l(&session_keys_mu_);
@@ -750,7 +823,13 @@ ClientContextImpl::newSsl(const Network::TransportSocketOptionsConstSharedPtr& o
   return ssl_con;
 }
 
-int ClientContextImpl::newSessionKey(SSL_SESSION* session) {
+int ClientContextImpl::newSessionKey(SSL* ssl, SSL_SESSION* session) {
+  const auto* key = static_cast<const std::string*>(SSL_get_ex_data(ssl, sessionCacheKeyIndex()));
+  if (key != nullptr) {
+    session_cache_->insert(*key, bssl::UniquePtr<SSL_SESSION>(session), max_session_keys_);
+    return 1; // Tell BoringSSL that we took ownership of the session.
+  }
+
   // In case we ever store single-use session key (TLS 1.3),
   // we need to switch to using write/write locks.
   if (SSL_SESSION_should_be_single_use(session)) {
@@ -780,8 +859,16 @@ uint16_t ClientContextImpl::parseSigningAlgorithmsForTest(const std::string& sig
 ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
-                                     TimeSource& time_source)
-    : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()),
+                                     TimeSource& time_source, SessionCacheSharedPtr session_cache)
+    : ServerContextImpl(scope, generateSslStats(scope), config, server_names, time_source,
+                        std::move(session_cache)) {}
+
+ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const SslStats& stats,
+                                     const Envoy::Ssl::ServerContextConfig& config,
+                                     const std::vector<std::string>& server_names,
+                                     TimeSource& time_source, SessionCacheSharedPtr session_cache)
+    : ContextImpl(scope, stats, config, time_source, std::move(session_cache)),
+      session_ticket_keys_(config.sessionTicketKeys()),
       ocsp_staple_policy_(config.ocspStaplePolicy()) {
   if (config.tlsCertificates().empty() && !config.capabilities().provides_certificates) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
@@ -791,6 +878,7 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
   // since we should have a common ID for session resumption no matter what cert
   // is used. We do this early because it can throw an EnvoyException.
   const SessionContextID session_id = generateHashForSessionContextId(server_names);
+  session_id_context_.assign(session_id.begin(), session_id.end());
 
   // First, configure the base context for ClientHello interception.
   // TODO(htuch): replace with SSL_IDENTITY when we have this as a means to do multi-cert in
@@ -851,6 +939,36 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
         SSL_CTX_set_session_id_context(ctx.ssl_ctx_.get(), session_id.data(), session_id.size());
     RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
 
+    // Sessions resumed by session ID are looked up in the shared session cache rather than in the
+    // cache of the SSL_CTX, so that they can be resumed through any context with the same session
+    // ID context, e.g. after an SDS update. TLS 1.3 resumption only uses tickets.
+    if (session_cache_ != nullptr && !config.capabilities().handles_session_resumption) {
+      SSL_CTX_set_session_cache_mode(ctx.ssl_ctx_.get(),
+                                     SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+      SSL_CTX_sess_set_new_cb(ctx.ssl_ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+        ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(
+            static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl))));
+        RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+        return server_context_impl->newSession(session);
+      });
+      SSL_CTX_sess_set_get_cb(
+          ctx.ssl_ctx_.get(),
+          [](SSL* ssl, const uint8_t* id, int id_len, int* out_copy) -> SSL_SESSION* {
+            ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(
+                static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl))));
+            RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+            // The returned session already holds a reference for the caller.
+            *out_copy = 0;
+            return server_context_impl->getSession(id, id_len).release();
+          });
+      SSL_CTX_sess_set_remove_cb(ctx.ssl_ctx_.get(), [](SSL_CTX* ssl_ctx, SSL_SESSION* session) {
+        ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(
+            static_cast<ContextImpl*>(SSL_CTX_get_app_data(ssl_ctx)));
+        RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+        server_context_impl->removeSession(session);
+      });
+    }
+
     auto& ocsp_resp_bytes = tls_certificates[i].get().ocspStaple();
     if (ocsp_resp_bytes.empty()) {
       if (ctx.is_must_staple_) {
@@ -867,6 +985,24 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
       ctx.ocsp_response_ = std::move(response);
     }
   }
+
+  // Index the certificates by server name, so that selecting one for a ClientHello doesn't need to
+  // scan them all. Wildcard names are indexed by their suffix, e.g. ".example.com".
+  if (!config.capabilities().provides_certificates &&
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.tls_select_certificate_by_sni")) {
+    for (const TlsContext& ctx : tls_contexts_) {
+      for (const std::string& name : getCertificateServerNames(*ctx.cert_chain_)) {
+        const TlsContext*& indexed_ctx =
+            server_names_map_[absl::StartsWith(name, "*.") ? name.substr(1) : name][ctx.is_ecdsa_];
+        if (indexed_ctx != nullptr && indexed_ctx != &ctx) {
+          throw EnvoyException(fmt::format("Failed to load certificate chain from {}, at most one "
+                                           "certificate of a given type may be specified for {}",
+                                           ctx.cert_chain_file_path_, name));
+        }
+        indexed_ctx = &ctx;
+      }
+    }
+  }
 }
 
 ServerContextImpl::SessionContextID
@@ -973,6 +1109,39 @@ ServerContextImpl::generateHashForSessionContextId(const std::vector<std::string
   return session_id;
 }
 
+std::string ServerContextImpl::sessionCacheKey(const uint8_t* session_id,
+                                               size_t session_id_length) const {
+  return absl::StrCat("server:", session_id_context_,
+                      absl::string_view(reinterpret_cast<const char*>(session_id),
+                                        session_id_length));
+}
+
+int ServerContextImpl::newSession(SSL_SESSION* session) {
+  unsigned session_id_length = 0;
+  const uint8_t* session_id = SSL_SESSION_get_id(session, &session_id_length);
+  session_cache_->insert(sessionCacheKey(session_id, session_id_length),
+                         bssl::UniquePtr<SSL_SESSION>(session), 1);
+  return 1; // Tell BoringSSL that we took ownership of the session.
+}
+
+bssl::UniquePtr<SSL_SESSION> ServerContextImpl::getSession(const uint8_t* session_id,
+                                                           int session_id_length) {
+  bssl::UniquePtr<SSL_SESSION> session =
+      session_cache_->lookup(sessionCacheKey(session_id, session_id_length));
+  if (session != nullptr) {
+    stats_.session_cache_hit_.inc();
+  } else {
+    stats_.session_cache_miss_.inc();
+  }
+  return session;
+}
+
+void ServerContextImpl::removeSession(SSL_SESSION* session) {
+  unsigned session_id_length = 0;
+  const uint8_t* session_id = SSL_SESSION_get_id(session, &session_id_length);
+  session_cache_->remove(sessionCacheKey(session_id, session_id_length), session);
+}
+
 int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv,
                                             EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx, int encrypt) {
   const EVP_MD* hmac = EVP_sha256();
@@ -1033,54 +1202,23 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   }
 }
 
-bool ServerContextImpl::isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello) {
-  CBS client_hello;
-  CBS_init(&client_hello, ssl_client_hello->client_hello, ssl_client_hello->client_hello_len);
-
+bool ServerContextImpl::isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello,
+                                             const Ssl::ClientHelloInfo& client_hello_info) {
   // This is the TLSv1.3 case (TLSv1.2 on the wire and the supported_versions extensions present).
   // We just need to look at signature algorithms.
-  const uint16_t client_version = ssl_client_hello->version;
+  const uint16_t client_version = client_hello_info.version();
   if (client_version == TLS1_2_VERSION && tls_max_version_ == TLS1_3_VERSION) {
     // If the supported_versions extension is found then we assume that the client is competent
     // enough that just checking the signature_algorithms is sufficient.
-    const uint8_t* supported_versions_data;
-    size_t supported_versions_len;
-    if (SSL_early_callback_ctx_extension_get(ssl_client_hello, TLSEXT_TYPE_supported_versions,
-                                             &supported_versions_data, &supported_versions_len)) {
-      const uint8_t* signature_algorithms_data;
-      size_t signature_algorithms_len;
-      if (SSL_early_callback_ctx_extension_get(ssl_client_hello, TLSEXT_TYPE_signature_algorithms,
-                                               &signature_algorithms_data,
-                                               &signature_algorithms_len)) {
-        CBS signature_algorithms_ext, signature_algorithms;
-        CBS_init(&signature_algorithms_ext, signature_algorithms_data, signature_algorithms_len);
-        if (!CBS_get_u16_length_prefixed(&signature_algorithms_ext, &signature_algorithms) ||
-            CBS_len(&signature_algorithms_ext) != 0) {
-          return false;
-        }
-        if (cbsContainsU16(signature_algorithms, SSL_SIGN_ECDSA_SECP256R1_SHA256)) {
-          return true;
-        }
-      }
-
-      return false;
+    if (client_hello_info.hasSupportedVersions()) {
+      return client_hello_info.offersEcdsaP256Signature();
     }
   }
 
   // Otherwise we are < TLSv1.3 and need to look at both the curves in the supported_groups for
   // ECDSA and also for a compatible cipher suite. https://tools.ietf.org/html/rfc4492#section-5.1.1
-  const uint8_t* curvelist_data;
-  size_t curvelist_len;
-  if (!SSL_early_callback_ctx_extension_get(ssl_client_hello, TLSEXT_TYPE_supported_groups,
-                                            &curvelist_data, &curvelist_len)) {
-    return false;
-  }
-
-  CBS curvelist;
-  CBS_init(&curvelist, curvelist_data, curvelist_len);
-
   // We only support P256 ECDSA curves today.
-  if (!cbsContainsU16(curvelist, SSL_CURVE_SECP256R1)) {
+  if (!client_hello_info.offersP256Curve()) {
     return false;
   }
 
@@ -1103,17 +1241,6 @@ bool ServerContextImpl::isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_
   return false;
 }
 
-bool ServerContextImpl::isClientOcspCapable(const SSL_CLIENT_HELLO* ssl_client_hello) {
-  const uint8_t* status_request_data;
-  size_t status_request_len;
-  if (SSL_early_callback_ctx_extension_get(ssl_client_hello, TLSEXT_TYPE_status_request,
-                                           &status_request_data, &status_request_len)) {
-    return true;
-  }
-
-  return false;
-}
-
 OcspStapleAction ServerContextImpl::ocspStapleAction(const TlsContext& ctx,
                                                      bool client_ocsp_capable) {
   if (!client_ocsp_capable) {
@@ -1156,27 +1283,87 @@ OcspStapleAction ServerContextImpl::ocspStapleAction(const TlsContext& ctx,
   PANIC_DUE_TO_CORRUPT_ENUM;
 }
 
-enum ssl_select_cert_result_t
-ServerContextImpl::selectTlsContext(const SSL_CLIENT_HELLO* ssl_client_hello) {
-  const bool client_ecdsa_capable = isClientEcdsaCapable(ssl_client_hello);
-  const bool client_ocsp_capable = isClientOcspCapable(ssl_client_hello);
+const TlsContext* ServerContextImpl::selectTlsContextByServerName(
+    absl::string_view server_name, bool client_ecdsa_capable, bool client_ocsp_capable,
+    OcspStapleAction& ocsp_staple_action) {
+  auto it = server_names_map_.find(server_name);
+  if (it == server_names_map_.end()) {
+    // A wildcard only matches a single label.
+    const size_t dot = server_name.find('.');
+    if (dot == absl::string_view::npos) {
+      return nullptr;
+    }
+    it = server_names_map_.find(server_name.substr(dot));
+    if (it == server_names_map_.end()) {
+      return nullptr;
+    }
+  }
 
-  // Fallback on first certificate.
-  const TlsContext* selected_ctx = &tls_contexts_[0];
-  auto ocsp_staple_action = ocspStapleAction(*selected_ctx, client_ocsp_capable);
-  for (const auto& ctx : tls_contexts_) {
-    if (client_ecdsa_capable != ctx.is_ecdsa_) {
+  // Prefer a certificate with the key type the client asked for, but an ECDSA capable client can
+  // also use an RSA certificate for this name.
+  for (const TlsContext* ctx : {it->second[client_ecdsa_capable], it->second[false]}) {
+    if (ctx == nullptr) {
       continue;
     }
+    const OcspStapleAction action = ocspStapleAction(*ctx, client_ocsp_capable);
+    if (action != OcspStapleAction::Fail) {
+      ocsp_staple_action = action;
+      return ctx;
+    }
+  }
+  return nullptr;
+}
 
-    auto action = ocspStapleAction(ctx, client_ocsp_capable);
-    if (action == OcspStapleAction::Fail) {
-      continue;
+enum ssl_select_cert_result_t
+ServerContextImpl::selectTlsContext(const SSL_CLIENT_HELLO* ssl_client_hello) {
+  // The TLS inspector may already have parsed the ClientHello of this connection. The filter state
+  // is only looked up if the inspector could have stored it there.
+  const auto* callbacks = static_cast<Network::TransportSocketCallbacks*>(
+      SSL_get_ex_data(ssl_client_hello->ssl, sslSocketIndex()));
+  const Ssl::ClientHelloInfo* client_hello_info = nullptr;
+  if (callbacks != nullptr && Runtime::runtimeFeatureEnabled(
+                                   "envoy.reloadable_features.tls_inspector_share_client_hello")) {
+    client_hello_info =
+        callbacks->connection().streamInfo().filterState()->getDataReadOnly<Ssl::ClientHelloInfo>(
+            Ssl::ClientHelloInfo::key());
+  }
+  absl::optional<Ssl::ClientHelloInfo> parsed_client_hello_info;
+  if (client_hello_info == nullptr) {
+    client_hello_info = &parsed_client_hello_info.emplace(*ssl_client_hello);
+  }
+
+  const bool client_ecdsa_capable = isClientEcdsaCapable(ssl_client_hello, *client_hello_info);
+  const bool client_ocsp_capable = client_hello_info->hasStatusRequest();
+
+  const TlsContext* selected_ctx = nullptr;
+  OcspStapleAction ocsp_staple_action{};
+  if (!server_names_map_.empty()) {
+    const char* server_name = SSL_get_servername(ssl_client_hello->ssl, TLSEXT_NAMETYPE_host_name);
+    if (server_name != nullptr) {
+      selected_ctx = selectTlsContextByServerName(absl::AsciiStrToLower(server_name),
+                                                  client_ecdsa_capable, client_ocsp_capable,
+                                                  ocsp_staple_action);
     }
+  }
 
-    selected_ctx = &ctx;
-    ocsp_staple_action = action;
-    break;
+  if (selected_ctx == nullptr) {
+    // Fallback on first certificate.
+    selected_ctx = &tls_contexts_[0];
+    ocsp_staple_action = ocspStapleAction(*selected_ctx, client_ocsp_capable);
+    for (const auto& ctx : tls_contexts_) {
+      if (client_ecdsa_capable != ctx.is_ecdsa_) {
+        continue;
+      }
+
+      auto action = ocspStapleAction(ctx, client_ocsp_capable);
+      if (action == OcspStapleAction::Fail) {
+        continue;
+      }
+
+      selected_ctx = &ctx;
+      ocsp_staple_action = action;
+      break;
+    }
   }
 
   // Apply the selected context. This must be done before OCSP stapling below
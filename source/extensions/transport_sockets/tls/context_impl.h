@@ -17,12 +17,15 @@
 #include "envoy/stats/stats_macros.h"
 
 #include "source/common/common/matchers.h"
+#include "source/common/ssl/client_hello_info.h"
 #include "source/common/stats/symbol_table.h"
 #include "source/extensions/transport_sockets/tls/cert_validator/cert_validator.h"
 #include "source/extensions/transport_sockets/tls/context_manager_impl.h"
 #include "source/extensions/transport_sockets/tls/ocsp/ocsp.h"
+#include "source/extensions/transport_sockets/tls/session_cache.h"
 #include "source/extensions/transport_sockets/tls/stats.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
 #include "openssl/x509v3.h"
@@ -75,6 +78,13 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return the dynamic record sizing settings of the connections using this context, if any.
+   */
+  const absl::optional<Ssl::DynamicRecordSizing>& dynamicRecordSizing() const {
+    return dynamic_record_sizing_;
+  }
+
   /**
    * The global SSL-library index used for storing a pointer to the SslExtendedSocketInfo
    * class in the SSL instance, for retrieval in callbacks.
@@ -106,7 +116,11 @@ protected:
   friend class ContextImplPeer;
 
   ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& config,
-              TimeSource& time_source);
+              TimeSource& time_source, SessionCacheSharedPtr session_cache);
+  // Uses stats generated from scope beforehand. Nothing else is looked up in scope while
+  // constructing, so the context may be built on a thread other than the one owning scope.
+  ContextImpl(Stats::Scope& scope, const SslStats& stats, const Envoy::Ssl::ContextConfig& config,
+              TimeSource& time_source, SessionCacheSharedPtr session_cache);
 
   /**
    * The global SSL-library index used for storing a pointer to the context
@@ -157,6 +171,9 @@ protected:
   const Network::Address::IpList tls_keylog_local_;
   const Network::Address::IpList tls_keylog_remote_;
   AccessLog::AccessLogFileSharedPtr tls_keylog_file_;
+  // The session cache shared with the other contexts of the context manager, if enabled.
+  const SessionCacheSharedPtr session_cache_;
+  const absl::optional<Ssl::DynamicRecordSizing> dynamic_record_sizing_;
 };
 
 using ContextImplSharedPtr = std::shared_ptr<ContextImpl>;
@@ -164,13 +181,26 @@ using ContextImplSharedPtr = std::shared_ptr<ContextImpl>;
 class ClientContextImpl : public ContextImpl, public Envoy::Ssl::ClientContext {
 public:
   ClientContextImpl(Stats::Scope& scope, const Envoy::Ssl::ClientContextConfig& config,
-                    TimeSource& time_source);
+                    TimeSource& time_source, SessionCacheSharedPtr session_cache = nullptr);
 
   bssl::UniquePtr<SSL>
   newSsl(const Network::TransportSocketOptionsConstSharedPtr& options) override;
 
+  /**
+   * @return a digest of the client certificates and the upstream validation configuration, which
+   *         prefixes the keys of sessions that other contexts may resume.
+   */
+  const std::string& sessionCacheKeyPrefix() const { return session_cache_key_prefix_; }
+
 private:
-  int newSessionKey(SSL_SESSION* session);
+  /**
+   * The global SSL-library index used for storing the shared session cache key of a connection
+   * in the SSL instance.
+   */
+  static int sessionCacheKeyIndex();
+
+  int newSessionKey(SSL* ssl, SSL_SESSION* session);
+  std::string generateSessionCacheKeyPrefix();
   uint16_t parseSigningAlgorithmsForTest(const std::string& sigalgs);
 
   const std::string server_name_indication_;
@@ -179,6 +209,10 @@ private:
   absl::Mutex session_keys_mu_;
   std::deque<bssl::UniquePtr<SSL_SESSION>> session_keys_ ABSL_GUARDED_BY(session_keys_mu_);
   bool session_keys_single_use_{false};
+  // Identifies the upstream validation configuration and client certificates in shared session
+  // cache keys, so that sessions are only resumed by contexts which would accept the same server.
+  // Also used by other session caches, such as the persistent one of upstream QUIC connections.
+  std::string session_cache_key_prefix_;
 };
 
 enum class OcspStapleAction { Staple, NoStaple, Fail, ClientNotCapable };
@@ -186,7 +220,13 @@ enum class OcspStapleAction { Staple, NoStaple, Fail, ClientNotCapable };
 class ServerContextImpl : public ContextImpl, public Envoy::Ssl::ServerContext {
 public:
   ServerContextImpl(Stats::Scope& scope, const Envoy::Ssl::ServerContextConfig& config,
-                    const std::vector<std::string>& server_names, TimeSource& time_source);
+                    const std::vector<std::string>& server_names, TimeSource& time_source,
+                    SessionCacheSharedPtr session_cache = nullptr);
+  // Uses stats generated from scope beforehand, see ContextManagerImpl::finishServerContextBatch().
+  ServerContextImpl(Stats::Scope& scope, const SslStats& stats,
+                    const Envoy::Ssl::ServerContextConfig& config,
+                    const std::vector<std::string>& server_names, TimeSource& time_source,
+                    SessionCacheSharedPtr session_cache);
 
   // Select the TLS certificate context in SSL_CTX_set_select_certificate_cb() callback with
   // ClientHello details. This is made public for use by custom TLS extensions who want to
@@ -200,14 +240,30 @@ private:
                          unsigned int inlen);
   int sessionTicketProcess(SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
                            HMAC_CTX* hmac_ctx, int encrypt);
-  bool isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello);
-  bool isClientOcspCapable(const SSL_CLIENT_HELLO* ssl_client_hello);
+  bool isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello,
+                            const Ssl::ClientHelloInfo& client_hello_info);
   OcspStapleAction ocspStapleAction(const TlsContext& ctx, bool client_ocsp_capable);
+  // Returns the context of the certificate valid for the server name which the client can use, or
+  // nullptr if there is none.
+  const TlsContext* selectTlsContextByServerName(absl::string_view server_name,
+                                                 bool client_ecdsa_capable,
+                                                 bool client_ocsp_capable,
+                                                 OcspStapleAction& ocsp_staple_action);
 
   SessionContextID generateHashForSessionContextId(const std::vector<std::string>& server_names);
 
+  // Session ID based resumption through the shared session cache.
+  std::string sessionCacheKey(const uint8_t* session_id, size_t session_id_length) const;
+  int newSession(SSL_SESSION* session);
+  bssl::UniquePtr<SSL_SESSION> getSession(const uint8_t* session_id, int session_id_length);
+  void removeSession(SSL_SESSION* session);
+
   const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey> session_ticket_keys_;
   const Ssl::ServerContextConfig::OcspStaplePolicy ocsp_staple_policy_;
+  std::string session_id_context_;
+  // The certificate contexts of each exact or wildcard server name, indexed by whether their key is
+  // ECDSA.
+  absl::flat_hash_map<std::string, std::array<const TlsContext*, 2>> server_names_map_;
 };
 
 } // namespace Tls
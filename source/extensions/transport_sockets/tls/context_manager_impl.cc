@@ -5,9 +5,12 @@
 #include <functional>
 #include <limits>
 
+#include "envoy/common/exception.h"
 #include "envoy/stats/scope.h"
 
 #include "source/common/common/assert.h"
+#include "source/common/common/thread.h"
+#include "source/common/runtime/runtime_features.h"
 #include "source/extensions/transport_sockets/tls/context_impl.h"
 
 namespace Envoy {
@@ -15,7 +18,30 @@ namespace Extensions {
 namespace TransportSockets {
 namespace Tls {
 
-ContextManagerImpl::ContextManagerImpl(TimeSource& time_source) : time_source_(time_source) {}
+namespace {
+
+uint32_t getUint32(Runtime::Loader& runtime, const std::string& key, uint32_t default_value) {
+  return std::min<uint64_t>(runtime.snapshot().getInteger(key, default_value),
+                            std::numeric_limits<uint32_t>::max());
+}
+
+} // namespace
+
+ContextManagerImpl::ContextManagerImpl(TimeSource& time_source)
+    : ContextManagerImpl(time_source, DefaultSessionCacheMaxSessions, DefaultSessionCacheShards) {}
+
+ContextManagerImpl::ContextManagerImpl(TimeSource& time_source, Runtime::Loader& runtime)
+    : ContextManagerImpl(
+          time_source,
+          getUint32(runtime, "tls.shared_session_cache.max_sessions",
+                    DefaultSessionCacheMaxSessions),
+          getUint32(runtime, "tls.shared_session_cache.shards", DefaultSessionCacheShards)) {}
+
+ContextManagerImpl::ContextManagerImpl(TimeSource& time_source,
+                                       uint32_t session_cache_max_sessions,
+                                       uint32_t session_cache_shards)
+    : time_source_(time_source), session_cache_(std::make_shared<SessionCache>(
+                                     session_cache_max_sessions, session_cache_shards)) {}
 
 ContextManagerImpl::~ContextManagerImpl() {
   KNOWN_ISSUE_ASSERT(contexts_.empty(), "https://github.com/envoyproxy/envoy/issues/10030");
@@ -29,7 +55,7 @@ ContextManagerImpl::createSslClientContext(Stats::Scope& scope,
   }
 
   Envoy::Ssl::ClientContextSharedPtr context =
-      std::make_shared<ClientContextImpl>(scope, config, time_source_);
+      std::make_shared<ClientContextImpl>(scope, config, time_source_, sessionCacheForNewContext());
   contexts_.insert(context);
   return context;
 }
@@ -43,11 +69,90 @@ ContextManagerImpl::createSslServerContext(Stats::Scope& scope,
   }
 
   Envoy::Ssl::ServerContextSharedPtr context =
-      std::make_shared<ServerContextImpl>(scope, config, server_names, time_source_);
+      std::make_shared<ServerContextImpl>(scope, config, server_names, time_source_,
+                                          sessionCacheForNewContext());
   contexts_.insert(context);
   return context;
 }
 
+SessionCacheSharedPtr ContextManagerImpl::sessionCacheForNewContext() const {
+  if (!Runtime::runtimeFeatureEnabled("envoy.reloadable_features.tls_shared_session_cache")) {
+    return nullptr;
+  }
+  return session_cache_;
+}
+
+void ContextManagerImpl::createSslServerContextDeferred(
+    Stats::Scope& scope, const Envoy::Ssl::ServerContextConfig& config,
+    const std::vector<std::string>& server_names, ServerContextCb cb) {
+  if (!batch_open_ || !config.isReady()) {
+    cb(createSslServerContext(scope, config, server_names));
+    return;
+  }
+  pending_server_contexts_.push_back(
+      {scope, config, server_names, std::move(cb), absl::nullopt, nullptr, nullptr});
+}
+
+void ContextManagerImpl::startServerContextBatch() {
+  ASSERT(!batch_open_);
+  ASSERT(pending_server_contexts_.empty());
+  batch_open_ = true;
+}
+
+void ContextManagerImpl::finishServerContextBatch(Thread::ThreadFactory& thread_factory,
+                                                  uint32_t max_threads) {
+  ASSERT(batch_open_);
+  std::vector<PendingServerContext> pending;
+  std::swap(pending, pending_server_contexts_);
+  batch_open_ = false;
+
+  // Building a context parses and validates certificates and keys, which dominates the cost of
+  // listeners with many TLS filter chains. The contexts are independent of each other, so they are
+  // built concurrently and only published on this thread once all of them succeeded. Scopes may
+  // only be used on this thread, so the stats of the contexts are created here first.
+  for (PendingServerContext& entry : pending) {
+    entry.stats_.emplace(generateSslStats(entry.scope_));
+  }
+  const SessionCacheSharedPtr session_cache = sessionCacheForNewContext();
+  Thread::parallelFor(thread_factory, max_threads, pending.size(), [&](size_t i) {
+    PendingServerContext& entry = pending[i];
+    // Nothing may escape a pool thread, so any error is carried back to this thread as is.
+    TRY_NEEDS_AUDIT {
+      entry.context_ =
+          std::make_shared<ServerContextImpl>(entry.scope_, *entry.stats_, entry.config_,
+                                              entry.server_names_, time_source_, session_cache);
+    }
+    catch (...) {
+      entry.error_ = std::current_exception();
+    }
+  });
+
+  // Every context that was built is handed out, so that no factory is left without one.
+  std::exception_ptr first_error;
+  for (PendingServerContext& entry : pending) {
+    if (entry.error_ != nullptr) {
+      if (first_error == nullptr) {
+        first_error = entry.error_;
+      }
+      continue;
+    }
+    contexts_.insert(entry.context_);
+    entry.cb_(std::move(entry.context_));
+  }
+  if (first_error != nullptr) {
+    std::rethrow_exception(first_error);
+  }
+}
+
+void ContextManagerImpl::cancelServerContextBatch() {
+  // The callback targets may already be gone, e.g. the socket factories of a listener whose
+  // construction threw, so the queued contexts are dropped without calling back.
+  ENVOY_LOG(debug, "dropping {} server context(s) of a cancelled batch",
+            pending_server_contexts_.size());
+  pending_server_contexts_.clear();
+  batch_open_ = false;
+}
+
 absl::optional<uint32_t> ContextManagerImpl::daysUntilFirstCertExpires() const {
   absl::optional<uint32_t> ret = absl::make_optional(std::numeric_limits<uint32_t>::max());
   for (const auto& context : contexts_) {
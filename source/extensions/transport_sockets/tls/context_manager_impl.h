@@ -1,15 +1,22 @@
 #pragma once
 
 #include <cstdint>
+#include <exception>
 #include <functional>
 #include <list>
+#include <string>
+#include <vector>
 
 #include "envoy/common/time.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context_manager.h"
 #include "envoy/ssl/private_key/private_key.h"
 #include "envoy/stats/scope.h"
 
+#include "source/common/common/logger.h"
 #include "source/extensions/transport_sockets/tls/private_key/private_key_manager_impl.h"
+#include "source/extensions/transport_sockets/tls/session_cache.h"
+#include "source/extensions/transport_sockets/tls/stats.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -23,11 +30,27 @@ namespace Tls {
  * be released from any thread). Context allocation/free is a very uncommon thing so we just do a
  * global lock to protect it all.
  */
-class ContextManagerImpl final : public Envoy::Ssl::ContextManager {
+class ContextManagerImpl final : public Envoy::Ssl::ContextManager,
+                                 Logger::Loggable<Logger::Id::config> {
 public:
+  // Sizes the shared session cache with the defaults below.
   explicit ContextManagerImpl(TimeSource& time_source);
+  // Sizes the shared session cache with the tls.shared_session_cache.max_sessions and
+  // tls.shared_session_cache.shards runtime values, which are read once.
+  ContextManagerImpl(TimeSource& time_source, Runtime::Loader& runtime);
+  ContextManagerImpl(TimeSource& time_source, uint32_t session_cache_max_sessions,
+                     uint32_t session_cache_shards);
   ~ContextManagerImpl() override;
 
+  // Client sessions hold on to the certificate chain of the server, so a session is typically a
+  // few KB and the default bounds the cache to tens of MB. That fits the sessions of a few
+  // thousand upstream hosts and SNIs, with a few sessions each, plus those of the downstream
+  // clients resuming by session ID shortly after their first connection.
+  static constexpr uint32_t DefaultSessionCacheMaxSessions = 16 * 1024;
+  // Each shard has its own lock. Lookups and inserts happen once per handshake and hold the lock
+  // briefly, so a few shards per worker of a large host keep contention negligible.
+  static constexpr uint32_t DefaultSessionCacheShards = 16;
+
   // Ssl::ContextManager
   Ssl::ClientContextSharedPtr
   createSslClientContext(Stats::Scope& scope,
@@ -35,6 +58,14 @@ public:
   Ssl::ServerContextSharedPtr
   createSslServerContext(Stats::Scope& scope, const Envoy::Ssl::ServerContextConfig& config,
                          const std::vector<std::string>& server_names) override;
+  void createSslServerContextDeferred(Stats::Scope& scope,
+                                      const Envoy::Ssl::ServerContextConfig& config,
+                                      const std::vector<std::string>& server_names,
+                                      ServerContextCb cb) override;
+  void startServerContextBatch() override;
+  void finishServerContextBatch(Thread::ThreadFactory& thread_factory,
+                                uint32_t max_threads) override;
+  void cancelServerContextBatch() override;
   absl::optional<uint32_t> daysUntilFirstCertExpires() const override;
   absl::optional<uint64_t> secondsUntilFirstOcspResponseExpires() const override;
   void iterateContexts(std::function<void(const Envoy::Ssl::Context&)> callback) override;
@@ -44,9 +75,28 @@ public:
   void removeContext(const Envoy::Ssl::ContextSharedPtr& old_context) override;
 
 private:
+  // A server context queued by createSslServerContextDeferred() while a batch is open.
+  struct PendingServerContext {
+    Stats::Scope& scope_;
+    const Envoy::Ssl::ServerContextConfig& config_;
+    std::vector<std::string> server_names_;
+    ServerContextCb cb_;
+    // Created from scope_ on the thread finishing the batch, before the context is built.
+    absl::optional<SslStats> stats_;
+    Envoy::Ssl::ServerContextSharedPtr context_;
+    // Whatever the build threw, to be rethrown on the thread finishing the batch.
+    std::exception_ptr error_;
+  };
+
+  // The session cache to share with a new context, or nullptr if sharing sessions is disabled.
+  SessionCacheSharedPtr sessionCacheForNewContext() const;
+
   TimeSource& time_source_;
+  bool batch_open_{};
+  std::vector<PendingServerContext> pending_server_contexts_;
   absl::flat_hash_set<Envoy::Ssl::ContextSharedPtr> contexts_;
   PrivateKeyMethodManagerImpl private_key_method_manager_{};
+  const SessionCacheSharedPtr session_cache_;
 };
 
 } // namespace Tls
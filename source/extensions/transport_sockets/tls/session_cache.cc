@@ -0,0 +1,129 @@
+#include "source/extensions/transport_sockets/tls/session_cache.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+
+#include "absl/hash/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+SessionCache::SessionCache(uint32_t max_sessions, uint32_t shard_count)
+    : max_sessions_per_shard_(std::max<uint64_t>(max_sessions / std::max(shard_count, 1U), 1)) {
+  shards_.reserve(std::max(shard_count, 1U));
+  for (uint32_t i = 0; i < std::max(shard_count, 1U); ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+void SessionCache::insert(absl::string_view key, bssl::UniquePtr<SSL_SESSION> session,
+                          uint32_t max_sessions_per_key) {
+  ASSERT(max_sessions_per_key > 0);
+  Shard& shard = shardFor(key);
+  absl::MutexLock lock(&shard.mutex_);
+
+  auto it = shard.entries_.find(key);
+  std::list<Entry>::iterator entry;
+  if (it == shard.entries_.end()) {
+    shard.lru_.push_front(Entry{std::string(key), {}});
+    entry = shard.lru_.begin();
+    shard.entries_.emplace(entry->key_, entry);
+  } else {
+    entry = it->second;
+    shard.lru_.splice(shard.lru_.begin(), shard.lru_, entry);
+  }
+
+  entry->sessions_.push_front(std::move(session));
+  ++shard.size_;
+  while (entry->sessions_.size() > max_sessions_per_key) {
+    entry->sessions_.pop_back();
+    --shard.size_;
+  }
+
+  // Evict the oldest sessions of the least recently used keys, which may include the new one if
+  // the shard is tiny.
+  while (shard.size_ > max_sessions_per_shard_) {
+    Entry& victim = shard.lru_.back();
+    victim.sessions_.pop_back();
+    --shard.size_;
+    if (victim.sessions_.empty()) {
+      erase(shard, std::prev(shard.lru_.end()));
+    }
+  }
+}
+
+bssl::UniquePtr<SSL_SESSION> SessionCache::lookup(absl::string_view key) {
+  Shard& shard = shardFor(key);
+  absl::MutexLock lock(&shard.mutex_);
+
+  auto it = shard.entries_.find(key);
+  if (it == shard.entries_.end()) {
+    return nullptr;
+  }
+  std::list<Entry>::iterator entry = it->second;
+  ASSERT(!entry->sessions_.empty());
+
+  bssl::UniquePtr<SSL_SESSION> session;
+  if (SSL_SESSION_should_be_single_use(entry->sessions_.front().get())) {
+    session = std::move(entry->sessions_.front());
+    entry->sessions_.pop_front();
+    --shard.size_;
+    if (entry->sessions_.empty()) {
+      erase(shard, entry);
+      return session;
+    }
+  } else {
+    session = bssl::UpRef(entry->sessions_.front());
+  }
+  shard.lru_.splice(shard.lru_.begin(), shard.lru_, entry);
+  return session;
+}
+
+void SessionCache::remove(absl::string_view key, const SSL_SESSION* session) {
+  Shard& shard = shardFor(key);
+  absl::MutexLock lock(&shard.mutex_);
+
+  auto it = shard.entries_.find(key);
+  if (it == shard.entries_.end()) {
+    return;
+  }
+  std::list<Entry>::iterator entry = it->second;
+  auto session_it =
+      std::find_if(entry->sessions_.begin(), entry->sessions_.end(),
+                   [session](const bssl::UniquePtr<SSL_SESSION>& s) { return s.get() == session; });
+  if (session_it == entry->sessions_.end()) {
+    return;
+  }
+  entry->sessions_.erase(session_it);
+  --shard.size_;
+  if (entry->sessions_.empty()) {
+    erase(shard, entry);
+  }
+}
+
+uint64_t SessionCache::size() const {
+  uint64_t size = 0;
+  for (const auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mutex_);
+    size += shard->size_;
+  }
+  return size;
+}
+
+SessionCache::Shard& SessionCache::shardFor(absl::string_view key) {
+  return *shards_[absl::Hash<absl::string_view>()(key) % shards_.size()];
+}
+
+void SessionCache::erase(Shard& shard, std::list<Entry>::iterator it) {
+  // The map is keyed by a view of the entry's key, so it must be erased first.
+  shard.entries_.erase(it->key_);
+  shard.lru_.erase(it);
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * A TLS session cache shared by all the contexts created by a context manager, and thus by all the
+ * workers, so that a session established through one context can be resumed through another one
+ * with the same resumption identity, e.g. after an SDS update replaced the context.
+ *
+ * Sessions are stored under a key which must capture everything that makes resuming them safe
+ * (the session ID context on the server side, the validation configuration and SNI on the client
+ * side). The cache is split into shards with their own lock and LRU list to limit contention, and
+ * holds at most max_sessions sessions in total, evicting the least recently used keys first.
+ */
+class SessionCache {
+public:
+  SessionCache(uint32_t max_sessions, uint32_t shard_count);
+
+  /**
+   * Stores a session under a key, ahead of the sessions already stored under it.
+   * @param key the resumption identity of the session.
+   * @param session the session.
+   * @param max_sessions_per_key how many sessions are kept under the key, dropping the oldest ones.
+   */
+  void insert(absl::string_view key, bssl::UniquePtr<SSL_SESSION> session,
+              uint32_t max_sessions_per_key);
+
+  /**
+   * @return the most recently stored session under a key, or nullptr if there is none. Single use
+   *         (TLS 1.3) sessions are removed from the cache.
+   */
+  bssl::UniquePtr<SSL_SESSION> lookup(absl::string_view key);
+
+  /**
+   * Removes a session which is no longer valid from the cache.
+   */
+  void remove(absl::string_view key, const SSL_SESSION* session);
+
+  /**
+   * @return the number of sessions in the cache.
+   */
+  uint64_t size() const;
+
+private:
+  struct Entry {
+    std::string key_;
+    // Most recently stored first.
+    std::deque<bssl::UniquePtr<SSL_SESSION>> sessions_;
+  };
+
+  struct Shard {
+    mutable absl::Mutex mutex_;
+    // Most recently used first.
+    std::list<Entry> lru_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator>
+        entries_ ABSL_GUARDED_BY(mutex_);
+    uint64_t size_ ABSL_GUARDED_BY(mutex_){};
+  };
+
+  Shard& shardFor(absl::string_view key);
+  static void erase(Shard& shard, std::list<Entry>::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  const uint64_t max_sessions_per_shard_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+using SessionCacheSharedPtr = std::shared_ptr<SessionCache>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -252,7 +252,7 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     bytes_to_write = bytes_to_retry_;
     bytes_to_retry_ = 0;
   } else {
-    bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+    bytes_to_write = std::min(write_buffer.length(), maxRecordSize());
   }
 
   uint64_t total_bytes_written = 0;
@@ -270,7 +270,8 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
       ASSERT(rc == static_cast<int>(bytes_to_write));
       total_bytes_written += rc;
       write_buffer.drain(rc);
-      bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+      ramp_up_bytes_written_ += rc;
+      bytes_to_write = std::min(write_buffer.length(), maxRecordSize());
     } else {
       int err = SSL_get_error(rawSsl(), rc);
       ENVOY_CONN_LOG(trace, "ssl error occurred while write: {}", callbacks_->connection(),
@@ -297,6 +298,23 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+uint64_t SslSocket::maxRecordSize() {
+  // SSL_write() writes at most 16KB per record, so writes are split at record boundaries.
+  static constexpr uint64_t MaxRecordSize = 16384;
+  const absl::optional<Ssl::DynamicRecordSizing>& sizing = ctx_->dynamicRecordSizing();
+  if (!sizing.has_value()) {
+    return MaxRecordSize;
+  }
+  const MonotonicTime now = callbacks_->connection().dispatcher().approximateMonotonicTime();
+  if (now - last_write_time_ >= sizing->idle_timeout_) {
+    // The congestion window may have shrunk while idle, so ramp up again.
+    ramp_up_bytes_written_ = 0;
+  }
+  last_write_time_ = now;
+  return ramp_up_bytes_written_ < sizing->ramp_up_bytes_ ? sizing->initial_record_size_
+                                                          : MaxRecordSize;
+}
+
 void SslSocket::onConnected() { ASSERT(info_->state() == Ssl::SocketState::PreHandshake); }
 
 Ssl::ConnectionInfoConstSharedPtr SslSocket::ssl() const { return info_; }
@@ -419,8 +437,17 @@ ServerSslSocketFactory::ServerSslSocketFactory(Envoy::Ssl::ServerContextConfigPt
                                                Stats::Scope& stats_scope,
                                                const std::vector<std::string>& server_names)
     : manager_(manager), stats_scope_(stats_scope), stats_(generateStats("server", stats_scope)),
-      config_(std::move(config)), server_names_(server_names),
-      ssl_ctx_(manager_.createSslServerContext(stats_scope_, *config_, server_names_)) {
+      config_(std::move(config)), server_names_(server_names) {
+  // When the manager is batching server contexts (e.g. while a listener's filter chains are being
+  // built) the context is filled in once the batch is finished; until then it is not ready.
+  manager_.createSslServerContextDeferred(
+      stats_scope_, *config_, server_names_, [this](Envoy::Ssl::ServerContextSharedPtr ctx) {
+        {
+          absl::WriterMutexLock l(&ssl_ctx_mu_);
+          std::swap(ctx, ssl_ctx_);
+        }
+        manager_.removeContext(ctx);
+      });
   config_->setSecretUpdateCallback([this]() { onAddOrUpdateSecret(); });
 }
 
@@ -86,6 +86,7 @@ private:
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
 
   Network::PostIoAction doHandshake();
+  uint64_t maxRecordSize();
   void drainErrorQueue();
   void shutdownSsl();
   void shutdownBasic();
@@ -95,6 +96,9 @@ private:
   Network::TransportSocketCallbacks* callbacks_{};
   ContextImplSharedPtr ctx_;
   uint64_t bytes_to_retry_{};
+  // With dynamic record sizing, the bytes written since the connection started or was last idle.
+  uint64_t ramp_up_bytes_written_{};
+  MonotonicTime last_write_time_;
   std::string failure_reason_;
 
   SslHandshakerImplSharedPtr info_;
@@ -6,6 +6,7 @@
 
 #include "source/common/network/utility.h"
 
+#include "absl/hash/hash.h"
 #include "spdlog/spdlog.h"
 
 namespace Envoy {
@@ -92,7 +93,8 @@ ActiveRawUdpListener::ActiveRawUdpListener(uint32_t worker_index, uint32_t concu
                                            Network::UdpListenerPtr&& listener,
                                            Network::ListenerConfig& config)
     : ActiveUdpListenerBase(worker_index, concurrency, parent, listen_socket, std::move(listener),
-                            &config) {
+                            &config),
+      route_by_address_hash_(config.udpListenerConfig()->config().route_by_address_hash()) {
   // Create the filter chain on creating a new udp listener.
   config_->filterChainFactory().createUdpListenerFilterChain(*this, *this);
 
@@ -118,6 +120,15 @@ void ActiveRawUdpListener::onDataWorker(Network::UdpRecvData&& data) {
 
 void ActiveRawUdpListener::onReadReady() {}
 
+uint32_t ActiveRawUdpListener::destination(const Network::UdpRecvData& data) const {
+  if (!route_by_address_hash_) {
+    return ActiveUdpListenerBase::destination(data);
+  }
+  // Every worker computes the same hash for the datagrams of a flow, whichever socket they arrive
+  // on, so the flow is always processed on the same worker.
+  return absl::Hash<Network::UdpRecvData::LocalPeerAddresses>()(data.addresses_) % concurrency_;
+}
+
 void ActiveRawUdpListener::onWriteReady(const Network::Socket&) {
   // TODO(sumukhs): This is not used now. When write filters are implemented, this is a
   // trigger to invoke the on write ready API on the filters which is when they can write
@@ -15,7 +15,10 @@
 namespace Envoy {
 namespace Server {
 
-#define ALL_UDP_LISTENER_STATS(COUNTER) COUNTER(downstream_rx_datagram_dropped)
+#define ALL_UDP_LISTENER_STATS(COUNTER)                                                            \
+  COUNTER(downstream_rx_datagram_dropped)                                                          \
+  COUNTER(downstream_rx_packet_buffer_allocated)                                                   \
+  COUNTER(downstream_rx_packet_buffer_reused)
 
 /**
  * Wrapper struct for UDP listener stats. @see stats_macros.h
@@ -39,6 +42,10 @@ public:
   void onDatagramsDropped(uint32_t dropped) final {
     udp_stats_.downstream_rx_datagram_dropped_.add(dropped);
   }
+  void onPacketBuffersAcquired(uint64_t allocated, uint64_t reused) final {
+    udp_stats_.downstream_rx_packet_buffer_allocated_.add(allocated);
+    udp_stats_.downstream_rx_packet_buffer_reused_.add(reused);
+  }
 
   // ActiveListenerImplBase
   Network::Listener* listener() override { return udp_listener_.get(); }
@@ -117,9 +124,16 @@ public:
   // Network::UdpReadFilterCallbacks
   Network::UdpListener& udpListener() override;
 
+protected:
+  // ActiveUdpListenerBase
+  uint32_t destination(const Network::UdpRecvData& data) const override;
+
 private:
   std::list<Network::UdpListenerReadFilterPtr> read_filters_;
   Network::UdpPacketWriterPtr udp_packet_writer_;
+  // Whether datagrams are routed to workers by a hash of their addresses rather than processed by
+  // the worker which received them.
+  const bool route_by_address_hash_;
 };
 
 } // namespace Server
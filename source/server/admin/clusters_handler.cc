@@ -38,24 +38,6 @@ void addCircuitBreakerSettingsAsJson(const envoy::config::core::v3::RoutingPrior
   thresholds.mutable_max_retries()->set_value(resource_manager.retries().max());
 }
 
-} // namespace
-
-ClustersHandler::ClustersHandler(Server::Instance& server) : HandlerContextBase(server) {}
-
-Http::Code ClustersHandler::handlerClusters(Http::ResponseHeaderMap& response_headers,
-                                            Buffer::Instance& response, AdminStream& admin_stream) {
-  const auto format_value = Utility::formatParam(admin_stream.queryParams());
-
-  if (format_value.has_value() && format_value.value() == "json") {
-    writeClustersAsJson(response);
-    response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Json);
-  } else {
-    writeClustersAsText(response);
-  }
-
-  return Http::Code::OK;
-}
-
 // Helper method that ensures that we've setting flags based on all the health flag values on the
 // host.
 void setHealthFlag(Upstream::Host::HealthFlag flag, const Upstream::Host& host,
@@ -102,191 +84,251 @@ void setHealthFlag(Upstream::Host::HealthFlag flag, const Upstream::Host& host,
   }
 }
 
-// TODO(efimki): Add support of text readouts stats.
-void ClustersHandler::writeClustersAsJson(Buffer::Instance& response) {
-  envoy::admin::v3::Clusters clusters;
-  // TODO(mattklein123): Add ability to see warming clusters in admin output.
-  auto all_clusters = server_.clusterManager().clusters();
-  for (const auto& [name, cluster_ref] : all_clusters.active_clusters_) {
-    UNREFERENCED_PARAMETER(name);
-    const Upstream::Cluster& cluster = cluster_ref.get();
-    Upstream::ClusterInfoConstSharedPtr cluster_info = cluster.info();
-
-    envoy::admin::v3::ClusterStatus& cluster_status = *clusters.add_cluster_statuses();
-    cluster_status.set_name(cluster_info->name());
-    cluster_status.set_observability_name(cluster_info->observabilityName());
-    const auto& eds_service_name = cluster_info->edsServiceName();
-    if (eds_service_name.has_value()) {
-      cluster_status.set_eds_service_name(*eds_service_name);
-    }
 
-    addCircuitBreakerSettingsAsJson(
-        envoy::config::core::v3::RoutingPriority::DEFAULT,
-        cluster.info()->resourceManager(Upstream::ResourcePriority::Default), cluster_status);
-    addCircuitBreakerSettingsAsJson(
-        envoy::config::core::v3::RoutingPriority::HIGH,
-        cluster.info()->resourceManager(Upstream::ResourcePriority::High), cluster_status);
+void addOutlierInfo(const std::string& cluster_name,
+                    const Upstream::Outlier::Detector* outlier_detector,
+                    Buffer::Instance& response) {
+  if (outlier_detector) {
+    response.add(fmt::format(
+        "{}::outlier::success_rate_average::{:g}\n", cluster_name,
+        outlier_detector->successRateAverage(
+            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin)));
+    response.add(fmt::format(
+        "{}::outlier::success_rate_ejection_threshold::{:g}\n", cluster_name,
+        outlier_detector->successRateEjectionThreshold(
+            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin)));
+    response.add(fmt::format(
+        "{}::outlier::local_origin_success_rate_average::{:g}\n", cluster_name,
+        outlier_detector->successRateAverage(
+            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin)));
+    response.add(fmt::format(
+        "{}::outlier::local_origin_success_rate_ejection_threshold::{:g}\n", cluster_name,
+        outlier_detector->successRateEjectionThreshold(
+            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin)));
+  }
+}
+
+// TODO(efimki): Add support of text readouts stats.
+void addClusterStatus(const Upstream::Cluster& cluster,
+                      envoy::admin::v3::ClusterStatus& cluster_status) {
+  Upstream::ClusterInfoConstSharedPtr cluster_info = cluster.info();
+  cluster_status.set_name(cluster_info->name());
+  cluster_status.set_observability_name(cluster_info->observabilityName());
+  const auto& eds_service_name = cluster_info->edsServiceName();
+  if (eds_service_name.has_value()) {
+    cluster_status.set_eds_service_name(*eds_service_name);
+  }
 
-    const Upstream::Outlier::Detector* outlier_detector = cluster.outlierDetector();
-    if (outlier_detector != nullptr &&
+  addCircuitBreakerSettingsAsJson(
+      envoy::config::core::v3::RoutingPriority::DEFAULT,
+      cluster.info()->resourceManager(Upstream::ResourcePriority::Default), cluster_status);
+  addCircuitBreakerSettingsAsJson(envoy::config::core::v3::RoutingPriority::HIGH,
+                                  cluster.info()->resourceManager(Upstream::ResourcePriority::High),
+                                  cluster_status);
+
+  const Upstream::Outlier::Detector* outlier_detector = cluster.outlierDetector();
+  if (outlier_detector != nullptr &&
+      outlier_detector->successRateEjectionThreshold(
+          Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin) > 0.0) {
+    cluster_status.mutable_success_rate_ejection_threshold()->set_value(
         outlier_detector->successRateEjectionThreshold(
-            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin) > 0.0) {
-      cluster_status.mutable_success_rate_ejection_threshold()->set_value(
-          outlier_detector->successRateEjectionThreshold(
-              Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin));
-    }
-    if (outlier_detector != nullptr &&
+            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin));
+  }
+  if (outlier_detector != nullptr &&
+      outlier_detector->successRateEjectionThreshold(
+          Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin) > 0.0) {
+    cluster_status.mutable_local_origin_success_rate_ejection_threshold()->set_value(
         outlier_detector->successRateEjectionThreshold(
-            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin) > 0.0) {
-      cluster_status.mutable_local_origin_success_rate_ejection_threshold()->set_value(
-          outlier_detector->successRateEjectionThreshold(
-              Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin));
-    }
+            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin));
+  }
 
-    cluster_status.set_added_via_api(cluster_info->addedViaApi());
+  cluster_status.set_added_via_api(cluster_info->addedViaApi());
 
-    for (auto& host_set : cluster.prioritySet().hostSetsPerPriority()) {
-      for (auto& host : host_set->hosts()) {
-        envoy::admin::v3::HostStatus& host_status = *cluster_status.add_host_statuses();
-        Network::Utility::addressToProtobufAddress(*host->address(),
-                                                   *host_status.mutable_address());
-        host_status.set_hostname(host->hostname());
-        host_status.mutable_locality()->MergeFrom(host->locality());
+  for (auto& host_set : cluster.prioritySet().hostSetsPerPriority()) {
+    for (auto& host : host_set->hosts()) {
+      envoy::admin::v3::HostStatus& host_status = *cluster_status.add_host_statuses();
+      Network::Utility::addressToProtobufAddress(*host->address(), *host_status.mutable_address());
+      host_status.set_hostname(host->hostname());
+      host_status.mutable_locality()->MergeFrom(host->locality());
 
-        for (const auto& [counter_name, counter] : host->counters()) {
-          auto& metric = *host_status.add_stats();
-          metric.set_name(std::string(counter_name));
-          metric.set_value(counter.get().value());
-          metric.set_type(envoy::admin::v3::SimpleMetric::COUNTER);
-        }
+      for (const auto& [counter_name, counter] : host->counters()) {
+        auto& metric = *host_status.add_stats();
+        metric.set_name(std::string(counter_name));
+        metric.set_value(counter.get().value());
+        metric.set_type(envoy::admin::v3::SimpleMetric::COUNTER);
+      }
 
-        for (const auto& [gauge_name, gauge] : host->gauges()) {
-          auto& metric = *host_status.add_stats();
-          metric.set_name(std::string(gauge_name));
-          metric.set_value(gauge.get().value());
-          metric.set_type(envoy::admin::v3::SimpleMetric::GAUGE);
-        }
+      for (const auto& [gauge_name, gauge] : host->gauges()) {
+        auto& metric = *host_status.add_stats();
+        metric.set_name(std::string(gauge_name));
+        metric.set_value(gauge.get().value());
+        metric.set_type(envoy::admin::v3::SimpleMetric::GAUGE);
+      }
 
-        envoy::admin::v3::HostHealthStatus& health_status = *host_status.mutable_health_status();
+      envoy::admin::v3::HostHealthStatus& health_status = *host_status.mutable_health_status();
 
 // Invokes setHealthFlag for each health flag.
 #define SET_HEALTH_FLAG(name, notused)                                                             \
   setHealthFlag(Upstream::Host::HealthFlag::name, *host, health_status);
-        HEALTH_FLAG_ENUM_VALUES(SET_HEALTH_FLAG)
+      HEALTH_FLAG_ENUM_VALUES(SET_HEALTH_FLAG)
 #undef SET_HEALTH_FLAG
 
-        double success_rate = host->outlierDetector().successRate(
-            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin);
-        if (success_rate >= 0.0) {
-          host_status.mutable_success_rate()->set_value(success_rate);
-        }
+      double success_rate = host->outlierDetector().successRate(
+          Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin);
+      if (success_rate >= 0.0) {
+        host_status.mutable_success_rate()->set_value(success_rate);
+      }
 
-        host_status.set_weight(host->weight());
+      host_status.set_weight(host->weight());
 
-        host_status.set_priority(host->priority());
-        success_rate = host->outlierDetector().successRate(
-            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin);
-        if (success_rate >= 0.0) {
-          host_status.mutable_local_origin_success_rate()->set_value(success_rate);
-        }
+      host_status.set_priority(host->priority());
+      success_rate = host->outlierDetector().successRate(
+          Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin);
+      if (success_rate >= 0.0) {
+        host_status.mutable_local_origin_success_rate()->set_value(success_rate);
       }
     }
   }
-  response.add(MessageUtil::getJsonStringFromMessageOrError(clusters, true)); // pretty-print
 }
 
 // TODO(efimki): Add support of text readouts stats.
-void ClustersHandler::writeClustersAsText(Buffer::Instance& response) {
-  // TODO(mattklein123): Add ability to see warming clusters in admin output.
-  auto all_clusters = server_.clusterManager().clusters();
-  for (const auto& [name, cluster_ref] : all_clusters.active_clusters_) {
-    UNREFERENCED_PARAMETER(name);
-    const Upstream::Cluster& cluster = cluster_ref.get();
-    const std::string& cluster_name = cluster.info()->name();
-    response.add(fmt::format("{}::observability_name::{}\n", cluster_name,
-                             cluster.info()->observabilityName()));
-    addOutlierInfo(cluster_name, cluster.outlierDetector(), response);
-
-    addCircuitBreakerSettingsAsText(
-        cluster_name, "default",
-        cluster.info()->resourceManager(Upstream::ResourcePriority::Default), response);
-    addCircuitBreakerSettingsAsText(
-        cluster_name, "high", cluster.info()->resourceManager(Upstream::ResourcePriority::High),
-        response);
-
-    response.add(
-        fmt::format("{}::added_via_api::{}\n", cluster_name, cluster.info()->addedViaApi()));
-    const auto& eds_service_name = cluster.info()->edsServiceName();
-    if (eds_service_name.has_value()) {
-      response.add(fmt::format("{}::eds_service_name::{}\n", cluster_name, *eds_service_name));
-    }
-    for (auto& host_set : cluster.prioritySet().hostSetsPerPriority()) {
-      for (auto& host : host_set->hosts()) {
-        const std::string& host_address = host->address()->asString();
-        std::map<absl::string_view, uint64_t> all_stats;
-        for (const auto& [counter_name, counter] : host->counters()) {
-          all_stats[counter_name] = counter.get().value();
-        }
-
-        for (const auto& [gauge_name, gauge] : host->gauges()) {
-          all_stats[gauge_name] = gauge.get().value();
-        }
-
-        for (const auto& [stat_name, stat] : all_stats) {
-          response.add(
-              fmt::format("{}::{}::{}::{}\n", cluster_name, host_address, stat_name, stat));
-        }
-
-        response.add(
-            fmt::format("{}::{}::hostname::{}\n", cluster_name, host_address, host->hostname()));
-        response.add(fmt::format("{}::{}::health_flags::{}\n", cluster_name, host_address,
-                                 Upstream::HostUtility::healthFlagsToString(*host)));
-        response.add(
-            fmt::format("{}::{}::weight::{}\n", cluster_name, host_address, host->weight()));
-        response.add(fmt::format("{}::{}::region::{}\n", cluster_name, host_address,
-                                 host->locality().region()));
-        response.add(
-            fmt::format("{}::{}::zone::{}\n", cluster_name, host_address, host->locality().zone()));
-        response.add(fmt::format("{}::{}::sub_zone::{}\n", cluster_name, host_address,
-                                 host->locality().sub_zone()));
-        response.add(
-            fmt::format("{}::{}::canary::{}\n", cluster_name, host_address, host->canary()));
-        response.add(
-            fmt::format("{}::{}::priority::{}\n", cluster_name, host_address, host->priority()));
-        response.add(fmt::format(
-            "{}::{}::success_rate::{}\n", cluster_name, host_address,
-            host->outlierDetector().successRate(
-                Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin)));
-        response.add(fmt::format(
-            "{}::{}::local_origin_success_rate::{}\n", cluster_name, host_address,
-            host->outlierDetector().successRate(
-                Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin)));
+void writeClusterAsText(const Upstream::Cluster& cluster, Buffer::Instance& response) {
+  const std::string& cluster_name = cluster.info()->name();
+  response.add(fmt::format("{}::observability_name::{}\n", cluster_name,
+                           cluster.info()->observabilityName()));
+  addOutlierInfo(cluster_name, cluster.outlierDetector(), response);
+
+  addCircuitBreakerSettingsAsText(
+      cluster_name, "default",
+      cluster.info()->resourceManager(Upstream::ResourcePriority::Default), response);
+  addCircuitBreakerSettingsAsText(cluster_name, "high",
+                                  cluster.info()->resourceManager(Upstream::ResourcePriority::High),
+                                  response);
+
+  response.add(fmt::format("{}::added_via_api::{}\n", cluster_name, cluster.info()->addedViaApi()));
+  const auto& eds_service_name = cluster.info()->edsServiceName();
+  if (eds_service_name.has_value()) {
+    response.add(fmt::format("{}::eds_service_name::{}\n", cluster_name, *eds_service_name));
+  }
+  for (auto& host_set : cluster.prioritySet().hostSetsPerPriority()) {
+    for (auto& host : host_set->hosts()) {
+      const std::string& host_address = host->address()->asString();
+      std::map<absl::string_view, uint64_t> all_stats;
+      for (const auto& [counter_name, counter] : host->counters()) {
+        all_stats[counter_name] = counter.get().value();
       }
+
+      for (const auto& [gauge_name, gauge] : host->gauges()) {
+        all_stats[gauge_name] = gauge.get().value();
+      }
+
+      for (const auto& [stat_name, stat] : all_stats) {
+        response.add(fmt::format("{}::{}::{}::{}\n", cluster_name, host_address, stat_name, stat));
+      }
+
+      response.add(
+          fmt::format("{}::{}::hostname::{}\n", cluster_name, host_address, host->hostname()));
+      response.add(fmt::format("{}::{}::health_flags::{}\n", cluster_name, host_address,
+                               Upstream::HostUtility::healthFlagsToString(*host)));
+      response.add(fmt::format("{}::{}::weight::{}\n", cluster_name, host_address, host->weight()));
+      response.add(fmt::format("{}::{}::region::{}\n", cluster_name, host_address,
+                               host->locality().region()));
+      response.add(
+          fmt::format("{}::{}::zone::{}\n", cluster_name, host_address, host->locality().zone()));
+      response.add(fmt::format("{}::{}::sub_zone::{}\n", cluster_name, host_address,
+                               host->locality().sub_zone()));
+      response.add(fmt::format("{}::{}::canary::{}\n", cluster_name, host_address, host->canary()));
+      response.add(
+          fmt::format("{}::{}::priority::{}\n", cluster_name, host_address, host->priority()));
+      response.add(fmt::format(
+          "{}::{}::success_rate::{}\n", cluster_name, host_address,
+          host->outlierDetector().successRate(
+              Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin)));
+      response.add(fmt::format(
+          "{}::{}::local_origin_success_rate::{}\n", cluster_name, host_address,
+          host->outlierDetector().successRate(
+              Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin)));
     }
   }
 }
 
-void ClustersHandler::addOutlierInfo(const std::string& cluster_name,
-                                     const Upstream::Outlier::Detector* outlier_detector,
-                                     Buffer::Instance& response) {
-  if (outlier_detector) {
-    response.add(fmt::format(
-        "{}::outlier::success_rate_average::{:g}\n", cluster_name,
-        outlier_detector->successRateAverage(
-            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin)));
-    response.add(fmt::format(
-        "{}::outlier::success_rate_ejection_threshold::{:g}\n", cluster_name,
-        outlier_detector->successRateEjectionThreshold(
-            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::ExternalOrigin)));
-    response.add(fmt::format(
-        "{}::outlier::local_origin_success_rate_average::{:g}\n", cluster_name,
-        outlier_detector->successRateAverage(
-            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin)));
-    response.add(fmt::format(
-        "{}::outlier::local_origin_success_rate_ejection_threshold::{:g}\n", cluster_name,
-        outlier_detector->successRateEjectionThreshold(
-            Upstream::Outlier::DetectorHostMonitor::SuccessRateMonitorType::LocalOrigin)));
+// Streams the status of the active clusters out one cluster at a time, rather than building the
+// status of all of them before writing any. The names of the clusters are captured when the
+// request starts, and each chunk looks them up again so that clusters removed in the meantime are
+// skipped.
+class ClustersRequest : public Admin::Request {
+public:
+  ClustersRequest(Upstream::ClusterManager& cluster_manager, AdminStream& admin_stream)
+      : cluster_manager_(cluster_manager), admin_stream_(admin_stream),
+        streamer_(envoy::admin::v3::Clusters::default_instance(), "cluster_statuses") {}
+
+  // Admin::Request
+  Http::Code start(Http::ResponseHeaderMap& response_headers) override {
+    const auto format_value = Utility::formatParam(admin_stream_.queryParams());
+    if (format_value.has_value() && format_value.value() == "json") {
+      json_ = true;
+      response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Json);
+    }
+
+    // TODO(mattklein123): Add ability to see warming clusters in admin output.
+    auto all_clusters = cluster_manager_.clusters();
+    cluster_names_.reserve(all_clusters.active_clusters_.size());
+    for (const auto& [name, cluster_ref] : all_clusters.active_clusters_) {
+      UNREFERENCED_PARAMETER(cluster_ref);
+      cluster_names_.push_back(name);
+    }
+    return Http::Code::OK;
   }
+
+  bool nextChunk(Buffer::Instance& response) override {
+    auto all_clusters = cluster_manager_.clusters();
+    while (response.length() < chunk_size_ && next_ < cluster_names_.size()) {
+      auto iter = all_clusters.active_clusters_.find(cluster_names_[next_++]);
+      if (iter == all_clusters.active_clusters_.end()) {
+        continue;
+      }
+      if (json_) {
+        envoy::admin::v3::ClusterStatus cluster_status;
+        addClusterStatus(iter->second.get(), cluster_status);
+        streamer_.addElement(cluster_status, response);
+      } else {
+        writeClusterAsText(iter->second.get(), response);
+      }
+    }
+    if (next_ < cluster_names_.size()) {
+      return true;
+    }
+    if (json_) {
+      streamer_.finish(response);
+    }
+    return false;
+  }
+
+  // Sets the chunk size.
+  void setChunkSize(uint64_t chunk_size) { chunk_size_ = chunk_size; }
+
+private:
+  Upstream::ClusterManager& cluster_manager_;
+  AdminStream& admin_stream_;
+  std::vector<std::string> cluster_names_;
+  size_t next_{0};
+  bool json_{false};
+  uint64_t chunk_size_{Utility::DefaultChunkSize};
+  Utility::RepeatedFieldJsonStreamer streamer_;
+};
+
+} // namespace
+
+ClustersHandler::ClustersHandler(Server::Instance& server) : HandlerContextBase(server) {}
+
+Admin::RequestPtr ClustersHandler::makeRequest(AdminStream& admin_stream) {
+  return makeRequest(admin_stream, Utility::DefaultChunkSize);
+}
+
+Admin::RequestPtr ClustersHandler::makeRequest(AdminStream& admin_stream, uint64_t chunk_size) {
+  auto request = std::make_unique<ClustersRequest>(server_.clusterManager(), admin_stream);
+  request->setChunkSize(chunk_size);
+  return request;
 }
 
 } // namespace Server
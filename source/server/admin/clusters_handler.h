@@ -18,15 +18,16 @@ class ClustersHandler : public HandlerContextBase {
 public:
   ClustersHandler(Server::Instance& server);
 
-  Http::Code handlerClusters(Http::ResponseHeaderMap& response_headers, Buffer::Instance& response,
-                             AdminStream&);
-
-private:
-  void addOutlierInfo(const std::string& cluster_name,
-                      const Upstream::Outlier::Detector* outlier_detector,
-                      Buffer::Instance& response);
-  void writeClustersAsJson(Buffer::Instance& response);
-  void writeClustersAsText(Buffer::Instance& response);
+  /**
+   * @return a Request streaming the status of the active clusters out one cluster at a time.
+   */
+  Admin::RequestPtr makeRequest(AdminStream& admin_stream);
+
+  /**
+   * @return a Request as above, which ends each chunk once it has grown to at least chunk_size
+   * bytes rather than Utility::DefaultChunkSize.
+   */
+  Admin::RequestPtr makeRequest(AdminStream& admin_stream, uint64_t chunk_size);
 };
 
 } // namespace Server
@@ -152,106 +152,237 @@ buildNameMatcher(const Http::Utility::QueryParams& params) {
   }
 }
 
-} // namespace
+// Streams a config dump out one config, or one resource when a resource is requested, at a time.
+// Unless a mask is given, the config tracker callbacks are only invoked once the previous config
+// has been written, so only one config is held in memory at a time in addition to the chunk.
+class ConfigDumpRequest : public Admin::Request {
+public:
+  ConfigDumpRequest(ConfigTracker::CbsMap callbacks_map, AdminStream& admin_stream)
+      : callbacks_map_(std::move(callbacks_map)), admin_stream_(admin_stream),
+        streamer_(envoy::admin::v3::ConfigDump::default_instance(), "configs") {}
+
+  // Admin::Request
+  Http::Code start(Http::ResponseHeaderMap& response_headers) override {
+    Http::Utility::QueryParams query_params = admin_stream_.queryParams();
+    const auto resource = resourceParam(query_params);
+    mask_ = maskParam(query_params);
+    absl::StatusOr<Matchers::StringMatcherPtr> name_matcher = buildNameMatcher(query_params);
+    if (!name_matcher.ok()) {
+      response_.add(name_matcher.status().ToString());
+      response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Text);
+      return Http::Code::BadRequest;
+    }
+    name_matcher_ = std::move(*name_matcher);
 
-ConfigDumpHandler::ConfigDumpHandler(ConfigTracker& config_tracker, Server::Instance& server)
-    : HandlerContextBase(server), config_tracker_(config_tracker) {}
+    absl::optional<std::pair<Http::Code, std::string>> err;
+    if (resource.has_value()) {
+      err = prepareResource(resource.value());
+    } else {
+      err = prepareAllConfigs();
+    }
+    if (err.has_value()) {
+      response_headers.addReference(Http::Headers::get().XContentTypeOptions,
+                                    Http::Headers::get().XContentTypeOptionValues.Nosniff);
+      response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Text);
+      response_.add(err.value().second);
+      return err.value().first;
+    }
 
-Http::Code ConfigDumpHandler::handlerConfigDump(Http::ResponseHeaderMap& response_headers,
-                                                Buffer::Instance& response,
-                                                AdminStream& admin_stream) const {
-  Http::Utility::QueryParams query_params = admin_stream.queryParams();
-  const auto resource = resourceParam(query_params);
-  const auto mask = maskParam(query_params);
-  const bool include_eds = shouldIncludeEdsInDump(query_params);
-  const absl::StatusOr<Matchers::StringMatcherPtr> name_matcher = buildNameMatcher(query_params);
-  if (!name_matcher.ok()) {
-    response.add(name_matcher.status().ToString());
-    response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Text);
-    return Http::Code::BadRequest;
+    streaming_ = true;
+    response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Json);
+    return Http::Code::OK;
   }
 
-  envoy::admin::v3::ConfigDump dump;
-
-  absl::optional<std::pair<Http::Code, std::string>> err;
-  if (resource.has_value()) {
-    err = addResourceToDump(dump, mask, resource.value(), **name_matcher, include_eds);
-  } else {
-    err = addAllConfigToDump(dump, mask, **name_matcher, include_eds);
-  }
-  if (err.has_value()) {
-    response_headers.addReference(Http::Headers::get().XContentTypeOptions,
-                                  Http::Headers::get().XContentTypeOptionValues.Nosniff);
-    response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Text);
-    response.add(err.value().second);
-    return err.value().first;
+  bool nextChunk(Buffer::Instance& response) override {
+    response.move(response_);
+    if (!streaming_) {
+      return false;
+    }
+    while (response.length() < chunk_size_) {
+      const Protobuf::Message* config = nextConfig();
+      if (config == nullptr) {
+        streamer_.finish(response);
+        return false;
+      }
+      ProtobufWkt::Any any;
+      any.PackFrom(*config);
+      MessageUtil::redact(any);
+      streamer_.addElement(any, response);
+    }
+    return true;
   }
-  MessageUtil::redact(dump);
 
-  response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Json);
-  response.add(MessageUtil::getJsonStringFromMessageOrError(dump, true)); // pretty-print
-  return Http::Code::OK;
-}
+  // Sets the chunk size.
+  void setChunkSize(uint64_t chunk_size) { chunk_size_ = chunk_size; }
+
+private:
+  /**
+   * Finds the config containing the passed resource, applying the mask to each of its elements.
+   * @return absl::nullopt on success, else the Http::Code and an error message that should be added
+   * to the admin response.
+   */
+  absl::optional<std::pair<Http::Code, std::string>> prepareResource(const std::string& resource) {
+    for (const auto& [name, callback] : callbacks_map_) {
+      UNREFERENCED_PARAMETER(name);
+      ProtobufTypes::MessagePtr message = callback(*name_matcher_);
+      ASSERT(message);
+
+      const Protobuf::FieldDescriptor* field_descriptor =
+          message->GetDescriptor()->FindFieldByName(resource);
+      if (!field_descriptor) {
+        continue;
+      } else if (!field_descriptor->is_repeated()) {
+        return absl::optional<std::pair<Http::Code, std::string>>{std::make_pair(
+            Http::Code::BadRequest,
+            fmt::format("{} is not a repeated field. Use ?mask={} to get only this field",
+                        field_descriptor->name(), field_descriptor->name()))};
+      }
 
-absl::optional<std::pair<Http::Code, std::string>> ConfigDumpHandler::addResourceToDump(
-    envoy::admin::v3::ConfigDump& dump, const absl::optional<std::string>& mask,
-    const std::string& resource, const Matchers::StringMatcher& name_matcher,
-    bool include_eds) const {
-  Envoy::Server::ConfigTracker::CbsMap callbacks_map = config_tracker_.getCallbacksMap();
-  if (include_eds) {
-    // TODO(mattklein123): Add ability to see warming clusters in admin output.
-    auto all_clusters = server_.clusterManager().clusters();
-    if (!all_clusters.active_clusters_.empty()) {
-      callbacks_map.emplace("endpoint", [this](const Matchers::StringMatcher& name_matcher) {
-        return dumpEndpointConfigs(name_matcher);
-      });
+      if (mask_.has_value()) {
+        Protobuf::FieldMask field_mask;
+        ProtobufUtil::FieldMaskUtil::FromString(mask_.value(), &field_mask);
+        const Protobuf::Reflection* reflection = message->GetReflection();
+        const int field_size = reflection->FieldSize(*message, field_descriptor);
+        for (int i = 0; i < field_size; ++i) {
+          if (!trimResourceMessage(field_mask, *reflection->MutableRepeatedMessage(
+                                                   message.get(), field_descriptor, i))) {
+            return absl::optional<std::pair<Http::Code, std::string>>{std::make_pair(
+                Http::Code::BadRequest, absl::StrCat("FieldMask ", field_mask.DebugString(),
+                                                     " could not be successfully used."))};
+          }
+        }
+      }
+
+      // We found the desired resource so there is no need to continue iterating over
+      // the other keys.
+      resource_message_ = std::move(message);
+      resource_field_ = field_descriptor;
+      return absl::nullopt;
     }
-  }
 
-  for (const auto& [name, callback] : callbacks_map) {
-    UNREFERENCED_PARAMETER(name);
-    ProtobufTypes::MessagePtr message = callback(name_matcher);
-    ASSERT(message);
+    return absl::optional<std::pair<Http::Code, std::string>>{
+        std::make_pair(Http::Code::NotFound, fmt::format("{} not found in config dump", resource))};
+  }
 
-    auto field_descriptor = message->GetDescriptor()->FindFieldByName(resource);
-    const Protobuf::Reflection* reflection = message->GetReflection();
-    if (!field_descriptor) {
-      continue;
-    } else if (!field_descriptor->is_repeated()) {
-      return absl::optional<std::pair<Http::Code, std::string>>{std::make_pair(
-          Http::Code::BadRequest,
-          fmt::format("{} is not a repeated field. Use ?mask={} to get only this field",
-                      field_descriptor->name(), field_descriptor->name()))};
+  /**
+   * Prepares to dump all configs. Configs are generated lazily unless there is a mask, in which
+   * case they are generated and trimmed up front, as it is an error for the mask to apply to none
+   * of them.
+   * @return absl::nullopt on success, else the Http::Code and an error message that should be added
+   * to the admin response.
+   */
+  absl::optional<std::pair<Http::Code, std::string>> prepareAllConfigs() {
+    next_callback_ = callbacks_map_.begin();
+    if (!mask_.has_value()) {
+      return absl::nullopt;
     }
 
-    auto repeated = reflection->GetRepeatedPtrField<Protobuf::Message>(*message, field_descriptor);
-    for (Protobuf::Message& msg : repeated) {
-      if (mask.has_value()) {
-        Protobuf::FieldMask field_mask;
-        ProtobufUtil::FieldMaskUtil::FromString(mask.value(), &field_mask);
-        if (!trimResourceMessage(field_mask, msg)) {
-          return absl::optional<std::pair<Http::Code, std::string>>{std::make_pair(
-              Http::Code::BadRequest, absl::StrCat("FieldMask ", field_mask.DebugString(),
-                                                   " could not be successfully used."))};
-        }
+    Protobuf::FieldMask field_mask;
+    ProtobufUtil::FieldMaskUtil::FromString(mask_.value(), &field_mask);
+    for (const auto& [name, callback] : callbacks_map_) {
+      UNREFERENCED_PARAMETER(name);
+      ProtobufTypes::MessagePtr message = callback(*name_matcher_);
+      ASSERT(message);
+
+      // We don't use trimMessage() above here since masks don't support
+      // indexing through repeated fields. We don't return error on failure
+      // because different callback return types will have different valid
+      // field masks.
+      if (checkFieldMaskAndTrimMessage(field_mask, *message)) {
+        masked_configs_.push_back(std::move(message));
       }
-      auto* config = dump.add_configs();
-      config->PackFrom(msg);
     }
-
-    // We found the desired resource so there is no need to continue iterating over
-    // the other keys.
+    if (masked_configs_.empty()) {
+      return absl::optional<std::pair<Http::Code, std::string>>{
+          std::make_pair(Http::Code::BadRequest,
+                         absl::StrCat("FieldMask ", *mask_,
+                                      " could not be successfully applied to any configs."))};
+    }
     return absl::nullopt;
   }
 
-  return absl::optional<std::pair<Http::Code, std::string>>{
-      std::make_pair(Http::Code::NotFound, fmt::format("{} not found in config dump", resource))};
+  /**
+   * @return the next config or resource to dump, or nullptr once all have been dumped. The
+   * returned message is valid until the next call.
+   */
+  const Protobuf::Message* nextConfig() {
+    if (resource_field_ != nullptr) {
+      const Protobuf::Reflection* reflection = resource_message_->GetReflection();
+      if (next_index_ == reflection->FieldSize(*resource_message_, resource_field_)) {
+        return nullptr;
+      }
+      return &reflection->GetRepeatedMessage(*resource_message_, resource_field_, next_index_++);
+    }
+    if (mask_.has_value()) {
+      if (next_index_ == static_cast<int>(masked_configs_.size())) {
+        return nullptr;
+      }
+      current_config_ = std::move(masked_configs_[next_index_++]);
+    } else {
+      if (next_callback_ == callbacks_map_.end()) {
+        return nullptr;
+      }
+      current_config_ = next_callback_->second(*name_matcher_);
+      ASSERT(current_config_);
+      ++next_callback_;
+    }
+    return current_config_.get();
+  }
+
+  const ConfigTracker::CbsMap callbacks_map_;
+  AdminStream& admin_stream_;
+  absl::optional<std::string> mask_;
+  Matchers::StringMatcherPtr name_matcher_;
+  ConfigTracker::CbsMap::const_iterator next_callback_;
+  std::vector<ProtobufTypes::MessagePtr> masked_configs_;
+  ProtobufTypes::MessagePtr current_config_;
+  ProtobufTypes::MessagePtr resource_message_;
+  const Protobuf::FieldDescriptor* resource_field_{};
+  int next_index_{0};
+  Utility::RepeatedFieldJsonStreamer streamer_;
+  Buffer::OwnedImpl response_;
+  bool streaming_{false};
+  uint64_t chunk_size_{Utility::DefaultChunkSize};
+};
+
+} // namespace
+
+ConfigDumpHandler::ConfigDumpHandler(ConfigTracker& config_tracker, Server::Instance& server)
+    : HandlerContextBase(server), config_tracker_(config_tracker) {}
+
+Admin::UrlHandler ConfigDumpHandler::configDumpHandler() {
+  return {
+      "/config_dump",
+      "dump current Envoy configs (experimental)",
+      [this](AdminStream& admin_stream) -> Admin::RequestPtr { return makeRequest(admin_stream); },
+      false,
+      false,
+      {{Admin::ParamDescriptor::Type::String, "resource", "The resource to dump"},
+       {Admin::ParamDescriptor::Type::String, "mask",
+        "The mask to apply. When both resource and mask are specified, "
+        "the mask is applied to every element in the desired repeated field so that only a "
+        "subset of fields are returned. The mask is parsed as a ProtobufWkt::FieldMask"},
+       {Admin::ParamDescriptor::Type::String, "name_regex",
+        "Dump only the currently loaded configurations whose names match the specified "
+        "regex. Can be used with both resource and mask query parameters."},
+       {Admin::ParamDescriptor::Type::Boolean, "include_eds",
+        "Dump currently loaded configuration including EDS. See the response definition "
+        "for more information"}}};
+}
+
+Admin::RequestPtr ConfigDumpHandler::makeRequest(AdminStream& admin_stream) {
+  return makeRequest(admin_stream, Utility::DefaultChunkSize);
+}
+
+Admin::RequestPtr ConfigDumpHandler::makeRequest(AdminStream& admin_stream, uint64_t chunk_size) {
+  auto request = std::make_unique<ConfigDumpRequest>(
+      callbacksMap(shouldIncludeEdsInDump(admin_stream.queryParams())), admin_stream);
+  request->setChunkSize(chunk_size);
+  return request;
 }
 
-absl::optional<std::pair<Http::Code, std::string>> ConfigDumpHandler::addAllConfigToDump(
-    envoy::admin::v3::ConfigDump& dump, const absl::optional<std::string>& mask,
-    const Matchers::StringMatcher& name_matcher, bool include_eds) const {
-  Envoy::Server::ConfigTracker::CbsMap callbacks_map = config_tracker_.getCallbacksMap();
+ConfigTracker::CbsMap ConfigDumpHandler::callbacksMap(bool include_eds) const {
+  ConfigTracker::CbsMap callbacks_map = config_tracker_.getCallbacksMap();
   if (include_eds) {
     // TODO(mattklein123): Add ability to see warming clusters in admin output.
     auto all_clusters = server_.clusterManager().clusters();
@@ -261,33 +392,7 @@ absl::optional<std::pair<Http::Code, std::string>> ConfigDumpHandler::addAllConf
       });
     }
   }
-
-  for (const auto& [name, callback] : callbacks_map) {
-    UNREFERENCED_PARAMETER(name);
-    ProtobufTypes::MessagePtr message = callback(name_matcher);
-    ASSERT(message);
-
-    if (mask.has_value()) {
-      Protobuf::FieldMask field_mask;
-      ProtobufUtil::FieldMaskUtil::FromString(mask.value(), &field_mask);
-      // We don't use trimMessage() above here since masks don't support
-      // indexing through repeated fields. We don't return error on failure
-      // because different callback return types will have different valid
-      // field masks.
-      if (!checkFieldMaskAndTrimMessage(field_mask, *message)) {
-        continue;
-      }
-    }
-
-    auto* config = dump.add_configs();
-    config->PackFrom(*message);
-  }
-  if (dump.configs().empty() && mask.has_value()) {
-    return absl::optional<std::pair<Http::Code, std::string>>{std::make_pair(
-        Http::Code::BadRequest,
-        absl::StrCat("FieldMask ", *mask, " could not be successfully applied to any configs."))};
-  }
-  return absl::nullopt;
+  return callbacks_map;
 }
 
 ProtobufTypes::MessagePtr
@@ -22,22 +22,26 @@ class ConfigDumpHandler : public HandlerContextBase {
 public:
   ConfigDumpHandler(ConfigTracker& config_tracker, Server::Instance& server);
 
-  Http::Code handlerConfigDump(Http::ResponseHeaderMap& response_headers,
-                               Buffer::Instance& response, AdminStream&) const;
+  /**
+   * @return the UrlHandler for /config_dump, which streams the dump out one config, or one
+   * resource when a resource is requested, at a time.
+   */
+  Admin::UrlHandler configDumpHandler();
+
+  Admin::RequestPtr makeRequest(AdminStream& admin_stream);
+
+  /**
+   * @return a Request as above, which ends each chunk once it has grown to at least chunk_size
+   * bytes rather than Utility::DefaultChunkSize.
+   */
+  Admin::RequestPtr makeRequest(AdminStream& admin_stream, uint64_t chunk_size);
 
 private:
-  absl::optional<std::pair<Http::Code, std::string>>
-  addAllConfigToDump(envoy::admin::v3::ConfigDump& dump, const absl::optional<std::string>& mask,
-                     const Matchers::StringMatcher& name_matcher, bool include_eds) const;
   /**
-   * Add the config matching the passed resource to the passed config dump.
-   * @return absl::nullopt on success, else the Http::Code and an error message that should be added
-   * to the admin response.
+   * @return the config tracker callbacks, along with one dumping endpoints if `include_eds` is set
+   * and there are active clusters.
    */
-  absl::optional<std::pair<Http::Code, std::string>>
-  addResourceToDump(envoy::admin::v3::ConfigDump& dump, const absl::optional<std::string>& mask,
-                    const std::string& resource, const Matchers::StringMatcher& name_matcher,
-                    bool include_eds) const;
+  ConfigTracker::CbsMap callbacksMap(bool include_eds) const;
 
   /**
    * Helper methods to add endpoints config
@@ -37,8 +37,6 @@ class StatsRequest : public Admin::Request {
 public:
   using UrlHandlerFn = std::function<Admin::UrlHandler()>;
 
-  static constexpr uint64_t DefaultChunkSize = 2 * 1000 * 1000;
-
   StatsRequest(Stats::Store& stats, const StatsParams& params,
                UrlHandlerFn url_handler_fn = nullptr);
 
@@ -111,7 +109,7 @@ private:
   absl::string_view phase_string_{"text readouts"};
   Buffer::OwnedImpl response_;
   UrlHandlerFn url_handler_fn_;
-  uint64_t chunk_size_{DefaultChunkSize};
+  uint64_t chunk_size_{Utility::DefaultChunkSize};
 };
 
 } // namespace Server
@@ -2,6 +2,10 @@
 
 #include "source/common/common/enum_to_int.h"
 #include "source/common/http/headers.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/strings/str_replace.h"
+#include "absl/strings/strip.h"
 
 namespace Envoy {
 namespace Server {
@@ -97,6 +101,29 @@ absl::optional<std::string> queryParam(const Http::Utility::QueryParams& params,
   return absl::nullopt;
 }
 
+void RepeatedFieldJsonStreamer::addElement(const Protobuf::Message& element,
+                                           Buffer::Instance& response) {
+  if (empty_) {
+    response.addFragments({"{\n \"", field_name_, "\": [\n"});
+    empty_ = false;
+  } else {
+    response.add(",\n");
+  }
+  // The pretty-printer escapes newlines within strings, so every newline of the element's JSON is
+  // a line break which we indent to the element's depth within the array.
+  const std::string json = MessageUtil::getJsonStringFromMessageOrError(element, true);
+  response.addFragments(
+      {"  ", absl::StrReplaceAll(absl::StripSuffix(json, "\n"), {{"\n", "\n  "}})});
+}
+
+void RepeatedFieldJsonStreamer::finish(Buffer::Instance& response) {
+  if (empty_) {
+    response.add(MessageUtil::getJsonStringFromMessageOrError(empty_message_, true));
+  } else {
+    response.add("\n ]\n}\n");
+  }
+}
+
 } // namespace Utility
 } // namespace Server
 } // namespace Envoy
@@ -3,11 +3,13 @@
 #include <regex>
 
 #include "envoy/admin/v3/server_info.pb.h"
+#include "envoy/buffer/buffer.h"
 #include "envoy/init/manager.h"
 
 #include "source/common/http/codes.h"
 #include "source/common/http/header_map_impl.h"
 #include "source/common/http/utility.h"
+#include "source/common/protobuf/protobuf.h"
 
 namespace Envoy {
 namespace Server {
@@ -31,6 +33,41 @@ absl::optional<std::string> formatParam(const Http::Utility::QueryParams& params
 absl::optional<std::string> queryParam(const Http::Utility::QueryParams& params,
                                        const std::string& key);
 
+// Streaming admin handlers end a chunk once it grows beyond this size, so that it can be flushed to
+// the network before the next one is generated.
+constexpr uint64_t DefaultChunkSize = 2 * 1000 * 1000;
+
+/**
+ * Writes the pretty-printed JSON of a message with a single repeated message field one element at
+ * a time, so that large responses can be streamed out in chunks rather than built as a single
+ * proto and JSON string. The output is identical to pretty-printing the whole message at once.
+ */
+class RepeatedFieldJsonStreamer {
+public:
+  /**
+   * @param empty_message an empty instance of the message being written, rendered if no elements
+   *        are added.
+   * @param field_name the JSON name of the repeated field.
+   */
+  RepeatedFieldJsonStreamer(const Protobuf::Message& empty_message, absl::string_view field_name)
+      : empty_message_(empty_message), field_name_(field_name) {}
+
+  /**
+   * Writes the next element of the repeated field.
+   */
+  void addElement(const Protobuf::Message& element, Buffer::Instance& response);
+
+  /**
+   * Writes the end of the message, after the last element.
+   */
+  void finish(Buffer::Instance& response);
+
+private:
+  const Protobuf::Message& empty_message_;
+  const std::string field_name_;
+  bool empty_{true};
+};
+
 } // namespace Utility
 } // namespace Server
 } // namespace Envoy
@@ -109,7 +109,8 @@ void ValidationInstance::initialize(const Options& options,
   }
 
   secret_manager_ = std::make_unique<Secret::SecretManagerImpl>(admin().getConfigTracker());
-  ssl_context_manager_ = createContextManager("ssl_context_manager", api_->timeSource());
+  ssl_context_manager_ =
+      createContextManager("ssl_context_manager", api_->timeSource(), runtime());
   cluster_manager_factory_ = std::make_unique<Upstream::ValidationClusterManagerFactory>(
       admin(), runtime(), stats(), threadLocal(), dnsResolver(), sslContextManager(), dispatcher(),
       localInfo(), *secret_manager_, messageValidationContext(), *api_, http_context_,
@@ -15,6 +15,7 @@
 #include "source/common/access_log/access_log_impl.h"
 #include "source/common/api/os_sys_calls_impl.h"
 #include "source/common/common/assert.h"
+#include "source/common/common/cleanup.h"
 #include "source/common/config/utility.h"
 #include "source/common/network/connection_balancer_impl.h"
 #include "source/common/network/resolver_impl.h"
@@ -719,11 +720,21 @@ void ListenerImpl::validateFilterChains() {
 void ListenerImpl::buildFilterChains() {
   transport_factory_context_->setInitManager(*dynamic_init_manager_);
   ListenerFilterChainFactoryBuilder builder(*this, *transport_factory_context_);
+  // The server TLS contexts of the new filter chains are independent of each other and expensive
+  // to build, so they are queued while the filter chains are added and then built concurrently.
+  // None of them is visible until the listener is published.
+  Ssl::ContextManager& ssl_context_manager = parent_.server_.sslContextManager();
+  ssl_context_manager.startServerContextBatch();
+  Cleanup cancel_batch(
+      [&ssl_context_manager]() { ssl_context_manager.cancelServerContextBatch(); });
   filter_chain_manager_->addFilterChains(
       config_.has_filter_chain_matcher() ? &config_.filter_chain_matcher() : nullptr,
       config_.filter_chains(),
       config_.has_default_filter_chain() ? &config_.default_filter_chain() : nullptr, builder,
       *filter_chain_manager_);
+  ssl_context_manager.finishServerContextBatch(parent_.server_.api().threadFactory(),
+                                               parent_.server_.options().concurrency());
+  cancel_batch.cancel();
 }
 
 void ListenerImpl::buildConnectionBalancer(const Network::Address::Instance& address) {
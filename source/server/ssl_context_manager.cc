@@ -27,6 +27,18 @@ class SslContextManagerNoTlsStub final : public Envoy::Ssl::ContextManager {
     throwException();
   }
 
+  void createSslServerContextDeferred(Stats::Scope& /* scope */,
+                                      const Envoy::Ssl::ServerContextConfig& /* config */,
+                                      const std::vector<std::string>& /* server_names */,
+                                      ServerContextCb /* cb */) override {
+    throwException();
+  }
+
+  void startServerContextBatch() override {}
+  void finishServerContextBatch(Thread::ThreadFactory& /* thread_factory */,
+                                uint32_t /* max_threads */) override {}
+  void cancelServerContextBatch() override {}
+
   absl::optional<uint32_t> daysUntilFirstCertExpires() const override {
     return absl::make_optional(std::numeric_limits<uint32_t>::max());
   }
@@ -51,11 +63,11 @@ private:
 };
 
 Ssl::ContextManagerPtr createContextManager(const std::string& factory_name,
-                                            TimeSource& time_source) {
+                                            TimeSource& time_source, Runtime::Loader& runtime) {
   Ssl::ContextManagerFactory* factory =
       Registry::FactoryRegistry<Ssl::ContextManagerFactory>::getFactory(factory_name);
   if (factory != nullptr) {
-    return factory->createContextManager(time_source);
+    return factory->createContextManager(time_source, runtime);
   }
 
   return std::make_unique<SslContextManagerNoTlsStub>();
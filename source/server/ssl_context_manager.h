@@ -1,13 +1,14 @@
 #pragma once
 
 #include "envoy/common/time.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context_manager.h"
 
 namespace Envoy {
 namespace Server {
 
 Ssl::ContextManagerPtr createContextManager(const std::string& factory_name,
-                                            TimeSource& time_source);
+                                            TimeSource& time_source, Runtime::Loader& runtime);
 
 } // namespace Server
 } // namespace Envoy
@@ -246,6 +246,21 @@ TEST_F(ThreadAsyncPtrTest, NameNotSpecifiedWait) {
   thread->join();
 }
 
+TEST_F(ThreadAsyncPtrTest, ParallelFor) {
+  std::vector<std::atomic<uint32_t>> calls(1000);
+  parallelFor(thread_factory_, 4, calls.size(), [&calls](size_t index) { calls[index]++; });
+  for (const auto& count : calls) {
+    EXPECT_EQ(1, count);
+  }
+
+  // Fewer indices than threads, and no indices at all.
+  std::atomic<uint32_t> total{0};
+  parallelFor(thread_factory_, 8, 2, [&total](size_t) { total++; });
+  EXPECT_EQ(2, total);
+  parallelFor(thread_factory_, 8, 0, [&total](size_t) { total++; });
+  EXPECT_EQ(2, total);
+}
+
 } // namespace
 } // namespace Thread
 } // namespace Envoy
@@ -24,7 +24,9 @@
 #include "test/test_common/logging.h"
 #include "test/test_common/resources.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/test_time.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -32,10 +34,12 @@
 
 using testing::_;
 using testing::AtLeast;
+using testing::HasSubstr;
 using testing::InSequence;
 using testing::Invoke;
 using testing::IsSubstring;
 using testing::NiceMock;
+using testing::Not;
 using testing::Return;
 using testing::ReturnRef;
 
@@ -61,6 +65,7 @@ public:
   void setup() {
     grpc_mux_ = std::make_unique<GrpcMuxImpl>(
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
+        Thread::threadFactoryForTest(),
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v3.AggregatedDiscoveryService.StreamAggregatedResources"),
         random_, stats_, rate_limit_settings_, true, std::move(config_validators_),
@@ -70,6 +75,7 @@ public:
   void setup(const RateLimitSettings& custom_rate_limit_settings) {
     grpc_mux_ = std::make_unique<GrpcMuxImpl>(
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
+        Thread::threadFactoryForTest(),
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v3.AggregatedDiscoveryService.StreamAggregatedResources"),
         random_, stats_, custom_rate_limit_settings, true, std::move(config_validators_),
@@ -531,6 +537,125 @@ TEST_F(GrpcMuxImplTest, WildcardWatch) {
   }
 }
 
+// Counts the resources it decodes.
+class CountingResourceDecoder : public TestUtility::TestOpaqueResourceDecoderImpl<
+                                    envoy::config::endpoint::v3::ClusterLoadAssignment> {
+public:
+  CountingResourceDecoder() : TestOpaqueResourceDecoderImpl("cluster_name") {}
+
+  ProtobufTypes::MessagePtr decodeResource(const ProtobufWkt::Any& resource) override {
+    ++decoded_;
+    return TestOpaqueResourceDecoderImpl::decodeResource(resource);
+  }
+
+  uint32_t decoded_{};
+};
+
+// Resources whose bytes are unchanged since the last accepted response are not decoded again.
+TEST_F(GrpcMuxImplTest, ReuseUnchangedResources) {
+  setup();
+
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto resource_decoder = std::make_shared<CountingResourceDecoder>();
+  auto foo_sub = grpc_mux_->addWatch(type_url, {}, callbacks_, resource_decoder, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {}, "", true);
+  grpc_mux_->start();
+
+  envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment_x;
+  load_assignment_x.set_cluster_name("x");
+  envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment_y;
+  load_assignment_y.set_cluster_name("y");
+  const auto send_response = [&](const std::string& version) {
+    auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(type_url);
+    response->set_version_info(version);
+    response->add_resources()->PackFrom(load_assignment_x);
+    response->add_resources()->PackFrom(load_assignment_y);
+    EXPECT_CALL(callbacks_, onConfigUpdate(_, version))
+        .WillOnce(Invoke([&, version](const std::vector<DecodedResourceRef>& resources,
+                                      const std::string&) {
+          ASSERT_EQ(2, resources.size());
+          EXPECT_EQ(version, resources[0].get().version());
+          EXPECT_EQ(version, resources[1].get().version());
+          EXPECT_TRUE(TestUtility::protoEqual(resources[0].get().resource(), load_assignment_x));
+          EXPECT_TRUE(TestUtility::protoEqual(resources[1].get().resource(), load_assignment_y));
+        }));
+    expectSendMessage(type_url, {}, version);
+    grpc_mux_->grpcStreamForTest().onReceiveMessage(std::move(response));
+  };
+
+  send_response("1");
+  EXPECT_EQ(2, resource_decoder->decoded_);
+
+  // Only the changed resource is decoded.
+  load_assignment_y.mutable_policy()->mutable_overprovisioning_factor()->set_value(150);
+  send_response("2");
+  EXPECT_EQ(3, resource_decoder->decoded_);
+
+  send_response("3");
+  EXPECT_EQ(3, resource_decoder->decoded_);
+
+  {
+    TestScopedRuntime scoped_runtime;
+    scoped_runtime.mergeValues(
+        {{"envoy.reloadable_features.xds_reuse_unchanged_resources", "false"}});
+    send_response("4");
+    EXPECT_EQ(5, resource_decoder->decoded_);
+  }
+}
+
+// Large responses decoded on multiple threads are applied in order, and rejected for their first
+// invalid resource with the exception it raised.
+TEST_F(GrpcMuxImplTest, ParallelResourceDecoding) {
+  setup();
+
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  OpaqueResourceDecoderSharedPtr resource_decoder(
+      std::make_shared<TestUtility::TestOpaqueResourceDecoderImpl<
+          envoy::config::endpoint::v3::ClusterLoadAssignment>>("cluster_name"));
+  auto foo_sub = grpc_mux_->addWatch(type_url, {}, callbacks_, resource_decoder, {});
+  EXPECT_CALL(*async_client_, startRaw(_, _, _, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {}, "", true);
+  grpc_mux_->start();
+
+  constexpr int NumResources = 1024;
+  std::vector<envoy::config::endpoint::v3::ClusterLoadAssignment> load_assignments(NumResources);
+  for (int i = 0; i < NumResources; ++i) {
+    load_assignments[i].set_cluster_name(absl::StrCat("cluster_", i));
+  }
+  const auto make_response = [&](const std::string& version) {
+    auto response = std::make_unique<envoy::service::discovery::v3::DiscoveryResponse>();
+    response->set_type_url(type_url);
+    response->set_version_info(version);
+    for (const auto& load_assignment : load_assignments) {
+      response->add_resources()->PackFrom(load_assignment);
+    }
+    return response;
+  };
+
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"))
+      .WillOnce(Invoke([&](const std::vector<DecodedResourceRef>& resources, const std::string&) {
+        ASSERT_EQ(NumResources, resources.size());
+        for (int i = 0; i < NumResources; ++i) {
+          EXPECT_EQ(load_assignments[i].cluster_name(), resources[i].get().name());
+        }
+      }));
+  expectSendMessage(type_url, {}, "1");
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(make_response("1"));
+
+  load_assignments[300].clear_cluster_name();
+  load_assignments[700].mutable_policy()->mutable_overprovisioning_factor()->set_value(0);
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_, _))
+      .WillOnce(Invoke([](Envoy::Config::ConfigUpdateFailureReason, const EnvoyException* e) {
+        EXPECT_NE(nullptr, dynamic_cast<const ProtoValidationException*>(e));
+        EXPECT_THAT(e->what(), HasSubstr("ClusterName"));
+        EXPECT_THAT(e->what(), Not(HasSubstr("OverprovisioningFactor")));
+      }));
+  EXPECT_CALL(async_stream_, sendMessageRaw_(_, false));
+  grpc_mux_->grpcStreamForTest().onReceiveMessage(make_response("2"));
+}
+
 // Validate behavior when watches specify resources (potentially overlapping).
 TEST_F(GrpcMuxImplTest, WatchDemux) {
   setup();
@@ -0,0 +1,101 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures receiving a large state-of-the-world EDS response, i.e. parsing it and freeing it once
+// it has been applied, with the response parsed on the heap and on an arena.
+
+#include "envoy/config/endpoint/v3/endpoint.pb.h"
+#include "envoy/service/discovery/v3/discovery.pb.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/config/grpc_stream.h"
+#include "source/common/runtime/runtime_features.h"
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class GrpcStreamSpeedTest
+    : public GrpcStreamCallbacks<envoy::service::discovery::v3::DiscoveryResponse> {
+public:
+  explicit GrpcStreamSpeedTest(size_t response_bytes)
+      : grpc_stream_(this, std::make_unique<NiceMock<Grpc::MockAsyncClient>>(),
+                     *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+                         "envoy.service.endpoint.v3.EndpointDiscoveryService.StreamEndpoints"),
+                     random_, dispatcher_, store_, RateLimitSettings()) {
+    envoy::service::discovery::v3::DiscoveryResponse response;
+    response.set_version_info("1");
+    response.set_type_url("type.googleapis.com/envoy.config.endpoint.v3.ClusterLoadAssignment");
+    size_t resource_bytes = 0;
+    for (size_t i = 0; resource_bytes < response_bytes; ++i) {
+      envoy::config::endpoint::v3::ClusterLoadAssignment load_assignment;
+      load_assignment.set_cluster_name(absl::StrCat("cluster_", i));
+      auto* endpoints = load_assignment.add_endpoints();
+      for (uint32_t port = 0; port < 100; ++port) {
+        auto* socket_address = endpoints->add_lb_endpoints()
+                                   ->mutable_endpoint()
+                                   ->mutable_address()
+                                   ->mutable_socket_address();
+        socket_address->set_address("10.0.0.1");
+        socket_address->set_port_value(port);
+      }
+      response.add_resources()->PackFrom(load_assignment);
+      resource_bytes += load_assignment.ByteSizeLong();
+    }
+    response_ = response.SerializeAsString();
+  }
+
+  void receive(benchmark::State& state) {
+    Grpc::RawAsyncStreamCallbacks& raw_callbacks = grpc_stream_;
+    for (auto _ : state) { // NOLINT: Silences warning about dead store
+      state.PauseTiming();
+      auto buffer = std::make_unique<Buffer::OwnedImpl>(response_);
+      state.ResumeTiming();
+      raw_callbacks.onReceiveMessageRaw(std::move(buffer));
+    }
+    state.counters["response_bytes"] = response_.size();
+  }
+
+  // GrpcStreamCallbacks
+  void onStreamEstablished() override {}
+  void onEstablishmentFailure() override {}
+  void
+  onDiscoveryResponse(ResponseProtoPtr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
+                      ControlPlaneStats&) override {
+    benchmark::DoNotOptimize(message->resources_size());
+  }
+  void onWriteable() override {}
+
+private:
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Random::MockRandomGenerator> random_;
+  Stats::IsolatedStoreImpl store_;
+  GrpcStream<envoy::service::discovery::v3::DiscoveryRequest,
+             envoy::service::discovery::v3::DiscoveryResponse>
+      grpc_stream_;
+  std::string response_;
+};
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
+
+// Receives a synthetic response of about 50MB, parsed on an arena when the argument is 1.
+static void bmReceiveResponse(benchmark::State& state) {
+  Envoy::Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.xds_parse_responses_on_arena",
+                                       state.range(0) != 0);
+  const size_t response_bytes = Envoy::skipExpensiveBenchmarks() ? 1 << 20 : 50 << 20;
+  Envoy::Config::GrpcStreamSpeedTest speed_test(response_bytes);
+  speed_test.receive(state);
+}
+BENCHMARK(bmReceiveResponse)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
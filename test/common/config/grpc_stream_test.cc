@@ -1,5 +1,6 @@
 #include "envoy/service/discovery/v3/discovery.pb.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/config/grpc_stream.h"
 #include "source/common/protobuf/protobuf.h"
 
@@ -10,6 +11,7 @@
 #include "test/mocks/grpc/mocks.h"
 #include "test/test_common/logging.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -216,12 +218,38 @@ TEST_F(GrpcStreamTest, ReceiveMessage) {
   envoy::service::discovery::v3::DiscoveryResponse received_message;
   EXPECT_CALL(callbacks_, onDiscoveryResponse(_, _))
       .WillOnce([&received_message](
-                    std::unique_ptr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
+                    ResponseProtoPtr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
                     ControlPlaneStats&) { received_message = *message; });
   grpc_stream_.onReceiveMessage(std::move(response));
   EXPECT_TRUE(TestUtility::protoEqual(response_copy, received_message));
 }
 
+// Received responses are parsed on an arena unless disabled by runtime.
+TEST_F(GrpcStreamTest, ReceiveMessageRaw) {
+  envoy::service::discovery::v3::DiscoveryResponse response;
+  response.set_type_url("faketypeURL");
+  response.add_resources()->PackFrom(response);
+  Grpc::RawAsyncStreamCallbacks& raw_callbacks = grpc_stream_;
+
+  for (const bool on_arena : {true, false}) {
+    TestScopedRuntime scoped_runtime;
+    scoped_runtime.mergeValues({{"envoy.reloadable_features.xds_parse_responses_on_arena",
+                                 on_arena ? "true" : "false"}});
+    EXPECT_CALL(callbacks_, onDiscoveryResponse(_, _))
+        .WillOnce([&response, on_arena](
+                      ResponseProtoPtr<envoy::service::discovery::v3::DiscoveryResponse>&& message,
+                      ControlPlaneStats&) {
+          EXPECT_EQ(on_arena, message->GetArena() != nullptr);
+          EXPECT_TRUE(TestUtility::protoEqual(response, *message));
+        });
+    EXPECT_TRUE(raw_callbacks.onReceiveMessageRaw(
+        std::make_unique<Buffer::OwnedImpl>(response.SerializeAsString())));
+  }
+
+  EXPECT_CALL(callbacks_, onDiscoveryResponse(_, _)).Times(0);
+  EXPECT_FALSE(raw_callbacks.onReceiveMessageRaw(std::make_unique<Buffer::OwnedImpl>("\xff")));
+}
+
 // If the value has only ever been 0, the stat should remain unused, including after an attempt to
 // write a 0 to it.
 TEST_F(GrpcStreamTest, QueueSizeStat) {
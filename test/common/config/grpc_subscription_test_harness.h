@@ -22,6 +22,7 @@
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/upstream/cluster_manager.h"
 #include "test/test_common/resources.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -63,9 +64,9 @@ public:
     } else {
       mux_ = std::make_shared<Config::GrpcMuxImpl>(
           local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
-          *method_descriptor_, random_, stats_store_, rate_limit_settings_, true,
-          std::move(config_validators_), /*xds_resources_delegate=*/XdsResourcesDelegateOptRef(),
-          /*target_xds_authority=*/"");
+          Thread::threadFactoryForTest(), *method_descriptor_, random_, stats_store_,
+          rate_limit_settings_, true, std::move(config_validators_),
+          /*xds_resources_delegate=*/XdsResourcesDelegateOptRef(), /*target_xds_authority=*/"");
     }
     subscription_ = std::make_unique<GrpcSubscriptionImpl>(
         mux_, callbacks_, resource_decoder_, stats_, Config::TypeUrl::get().ClusterLoadAssignment,
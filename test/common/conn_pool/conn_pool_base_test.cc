@@ -81,6 +81,7 @@ public:
 class TestConnPoolImplBase : public ConnPoolImplBase {
 public:
   using ConnPoolImplBase::ConnPoolImplBase;
+  using ConnPoolImplBase::shouldPreconnectForPredictedStreams;
   ConnectionPool::Cancellable* newPendingStream(AttachContext& context,
                                                 bool can_send_early_data) override {
     auto entry = std::make_unique<TestPendingStream>(*this, context, can_send_early_data);
@@ -353,6 +354,68 @@ TEST_F(ConnPoolImplBaseTest, ExplicitPreconnectNotHealthy) {
   EXPECT_FALSE(pool_.maybePreconnectImpl(1));
 }
 
+class ConnPoolImplBaseRatePredictiveTest : public Event::TestUsingSimulatedTime,
+                                           public ConnPoolImplBaseTest {
+public:
+  ConnPoolImplBaseRatePredictiveTest() {
+    cluster_->rate_predictive_preconnect_ =
+        Upstream::ClusterInfo::RatePredictivePreconnect{std::chrono::milliseconds(1000), 0.5};
+  }
+};
+
+TEST_F(ConnPoolImplBaseRatePredictiveTest, PreconnectForPredictedStreams) {
+  // The first stream needs one connection and predicts one more stream in this interval.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(2);
+  pool_.newStreamImpl(context_, /*can_send_early_data=*/false);
+  CHECK_STATE(0 /*active*/, 1 /*pending*/, 2 /*connecting capacity*/);
+  EXPECT_FALSE(clients_[0]->preconnected_);
+  EXPECT_TRUE(clients_[1]->preconnected_);
+
+  clients_[0]->onEvent(Network::ConnectionEvent::Connected);
+  clients_[1]->onEvent(Network::ConnectionEvent::Connected);
+  CHECK_STATE(1 /*active*/, 0 /*pending*/, 1 /*connecting capacity*/);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_preconnect_hit_.value());
+
+  // The second stream uses the preconnected connection, and two more streams are predicted.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(2);
+  pool_.newStreamImpl(context_, /*can_send_early_data=*/false);
+  CHECK_STATE(2 /*active*/, 0 /*pending*/, 2 /*connecting capacity*/);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_hit_.value());
+
+  // Closing a preconnected connection which was never used is waste, and it is not replaced as
+  // no stream arrived.
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(0);
+  clients_[3]->close();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_waste_.value());
+
+  pool_.destructAllConnections();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_hit_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_preconnect_waste_.value());
+}
+
+TEST_F(ConnPoolImplBaseRatePredictiveTest, PredictionDecays) {
+  EXPECT_CALL(pool_, instantiateActiveClient).Times(AnyNumber());
+  EXPECT_CALL(pool_, onPoolFailure).Times(AnyNumber());
+
+  // Four streams arrive in the first interval. Each is pending, and as many streams are predicted.
+  for (int i = 0; i < 4; ++i) {
+    pool_.newStreamImpl(context_, /*can_send_early_data=*/false);
+  }
+  CHECK_STATE(0 /*active*/, 4 /*pending*/, 8 /*connecting capacity*/);
+  EXPECT_FALSE(pool_.shouldPreconnectForPredictedStreams());
+  EXPECT_TRUE(pool_.shouldPreconnectForPredictedStreams(1));
+
+  // After two intervals without streams, the average of 2 streams per interval has decayed to 0.5,
+  // so only the new stream itself is predicted.
+  simTime().advanceTimeWait(std::chrono::milliseconds(3000));
+  pool_.newStreamImpl(context_, /*can_send_early_data=*/false);
+  CHECK_STATE(0 /*active*/, 5 /*pending*/, 8 /*connecting capacity*/);
+  EXPECT_FALSE(pool_.shouldPreconnectForPredictedStreams(2));
+  EXPECT_TRUE(pool_.shouldPreconnectForPredictedStreams(3));
+
+  pool_.destructAllConnections();
+}
+
 TEST_F(ConnPoolImplDispatcherBaseTest, MaxConnectionDurationTimerNull) {
   // Force a null max connection duration optional.
   // newActiveClientAndStream() will expect the connection duration timer to remain null.
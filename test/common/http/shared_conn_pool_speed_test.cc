@@ -0,0 +1,196 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the latency a shared connection pool adds to a header only request and response by
+// handing the stream off to an owner thread, compared to using a pool on the worker itself. In
+// exchange, a cluster with N workers opens owner_threads rather than N connections to each host;
+// the upstream_connections counter reports the connections the pools opened for the given number
+// of workers, each of which sends every N-th request.
+
+#include <memory>
+#include <vector>
+
+#include "source/common/common/thread.h"
+#include "source/common/event/libevent.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/http/shared_conn_pool.h"
+#include "source/common/network/socket_impl.h"
+#include "source/common/stream_info/stream_info_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/upstream/cluster_info.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+// A stream which responds to a header only request with a header only response. Stands in for a
+// stream on an established HTTP/2 connection.
+class LoopbackStream : public RequestEncoder, public Stream {
+public:
+  // RequestEncoder
+  Status encodeHeaders(const RequestHeaderMap&, bool end_stream) override {
+    if (end_stream) {
+      decoder_->decodeHeaders(ResponseHeaderMapImpl::create(), true);
+    }
+    return okStatus();
+  }
+  void encodeTrailers(const RequestTrailerMap&) override {}
+  void enableTcpTunneling() override {}
+
+  // StreamEncoder
+  void encodeData(Buffer::Instance&, bool) override {}
+  Stream& getStream() override { return *this; }
+  void encodeMetadata(const MetadataMapVector&) override {}
+  Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+  // Stream
+  void addCallbacks(StreamCallbacks&) override {}
+  void removeCallbacks(StreamCallbacks&) override {}
+  void resetStream(StreamResetReason) override {}
+  void readDisable(bool) override {}
+  uint32_t bufferLimit() const override { return 0; }
+  const Network::ConnectionInfoProvider& connectionInfoProvider() override {
+    return *connection_info_;
+  }
+  void setFlushTimeout(std::chrono::milliseconds) override {}
+  void setAccount(Buffer::BufferMemoryAccountSharedPtr) override {}
+  const StreamInfo::BytesMeterSharedPtr& bytesMeter() override { return bytes_meter_; }
+
+  ResponseDecoder* decoder_{};
+  std::shared_ptr<Network::ConnectionInfoSetterImpl> connection_info_{
+      std::make_shared<Network::ConnectionInfoSetterImpl>(nullptr, nullptr)};
+  StreamInfo::BytesMeterSharedPtr bytes_meter_{std::make_shared<StreamInfo::BytesMeter>()};
+};
+
+// A pool with a single always ready loopback stream. Its connection is counted when the first
+// stream is created.
+class LoopbackConnPool : public ConnectionPool::Instance {
+public:
+  LoopbackConnPool(TimeSource& time_source, uint64_t& connections)
+      : stream_info_(time_source, stream_.connection_info_), connections_(connections) {}
+
+  // ConnectionPool::Instance
+  void addIdleCallback(IdleCb) override {}
+  bool isIdle() const override { return true; }
+  void drainConnections(Envoy::ConnectionPool::DrainBehavior) override {}
+  Upstream::HostDescriptionConstSharedPtr host() const override { return nullptr; }
+  bool maybePreconnect(float) override { return false; }
+  bool hasActiveConnections() const override { return false; }
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks,
+                                         const StreamOptions&) override {
+    if (!connected_) {
+      connected_ = true;
+      ++connections_;
+    }
+    stream_.decoder_ = &response_decoder;
+    callbacks.onPoolReady(stream_, nullptr, stream_info_, Protocol::Http2);
+    return nullptr;
+  }
+  absl::string_view protocolDescription() const override { return "loopback"; }
+
+private:
+  LoopbackStream stream_;
+  StreamInfo::StreamInfoImpl stream_info_;
+  uint64_t& connections_;
+  bool connected_{};
+};
+
+// Sends a header only request once the pool is ready and waits for the response.
+class Client : public ConnectionPool::Callbacks, public ResponseDecoder {
+public:
+  // ConnectionPool::Callbacks
+  void onPoolFailure(ConnectionPool::PoolFailureReason, absl::string_view,
+                     Upstream::HostDescriptionConstSharedPtr) override {
+    done_ = true;
+  }
+  void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr,
+                   StreamInfo::StreamInfo&, absl::optional<Protocol>) override {
+    auto status = encoder.encodeHeaders(request_headers_, true);
+    ASSERT(status.ok());
+  }
+
+  // ResponseDecoder
+  void decode1xxHeaders(ResponseHeaderMapPtr&&) override {}
+  void decodeHeaders(ResponseHeaderMapPtr&&, bool end_stream) override { done_ = end_stream; }
+  void decodeData(Buffer::Instance&, bool end_stream) override { done_ = end_stream; }
+  void decodeTrailers(ResponseTrailerMapPtr&&) override { done_ = true; }
+  void decodeMetadata(MetadataMapPtr&&) override {}
+  void dumpState(std::ostream&, int) const override {}
+
+  TestRequestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  bool done_{};
+};
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void bmWorkerPool(benchmark::State& state) {
+  if (!Event::Libevent::Global::initialized()) {
+    Event::Libevent::Global::initialize();
+  }
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("worker");
+  uint64_t connections = 0;
+  std::vector<std::unique_ptr<LoopbackConnPool>> pools;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    pools.push_back(std::make_unique<LoopbackConnPool>(api->timeSource(), connections));
+  }
+
+  size_t worker = 0;
+  for (auto _ : state) { // NOLINT(clang-analyzer-deadcode.DeadStores)
+    Client client;
+    pools[worker++ % pools.size()]->newStream(client, client, {false, false});
+    ASSERT(client.done_);
+  }
+  state.counters["upstream_connections"] = connections;
+}
+BENCHMARK(bmWorkerPool)->Arg(16)->Arg(64);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void bmSharedPool(benchmark::State& state) {
+  if (!Event::Libevent::Global::initialized()) {
+    Event::Libevent::Global::initialize();
+  }
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("worker");
+  Event::DispatcherPtr owner_dispatcher = api->allocateDispatcher("owner");
+  // Only read once the owner thread is joined.
+  uint64_t connections = 0;
+  LoopbackConnPool owner_pool(api->timeSource(), connections);
+  Thread::ThreadPtr owner_thread = api->threadFactory().createThread(
+      [&owner_dispatcher]() { owner_dispatcher->run(Event::Dispatcher::RunType::RunUntilExit); });
+
+  // The workers all run on this thread, which only changes how their streams are scheduled.
+  auto cluster = std::make_shared<testing::NiceMock<Upstream::MockClusterInfo>>();
+  auto host = Upstream::makeTestHost(cluster, "tcp://127.0.0.1:80", api->timeSource());
+  auto thread = std::make_shared<SharedConnPoolThread>(*dispatcher);
+  auto owner = std::make_shared<SharedConnPoolThread>(*owner_dispatcher);
+  std::vector<std::unique_ptr<SharedConnPoolImpl>> pools;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    pools.push_back(std::make_unique<SharedConnPoolImpl>(*dispatcher, thread, owner, host,
+                                                         [&owner_pool]() { return &owner_pool; }));
+  }
+
+  size_t worker = 0;
+  for (auto _ : state) { // NOLINT(clang-analyzer-deadcode.DeadStores)
+    Client client;
+    pools[worker++ % pools.size()]->newStream(client, client, {false, false});
+    while (!client.done_) {
+      dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+
+  owner_dispatcher->exit();
+  owner_thread->join();
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+  state.counters["upstream_connections"] = connections;
+}
+BENCHMARK(bmSharedPool)->Arg(16)->Arg(64)->UseRealTime();
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
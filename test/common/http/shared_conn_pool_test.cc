@@ -0,0 +1,352 @@
+#include <memory>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/http/shared_conn_pool.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/conn_pool.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/http/stream_decoder.h"
+#include "test/mocks/http/stream_encoder.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/upstream/cluster_info.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+// The mock dispatchers run posted callbacks inline, so both halves of a stream run on the test
+// thread in the order they would run on the worker and the owner.
+class SharedConnPoolImplTest : public Event::TestUsingSimulatedTime, public testing::Test {
+public:
+  SharedConnPoolImplTest()
+      : host_(Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:9000", simTime())),
+        pool_(std::make_unique<SharedConnPoolImpl>(dispatcher_, thread_, owner_, host_,
+                                                   [this]() { return owner_pool_; })) {}
+
+  // Creates a stream on the shared pool and makes it ready on the owner.
+  RequestEncoder& newReadyStream() {
+    EXPECT_CALL(owner_conn_pool_, newStream(_, _, _))
+        .WillOnce(Invoke([this](ResponseDecoder& decoder, ConnectionPool::Callbacks& callbacks,
+                                const ConnectionPool::Instance::StreamOptions&) {
+          owner_decoder_ = &decoder;
+          owner_callbacks_ = &callbacks;
+          return &owner_cancellable_;
+        }));
+    EXPECT_NE(nullptr, pool_->newStream(response_decoder_, callbacks_, {false, false}));
+
+    RequestEncoder* encoder = nullptr;
+    EXPECT_CALL(callbacks_, onPoolReady(_, _, _, absl::optional<Protocol>(Protocol::Http2)))
+        .WillOnce(Invoke([&encoder](RequestEncoder& ready_encoder,
+                                    Upstream::HostDescriptionConstSharedPtr,
+                                    StreamInfo::StreamInfo&, absl::optional<Protocol>) {
+          encoder = &ready_encoder;
+        }));
+    owner_callbacks_->onPoolReady(owner_encoder_, host_, stream_info_, Protocol::Http2);
+    EXPECT_NE(&owner_encoder_, encoder);
+    return *encoder;
+  }
+
+  // Queues the callbacks posted to dispatcher rather than running them inline.
+  void queuePosts(Event::MockDispatcher& dispatcher) {
+    ON_CALL(dispatcher, post(_)).WillByDefault(Invoke([this](Event::PostCb cb) {
+      posted_.push_back(std::move(cb));
+    }));
+  }
+
+  void runPosted() {
+    std::vector<Event::PostCb> posted;
+    posted.swap(posted_);
+    for (Event::PostCb& cb : posted) {
+      cb();
+    }
+  }
+
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
+  Upstream::HostSharedPtr host_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Event::MockDispatcher> owner_dispatcher_;
+  SharedConnPoolThreadSharedPtr thread_{std::make_shared<SharedConnPoolThread>(dispatcher_)};
+  SharedConnPoolThreadSharedPtr owner_{std::make_shared<SharedConnPoolThread>(owner_dispatcher_)};
+  std::vector<Event::PostCb> posted_;
+  NiceMock<ConnectionPool::MockInstance> owner_conn_pool_;
+  ConnectionPool::Instance* owner_pool_{&owner_conn_pool_};
+  std::unique_ptr<SharedConnPoolImpl> pool_;
+  NiceMock<MockResponseDecoder> response_decoder_;
+  NiceMock<ConnectionPool::MockCallbacks> callbacks_;
+  NiceMock<Envoy::ConnectionPool::MockCancellable> owner_cancellable_;
+  NiceMock<MockRequestEncoder> owner_encoder_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  ResponseDecoder* owner_decoder_{};
+  ConnectionPool::Callbacks* owner_callbacks_{};
+};
+
+TEST_F(SharedConnPoolImplTest, RequestAndResponse) {
+  RequestEncoder& encoder = newReadyStream();
+  EXPECT_FALSE(pool_->isIdle());
+
+  TestRequestHeaderMapImpl request_headers{
+      {":method", "POST"}, {":path", "/"}, {":authority", "host"}};
+  EXPECT_CALL(owner_encoder_, encodeHeaders(HeaderMapEqualRef(&request_headers), false));
+  EXPECT_TRUE(encoder.encodeHeaders(request_headers, false).ok());
+
+  Buffer::OwnedImpl request_body("request");
+  EXPECT_CALL(owner_encoder_, encodeData(BufferStringEqual("request"), true));
+  encoder.encodeData(request_body, true);
+  EXPECT_EQ(0, request_body.length());
+
+  EXPECT_CALL(response_decoder_, decodeHeaders_(_, false));
+  owner_decoder_->decodeHeaders(ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{
+                                    {":status", "200"}}},
+                                false);
+  EXPECT_FALSE(pool_->isIdle());
+
+  Buffer::OwnedImpl response_body("response");
+  EXPECT_CALL(response_decoder_, decodeData(BufferStringEqual("response"), true));
+  owner_decoder_->decodeData(response_body, true);
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+// The worker sees a copy of the TLS properties of the owner's connection, as the owner's object
+// caches them lazily and must only be used on the owner thread.
+TEST_F(SharedConnPoolImplTest, CopiesSslConnectionInfo) {
+  auto ssl_info = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  const std::string empty;
+  const std::string sni = "example.com";
+  const std::string digest = "abcd";
+  ON_CALL(*ssl_info, subjectLocalCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, sha256PeerCertificateDigest()).WillByDefault(ReturnRef(digest));
+  ON_CALL(*ssl_info, sha1PeerCertificateDigest()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, serialNumberPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, issuerPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, subjectPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, urlEncodedPemEncodedPeerCertificate()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, urlEncodedPemEncodedPeerCertificateChain()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, sessionId()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, tlsVersion()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, alpn()).WillByDefault(ReturnRef(empty));
+  ON_CALL(*ssl_info, sni()).WillByDefault(ReturnRef(sni));
+  ON_CALL(*ssl_info, peerCertificateValidated()).WillByDefault(Return(true));
+  stream_info_.downstream_connection_info_provider_->setSslConnection(ssl_info);
+
+  RequestEncoder& encoder = newReadyStream();
+  Ssl::ConnectionInfoConstSharedPtr worker_ssl_info =
+      encoder.getStream().connectionInfoProvider().sslConnection();
+  ASSERT_NE(nullptr, worker_ssl_info);
+  EXPECT_NE(ssl_info, worker_ssl_info);
+  EXPECT_EQ("example.com", worker_ssl_info->sni());
+  EXPECT_EQ("abcd", worker_ssl_info->sha256PeerCertificateDigest());
+  EXPECT_TRUE(worker_ssl_info->peerCertificateValidated());
+
+  // Nothing is read from the owner's object once the stream was handed to the worker.
+  testing::Mock::VerifyAndClearExpectations(ssl_info.get());
+  EXPECT_CALL(*ssl_info, sni()).Times(0);
+  EXPECT_EQ("example.com", worker_ssl_info->sni());
+  encoder.getStream().resetStream(StreamResetReason::LocalReset);
+}
+
+TEST_F(SharedConnPoolImplTest, CancelPendingStream) {
+  EXPECT_CALL(owner_conn_pool_, newStream(_, _, _)).WillOnce(Return(&owner_cancellable_));
+  ConnectionPool::Cancellable* handle =
+      pool_->newStream(response_decoder_, callbacks_, {false, false});
+  ASSERT_NE(nullptr, handle);
+
+  EXPECT_CALL(owner_cancellable_, cancel(Envoy::ConnectionPool::CancelPolicy::CloseExcess));
+  handle->cancel(Envoy::ConnectionPool::CancelPolicy::CloseExcess);
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+TEST_F(SharedConnPoolImplTest, PoolFailure) {
+  EXPECT_CALL(owner_conn_pool_, newStream(_, _, _))
+      .WillOnce(Invoke([this](ResponseDecoder&, ConnectionPool::Callbacks& callbacks,
+                              const ConnectionPool::Instance::StreamOptions&) {
+        owner_callbacks_ = &callbacks;
+        return &owner_cancellable_;
+      }));
+  pool_->newStream(response_decoder_, callbacks_, {false, false});
+
+  EXPECT_CALL(callbacks_, onPoolFailure(ConnectionPool::PoolFailureReason::Timeout,
+                                        absl::string_view("timeout"), _));
+  owner_callbacks_->onPoolFailure(ConnectionPool::PoolFailureReason::Timeout, "timeout", host_);
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+TEST_F(SharedConnPoolImplTest, NoOwnerPool) {
+  owner_pool_ = nullptr;
+  EXPECT_CALL(callbacks_,
+              onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure, _, _));
+  pool_->newStream(response_decoder_, callbacks_, {false, false});
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+// Streams handed off to an owner which shut down fail rather than waiting forever.
+TEST_F(SharedConnPoolImplTest, OwnerShutDown) {
+  owner_->shutdown();
+  EXPECT_CALL(owner_conn_pool_, newStream(_, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                                        absl::string_view("shared connection pool owner shut down"),
+                                        _));
+  pool_->newStream(response_decoder_, callbacks_, {false, false});
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+TEST_F(SharedConnPoolImplTest, OwnerShutDownWithActiveStream) {
+  RequestEncoder& encoder = newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+  owner_->shutdown();
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::ConnectionTermination, _));
+  encoder.getStream().readDisable(true);
+  EXPECT_TRUE(pool_->isIdle());
+
+  // The owner resets its streams when it shuts down.
+  owner_encoder_.stream_.resetStream(StreamResetReason::LocalReset);
+}
+
+// Owner streams whose events can no longer be delivered to the worker are reset.
+TEST_F(SharedConnPoolImplTest, WorkerShutDown) {
+  newReadyStream();
+  thread_->shutdown();
+
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  owner_decoder_->decodeHeaders(ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{
+                                    {":status", "200"}}},
+                                false);
+}
+
+// Events which were posted but never run because the owner shut down fail the stream too.
+TEST_F(SharedConnPoolImplTest, OwnerShutDownWithQueuedEvents) {
+  queuePosts(owner_dispatcher_);
+  pool_->newStream(response_decoder_, callbacks_, {false, false});
+  ASSERT_EQ(1U, posted_.size());
+
+  EXPECT_CALL(callbacks_,
+              onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure, _, _));
+  posted_.clear();
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+TEST_F(SharedConnPoolImplTest, RemoteReset) {
+  RequestEncoder& encoder = newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::RemoteReset, _));
+  owner_encoder_.stream_.resetStream(StreamResetReason::RemoteReset);
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+TEST_F(SharedConnPoolImplTest, LocalReset) {
+  RequestEncoder& encoder = newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+  encoder.getStream().removeCallbacks(stream_callbacks);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(_, _)).Times(0);
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  encoder.getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_TRUE(pool_->isIdle());
+}
+
+TEST_F(SharedConnPoolImplTest, FlowControl) {
+  RequestEncoder& encoder = newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(owner_encoder_.stream_, readDisable(true));
+  encoder.getStream().readDisable(true);
+
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark());
+  owner_encoder_.stream_.runHighWatermarkCallbacks();
+  EXPECT_CALL(stream_callbacks, onBelowWriteBufferLowWatermark());
+  owner_encoder_.stream_.runLowWatermarkCallbacks();
+
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(_));
+  pool_.reset();
+}
+
+// Response body posted to the worker but not decoded yet read disables the upstream stream once it
+// exceeds the buffer limit.
+TEST_F(SharedConnPoolImplTest, DecodeFlowControl) {
+  ON_CALL(owner_encoder_.stream_, bufferLimit()).WillByDefault(Return(10));
+  newReadyStream();
+  EXPECT_CALL(response_decoder_, decodeHeaders_(_, false));
+  owner_decoder_->decodeHeaders(ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{
+                                    {":status", "200"}}},
+                                false);
+  queuePosts(dispatcher_);
+
+  EXPECT_CALL(owner_encoder_.stream_, readDisable(_)).Times(0);
+  Buffer::OwnedImpl first("0123456789");
+  owner_decoder_->decodeData(first, false);
+
+  EXPECT_CALL(owner_encoder_.stream_, readDisable(true));
+  Buffer::OwnedImpl second("0123456789");
+  owner_decoder_->decodeData(second, false);
+
+  EXPECT_CALL(response_decoder_, decodeData(_, false)).Times(2);
+  EXPECT_CALL(owner_encoder_.stream_, readDisable(false));
+  runPosted();
+
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(_));
+  pool_.reset();
+}
+
+// Request body posted to the owner but not encoded yet raises the write buffer high watermark of
+// the worker's stream once it exceeds the buffer limit.
+TEST_F(SharedConnPoolImplTest, EncodeFlowControl) {
+  ON_CALL(owner_encoder_.stream_, bufferLimit()).WillByDefault(Return(10));
+  RequestEncoder& encoder = newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+  EXPECT_EQ(10, encoder.getStream().bufferLimit());
+  TestRequestHeaderMapImpl request_headers{
+      {":method", "POST"}, {":path", "/"}, {":authority", "host"}};
+  EXPECT_TRUE(encoder.encodeHeaders(request_headers, false).ok());
+  queuePosts(owner_dispatcher_);
+
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark());
+  Buffer::OwnedImpl body("0123456789abcdef");
+  encoder.encodeData(body, false);
+
+  EXPECT_CALL(owner_encoder_, encodeData(BufferStringEqual("0123456789abcdef"), false));
+  EXPECT_CALL(stream_callbacks, onBelowWriteBufferLowWatermark());
+  runPosted();
+
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(_));
+  pool_.reset();
+  runPosted();
+}
+
+TEST_F(SharedConnPoolImplTest, DrainAndDelete) {
+  RequestEncoder& encoder = newReadyStream();
+  bool idle = false;
+  pool_->addIdleCallback([&idle]() { idle = true; });
+
+  pool_->drainConnections(Envoy::ConnectionPool::DrainBehavior::DrainAndDelete);
+  EXPECT_FALSE(idle);
+
+  encoder.getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_TRUE(idle);
+}
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
@@ -19,6 +19,7 @@
 #include "test/mocks/network/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
@@ -138,6 +139,67 @@ TEST_P(UdpListenerImplTest, UseActualDstUdp) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// Test that packets are read into pooled buffers, and the pool use is reported.
+TEST_P(UdpListenerImplTest, PacketBufferPool) {
+  setup();
+  ASSERT_NE(nullptr, listener_->packetBufferPool());
+
+  const std::string first("first");
+  client_.write(first, *send_to_addr_);
+
+  uint64_t acquired = 0;
+  EXPECT_CALL(listener_callbacks_, onPacketBuffersAcquired(_, _))
+      .WillRepeatedly(Invoke([&](uint64_t allocated, uint64_t reused) -> void {
+        acquired += allocated + reused;
+      }));
+  EXPECT_CALL(listener_callbacks_, onData(_)).WillOnce(Invoke([&](const UdpRecvData& data) -> void {
+    EXPECT_EQ(data.buffer_->toString(), first);
+    dispatcher_->exit();
+  }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_GE(acquired, 1);
+  EXPECT_EQ(acquired, listener_->packetBufferPool()->allocated() +
+                          listener_->packetBufferPool()->reused());
+}
+
+// Test that the pooled buffers only fit a single datagram unless GRO is used.
+TEST_P(UdpListenerImplTest, PacketBufferPoolBlockSizeWithoutGro) {
+  // GRO is preferred but not supported.
+  setup(true);
+  ASSERT_NE(nullptr, listener_->packetBufferPool());
+  EXPECT_EQ(DEFAULT_UDP_MAX_DATAGRAM_SIZE, listener_->packetBufferPool()->blockSize());
+
+  const std::string first("first");
+  client_.write(first, *send_to_addr_);
+  EXPECT_CALL(listener_callbacks_, onData(_)).WillOnce(Invoke([&](const UdpRecvData& data) -> void {
+    EXPECT_EQ(data.buffer_->toString(), first);
+    dispatcher_->exit();
+  }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_GE(listener_->packetBufferPool()->allocated(), 1);
+}
+
+// Test that a buffer is allocated for each read when the pool is disabled.
+TEST_P(UdpListenerImplTest, PacketBufferPoolDisabled) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.udp_listener_packet_buffer_pool", "false"}});
+  setup();
+  EXPECT_EQ(nullptr, listener_->packetBufferPool());
+
+  const std::string first("first");
+  client_.write(first, *send_to_addr_);
+
+  EXPECT_CALL(listener_callbacks_, onPacketBuffersAcquired(_, _)).Times(0);
+  EXPECT_CALL(listener_callbacks_, onData(_)).WillOnce(Invoke([&](const UdpRecvData& data) -> void {
+    EXPECT_EQ(data.buffer_->toString(), first);
+    dispatcher_->exit();
+  }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
 // Test a large datagram that gets dropped using recvmsg or recvmmsg if supported.
 TEST_P(UdpListenerImplTest, LargeDatagramRecvmmsg) {
   setup();
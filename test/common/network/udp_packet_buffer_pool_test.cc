@@ -0,0 +1,105 @@
+#include <cstring>
+
+#include "source/common/network/udp_packet_buffer_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+TEST(UdpPacketBufferPoolTest, SlotsKeepBlocksUntilHandedOut) {
+  UdpPacketBufferPool pool(1500, 1, 1);
+  EXPECT_EQ(1500, pool.blockSize());
+
+  pool.prepareSlots(2);
+  uint8_t* first = pool.slot(0);
+  uint8_t* second = pool.slot(1);
+  EXPECT_EQ(2, pool.allocated());
+  EXPECT_EQ(0, pool.reused());
+
+  // Slots keep their blocks if nothing read into them is still referenced.
+  pool.toBuffer(0, 0, 10).reset();
+  pool.prepareSlots(2);
+  EXPECT_EQ(first, pool.slot(0));
+  EXPECT_EQ(second, pool.slot(1));
+  EXPECT_EQ(2, pool.allocated());
+
+  // Only the slot whose packet is still referenced takes another block.
+  Buffer::InstancePtr buffer = pool.toBuffer(0, 0, 10);
+  pool.prepareSlots(2);
+  uint8_t* third = pool.slot(0);
+  EXPECT_NE(first, third);
+  EXPECT_EQ(second, pool.slot(1));
+  EXPECT_EQ(3, pool.allocated());
+  EXPECT_EQ(0, pool.reused());
+
+  // The released block is handed out again.
+  buffer.reset();
+  buffer = pool.toBuffer(0, 0, 10);
+  pool.prepareSlots(1);
+  EXPECT_EQ(first, pool.slot(0));
+  EXPECT_EQ(3, pool.allocated());
+  EXPECT_EQ(1, pool.reused());
+
+  // Only one block is cached, so the second one released is freed.
+  Buffer::InstancePtr other = pool.toBuffer(0, 0, 10);
+  pool.prepareSlots(1);
+  EXPECT_EQ(4, pool.allocated());
+  buffer.reset();
+  other.reset();
+  buffer = pool.toBuffer(0, 0, 10);
+  other = pool.toBuffer(1, 0, 10);
+  pool.prepareSlots(2);
+  EXPECT_EQ(third, pool.slot(0));
+  EXPECT_EQ(2, pool.reused());
+  EXPECT_EQ(5, pool.allocated());
+}
+
+TEST(UdpPacketBufferPoolTest, BuffersReferenceBlockWithoutCopying) {
+  // Fewer fragments than packets read into the block.
+  UdpPacketBufferPool pool(16, 2, 4);
+  pool.prepareSlots(1);
+  uint8_t* data = pool.slot(0);
+  memcpy(data, "firstsecondthird", 16);
+
+  Buffer::InstancePtr first = pool.toBuffer(0, 0, 5);
+  Buffer::InstancePtr second = pool.toBuffer(0, 5, 6);
+  Buffer::InstancePtr third = pool.toBuffer(0, 11, 5);
+  EXPECT_EQ("first", first->toString());
+  EXPECT_EQ("second", second->toString());
+  EXPECT_EQ("third", third->toString());
+  EXPECT_EQ(data, first->frontSlice().mem_);
+  EXPECT_EQ(data + 5, second->frontSlice().mem_);
+  EXPECT_EQ(data + 11, third->frontSlice().mem_);
+  EXPECT_EQ(0, pool.toBuffer(0, 0, 0)->length());
+
+  // The block goes back to the pool once all the buffers are gone.
+  pool.prepareSlots(1);
+  EXPECT_NE(data, pool.slot(0));
+  first.reset();
+  second.reset();
+  Buffer::InstancePtr next = pool.toBuffer(0, 0, 1);
+  pool.prepareSlots(1);
+  EXPECT_NE(data, pool.slot(0));
+  next.reset();
+  third.reset();
+  next = pool.toBuffer(0, 0, 1);
+  pool.prepareSlots(1);
+  EXPECT_EQ(data, pool.slot(0));
+}
+
+TEST(UdpPacketBufferPoolTest, BufferOutlivesPool) {
+  Buffer::InstancePtr buffer;
+  {
+    UdpPacketBufferPool pool(16, 1, 4);
+    pool.prepareSlots(1);
+    memcpy(pool.slot(0), "packet", 6);
+    buffer = pool.toBuffer(0, 0, 6);
+  }
+  EXPECT_EQ("packet", buffer->toString());
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
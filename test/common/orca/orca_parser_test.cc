@@ -0,0 +1,59 @@
+#include <string>
+
+#include "source/common/common/base64.h"
+#include "source/common/orca/orca_parser.h"
+
+#include "test/test_common/status_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+#include "xds/data/orca/v3/orca_load_report.pb.h"
+
+namespace Envoy {
+namespace Orca {
+namespace {
+
+using StatusHelpers::StatusIs;
+
+std::string encodeReport(const xds::data::orca::v3::OrcaLoadReport& report) {
+  const std::string serialized = report.SerializeAsString();
+  return Base64::encode(serialized.data(), serialized.size());
+}
+
+TEST(OrcaParserTest, MissingHeader) {
+  Http::TestResponseHeaderMapImpl headers{{":status", "200"}};
+  EXPECT_THAT(parseOrcaLoadReportHeaders(headers), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(OrcaParserTest, InvalidHeader) {
+  Http::TestResponseHeaderMapImpl headers{{std::string(EndpointLoadMetricsHeaderBin), "%%%"}};
+  EXPECT_THAT(parseOrcaLoadReportHeaders(headers), StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(OrcaParserTest, ValidHeader) {
+  xds::data::orca::v3::OrcaLoadReport report;
+  report.set_cpu_utilization(0.5);
+  report.set_rps(1000);
+
+  Http::TestResponseHeaderMapImpl headers{
+      {std::string(EndpointLoadMetricsHeaderBin), encodeReport(report)}};
+  const auto parsed = parseOrcaLoadReportHeaders(headers);
+  ASSERT_TRUE(parsed.ok());
+  EXPECT_DOUBLE_EQ(0.5, parsed->cpu_utilization());
+  EXPECT_EQ(1000, parsed->rps());
+}
+
+TEST(OrcaParserTest, ValidTrailer) {
+  xds::data::orca::v3::OrcaLoadReport report;
+  report.set_cpu_utilization(0.25);
+
+  Http::TestResponseTrailerMapImpl trailers{
+      {std::string(EndpointLoadMetricsHeaderBin), encodeReport(report)}};
+  const auto parsed = parseOrcaLoadReportHeaders(trailers);
+  ASSERT_TRUE(parsed.ok());
+  EXPECT_DOUBLE_EQ(0.25, parsed->cpu_utilization());
+}
+
+} // namespace
+} // namespace Orca
+} // namespace Envoy
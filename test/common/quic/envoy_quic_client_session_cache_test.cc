@@ -0,0 +1,202 @@
+#include "source/common/common/assert.h"
+#include "source/common/quic/envoy_quic_client_session_cache.h"
+
+#include "test/test_common/environment.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Quic {
+namespace {
+
+// An in-memory key value store, standing in for one which outlives the caches writing to it.
+class TestKeyValueStore : public KeyValueStore {
+public:
+  void addOrUpdate(absl::string_view key, absl::string_view value,
+                   absl::optional<std::chrono::seconds>) override {
+    entries_[std::string(key)] = std::string(value);
+  }
+  void remove(absl::string_view key) override { entries_.erase(key); }
+  absl::optional<absl::string_view> get(absl::string_view key) override {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return absl::nullopt;
+    }
+    return it->second;
+  }
+  void flush() override {}
+  void iterate(ConstIterateCb cb) const override {
+    for (const auto& [key, value] : entries_) {
+      if (cb(key, value) == Iterate::Break) {
+        return;
+      }
+    }
+  }
+
+  absl::flat_hash_map<std::string, std::string> entries_;
+};
+
+class EnvoyQuicClientSessionCacheTest : public testing::Test {
+protected:
+  EnvoyQuicClientSessionCacheTest() {
+    params_.perspective = quic::Perspective::IS_SERVER;
+    params_.initial_max_data.set_value(12345);
+  }
+
+  // Returns a resumable session from a TLS handshake with a server using the test certificate.
+  bssl::UniquePtr<SSL_SESSION> createSession() {
+    bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
+    const std::string test_data =
+        TestEnvironment::substitute("{{ test_rundir }}/test/extensions/transport_sockets/tls/"
+                                    "test_data/");
+    RELEASE_ASSERT(SSL_CTX_use_certificate_chain_file(
+                       server_ctx.get(), (test_data + "san_uri_cert.pem").c_str()) == 1,
+                   "");
+    RELEASE_ASSERT(SSL_CTX_use_PrivateKey_file(server_ctx.get(),
+                                               (test_data + "san_uri_key.pem").c_str(),
+                                               SSL_FILETYPE_PEM) == 1,
+                   "");
+    // TLS 1.2 sessions are resumable as soon as the handshake completes.
+    RELEASE_ASSERT(SSL_CTX_set_max_proto_version(client_ctx_.get(), TLS1_2_VERSION) == 1, "");
+
+    bssl::UniquePtr<SSL> server_ssl(SSL_new(server_ctx.get()));
+    SSL_set_accept_state(server_ssl.get());
+    bssl::UniquePtr<SSL> client_ssl(SSL_new(client_ctx_.get()));
+    SSL_set_connect_state(client_ssl.get());
+    BIO* client_bio;
+    BIO* server_bio;
+    RELEASE_ASSERT(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0) == 1, "");
+    SSL_set_bio(client_ssl.get(), client_bio, client_bio);
+    SSL_set_bio(server_ssl.get(), server_bio, server_bio);
+
+    bool handshake_success = false;
+    for (int i = 0; i < 10 && !handshake_success; ++i) {
+      const int client_rc = SSL_do_handshake(client_ssl.get());
+      const int server_rc = SSL_do_handshake(server_ssl.get());
+      handshake_success = client_rc == 1 && server_rc == 1;
+    }
+    RELEASE_ASSERT(handshake_success, "handshake failed");
+    return bssl::UniquePtr<SSL_SESSION>(SSL_get1_session(client_ssl.get()));
+  }
+
+  static std::string sessionId(const SSL_SESSION& session) {
+    unsigned int length;
+    const uint8_t* id = SSL_SESSION_get_id(&session, &length);
+    return {reinterpret_cast<const char*>(id), length};
+  }
+
+  std::string storeKey(const quic::QuicServerId& server_id) const {
+    return absl::StrCat(key_prefix_, "\n", server_id.ToString());
+  }
+
+  static quic::QuicWallTime sessionTime(const SSL_SESSION& session) {
+    return quic::QuicWallTime::FromUNIXSeconds(SSL_SESSION_get_time(&session));
+  }
+
+  bssl::UniquePtr<SSL_CTX> client_ctx_{SSL_CTX_new(TLS_method())};
+  std::shared_ptr<TestKeyValueStore> store_{std::make_shared<TestKeyValueStore>()};
+  const std::string key_prefix_{"client:1234"};
+  const quic::QuicServerId server_id_{"www.abc.com", 443, false};
+  quic::TransportParameters params_;
+  const quic::ApplicationState application_state_{1, 2, 3};
+};
+
+TEST_F(EnvoyQuicClientSessionCacheTest, InMemoryOnly) {
+  EnvoyQuicClientSessionCache cache(nullptr, "");
+  bssl::UniquePtr<SSL_SESSION> session = createSession();
+  const quic::QuicWallTime now = sessionTime(*session);
+  cache.Insert(server_id_, std::move(session), params_, &application_state_);
+
+  EXPECT_NE(nullptr, cache.Lookup(server_id_, now, client_ctx_.get()));
+  EXPECT_EQ(nullptr, cache.Lookup(server_id_, now, client_ctx_.get()));
+}
+
+// Resumption state written by one cache can be used by another one, e.g. after a restart, once.
+TEST_F(EnvoyQuicClientSessionCacheTest, ResumeFromStore) {
+  bssl::UniquePtr<SSL_SESSION> session = createSession();
+  const std::string session_id = sessionId(*session);
+  const quic::QuicWallTime now = sessionTime(*session);
+  EnvoyQuicClientSessionCache(store_, key_prefix_)
+      .Insert(server_id_, std::move(session), params_, &application_state_);
+  EXPECT_EQ(1U, store_->entries_.size());
+
+  EnvoyQuicClientSessionCache cache(store_, key_prefix_);
+  std::unique_ptr<quic::QuicResumptionState> state =
+      cache.Lookup(server_id_, now, client_ctx_.get());
+  ASSERT_NE(nullptr, state);
+  EXPECT_EQ(session_id, sessionId(*state->tls_session));
+  EXPECT_EQ(12345U, state->transport_params->initial_max_data.value());
+  ASSERT_NE(nullptr, state->application_state);
+  EXPECT_EQ(application_state_, *state->application_state);
+
+  EXPECT_TRUE(store_->entries_.empty());
+  EXPECT_EQ(nullptr, cache.Lookup(server_id_, now, client_ctx_.get()));
+}
+
+// A session handed out from memory is not resumed again from the store.
+TEST_F(EnvoyQuicClientSessionCacheTest, InMemoryHitRemovesStoreEntry) {
+  EnvoyQuicClientSessionCache cache(store_, key_prefix_);
+  bssl::UniquePtr<SSL_SESSION> session = createSession();
+  const quic::QuicWallTime now = sessionTime(*session);
+  cache.Insert(server_id_, std::move(session), params_, &application_state_);
+  EXPECT_EQ(1U, store_->entries_.count(storeKey(server_id_)));
+
+  EXPECT_NE(nullptr, cache.Lookup(server_id_, now, client_ctx_.get()));
+  EXPECT_TRUE(store_->entries_.empty());
+  EXPECT_EQ(nullptr, EnvoyQuicClientSessionCache(store_, key_prefix_)
+                         .Lookup(server_id_, now, client_ctx_.get()));
+}
+
+// Entries written under another TLS context are neither resumed nor kept.
+TEST_F(EnvoyQuicClientSessionCacheTest, StoreEntryOfOtherContext) {
+  bssl::UniquePtr<SSL_SESSION> session = createSession();
+  const quic::QuicWallTime now = sessionTime(*session);
+  EnvoyQuicClientSessionCache(store_, "client:5678")
+      .Insert(server_id_, std::move(session), params_, &application_state_);
+  EXPECT_EQ(1U, store_->entries_.size());
+
+  EnvoyQuicClientSessionCache cache(store_, key_prefix_);
+  EXPECT_TRUE(store_->entries_.empty());
+  EXPECT_EQ(nullptr, cache.Lookup(server_id_, now, client_ctx_.get()));
+}
+
+TEST_F(EnvoyQuicClientSessionCacheTest, ExpiredStoreEntry) {
+  bssl::UniquePtr<SSL_SESSION> session = createSession();
+  const quic::QuicWallTime expiry = quic::QuicWallTime::FromUNIXSeconds(
+      SSL_SESSION_get_time(session.get()) + SSL_SESSION_get_timeout(session.get()));
+  EnvoyQuicClientSessionCache(store_, key_prefix_)
+      .Insert(server_id_, std::move(session), params_, nullptr);
+
+  EnvoyQuicClientSessionCache cache(store_, key_prefix_);
+  EXPECT_EQ(nullptr, cache.Lookup(server_id_, expiry, client_ctx_.get()));
+  EXPECT_TRUE(store_->entries_.empty());
+}
+
+TEST_F(EnvoyQuicClientSessionCacheTest, MalformedStoreEntry) {
+  store_->entries_[storeKey(server_id_)] = "not|an|entry";
+  EnvoyQuicClientSessionCache cache(store_, key_prefix_);
+  EXPECT_EQ(nullptr,
+            cache.Lookup(server_id_, quic::QuicWallTime::FromUNIXSeconds(0), client_ctx_.get()));
+  EXPECT_TRUE(store_->entries_.empty());
+}
+
+TEST_F(EnvoyQuicClientSessionCacheTest, ClearEarlyDataAndClearRemoveStoreEntries) {
+  EnvoyQuicClientSessionCache cache(store_, key_prefix_);
+  cache.Insert(server_id_, createSession(), params_, &application_state_);
+  cache.ClearEarlyData(server_id_);
+  EXPECT_TRUE(store_->entries_.empty());
+
+  const quic::QuicServerId other_server_id("www.def.com", 443, false);
+  cache.Insert(server_id_, createSession(), params_, &application_state_);
+  cache.Insert(other_server_id, createSession(), params_, &application_state_);
+  EXPECT_EQ(2U, store_->entries_.size());
+  cache.Clear();
+  EXPECT_TRUE(store_->entries_.empty());
+}
+
+} // namespace
+} // namespace Quic
+} // namespace Envoy
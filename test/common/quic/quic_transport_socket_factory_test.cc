@@ -1,10 +1,17 @@
+#include "source/common/common/thread.h"
 #include "source/common/quic/quic_transport_socket_factory.h"
+#include "source/extensions/transport_sockets/tls/context_impl.h"
 
+#include "test/mocks/common.h"
 #include "test/mocks/server/transport_socket_factory_context.h"
 #include "test/mocks/ssl/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/environment.h"
+#include "test/test_common/registry.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
+using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
@@ -127,5 +134,98 @@ TEST_F(QuicClientTransportSocketFactoryTest, GetCryptoConfig) {
   EXPECT_NE(crypto_config2, crypto_config1);
 }
 
+TEST(QuicClientTransportSocketConfigFactoryTest, SessionStoreRequiresConcurrencyOne) {
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> context;
+  context.options_.concurrency_ = 2;
+  envoy::extensions::transport_sockets::quic::v3::QuicUpstreamTransport proto_config;
+  TestUtility::loadFromYaml(R"EOF(
+upstream_tls_context: {}
+session_cache_key_value_store_config:
+  name: envoy.common.key_value
+  typed_config:
+    "@type": type.googleapis.com/envoy.config.common.key_value.v3.KeyValueStoreConfig
+)EOF",
+                            proto_config);
+  QuicClientTransportSocketConfigFactory config_factory;
+  EXPECT_THROW_WITH_MESSAGE(config_factory.createTransportSocketFactory(proto_config, context),
+                            EnvoyException,
+                            "QUIC session cache has key value store but Envoy has concurrency = 2");
+}
+
+class QuicClientSessionStoreTest : public testing::Test {
+public:
+  QuicClientSessionStoreTest() : injector_(kv_factory_) {
+    context_.options_.concurrency_ = 1;
+    ON_CALL(context_, threadLocal()).WillByDefault(ReturnRef(thread_local_instance_));
+    ON_CALL(context_.context_manager_, createSslClientContext(_, _))
+        .WillByDefault(
+            Invoke([this](Stats::Scope& scope, const Ssl::ClientContextConfig& config) {
+              return std::make_shared<Extensions::TransportSockets::Tls::ClientContextImpl>(
+                  scope, config, time_system_);
+            }));
+    ON_CALL(kv_factory_, createEmptyConfigProto()).WillByDefault(Invoke([]() {
+      return std::make_unique<ProtobufWkt::Struct>();
+    }));
+  }
+
+  Network::UpstreamTransportSocketFactoryPtr createFactory() {
+    envoy::extensions::transport_sockets::quic::v3::QuicUpstreamTransport proto_config;
+    TestUtility::loadFromYaml(R"EOF(
+upstream_tls_context: {}
+session_cache_key_value_store_config:
+  name: envoy.common.key_value
+  typed_config:
+    "@type": type.googleapis.com/envoy.config.common.key_value.v3.KeyValueStoreConfig
+    config:
+      name: mock_key_value_store_factory
+      typed_config:
+        "@type": type.googleapis.com/google.protobuf.Struct
+)EOF",
+                              proto_config);
+    QuicClientTransportSocketConfigFactory config_factory;
+    return config_factory.createTransportSocketFactory(proto_config, context_);
+  }
+
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> context_;
+  NiceMock<ThreadLocal::MockInstance> thread_local_instance_;
+  Event::SimulatedTimeSystem time_system_;
+  MockKeyValueStoreFactory kv_factory_;
+  Registry::InjectFactory<KeyValueStoreFactory> injector_;
+};
+
+// The key value store is created on the dispatcher of the thread using the crypto config, rather
+// than the main thread's.
+TEST_F(QuicClientSessionStoreTest, SessionStoreCreatedOnWorker) {
+  EXPECT_CALL(kv_factory_, createStore(_, _, _, _)).Times(0);
+  Network::UpstreamTransportSocketFactoryPtr factory = createFactory();
+
+  EXPECT_CALL(kv_factory_, createStore(_, _, testing::Ref(thread_local_instance_.dispatcher_), _))
+      .WillOnce(Invoke([]() { return std::make_unique<NiceMock<MockKeyValueStore>>(); }));
+  std::shared_ptr<quic::QuicCryptoClientConfig> crypto_config = factory->getCryptoConfig();
+  EXPECT_NE(nullptr, crypto_config);
+  // The crypto config is kept until the context changes.
+  EXPECT_EQ(crypto_config, factory->getCryptoConfig());
+}
+
+// Crypto configs created on the main thread, e.g. for HTTP/3 health checks, don't use the store.
+TEST_F(QuicClientSessionStoreTest, SessionStoreNotUsedOnMainThread) {
+  Network::UpstreamTransportSocketFactoryPtr factory = createFactory();
+
+  Thread::MainThread main_thread;
+  EXPECT_CALL(kv_factory_, createStore(_, _, _, _)).Times(0);
+  EXPECT_NE(nullptr, factory->getCryptoConfig());
+}
+
+// Contexts of other implementations store their sessions without a key prefix.
+TEST_F(QuicClientSessionStoreTest, SessionStoreWithOtherContextImplementation) {
+  ON_CALL(context_.context_manager_, createSslClientContext(_, _))
+      .WillByDefault(Return(std::make_shared<NiceMock<Ssl::MockClientContext>>()));
+  Network::UpstreamTransportSocketFactoryPtr factory = createFactory();
+
+  EXPECT_CALL(kv_factory_, createStore(_, _, _, _))
+      .WillOnce(Invoke([]() { return std::make_unique<NiceMock<MockKeyValueStore>>(); }));
+  EXPECT_NE(nullptr, factory->getCryptoConfig());
+}
+
 } // namespace Quic
 } // namespace Envoy
@@ -12,6 +12,7 @@
 #include "envoy/type/v3/percent.pb.h"
 
 #include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/base64.h"
 #include "source/common/common/empty_string.h"
 #include "source/common/config/metadata.h"
 #include "source/common/config/well_known_names.h"
@@ -24,6 +25,7 @@
 #include "source/common/network/upstream_subject_alt_names.h"
 #include "source/common/network/utility.h"
 #include "source/common/network/win32_redirect_records_option_impl.h"
+#include "source/common/orca/orca_parser.h"
 #include "source/common/router/config_impl.h"
 #include "source/common/router/debug_config.h"
 #include "source/common/router/router.h"
@@ -51,6 +53,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xds/data/orca/v3/orca_load_report.pb.h"
 
 using testing::_;
 using testing::AtLeast;
@@ -796,6 +799,55 @@ TEST_F(RouterTest, EnvoyUpstreamServiceTime) {
   EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
 }
 
+// Validate that the response time of the upstream host is recorded when the cluster uses the
+// peak EWMA load balancer.
+TEST_F(RouterTest, PeakEwmaRecordsResponseTime) {
+  cm_.thread_local_cluster_.cluster_.info_->lb_type_ = Upstream::LoadBalancerType::PeakEwma;
+
+  NiceMock<Http::MockRequestEncoder> encoder1;
+  Http::ResponseDecoder* response_decoder = nullptr;
+  expectNewStreamWithImmediateEncoder(encoder1, &response_decoder, Http::Protocol::Http10);
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  EXPECT_CALL(cm_.thread_local_cluster_.conn_pool_.host_->response_time_estimator_, add(_));
+  Http::ResponseHeaderMapPtr response_headers(
+      new Http::TestResponseHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
+// Validate that ORCA load reports update the utilization weight of the upstream host when the
+// cluster uses the ORCA weighted round robin load balancer.
+TEST_F(RouterTest, OrcaLoadReportUpdatesUtilizationWeight) {
+  cm_.thread_local_cluster_.cluster_.info_->lb_type_ =
+      Upstream::LoadBalancerType::OrcaWeightedRoundRobin;
+
+  NiceMock<Http::MockRequestEncoder> encoder1;
+  Http::ResponseDecoder* response_decoder = nullptr;
+  expectNewStreamWithImmediateEncoder(encoder1, &response_decoder, Http::Protocol::Http10);
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  xds::data::orca::v3::OrcaLoadReport report;
+  report.set_rps(100);
+  report.set_cpu_utilization(0.5);
+  const std::string serialized = report.SerializeAsString();
+  Http::ResponseHeaderMapPtr response_headers(new Http::TestResponseHeaderMapImpl{
+      {":status", "200"},
+      {std::string(Orca::EndpointLoadMetricsHeaderBin),
+       Base64::encode(serialized.data(), serialized.size())}});
+  EXPECT_CALL(cm_.thread_local_cluster_.conn_pool_.host_->utilization_weight_, update(100, 0.5));
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
 // Validate that x-envoy-attempt-count is added to request headers when the option is true.
 TEST_F(RouterTest, EnvoyAttemptCountInRequest) {
   verifyAttemptCountInRequestBasic(
@@ -0,0 +1,97 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures applying an RTDS update that changes a single key on top of a large static runtime
+// layer, which only rebuilds the RTDS layer and shares the static layer with the previous snapshot.
+
+#include "envoy/config/bootstrap/v3/bootstrap.pb.h"
+#include "envoy/service/runtime/v3/rtds.pb.h"
+
+#include "source/common/runtime/runtime_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/common.h"
+#include "test/mocks/config/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/protobuf/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/mocks/upstream/cluster_manager.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::_;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Runtime {
+namespace {
+
+class RtdsSpeedTest {
+public:
+  explicit RtdsSpeedTest(size_t num_keys) : api_(Api::createApiForTest(store_)) {
+    envoy::config::bootstrap::v3::LayeredRuntime config;
+    auto* static_layer = config.add_layers();
+    static_layer->set_name("base");
+    for (size_t i = 0; i < num_keys; ++i) {
+      (*static_layer->mutable_static_layer()->mutable_fields())[absl::StrCat("key_", i)]
+          .set_string_value(absl::StrCat(i));
+    }
+    auto* rtds_layer = config.add_layers();
+    rtds_layer->set_name("rtds");
+    rtds_layer->mutable_rtds_layer()->set_name("rtds");
+    rtds_layer->mutable_rtds_layer()->mutable_rtds_config();
+
+    ON_CALL(cm_.subscription_factory_, subscriptionFromConfigSource(_, _, _, _, _, _))
+        .WillByDefault(testing::Invoke(
+            [this](const envoy::config::core::v3::ConfigSource&, absl::string_view, Stats::Scope&,
+                   Config::SubscriptionCallbacks& callbacks, Config::OpaqueResourceDecoderSharedPtr,
+                   const Config::SubscriptionOptions&) -> Config::SubscriptionPtr {
+              callbacks_ = &callbacks;
+              return std::make_unique<NiceMock<Config::MockSubscription>>();
+            }));
+    loader_ = std::make_unique<LoaderImpl>(dispatcher_, tls_, config, local_info_, store_,
+                                           generator_, validation_visitor_, *api_);
+    loader_->initialize(cm_);
+  }
+
+  void update(benchmark::State& state) {
+    std::vector<Config::DecodedResourcesWrapper> updates;
+    for (const std::string value : {"0", "1"}) {
+      envoy::service::runtime::v3::Runtime runtime;
+      runtime.set_name("rtds");
+      (*runtime.mutable_layer()->mutable_fields())["key_0"].set_string_value(value);
+      updates.push_back(TestUtility::decodeResources({runtime}));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) { // NOLINT: Silences warning about dead store
+      callbacks_->onConfigUpdate(updates[i++ % updates.size()].refvec_, "");
+    }
+  }
+
+private:
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<Random::MockRandomGenerator> generator_;
+  NiceMock<Upstream::MockClusterManager> cm_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<ProtobufMessage::MockValidationVisitor> validation_visitor_;
+  Config::SubscriptionCallbacks* callbacks_{};
+  std::unique_ptr<LoaderImpl> loader_;
+};
+
+} // namespace
+} // namespace Runtime
+} // namespace Envoy
+
+static void bmRtdsUpdate(benchmark::State& state) {
+  const size_t num_keys = Envoy::skipExpensiveBenchmarks() ? 100 : state.range(0);
+  Envoy::Runtime::RtdsSpeedTest speed_test(num_keys);
+  speed_test.update(state);
+}
+BENCHMARK(bmRtdsUpdate)->Arg(100)->Arg(10000)->Arg(50000)->Unit(benchmark::kMicrosecond);
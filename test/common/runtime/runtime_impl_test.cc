@@ -1204,6 +1204,57 @@ TEST_F(RtdsLoaderImplTest, MultipleRtdsLayers) {
   EXPECT_EQ(3, store_.gauge("runtime.num_layers", Stats::Gauge::ImportMode::NeverImport).value());
 }
 
+// An RTDS update only rebuilds its own layer; the other layers are shared with the previous
+// snapshot and keys the updated layer stops providing fall back to the layers below.
+TEST_F(RtdsLoaderImplTest, UpdateSharesUnchangedLayers) {
+  addLayer("another_resource");
+  setup();
+
+  auto runtime = TestUtility::parseYaml<envoy::service::runtime::v3::Runtime>(R"EOF(
+    name: some_resource
+    layer:
+      foo: bar
+      baz: meh
+  )EOF");
+  EXPECT_CALL(rtds_init_callback_, Call());
+  doOnConfigUpdateVerifyNoThrow(runtime, 0);
+  const std::vector<const Snapshot::OverrideLayer*> old_layers{
+      loader_->snapshot().getLayers()[0].get(), loader_->snapshot().getLayers()[1].get(),
+      loader_->snapshot().getLayers()[2].get()};
+
+  runtime = TestUtility::parseYaml<envoy::service::runtime::v3::Runtime>(R"EOF(
+    name: another_resource
+    layer:
+      baz: saz
+  )EOF");
+  doOnConfigUpdateVerifyNoThrow(runtime, 1);
+  EXPECT_EQ(old_layers[0], loader_->snapshot().getLayers()[0].get());
+  EXPECT_EQ(old_layers[1], loader_->snapshot().getLayers()[1].get());
+  EXPECT_NE(old_layers[2], loader_->snapshot().getLayers()[2].get());
+  EXPECT_EQ("saz", loader_->snapshot().get("baz").value().get());
+
+  runtime = TestUtility::parseYaml<envoy::service::runtime::v3::Runtime>(R"EOF(
+    name: some_resource
+    layer:
+      bar: car
+  )EOF");
+  doOnConfigUpdateVerifyNoThrow(runtime, 0);
+  EXPECT_EQ("whatevs", loader_->snapshot().get("foo").value().get());
+  EXPECT_EQ("car", loader_->snapshot().get("bar").value().get());
+  EXPECT_EQ("saz", loader_->snapshot().get("baz").value().get());
+  EXPECT_EQ(3, store_.gauge("runtime.num_keys", Stats::Gauge::ImportMode::NeverImport).value());
+
+  runtime = TestUtility::parseYaml<envoy::service::runtime::v3::Runtime>(R"EOF(
+    name: another_resource
+    layer: {}
+  )EOF");
+  doOnConfigUpdateVerifyNoThrow(runtime, 1);
+  EXPECT_EQ("whatevs", loader_->snapshot().get("foo").value().get());
+  EXPECT_EQ("car", loader_->snapshot().get("bar").value().get());
+  EXPECT_FALSE(loader_->snapshot().get("baz").has_value());
+  EXPECT_EQ(2, store_.gauge("runtime.num_keys", Stats::Gauge::ImportMode::NeverImport).value());
+}
+
 TEST_F(RtdsLoaderImplTest, BadConfigSource) {
   Upstream::MockClusterManager cm_;
   EXPECT_CALL(cm_.subscription_factory_, subscriptionFromConfigSource(_, _, _, _, _, _))
@@ -1073,6 +1073,151 @@ TEST_F(TcpConnPoolImplTest, TestPreconnect) {
   conn_pool_->test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+// Test that warm connections are established ahead of streams and are claimed by the next stream.
+TEST_F(TcpConnPoolImplTest, WarmConnections) {
+  cluster_->warm_tcp_connections_ = Upstream::ClusterInfo::WarmTcpConnections{1, absl::nullopt};
+  initialize();
+  cluster_->resetResourceManager(3, 1024, 1024, 1, 1);
+
+  // The first connection serves the stream and the second one is kept warm.
+  conn_pool_->expectConnCreate();
+  conn_pool_->expectConnCreate();
+  ConnPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, conn_pool_->newConnection(callbacks));
+  EXPECT_CALL(callbacks.pool_ready_, ready());
+  conn_pool_->test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  conn_pool_->test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The next stream claims the warm connection immediately and another one is warmed.
+  conn_pool_->expectConnCreate();
+  ConnPoolCallbacks callbacks2;
+  EXPECT_CALL(callbacks2.pool_ready_, ready());
+  EXPECT_EQ(nullptr, conn_pool_->newConnection(callbacks2));
+  EXPECT_EQ(&callbacks2.conn_data_->connection(), conn_pool_->test_conns_[1].connection_);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_hit_.value());
+  EXPECT_EQ(3U, cluster_->stats_.upstream_cx_total_.value());
+
+  EXPECT_CALL(*conn_pool_, onConnReleasedForTest()).Times(2);
+  callbacks.conn_data_.reset();
+  callbacks2.conn_data_.reset();
+  EXPECT_CALL(*conn_pool_, onConnDestroyedForTest()).Times(3);
+  for (auto& test_conn : conn_pool_->test_conns_) {
+    test_conn.connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  }
+  dispatcher_.clearDeferredDeleteList();
+}
+
+// Test that warm connections which are not claimed are closed after the idle timeout.
+TEST_F(TcpConnPoolImplTest, WarmConnectionsIdleTimeout) {
+  cluster_->warm_tcp_connections_ =
+      Upstream::ClusterInfo::WarmTcpConnections{1, std::chrono::milliseconds(1000)};
+  initialize();
+  cluster_->resetResourceManager(3, 1024, 1024, 1, 1);
+
+  conn_pool_->expectConnCreate();
+  conn_pool_->expectConnCreate();
+  ConnPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, conn_pool_->newConnection(callbacks));
+  EXPECT_CALL(callbacks.pool_ready_, ready());
+  conn_pool_->test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // Only the unclaimed connection arms an idle timer.
+  auto* idle_timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(1000), _));
+  conn_pool_->test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  EXPECT_CALL(*conn_pool_, onConnDestroyedForTest());
+  idle_timer->invokeCallback();
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_idle_timeout_.value());
+
+  EXPECT_CALL(*conn_pool_, onConnReleasedForTest());
+  callbacks.conn_data_.reset();
+  EXPECT_CALL(*conn_pool_, onConnDestroyedForTest());
+  conn_pool_->test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+// Test that no connections are warmed for an unhealthy host.
+TEST_F(TcpConnPoolImplTest, WarmConnectionsUnhealthyHost) {
+  cluster_->warm_tcp_connections_ = Upstream::ClusterInfo::WarmTcpConnections{1, absl::nullopt};
+  initialize();
+  cluster_->resetResourceManager(3, 1024, 1024, 1, 1);
+  host_->healthFlagSet(Upstream::Host::HealthFlag::FAILED_ACTIVE_HC);
+
+  conn_pool_->expectConnCreate();
+  ConnPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, conn_pool_->newConnection(callbacks));
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_total_.value());
+
+  EXPECT_CALL(callbacks.pool_failure_, ready());
+  EXPECT_CALL(*conn_pool_, onConnDestroyedForTest());
+  conn_pool_->test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+// Test that warming connections does not exceed the connection circuit breaker.
+TEST_F(TcpConnPoolImplTest, WarmConnectionsCircuitBreaker) {
+  cluster_->warm_tcp_connections_ = Upstream::ClusterInfo::WarmTcpConnections{4, absl::nullopt};
+  initialize();
+  cluster_->resetResourceManager(2, 1024, 1024, 1, 1);
+
+  conn_pool_->expectConnCreate();
+  conn_pool_->expectConnCreate();
+  ConnPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, conn_pool_->newConnection(callbacks));
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  EXPECT_CALL(callbacks.pool_failure_, ready());
+  EXPECT_CALL(*conn_pool_, onConnDestroyedForTest()).Times(2);
+  conn_pool_->test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_->test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+// Test that connections are not warmed for a while after connecting to the host failed repeatedly.
+TEST_F(TcpConnPoolImplTest, WarmConnectionsBackOff) {
+  cluster_->warm_tcp_connections_ = Upstream::ClusterInfo::WarmTcpConnections{1, absl::nullopt};
+  initialize();
+  cluster_->resetResourceManager(3, 1024, 1024, 1, 1);
+
+  // Both the stream's connection and the warm one fail to connect, twice.
+  for (int i = 0; i < 2; i++) {
+    conn_pool_->expectConnCreate();
+    conn_pool_->expectConnCreate();
+    ConnPoolCallbacks callbacks;
+    EXPECT_NE(nullptr, conn_pool_->newConnection(callbacks));
+    EXPECT_CALL(callbacks.pool_failure_, ready());
+    EXPECT_CALL(*conn_pool_, onConnDestroyedForTest()).Times(2);
+    conn_pool_->test_conns_[2 * i].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+    conn_pool_->test_conns_[2 * i + 1].connection_->raiseEvent(
+        Network::ConnectionEvent::RemoteClose);
+    dispatcher_.clearDeferredDeleteList();
+  }
+
+  // After four failures in a row warming backs off for two seconds.
+  conn_pool_->expectConnCreate();
+  ConnPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, conn_pool_->newConnection(callbacks));
+  EXPECT_EQ(5U, cluster_->stats_.upstream_cx_total_.value());
+
+  simTime().advanceTimeWait(std::chrono::milliseconds(2000));
+  conn_pool_->expectConnCreate();
+  conn_pool_->expectConnCreate();
+  ConnPoolCallbacks callbacks2;
+  EXPECT_NE(nullptr, conn_pool_->newConnection(callbacks2));
+  EXPECT_EQ(7U, cluster_->stats_.upstream_cx_total_.value());
+
+  EXPECT_CALL(callbacks.pool_failure_, ready());
+  EXPECT_CALL(callbacks2.pool_failure_, ready());
+  EXPECT_CALL(*conn_pool_, onConnDestroyedForTest()).Times(3);
+  for (size_t i = 4; i < conn_pool_->test_conns_.size(); i++) {
+    conn_pool_->test_conns_[i].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  }
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Test that pending connections are closed when the connection pool is destroyed.
  */
@@ -0,0 +1,140 @@
+#include <limits>
+
+#include "source/common/upstream/alias_scheduler.h"
+
+#include "test/mocks/common.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+// Random number which results in a coin toss of approximately numerator / denominator.
+uint64_t coin(uint64_t numerator, uint64_t denominator) {
+  return numerator * (std::numeric_limits<uint64_t>::max() / denominator);
+}
+
+TEST(AliasSchedulerTest, Empty) {
+  NiceMock<Random::MockRandomGenerator> random;
+  AliasScheduler<uint32_t> sched(random);
+  EXPECT_TRUE(sched.empty());
+  EXPECT_EQ(nullptr, sched.peekAgain([](const uint32_t&) { return 1; }));
+  EXPECT_EQ(nullptr, sched.pickAndAdd([](const uint32_t&) { return 1; }));
+}
+
+// Validate selection probabilities by sweeping every column with evenly spaced coin tosses.
+TEST(AliasSchedulerTest, ProbabilityVerification) {
+  Random::MockRandomGenerator random;
+  AliasScheduler<uint32_t> sched(random);
+  constexpr uint32_t num_entries = 16;
+  constexpr uint32_t num_coins = 1000;
+  std::shared_ptr<uint32_t> entries[num_entries];
+  uint32_t pick_count[num_entries] = {};
+
+  double weight_sum = 0;
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(i + 1, entries[i]);
+    weight_sum += i + 1;
+  }
+  EXPECT_FALSE(sched.empty());
+
+  for (uint32_t column = 0; column < num_entries; ++column) {
+    for (uint32_t i = 0; i < num_coins; ++i) {
+      EXPECT_CALL(random, random()).WillOnce(Return(column)).WillOnce(Return(coin(i, num_coins)));
+      auto p = sched.pickAndAdd([](const uint32_t& x) { return x + 1; });
+      ++pick_count[*p];
+    }
+  }
+
+  // Each column contributes at most one pick of rounding error per entry.
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    EXPECT_NEAR((i + 1) / weight_sum * num_entries * num_coins, pick_count[i], num_entries);
+  }
+}
+
+// Validate that peeked entries are returned by the following picks.
+TEST(AliasSchedulerTest, PeekAgain) {
+  Random::MockRandomGenerator random;
+  AliasScheduler<uint32_t> sched(random);
+  auto first_entry = std::make_shared<uint32_t>(37);
+  auto second_entry = std::make_shared<uint32_t>(42);
+  sched.add(1, first_entry);
+  sched.add(1, second_entry);
+
+  EXPECT_CALL(random, random())
+      .WillOnce(Return(1))
+      .WillOnce(Return(0))
+      .WillOnce(Return(0))
+      .WillOnce(Return(0));
+  EXPECT_EQ(*second_entry, *sched.peekAgain({}));
+  EXPECT_EQ(*first_entry, *sched.peekAgain({}));
+  EXPECT_EQ(*second_entry, *sched.pickAndAdd({}));
+  EXPECT_EQ(*first_entry, *sched.pickAndAdd({}));
+}
+
+// Validate that expired entries are ignored.
+TEST(AliasSchedulerTest, Expired) {
+  NiceMock<Random::MockRandomGenerator> random;
+  AliasScheduler<uint32_t> sched(random);
+
+  auto second_entry = std::make_shared<uint32_t>(42);
+  {
+    auto first_entry = std::make_shared<uint32_t>(37);
+    sched.add(1000, first_entry);
+    sched.add(1, second_entry);
+  }
+
+  for (uint32_t i = 0; i < 4; ++i) {
+    EXPECT_CALL(random, random()).WillOnce(Return(i)).WillOnce(Return(coin(i, 4)));
+    EXPECT_EQ(*second_entry, *sched.pickAndAdd({}));
+  }
+}
+
+// Validate that all entries expiring leaves the scheduler empty.
+TEST(AliasSchedulerTest, AllExpired) {
+  NiceMock<Random::MockRandomGenerator> random;
+  AliasScheduler<uint32_t> sched(random);
+  {
+    auto entry = std::make_shared<uint32_t>(37);
+    sched.add(1, entry);
+  }
+  EXPECT_EQ(nullptr, sched.pickAndAdd({}));
+  EXPECT_TRUE(sched.empty());
+}
+
+// Validate that changed weights are picked up once as many weights as there are entries changed.
+TEST(AliasSchedulerTest, WeightChangesRebuildTable) {
+  Random::MockRandomGenerator random;
+  AliasScheduler<uint32_t> sched(random);
+  auto first_entry = std::make_shared<uint32_t>(0);
+  auto second_entry = std::make_shared<uint32_t>(1);
+  sched.add(1, first_entry);
+  sched.add(1, second_entry);
+  const auto calculate_weight = [](const uint32_t& x) { return x == 0 ? 3 : 2; };
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+
+  // With equal weights every column picks its own entry. The first changed weight does not trigger
+  // a rebuild.
+  EXPECT_CALL(random, random()).WillOnce(Return(0)).WillOnce(Return(max));
+  EXPECT_EQ(*first_entry, *sched.pickAndAdd(calculate_weight));
+  EXPECT_CALL(random, random()).WillOnce(Return(1)).WillOnce(Return(max));
+  EXPECT_EQ(*second_entry, *sched.pickAndAdd(calculate_weight));
+
+  // Both weights changed, the table is rebuilt with weights 3 and 2 and the second column is now
+  // partly aliased to the first entry.
+  EXPECT_CALL(random, random()).WillOnce(Return(0)).WillOnce(Return(max));
+  EXPECT_EQ(*first_entry, *sched.pickAndAdd(calculate_weight));
+  EXPECT_CALL(random, random()).WillOnce(Return(1)).WillOnce(Return(max));
+  EXPECT_EQ(*first_entry, *sched.pickAndAdd(calculate_weight));
+  EXPECT_CALL(random, random()).WillOnce(Return(1)).WillOnce(Return(0));
+  EXPECT_EQ(*second_entry, *sched.pickAndAdd(calculate_weight));
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
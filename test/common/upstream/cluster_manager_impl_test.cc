@@ -4,6 +4,7 @@
 #include "envoy/config/cluster/v3/cluster.pb.validate.h"
 #include "envoy/config/core/v3/base.pb.h"
 
+#include "source/common/common/hash.h"
 #include "source/common/config/xds_resource.h"
 #include "source/common/network/raw_buffer_socket.h"
 #include "source/common/network/resolver_impl.h"
@@ -14,6 +15,7 @@
 #include "test/common/upstream/test_cluster_manager.h"
 #include "test/config/v2_link_hacks.h"
 #include "test/mocks/http/conn_pool.h"
+#include "test/mocks/http/stream_decoder.h"
 #include "test/mocks/matcher/mocks.h"
 #include "test/mocks/protobuf/mocks.h"
 #include "test/mocks/server/instance.h"
@@ -37,6 +39,11 @@ public:
     ASSERT(data.has_value());
     return dynamic_cast<Http::ConnectionPool::MockInstance*>(data.value().pool_);
   }
+
+  static Http::ConnectionPool::Instance* getRealPool(absl::optional<HttpPoolData> data) {
+    ASSERT(data.has_value());
+    return data.value().pool_;
+  }
 };
 
 class TcpPoolDataPeer {
@@ -4307,6 +4314,167 @@ TEST_F(ClusterManagerImplTest, HttpPoolDataForwardsCallsToConnectionPool) {
   opt_cp.value().drainConnections(ConnectionPool::DrainBehavior::DrainAndDelete);
 }
 
+std::string sharedConnPoolClusterYaml(bool http2) {
+  return fmt::format(R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      type: STATIC
+      lb_policy: ROUND_ROBIN
+      shared_connection_pool:
+        owner_threads: 1
+      {}
+      load_assignment:
+        cluster_name: cluster_1
+        endpoints:
+        - lb_endpoints:
+          - endpoint:
+              address:
+                socket_address:
+                  address: 127.0.0.1
+                  port_value: 11001
+  )EOF",
+                     http2 ? "http2_protocol_options: {}" : "");
+}
+
+// Test that a shared connection pool owner is only picked once all the workers, identified by the
+// names of their dispatchers, are registered, and that it is picked among the first owner_threads
+// workers by the host address.
+TEST_F(ClusterManagerImplTest, SharedConnPoolOwner) {
+  server_.options_.concurrency_ = 2;
+  create(parseBootstrapFromV3Yaml(sharedConnPoolClusterYaml(true)));
+  const Host& host = *cluster_manager_->getThreadLocalCluster("cluster_1")
+                          ->prioritySet()
+                          .hostSetsPerPriority()[0]
+                          ->hosts()[0];
+
+  NiceMock<Event::MockDispatcher> main_dispatcher("main_thread");
+  NiceMock<Event::MockDispatcher> invalid_dispatcher("worker_x");
+  NiceMock<Event::MockDispatcher> out_of_range_dispatcher("worker_2");
+  NiceMock<Event::MockDispatcher> worker0_dispatcher("worker_0");
+  NiceMock<Event::MockDispatcher> worker1_dispatcher("worker_1");
+  auto worker0 = std::make_shared<Http::SharedConnPoolThread>(worker0_dispatcher);
+  auto worker1 = std::make_shared<Http::SharedConnPoolThread>(worker1_dispatcher);
+
+  // Threads which are not workers are ignored.
+  cluster_manager_->addSharedConnPoolThread(
+      main_dispatcher, std::make_shared<Http::SharedConnPoolThread>(main_dispatcher));
+  cluster_manager_->addSharedConnPoolThread(
+      invalid_dispatcher, std::make_shared<Http::SharedConnPoolThread>(invalid_dispatcher));
+  cluster_manager_->addSharedConnPoolThread(
+      out_of_range_dispatcher,
+      std::make_shared<Http::SharedConnPoolThread>(out_of_range_dispatcher));
+  cluster_manager_->addSharedConnPoolThread(worker1_dispatcher, worker1);
+  EXPECT_EQ(nullptr, cluster_manager_->sharedConnPoolOwner(host, 1));
+
+  cluster_manager_->addSharedConnPoolThread(worker0_dispatcher, worker0);
+  EXPECT_EQ(worker0, cluster_manager_->sharedConnPoolOwner(host, 1));
+  // Owner threads beyond the concurrency are capped.
+  const std::vector<Http::SharedConnPoolThreadSharedPtr> workers{worker0, worker1};
+  EXPECT_EQ(workers[HashUtil::xxHash64(host.address()->asStringView()) % 2],
+            cluster_manager_->sharedConnPoolOwner(host, 2));
+  EXPECT_EQ(cluster_manager_->sharedConnPoolOwner(host, 2),
+            cluster_manager_->sharedConnPoolOwner(host, 5));
+
+  cluster_manager_->removeSharedConnPoolThread(worker1_dispatcher);
+  EXPECT_EQ(nullptr, cluster_manager_->sharedConnPoolOwner(host, 1));
+  cluster_manager_->removeSharedConnPoolThread(worker0_dispatcher);
+}
+
+// Test that streams which can use connections of another worker get a shared connection pool,
+// which hands them off to the pool looked up on the owner, and that all others get a pool of
+// their own.
+TEST_F(ClusterManagerImplTest, SharedConnPoolForShareableStreams) {
+  create(parseBootstrapFromV3Yaml(sharedConnPoolClusterYaml(true)));
+  NiceMock<Event::MockDispatcher> owner_dispatcher("worker_0");
+  std::vector<Event::PostCb> owner_posts;
+  ON_CALL(owner_dispatcher, post(_)).WillByDefault(Invoke([&owner_posts](Event::PostCb cb) {
+    owner_posts.push_back(std::move(cb));
+  }));
+  cluster_manager_->addSharedConnPoolThread(
+      owner_dispatcher, std::make_shared<Http::SharedConnPoolThread>(owner_dispatcher));
+
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _)).Times(0);
+  Http::ConnectionPool::Instance* shared_pool = HttpPoolDataPeer::getRealPool(
+      cluster_manager_->getThreadLocalCluster("cluster_1")
+          ->httpConnPool(ResourcePriority::Default, Http::Protocol::Http2, nullptr));
+  ASSERT_NE(nullptr, shared_pool);
+  EXPECT_EQ("shared", shared_pool->protocolDescription());
+  Mock::VerifyAndClearExpectations(&factory_);
+
+  // Downstream derived socket options need a connection of their own.
+  {
+    NiceMock<MockLoadBalancerContext> context;
+    EXPECT_CALL(context, upstreamSocketOptions())
+        .WillOnce(Return(Network::SocketOptionFactory::buildIpTransparentOptions()));
+    EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _))
+        .WillOnce(Return(new NiceMock<Http::ConnectionPool::MockInstance>()));
+    EXPECT_TRUE(cluster_manager_->getThreadLocalCluster("cluster_1")
+                    ->httpConnPool(ResourcePriority::Default, Http::Protocol::Http2, &context)
+                    .has_value());
+  }
+  // So do transport socket options.
+  {
+    NiceMock<MockLoadBalancerContext> context;
+    Network::TransportSocketOptionsConstSharedPtr transport_socket_options =
+        std::make_shared<Network::TransportSocketOptionsImpl>("example.com");
+    ON_CALL(context, upstreamTransportSocketOptions())
+        .WillByDefault(Return(transport_socket_options));
+    EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _))
+        .WillOnce(Return(new NiceMock<Http::ConnectionPool::MockInstance>()));
+    EXPECT_TRUE(cluster_manager_->getThreadLocalCluster("cluster_1")
+                    ->httpConnPool(ResourcePriority::Default, Http::Protocol::Http2, &context)
+                    .has_value());
+  }
+
+  // A stream is handed off to the owner, which looks up its own pool for the host. As the owner
+  // and this worker share the thread local cluster manager in this test, the owner lookup only
+  // finds a pool of its own once the shared pool is gone.
+  NiceMock<Http::MockResponseDecoder> decoder;
+  NiceMock<Http::ConnectionPool::MockCallbacks> callbacks;
+  ConnectionPool::Cancellable* cancellable =
+      shared_pool->newStream(decoder, callbacks, {false, false});
+  ASSERT_NE(nullptr, cancellable);
+  cancellable->cancel(ConnectionPool::CancelPolicy::Default);
+  shared_pool->drainConnections(ConnectionPool::DrainBehavior::DrainAndDelete);
+  // The shared pool clears the deferred delete list when it is deleted, which the list of the mock
+  // dispatcher does not support while being cleared itself.
+  std::list<Event::DeferredDeletablePtr> to_delete =
+      std::move(factory_.tls_.dispatcher_.to_delete_);
+  to_delete.clear();
+
+  Http::ConnectionPool::MockInstance* owner_pool =
+      new NiceMock<Http::ConnectionPool::MockInstance>();
+  NiceMock<ConnectionPool::MockCancellable> owner_cancellable;
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _)).WillOnce(Return(owner_pool));
+  EXPECT_CALL(*owner_pool, newStream(_, _, _)).WillOnce(Return(&owner_cancellable));
+  EXPECT_CALL(owner_cancellable, cancel(ConnectionPool::CancelPolicy::Default));
+  ASSERT_EQ(2, owner_posts.size());
+  for (Event::PostCb& cb : owner_posts) {
+    cb();
+  }
+  owner_posts.clear();
+
+  cluster_manager_->removeSharedConnPoolThread(owner_dispatcher);
+}
+
+// Test that HTTP/1.1 streams never use a shared connection pool.
+TEST_F(ClusterManagerImplTest, SharedConnPoolNotUsedForHttp11) {
+  create(parseBootstrapFromV3Yaml(sharedConnPoolClusterYaml(false)));
+  NiceMock<Event::MockDispatcher> owner_dispatcher("worker_0");
+  cluster_manager_->addSharedConnPoolThread(
+      owner_dispatcher, std::make_shared<Http::SharedConnPoolThread>(owner_dispatcher));
+
+  Http::ConnectionPool::MockInstance* pool = new NiceMock<Http::ConnectionPool::MockInstance>();
+  EXPECT_CALL(factory_, allocateConnPool_(_, _, _, _, _)).WillOnce(Return(pool));
+  EXPECT_EQ(pool, HttpPoolDataPeer::getPool(cluster_manager_->getThreadLocalCluster("cluster_1")
+                                                ->httpConnPool(ResourcePriority::Default,
+                                                               Http::Protocol::Http11, nullptr)));
+
+  cluster_manager_->removeSharedConnPoolThread(owner_dispatcher);
+}
+
 // Test that the read only cross-priority host map in the main thread is correctly synchronized to
 // the worker thread when the cluster's host set is updated.
 TEST_F(ClusterManagerImplTest, CrossPriorityHostMapSyncTest) {
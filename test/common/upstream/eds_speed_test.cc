@@ -30,6 +30,7 @@
 #include "test/mocks/ssl/mocks.h"
 #include "test/mocks/upstream/cluster_manager.h"
 #include "test/test_common/test_runtime.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "benchmark/benchmark.h"
@@ -57,7 +58,7 @@ public:
     } else {
       grpc_mux_.reset(new Config::GrpcMuxImpl(
           local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_),
-          server_context_.dispatcher_,
+          server_context_.dispatcher_, Thread::threadFactoryForTest(),
           *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
               "envoy.service.endpoint.v3.EndpointDiscoveryService.StreamEndpoints"),
           random_, stats_, {}, true, std::move(config_validators_),
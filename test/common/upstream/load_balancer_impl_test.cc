@@ -1,5 +1,7 @@
 #include <bitset>
 #include <cstdint>
+#include <limits>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -1121,6 +1123,26 @@ TEST_P(RoundRobinLoadBalancerTest, WeightedSeed) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
 }
 
+// Validate that the alias table scheduler is used for weighted RR when configured.
+TEST_P(RoundRobinLoadBalancerTest, WeightedAliasTable) {
+  common_config_.set_weighted_scheduler(
+      envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS_TABLE);
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime(), 3)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init(false);
+
+  // Each pick draws the host source, the alias table column and the coin toss between the column
+  // and its alias. The first host only fills half of its column, the rest is aliased to the second.
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(0));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(max));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(1)).WillOnce(Return(max));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+}
+
 TEST_P(RoundRobinLoadBalancerTest, MaxUnhealthyPanic) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime()),
                               makeTestHost(info_, "tcp://127.0.0.1:81", simTime())};
@@ -2129,6 +2151,27 @@ TEST_P(LeastRequestLoadBalancerTest, PNC) {
   EXPECT_EQ(hostSet().healthy_hosts_[3], lb_5.chooseHost(nullptr));
 }
 
+// Validate that the alias table scheduler uses the active request adjusted host weights.
+TEST_P(LeastRequestLoadBalancerTest, WeightImbalanceAliasTable) {
+  common_config_.set_weighted_scheduler(
+      envoy::config::cluster::v3::Cluster::CommonLbConfig::ALIAS_TABLE);
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime(), 3)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  // Host 1 has an effective weight of 3 / (2 + 1) = 1, the same as host 0.
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(2);
+
+  LeastRequestLoadBalancer lb{priority_set_, nullptr, stats_, runtime_, random_, common_config_,
+                              least_request_lb_config_, simTime()};
+
+  // With equal effective weights every column picks its own host.
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(max));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb.chooseHost(nullptr));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(1)).WillOnce(Return(max));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb.chooseHost(nullptr));
+}
+
 TEST_P(LeastRequestLoadBalancerTest, WeightImbalance) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
                               makeTestHost(info_, "tcp://127.0.0.1:81", simTime(), 2)};
@@ -2487,6 +2530,195 @@ TEST_P(LeastRequestLoadBalancerTest, SlowStartWaitForPassingHC) {
 INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, LeastRequestLoadBalancerTest,
                          ::testing::Values(true, false));
 
+class PeakEwmaLoadBalancerTest : public LoadBalancerTestBase {
+public:
+  PeakEwmaLoadBalancer lb_{priority_set_, nullptr,        stats_,
+                           runtime_,      random_,        common_config_,
+                           absl::nullopt, simTime()};
+};
+
+TEST_P(PeakEwmaLoadBalancerTest, NoHosts) { EXPECT_EQ(nullptr, lb_.chooseHost(nullptr)); }
+
+// A host with a lower response time estimate is preferred when active requests are equal.
+TEST_P(PeakEwmaLoadBalancerTest, PrefersFasterHost) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime()),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime())};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  hostSet().healthy_hosts_[0]->responseTimeEstimator().add(std::chrono::milliseconds(100));
+  hostSet().healthy_hosts_[1]->responseTimeEstimator().add(std::chrono::milliseconds(10));
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(1);
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // Enough active requests on the faster host outweigh its lower response time.
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(20);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+}
+
+// Hosts without samples are preferred while idle and penalized once they have active requests.
+TEST_P(PeakEwmaLoadBalancerTest, UnknownResponseTime) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime()),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime())};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  hostSet().healthy_hosts_[0]->responseTimeEstimator().add(std::chrono::milliseconds(10));
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, HostCost) {
+  HostSharedPtr host = makeTestHost(info_, "tcp://127.0.0.1:80", simTime());
+  EXPECT_EQ(0, PeakEwmaLoadBalancer::hostCost(*host));
+
+  host->stats().rq_active_.set(2);
+  EXPECT_EQ(PeakEwmaLoadBalancer::UnknownResponseTimePenalty + 2,
+            PeakEwmaLoadBalancer::hostCost(*host));
+
+  host->responseTimeEstimator().add(std::chrono::milliseconds(10));
+  EXPECT_DOUBLE_EQ(30, PeakEwmaLoadBalancer::hostCost(*host));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, WeightImbalance) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime(), 2)};
+  stats_.max_host_weight_.set(2UL);
+
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  EXPECT_CALL(random_, random()).WillRepeatedly(Return(0));
+
+  // Without any samples nor active requests we should see 2:1 ratio for hosts[1] to hosts[0].
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, ChoiceCount) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime()),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime()),
+                              makeTestHost(info_, "tcp://127.0.0.1:82", simTime())};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  hostSet().healthy_hosts_[0]->responseTimeEstimator().add(std::chrono::milliseconds(30));
+  hostSet().healthy_hosts_[1]->responseTimeEstimator().add(std::chrono::milliseconds(20));
+  hostSet().healthy_hosts_[2]->responseTimeEstimator().add(std::chrono::milliseconds(10));
+
+  envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig config;
+  config.mutable_choice_count()->set_value(3);
+  PeakEwmaLoadBalancer lb_3{priority_set_, nullptr, stats_, runtime_, random_, common_config_,
+                            config,        simTime()};
+
+  // 3 choices configured results in P3C.
+  EXPECT_CALL(random_, random())
+      .Times(4)
+      .WillOnce(Return(0))
+      .WillOnce(Return(0))
+      .WillOnce(Return(2))
+      .WillOnce(Return(1));
+  EXPECT_EQ(hostSet().healthy_hosts_[2], lb_3.chooseHost(nullptr));
+}
+
+INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, PeakEwmaLoadBalancerTest,
+                         ::testing::Values(true, false));
+
+class OrcaWeightedRoundRobinLoadBalancerTest : public LoadBalancerTestBase {
+public:
+  void init() {
+    lb_ = std::make_unique<OrcaWeightedRoundRobinLoadBalancer>(
+        priority_set_, nullptr, stats_, runtime_, random_, common_config_, orca_lb_config_,
+        simTime());
+  }
+
+  envoy::config::cluster::v3::Cluster::OrcaWeightedRoundRobinLbConfig orca_lb_config_;
+  std::unique_ptr<OrcaWeightedRoundRobinLoadBalancer> lb_;
+};
+
+TEST_P(OrcaWeightedRoundRobinLoadBalancerTest, NoHosts) {
+  init();
+  EXPECT_EQ(nullptr, lb_->chooseHost(nullptr));
+}
+
+// Without load reports, the configured host weights are used.
+TEST_P(OrcaWeightedRoundRobinLoadBalancerTest, NoLoadReports) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime()),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime())};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init();
+
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_->chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
+}
+
+// Utilization weights are used once the blackout period is over, and hosts without load reports
+// get the mean weight.
+TEST_P(OrcaWeightedRoundRobinLoadBalancerTest, UtilizationWeights) {
+  orca_lb_config_.mutable_blackout_period()->set_seconds(1);
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime()),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime()),
+                              makeTestHost(info_, "tcp://127.0.0.1:82", simTime())};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init();
+
+  // hosts[0] serves 3 times more requests than hosts[1] for the same utilization.
+  hostSet().healthy_hosts_[0]->utilizationWeight().update(300, 0.5);
+  hostSet().healthy_hosts_[1]->utilizationWeight().update(100, 0.5);
+  simTime().advanceTimeWait(std::chrono::seconds(2));
+
+  // Picks until every host was re-inserted in the schedule with its new weight.
+  for (int i = 0; i < 10; ++i) {
+    lb_->chooseHost(nullptr);
+  }
+
+  // Weights are 600, 200 and 400 (mean) respectively.
+  std::map<HostConstSharedPtr, uint32_t> picks;
+  for (int i = 0; i < 600; ++i) {
+    ++picks[lb_->chooseHost(nullptr)];
+  }
+  EXPECT_NEAR(300, picks[hostSet().healthy_hosts_[0]], 2);
+  EXPECT_NEAR(100, picks[hostSet().healthy_hosts_[1]], 2);
+  EXPECT_NEAR(200, picks[hostSet().healthy_hosts_[2]], 2);
+}
+
+// Load reports are ignored during the blackout period.
+TEST_P(OrcaWeightedRoundRobinLoadBalancerTest, BlackoutPeriod) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime()),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime())};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init();
+
+  hostSet().healthy_hosts_[0]->utilizationWeight().update(900, 0.5);
+  hostSet().healthy_hosts_[1]->utilizationWeight().update(100, 0.5);
+
+  std::map<HostConstSharedPtr, uint32_t> picks;
+  for (int i = 0; i < 100; ++i) {
+    ++picks[lb_->chooseHost(nullptr)];
+  }
+  EXPECT_EQ(50, picks[hostSet().healthy_hosts_[0]]);
+  EXPECT_EQ(50, picks[hostSet().healthy_hosts_[1]]);
+}
+
+INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, OrcaWeightedRoundRobinLoadBalancerTest,
+                         ::testing::Values(true, false));
+
 class RandomLoadBalancerTest : public LoadBalancerTestBase {
 public:
   void init() {
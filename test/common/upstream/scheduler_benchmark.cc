@@ -4,6 +4,7 @@
 #include <random>
 
 #include "source/common/common/random_generator.h"
+#include "source/common/upstream/alias_scheduler.h"
 #include "source/common/upstream/edf_scheduler.h"
 #include "source/common/upstream/wrsq_scheduler.h"
 
@@ -159,6 +160,72 @@ void uniqueWeightPickWRSQ(::benchmark::State& state) {
                             });
 }
 
+void splitWeightAddAlias(::benchmark::State& state) {
+  Random::RandomGeneratorImpl random;
+  AliasScheduler<SchedulerTester::ObjInfo> alias(random);
+  const size_t num_objs = state.range(0);
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    SchedulerTester::setupSplitWeights(alias, num_objs, state);
+  }
+}
+
+void uniqueWeightAddAlias(::benchmark::State& state) {
+  Random::RandomGeneratorImpl random;
+  AliasScheduler<SchedulerTester::ObjInfo> alias(random);
+  const size_t num_objs = state.range(0);
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    SchedulerTester::setupUniqueWeights(alias, num_objs, state);
+  }
+}
+
+void splitWeightPickAlias(::benchmark::State& state) {
+  Random::RandomGeneratorImpl random;
+  AliasScheduler<SchedulerTester::ObjInfo> alias(random);
+  const size_t num_objs = state.range(0);
+
+  SchedulerTester::pickTest(alias, state,
+                            [num_objs, &state](Scheduler<SchedulerTester::ObjInfo>& sched) {
+                              return SchedulerTester::setupSplitWeights(sched, num_objs, state);
+                            });
+}
+
+void uniqueWeightPickAlias(::benchmark::State& state) {
+  Random::RandomGeneratorImpl random;
+  AliasScheduler<SchedulerTester::ObjInfo> alias(random);
+  const size_t num_objs = state.range(0);
+
+  SchedulerTester::pickTest(alias, state,
+                            [num_objs, &state](Scheduler<SchedulerTester::ObjInfo>& sched) {
+                              return SchedulerTester::setupUniqueWeights(sched, num_objs, state);
+                            });
+}
+
+// Builds a scheduler and performs one pick, which is the work done by the weighted load balancers
+// on every host set update.
+void buildTest(Scheduler<SchedulerTester::ObjInfo>& sched, ::benchmark::State& state) {
+  const size_t num_objs = state.range(0);
+  SchedulerTester::setupUniqueWeights(sched, num_objs, state);
+  sched.pickAndAdd([](const auto& i) { return i.weight; });
+}
+
+void uniqueWeightBuildEdf(::benchmark::State& state) {
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    EdfScheduler<SchedulerTester::ObjInfo> edf;
+    buildTest(edf, state);
+  }
+}
+
+void uniqueWeightBuildAlias(::benchmark::State& state) {
+  Random::RandomGeneratorImpl random;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    AliasScheduler<SchedulerTester::ObjInfo> alias(random);
+    buildTest(alias, state);
+  }
+}
+
+// Scheduler comparisons at small, medium and very large host counts.
+void schedulerSizes(::benchmark::internal::Benchmark* b) { b->Arg(10)->Arg(1000)->Arg(50000); }
+
 BENCHMARK(splitWeightAddEdf)
     ->Unit(::benchmark::kMicrosecond)
     ->RangeMultiplier(8)
@@ -179,6 +246,31 @@ BENCHMARK(uniqueWeightAddWRSQ)
     ->Range(1 << 6, 1 << 14);
 BENCHMARK(uniqueWeightPickEdf)->RangeMultiplier(8)->Range(1 << 6, 1 << 14);
 BENCHMARK(uniqueWeightPickWRSQ)->RangeMultiplier(8)->Range(1 << 6, 1 << 14);
+BENCHMARK(splitWeightAddAlias)
+    ->Unit(::benchmark::kMicrosecond)
+    ->RangeMultiplier(8)
+    ->Range(1 << 6, 1 << 14);
+BENCHMARK(uniqueWeightAddAlias)
+    ->Unit(::benchmark::kMicrosecond)
+    ->RangeMultiplier(8)
+    ->Range(1 << 6, 1 << 14);
+BENCHMARK(splitWeightPickAlias)->RangeMultiplier(8)->Range(1 << 6, 1 << 14);
+BENCHMARK(uniqueWeightPickAlias)->RangeMultiplier(8)->Range(1 << 6, 1 << 14);
+
+BENCHMARK(splitWeightPickEdf)->Name("compare/splitWeightPickEdf")->Apply(schedulerSizes);
+BENCHMARK(splitWeightPickWRSQ)->Name("compare/splitWeightPickWRSQ")->Apply(schedulerSizes);
+BENCHMARK(splitWeightPickAlias)->Name("compare/splitWeightPickAlias")->Apply(schedulerSizes);
+BENCHMARK(uniqueWeightPickEdf)->Name("compare/uniqueWeightPickEdf")->Apply(schedulerSizes);
+BENCHMARK(uniqueWeightPickWRSQ)->Name("compare/uniqueWeightPickWRSQ")->Apply(schedulerSizes);
+BENCHMARK(uniqueWeightPickAlias)->Name("compare/uniqueWeightPickAlias")->Apply(schedulerSizes);
+BENCHMARK(uniqueWeightBuildEdf)
+    ->Name("compare/uniqueWeightBuildEdf")
+    ->Unit(::benchmark::kMicrosecond)
+    ->Apply(schedulerSizes);
+BENCHMARK(uniqueWeightBuildAlias)
+    ->Name("compare/uniqueWeightBuildAlias")
+    ->Unit(::benchmark::kMicrosecond)
+    ->Apply(schedulerSizes);
 
 } // namespace
 } // namespace Upstream
@@ -0,0 +1,75 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures hashing the static clusters of a bootstrap, which ClusterManagerImpl spreads over
+// several threads before loading the clusters in order on the main thread. Only this phase of
+// startup runs in parallel, so the rest of loading a cluster is not part of the measurement.
+
+#include "envoy/config/cluster/v3/cluster.pb.h"
+#include "envoy/extensions/transport_sockets/tls/v3/tls.pb.h"
+
+#include "source/common/common/thread.h"
+#include "source/common/protobuf/utility.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+std::vector<envoy::config::cluster::v3::Cluster> makeClusters(size_t num_clusters) {
+  std::vector<envoy::config::cluster::v3::Cluster> clusters(num_clusters);
+  for (size_t i = 0; i < num_clusters; ++i) {
+    auto& cluster = clusters[i];
+    const std::string name = absl::StrCat("cluster_", i);
+    cluster.set_name(name);
+    cluster.set_type(envoy::config::cluster::v3::Cluster::STRICT_DNS);
+    cluster.mutable_connect_timeout()->set_seconds(1);
+    auto* endpoint = cluster.mutable_load_assignment()->add_endpoints()->add_lb_endpoints();
+    auto* address = endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address();
+    address->set_address(absl::StrCat(name, ".example.com"));
+    address->set_port_value(443);
+    cluster.mutable_circuit_breakers()->add_thresholds()->mutable_max_connections()->set_value(
+        1024);
+
+    envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
+    tls_context.set_sni(absl::StrCat(name, ".example.com"));
+    auto* validation_context =
+        tls_context.mutable_common_tls_context()->mutable_validation_context();
+    validation_context->mutable_trusted_ca()->set_filename("/etc/ssl/certs/ca-certificates.crt");
+    validation_context->add_match_typed_subject_alt_names()->mutable_matcher()->set_exact(
+        absl::StrCat(name, ".example.com"));
+    cluster.mutable_transport_socket()->set_name("envoy.transport_sockets.tls");
+    cluster.mutable_transport_socket()->mutable_typed_config()->PackFrom(tls_context);
+  }
+  return clusters;
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void bmHashStaticClusters(benchmark::State& state) {
+  const auto clusters = makeClusters(state.range(0));
+  const uint32_t num_threads = state.range(1);
+  std::vector<uint64_t> hashes(clusters.size());
+  for (auto _ : state) { // NOLINT(clang-analyzer-deadcode.DeadStores)
+    Thread::parallelFor(Thread::threadFactoryForTest(), num_threads, clusters.size(),
+                        [&clusters, &hashes](size_t index) {
+                          hashes[index] = MessageUtil::hash(clusters[index]);
+                        });
+  }
+  benchmark::DoNotOptimize(hashes);
+}
+BENCHMARK(bmHashStaticClusters)
+    ->Args({1000, 1})
+    ->Args({1000, 4})
+    ->Args({1000, 16})
+    ->Args({20000, 1})
+    ->Args({20000, 4})
+    ->Args({20000, 16})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
@@ -795,6 +795,97 @@ TEST_P(SubsetLoadBalancerTest, BalancesSubsetAfterUpdate) {
   EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
 }
 
+TEST_P(SubsetLoadBalancerTest, LazySubsetCreation) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK));
+  EXPECT_CALL(subset_info_, lazySubsetCreation()).WillRepeatedly(Return(true));
+
+  std::vector<SubsetSelectorPtr> subset_selectors = {makeSelector({"version"})};
+  EXPECT_CALL(subset_info_, subsetSelectors()).WillRepeatedly(ReturnRef(subset_selectors));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:81", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:82", {{"version", "1.1"}}},
+      {"tcp://127.0.0.1:83", {{"version", "1.1"}}},
+  });
+  EXPECT_EQ(0U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(0, TestUtility::findGauge(stats_store_, "testprefix.lb_subsets_hosts")->value());
+
+  TestLoadBalancerContext context_10({{"version", "1.0"}});
+  TestLoadBalancerContext context_11({{"version", "1.1"}});
+  TestLoadBalancerContext context_12({{"version", "1.2"}});
+  TestLoadBalancerContext context_prod({{"stage", "prod"}});
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_10));
+  EXPECT_EQ(1U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(2, TestUtility::findGauge(stats_store_, "testprefix.lb_subsets_hosts")->value());
+
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_11));
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(2U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(4, TestUtility::findGauge(stats_store_, "testprefix.lb_subsets_hosts")->value());
+
+  // Criteria which do not match the keys of any selector never create a subset.
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_prod));
+  EXPECT_EQ(2U, stats_.lb_subsets_created_.value());
+
+  // A subset without hosts is kept until the next update so it is not rebuilt for every request.
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_12));
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_12));
+  EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
+
+  // Updates only maintain the subsets which were already created.
+  modifyHosts({makeHost("tcp://127.0.0.1:8000", {{"version", "1.0"}}),
+               makeHost("tcp://127.0.0.1:8001", {{"version", "1.3"}})},
+              {host_set_.hosts_[2]});
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(1U, stats_.lb_subsets_removed_.value());
+  EXPECT_EQ(4, TestUtility::findGauge(stats_store_, "testprefix.lb_subsets_hosts")->value());
+
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_11));
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_11));
+}
+
+TEST_P(SubsetLoadBalancerTest, LazySubsetIdleExpiry) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK));
+  EXPECT_CALL(subset_info_, lazySubsetCreation()).WillRepeatedly(Return(true));
+  EXPECT_CALL(subset_info_, lazySubsetIdleTimeout())
+      .WillRepeatedly(Return(std::chrono::milliseconds(1000)));
+
+  std::vector<SubsetSelectorPtr> subset_selectors = {makeSelector({"version"})};
+  EXPECT_CALL(subset_info_, subsetSelectors()).WillRepeatedly(ReturnRef(subset_selectors));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:81", {{"version", "1.1"}}},
+  });
+
+  TestLoadBalancerContext context_10({{"version", "1.0"}});
+  TestLoadBalancerContext context_11({{"version", "1.1"}});
+
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10));
+  simTime().advanceTimeWait(std::chrono::milliseconds(500));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_11));
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+
+  // The 1.0 subset has been idle for the timeout, the 1.1 subset has not.
+  simTime().advanceTimeWait(std::chrono::milliseconds(500));
+  EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_11));
+  EXPECT_EQ(1U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(1U, stats_.lb_subsets_removed_.value());
+  EXPECT_EQ(1U, TestUtility::findCounter(stats_store_, "testprefix.lb_subsets_expired")->value());
+  EXPECT_EQ(1, TestUtility::findGauge(stats_store_, "testprefix.lb_subsets_hosts")->value());
+
+  // The expired subset is created again when it is selected.
+  EXPECT_EQ(host_set_.hosts_[0], lb_->chooseHost(&context_10));
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
+}
+
 TEST_P(SubsetLoadBalancerTest, ListAsAnyEnabled) {
   EXPECT_CALL(subset_info_, fallbackPolicy())
       .WillRepeatedly(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::NO_FALLBACK));
@@ -204,6 +204,20 @@ public:
   ClusterDiscoveryManager createAndSwapClusterDiscoveryManager(std::string thread_name) {
     return ClusterManagerImpl::createAndSwapClusterDiscoveryManager(std::move(thread_name));
   }
+
+  void addSharedConnPoolThread(Event::Dispatcher& dispatcher,
+                               Http::SharedConnPoolThreadSharedPtr thread) {
+    ClusterManagerImpl::addSharedConnPoolThread(dispatcher, std::move(thread));
+  }
+
+  void removeSharedConnPoolThread(Event::Dispatcher& dispatcher) {
+    ClusterManagerImpl::removeSharedConnPoolThread(dispatcher);
+  }
+
+  Http::SharedConnPoolThreadSharedPtr sharedConnPoolOwner(const Host& host,
+                                                          uint32_t owner_threads) {
+    return ClusterManagerImpl::sharedConnPoolOwner(host, owner_threads);
+  }
 };
 
 // Override postThreadLocalClusterUpdate so we can test that merged updates calls
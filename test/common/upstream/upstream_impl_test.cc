@@ -1518,6 +1518,70 @@ TEST_F(HostImplTest, HealthcheckHostname) {
   EXPECT_EQ("foo", descr.hostnameForHealthChecks());
 }
 
+TEST_F(HostImplTest, ResponseTimeEstimator) {
+  MockClusterMockPrioritySet cluster;
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234", simTime(), 1);
+  ResponseTimeEstimator& estimator = host->responseTimeEstimator();
+  EXPECT_EQ(0, estimator.estimate());
+
+  // The first sample is taken as is.
+  estimator.add(std::chrono::milliseconds(10));
+  EXPECT_DOUBLE_EQ(10, estimator.estimate());
+
+  // Slower samples replace the estimate.
+  estimator.add(std::chrono::milliseconds(100));
+  EXPECT_DOUBLE_EQ(100, estimator.estimate());
+
+  // The estimate decays with the default decay time of 10s.
+  simTime().advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_NEAR(100 * std::exp(-1), estimator.estimate(), 1e-6);
+
+  // Faster samples are blended in using the time elapsed since the previous sample.
+  estimator.add(std::chrono::milliseconds(20));
+  EXPECT_NEAR(100 * std::exp(-1) + 20 * (1 - std::exp(-1)), estimator.estimate(), 1e-6);
+}
+
+TEST_F(HostImplTest, ResponseTimeEstimatorDecayTime) {
+  MockClusterMockPrioritySet cluster;
+  envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig config;
+  config.mutable_decay_time()->set_seconds(1);
+  cluster.info_->lb_peak_ewma_config_ = config;
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234", simTime(), 1);
+
+  host->responseTimeEstimator().add(std::chrono::milliseconds(100));
+  simTime().advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_NEAR(100 * std::exp(-1), host->responseTimeEstimator().estimate(), 1e-6);
+}
+
+TEST_F(HostImplTest, UtilizationWeight) {
+  MockClusterMockPrioritySet cluster;
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234", simTime(), 1);
+  UtilizationWeight& weight = host->utilizationWeight();
+  const std::chrono::milliseconds blackout(std::chrono::seconds(10));
+  const std::chrono::milliseconds expiration(std::chrono::seconds(60));
+  EXPECT_EQ(0, weight.weight(blackout, expiration));
+
+  // Invalid reports are ignored.
+  weight.update(0, 0.5);
+  weight.update(100, 0);
+  EXPECT_EQ(0, weight.weight(std::chrono::milliseconds(0), expiration));
+
+  // The weight is only used after the blackout period.
+  weight.update(100, 0.5);
+  EXPECT_EQ(0, weight.weight(blackout, expiration));
+  EXPECT_EQ(200, weight.weight(std::chrono::milliseconds(0), expiration));
+  simTime().advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_EQ(200, weight.weight(blackout, expiration));
+
+  // The weight expires if no report is received, and the blackout period starts over.
+  simTime().advanceTimeWait(std::chrono::seconds(60));
+  EXPECT_EQ(0, weight.weight(blackout, expiration));
+  weight.update(100, 0.25);
+  EXPECT_EQ(0, weight.weight(blackout, expiration));
+  simTime().advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_EQ(400, weight.weight(blackout, expiration));
+}
+
 class StaticClusterImplTest : public testing::Test, public UpstreamImplTestBase {};
 
 TEST_F(StaticClusterImplTest, InitialHosts) {
@@ -3130,6 +3194,104 @@ TEST_F(ClusterInfoImplTest, Metadata) {
   EXPECT_EQ(LoadBalancerType::Maglev, cluster->info()->lbType());
 }
 
+TEST_F(ClusterInfoImplTest, PeakEwmaLbConfig) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: PEAK_EWMA
+    peak_ewma_lb_config:
+      choice_count: 3
+      decay_time: 5s
+    load_assignment:
+        endpoints:
+          - lb_endpoints:
+            - endpoint:
+                address:
+                  socket_address:
+                    address: foo.bar.com
+                    port_value: 443
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  EXPECT_EQ(LoadBalancerType::PeakEwma, cluster->info()->lbType());
+  EXPECT_EQ(3, cluster->info()->lbPeakEwmaConfig()->choice_count().value());
+  EXPECT_EQ(5, cluster->info()->lbPeakEwmaConfig()->decay_time().seconds());
+}
+
+TEST_F(ClusterInfoImplTest, PeakEwmaWithSubsetConfig) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: PEAK_EWMA
+    lb_subset_config:
+      subset_selectors:
+        - keys: [ "version" ]
+    load_assignment:
+        endpoints:
+          - lb_endpoints:
+            - endpoint:
+                address:
+                  socket_address:
+                    address: foo.bar.com
+                    port_value: 443
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(makeCluster(yaml), EnvoyException,
+                            "cluster: LB policy PEAK_EWMA cannot be combined with lb_subset_config");
+}
+
+TEST_F(ClusterInfoImplTest, OrcaWeightedRoundRobinLbConfig) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ORCA_WEIGHTED_ROUND_ROBIN
+    orca_weighted_round_robin_lb_config:
+      blackout_period: 5s
+      weight_expiration_period: 60s
+    load_assignment:
+        endpoints:
+          - lb_endpoints:
+            - endpoint:
+                address:
+                  socket_address:
+                    address: foo.bar.com
+                    port_value: 443
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  EXPECT_EQ(LoadBalancerType::OrcaWeightedRoundRobin, cluster->info()->lbType());
+  EXPECT_EQ(5, cluster->info()->lbOrcaWeightedRoundRobinConfig()->blackout_period().seconds());
+  EXPECT_EQ(
+      60, cluster->info()->lbOrcaWeightedRoundRobinConfig()->weight_expiration_period().seconds());
+}
+
+TEST_F(ClusterInfoImplTest, OrcaWeightedRoundRobinWithSubsetConfig) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ORCA_WEIGHTED_ROUND_ROBIN
+    lb_subset_config:
+      subset_selectors:
+        - keys: [ "version" ]
+    load_assignment:
+        endpoints:
+          - lb_endpoints:
+            - endpoint:
+                address:
+                  socket_address:
+                    address: foo.bar.com
+                    port_value: 443
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(
+      makeCluster(yaml), EnvoyException,
+      "cluster: LB policy ORCA_WEIGHTED_ROUND_ROBIN cannot be combined with lb_subset_config");
+}
+
 // Verify retry budget default values are honored.
 TEST_F(ClusterInfoImplTest, RetryBudgetDefaultPopulation) {
   std::string yaml = R"EOF(
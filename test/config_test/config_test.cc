@@ -74,6 +74,8 @@ public:
     // better for configuration tests.
     ON_CALL(server_.runtime_loader_.snapshot_, deprecatedFeatureEnabled(_, _))
         .WillByDefault(Invoke([](absl::string_view, bool default_value) { return default_value; }));
+    ON_CALL(*snapshot_, deprecatedFeatureEnabled(_, _))
+        .WillByDefault(Invoke([](absl::string_view, bool default_value) { return default_value; }));
 
     ON_CALL(server_.runtime_loader_, threadsafeSnapshot()).WillByDefault(Invoke([this]() {
       return snapshot_;
@@ -503,6 +503,132 @@ TEST_F(DnsCacheImplTest, TTLWithMinRefreshRate) {
              TestUtility::makeDnsResponse({"10.0.0.1"}));
 }
 
+// Verify that hosts which are in use are re-resolved ahead of their DNS TTL expiring, and that
+// unused hosts are re-resolved once it has expired.
+TEST_F(DnsCacheImplTest, RefreshAhead) {
+  config_.mutable_dns_refresh_ahead_ratio()->set_value(0.5);
+  initialize();
+  InSequence s;
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  Event::MockTimer* resolve_timer = new Event::MockTimer(&context_.dispatcher_);
+  Event::MockTimer* timeout_timer = new Event::MockTimer(&context_.dispatcher_);
+  EXPECT_CALL(*timeout_timer, enableTimer(std::chrono::milliseconds(5000), nullptr));
+  EXPECT_CALL(*resolver_, resolve("foo.com", _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  auto result = dns_cache_->loadDnsCacheEntry("foo.com", 80, false, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::Loading, result.status_);
+
+  EXPECT_CALL(*timeout_timer, disableTimer());
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("foo.com", DnsHostInfoEquals("10.0.0.1:80", "foo.com", false)));
+  EXPECT_CALL(callbacks,
+              onLoadDnsCacheComplete(DnsHostInfoEquals("10.0.0.1:80", "foo.com", false)));
+  EXPECT_CALL(update_callbacks_,
+              onDnsResolutionComplete("foo.com", DnsHostInfoEquals("10.0.0.1:80", "foo.com", false),
+                                      Network::DnsResolver::ResolutionStatus::Success));
+  EXPECT_CALL(*resolve_timer, enableTimer(std::chrono::milliseconds(30000), _));
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(60)));
+
+  // The host is used after it was resolved, so it is re-resolved half way through its TTL.
+  simTime().advanceTimeWait(std::chrono::seconds(10));
+  result = dns_cache_->loadDnsCacheEntry("foo.com", 80, false, callbacks);
+  ASSERT_NE(absl::nullopt, result.host_info_);
+  (*result.host_info_)->touch();
+  simTime().advanceTimeWait(std::chrono::seconds(20));
+  EXPECT_CALL(*timeout_timer, enableTimer(std::chrono::milliseconds(5000), nullptr));
+  EXPECT_CALL(*resolver_, resolve("foo.com", _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  resolve_timer->invokeCallback();
+  EXPECT_EQ(1, TestUtility::findCounter(context_.scope_, "dns_cache.foo.dns_query_refresh_ahead")
+                   ->value());
+
+  EXPECT_CALL(*timeout_timer, disableTimer());
+  EXPECT_CALL(update_callbacks_,
+              onDnsResolutionComplete("foo.com", DnsHostInfoEquals("10.0.0.1:80", "foo.com", false),
+                                      Network::DnsResolver::ResolutionStatus::Success));
+  EXPECT_CALL(*resolve_timer, enableTimer(std::chrono::milliseconds(30000), _));
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(60)));
+
+  // The host is not used again, so it is only re-resolved once its TTL expires.
+  simTime().advanceTimeWait(std::chrono::seconds(30));
+  EXPECT_CALL(*resolve_timer, enableTimer(std::chrono::milliseconds(30000), _));
+  resolve_timer->invokeCallback();
+  checkStats(2 /* attempt */, 2 /* success */, 0 /* failure */, 1 /* address changed */,
+             1 /* added */, 0 /* removed */, 1 /* num hosts */);
+
+  simTime().advanceTimeWait(std::chrono::seconds(30));
+  EXPECT_CALL(*timeout_timer, enableTimer(std::chrono::milliseconds(5000), nullptr));
+  EXPECT_CALL(*resolver_, resolve("foo.com", _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  resolve_timer->invokeCallback();
+  EXPECT_EQ(1, TestUtility::findCounter(context_.scope_, "dns_cache.foo.dns_query_refresh_ahead")
+                   ->value());
+
+  EXPECT_CALL(*timeout_timer, disableTimer());
+  EXPECT_CALL(update_callbacks_,
+              onDnsResolutionComplete("foo.com", DnsHostInfoEquals("10.0.0.1:80", "foo.com", false),
+                                      Network::DnsResolver::ResolutionStatus::Success));
+  EXPECT_CALL(*resolve_timer, enableTimer(std::chrono::milliseconds(30000), _));
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(60)));
+  checkStats(3 /* attempt */, 3 /* success */, 0 /* failure */, 1 /* address changed */,
+             1 /* added */, 0 /* removed */, 1 /* num hosts */);
+}
+
+// Verify that a resolved host keeps its address when re-resolution fails.
+TEST_F(DnsCacheImplTest, StaleServeOnResolveFailure) {
+  initialize();
+  InSequence s;
+
+  MockLoadDnsCacheEntryCallbacks callbacks;
+  Network::DnsResolver::ResolveCb resolve_cb;
+  Event::MockTimer* resolve_timer = new Event::MockTimer(&context_.dispatcher_);
+  Event::MockTimer* timeout_timer = new Event::MockTimer(&context_.dispatcher_);
+  EXPECT_CALL(*timeout_timer, enableTimer(std::chrono::milliseconds(5000), nullptr));
+  EXPECT_CALL(*resolver_, resolve("foo.com", _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  auto result = dns_cache_->loadDnsCacheEntry("foo.com", 80, false, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::Loading, result.status_);
+
+  EXPECT_CALL(*timeout_timer, disableTimer());
+  EXPECT_CALL(update_callbacks_,
+              onDnsHostAddOrUpdate("foo.com", DnsHostInfoEquals("10.0.0.1:80", "foo.com", false)));
+  EXPECT_CALL(callbacks,
+              onLoadDnsCacheComplete(DnsHostInfoEquals("10.0.0.1:80", "foo.com", false)));
+  EXPECT_CALL(update_callbacks_,
+              onDnsResolutionComplete("foo.com", DnsHostInfoEquals("10.0.0.1:80", "foo.com", false),
+                                      Network::DnsResolver::ResolutionStatus::Success));
+  EXPECT_CALL(*resolve_timer, enableTimer(std::chrono::milliseconds(6000), _));
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Success,
+             TestUtility::makeDnsResponse({"10.0.0.1"}));
+
+  simTime().advanceTimeWait(std::chrono::milliseconds(6001));
+  EXPECT_CALL(*timeout_timer, enableTimer(std::chrono::milliseconds(5000), nullptr));
+  EXPECT_CALL(*resolver_, resolve("foo.com", _, _))
+      .WillOnce(DoAll(SaveArg<2>(&resolve_cb), Return(&resolver_->active_query_)));
+  resolve_timer->invokeCallback();
+
+  EXPECT_CALL(*timeout_timer, disableTimer());
+  EXPECT_CALL(update_callbacks_, onDnsHostAddOrUpdate(_, _)).Times(0);
+  EXPECT_CALL(update_callbacks_,
+              onDnsResolutionComplete("foo.com", DnsHostInfoEquals("10.0.0.1:80", "foo.com", false),
+                                      Network::DnsResolver::ResolutionStatus::Failure));
+  EXPECT_CALL(*resolve_timer, enableTimer(_, _));
+  resolve_cb(Network::DnsResolver::ResolutionStatus::Failure, TestUtility::makeDnsResponse({}));
+  checkStats(2 /* attempt */, 1 /* success */, 1 /* failure */, 1 /* address changed */,
+             1 /* added */, 0 /* removed */, 1 /* num hosts */);
+  EXPECT_EQ(1, TestUtility::findCounter(context_.scope_, "dns_cache.foo.host_stale_serve")->value());
+
+  result = dns_cache_->loadDnsCacheEntry("foo.com", 80, false, callbacks);
+  EXPECT_EQ(DnsCache::LoadDnsCacheEntryStatus::InCache, result.status_);
+  ASSERT_NE(absl::nullopt, result.host_info_);
+  EXPECT_EQ("10.0.0.1:80", (*result.host_info_)->address()->asString());
+}
+
 // TTL purge test with different refresh/TTL parameters.
 TEST_F(DnsCacheImplTest, TTLWithCustomParameters) {
   *config_.mutable_dns_refresh_rate() = Protobuf::util::TimeUtil::SecondsToDuration(30);
@@ -1462,6 +1588,39 @@ TEST_F(DnsCacheImplTest, CacheLoad) {
   }
 }
 
+// Verify that stale entries loaded from the key value store are not all refreshed right away.
+TEST_F(DnsCacheImplTest, CacheLoadRefreshSpread) {
+  auto* time_source = new NiceMock<MockTimeSystem>();
+  context_.dispatcher_.time_system_.reset(time_source);
+  ON_CALL(*time_source, monotonicTime())
+      .WillByDefault(Return(MonotonicTime(std::chrono::seconds(100))));
+  ON_CALL(context_.api_.random_, random()).WillByDefault(Return(1234));
+
+  MockKeyValueStoreFactory factory;
+  EXPECT_CALL(factory, createEmptyConfigProto()).WillRepeatedly(Invoke([]() {
+    return std::make_unique<
+        envoy::extensions::key_value::file_based::v3::FileBasedKeyValueStoreConfig>();
+  }));
+  EXPECT_CALL(factory, createStore(_, _, _, _)).WillOnce(Invoke([]() {
+    auto store = std::make_unique<NiceMock<MockKeyValueStore>>();
+    // Resolved at 0s with a TTL of 40s, so stale by now.
+    EXPECT_CALL(*store, iterate).WillOnce(Invoke([](KeyValueStore::ConstIterateCb fn) {
+      fn("foo.com", "10.0.0.2:80|40|0");
+    }));
+    return store;
+  }));
+  Registry::InjectFactory<KeyValueStoreFactory> injector(factory);
+  config_.mutable_key_value_config()->mutable_config()->set_name("mock_key_value_store_factory");
+
+  InSequence s;
+  Event::MockTimer* refresh_timer = new Event::MockTimer(&context_.dispatcher_);
+  new NiceMock<Event::MockTimer>(&context_.dispatcher_);
+  // The minimum refresh rate of 5s plus 1234 % 5001 ms of jitter.
+  EXPECT_CALL(*refresh_timer, enableTimer(std::chrono::milliseconds(6234), _));
+  initialize();
+  EXPECT_EQ(1, TestUtility::findCounter(context_.scope_, "dns_cache.foo.cache_load")->value());
+}
+
 // Make sure the cache manager can handle the context going out of scope.
 TEST(DnsCacheManagerImplTest, TestLifetime) {
   NiceMock<Server::Configuration::MockFactoryContext> context;
@@ -5,6 +5,9 @@
 #include "source/common/network/io_socket_handle_impl.h"
 #include "source/common/network/listen_socket_impl.h"
 #include "source/common/network/listener_filter_buffer_impl.h"
+#include "source/common/runtime/runtime_features.h"
+#include "source/common/ssl/client_hello_info.h"
+#include "source/common/stream_info/filter_state_impl.h"
 #include "source/extensions/filters/listener/tls_inspector/tls_inspector.h"
 
 #include "test/extensions/filters/listener/tls_inspector/tls_utility.h"
@@ -28,8 +31,11 @@ class FastMockListenerFilterCallbacks : public Network::MockListenerFilterCallba
 public:
   FastMockListenerFilterCallbacks(Network::ConnectionSocket& socket) : socket_(socket) {}
   Network::ConnectionSocket& socket() override { return socket_; }
+  StreamInfo::FilterState& filterState() override { return *filter_state_; }
 
   Network::ConnectionSocket& socket_;
+  // Each connection has its own filter state.
+  std::unique_ptr<StreamInfo::FilterStateImpl> filter_state_;
 };
 
 // Don't inherit from the mock implementation at all, because this is instantiated
@@ -65,7 +71,11 @@ public:
   const std::vector<uint8_t> client_hello_;
 };
 
+// Runs the TLS inspector on a ClientHello, sharing the parsed ClientHello through the filter state
+// when the argument is 1.
 static void BM_TlsInspector(benchmark::State& state) {
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.tls_inspector_share_client_hello",
+                                state.range(0) != 0);
   NiceMock<FastMockOsSysCalls> os_sys_calls(Tls::Test::generateClientHello(
       Config::TLS_MIN_SUPPORTED_VERSION, Config::TLS_MAX_SUPPORTED_VERSION, "example.com",
       "\x02h2\x08http/1.1"));
@@ -84,6 +94,8 @@ static void BM_TlsInspector(benchmark::State& state) {
 
   for (auto _ : state) {
     UNREFERENCED_PARAMETER(_);
+    cb.filter_state_ = std::make_unique<StreamInfo::FilterStateImpl>(
+        StreamInfo::FilterState::LifeSpan::Connection);
     Filter filter(cfg);
     filter.onAccept(cb);
     auto filter_state = filter.onData(buffer);
@@ -100,7 +112,111 @@ static void BM_TlsInspector(benchmark::State& state) {
   }
 }
 
-BENCHMARK(BM_TlsInspector)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TlsInspector)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Measures what the TLS transport socket does to learn the client's capabilities when selecting a
+// certificate: parsing them out of the ClientHello when the argument is 0, or finding the ones the
+// TLS inspector shared through the filter state when it is 1.
+static void BM_ClientHelloInfo(benchmark::State& state) {
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_with_buffers_method()));
+  SSL_CTX_set_select_certificate_cb(
+      ctx.get(), [](const SSL_CLIENT_HELLO* client_hello) -> ssl_select_cert_result_t {
+        auto& state = *static_cast<benchmark::State*>(SSL_get_app_data(client_hello->ssl));
+        StreamInfo::FilterStateImpl filter_state(StreamInfo::FilterState::LifeSpan::Connection);
+        filter_state.setData(Ssl::ClientHelloInfo::key(),
+                             std::make_shared<Ssl::ClientHelloInfo>(*client_hello),
+                             StreamInfo::FilterState::StateType::ReadOnly,
+                             StreamInfo::FilterState::LifeSpan::Connection);
+        for (auto _ : state) {
+          UNREFERENCED_PARAMETER(_);
+          if (state.range(0) != 0) {
+            benchmark::DoNotOptimize(
+                filter_state.getDataReadOnly<Ssl::ClientHelloInfo>(Ssl::ClientHelloInfo::key()));
+          } else {
+            Ssl::ClientHelloInfo client_hello_info(*client_hello);
+            benchmark::DoNotOptimize(client_hello_info);
+          }
+        }
+        return ssl_select_cert_error;
+      });
+
+  const std::vector<uint8_t> client_hello = Tls::Test::generateClientHello(
+      Config::TLS_MIN_SUPPORTED_VERSION, Config::TLS_MAX_SUPPORTED_VERSION, "example.com",
+      "\x02h2\x08http/1.1");
+  bssl::UniquePtr<SSL> ssl(SSL_new(ctx.get()));
+  SSL_set_app_data(ssl.get(), &state);
+  SSL_set_accept_state(ssl.get());
+  BIO* bio = BIO_new_mem_buf(client_hello.data(), client_hello.size());
+  SSL_set_bio(ssl.get(), bio, bio);
+  RELEASE_ASSERT(SSL_do_handshake(ssl.get()) <= 0, "");
+}
+BENCHMARK(BM_ClientHelloInfo)->Arg(0)->Arg(1)->Unit(benchmark::kNanosecond);
+
+// Runs the TLS inspector and then the handshake of the TLS transport socket up to selecting a
+// certificate, on one connection at a time, sharing the parsed ClientHello when the argument is 1.
+// Unlike the benchmarks above, this weighs what the inspector pays for storing the ClientHello info
+// against what certificate selection saves by finding it.
+static void BM_TlsInspectorAndCertificateSelection(benchmark::State& state) {
+  Runtime::maybeSetRuntimeGuard("envoy.reloadable_features.tls_inspector_share_client_hello",
+                                state.range(0) != 0);
+  NiceMock<FastMockOsSysCalls> os_sys_calls(Tls::Test::generateClientHello(
+      Config::TLS_MIN_SUPPORTED_VERSION, Config::TLS_MAX_SUPPORTED_VERSION, "example.com",
+      "\x02h2\x08http/1.1"));
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls{&os_sys_calls};
+  NiceMock<Stats::MockStore> store;
+  envoy::extensions::filters::listener::tls_inspector::v3::TlsInspector proto_config;
+  ConfigSharedPtr cfg(std::make_shared<Config>(store, proto_config));
+  Network::IoHandlePtr io_handle = std::make_unique<Network::IoSocketHandleImpl>();
+  Network::ConnectionSocketImpl socket(std::move(io_handle), nullptr, nullptr);
+  NiceMock<FastMockDispatcher> dispatcher;
+  FastMockListenerFilterCallbacks cb(socket);
+  Network::ListenerFilterBufferImpl buffer(
+      socket.ioHandle(), dispatcher, [](bool) {}, [](Network::ListenerFilterBuffer&) {},
+      cfg->maxClientHelloSize());
+  dispatcher.file_event_callback_(Event::FileReadyType::Read);
+
+  // Learns the client's capabilities the way ServerContextImpl::selectTlsContext() does.
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_with_buffers_method()));
+  SSL_CTX_set_select_certificate_cb(
+      ctx.get(), [](const SSL_CLIENT_HELLO* client_hello) -> ssl_select_cert_result_t {
+        const auto& filter_state =
+            *static_cast<const StreamInfo::FilterState*>(SSL_get_app_data(client_hello->ssl));
+        const Ssl::ClientHelloInfo* client_hello_info = nullptr;
+        if (Runtime::runtimeFeatureEnabled(
+                "envoy.reloadable_features.tls_inspector_share_client_hello")) {
+          client_hello_info =
+              filter_state.getDataReadOnly<Ssl::ClientHelloInfo>(Ssl::ClientHelloInfo::key());
+        }
+        absl::optional<Ssl::ClientHelloInfo> parsed_client_hello_info;
+        if (client_hello_info == nullptr) {
+          client_hello_info = &parsed_client_hello_info.emplace(*client_hello);
+        }
+        benchmark::DoNotOptimize(client_hello_info->hasStatusRequest());
+        return ssl_select_cert_error;
+      });
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    cb.filter_state_ = std::make_unique<StreamInfo::FilterStateImpl>(
+        StreamInfo::FilterState::LifeSpan::Connection);
+    Filter filter(cfg);
+    filter.onAccept(cb);
+    RELEASE_ASSERT(filter.onData(buffer) == Network::FilterStatus::Continue, "");
+
+    bssl::UniquePtr<SSL> ssl(SSL_new(ctx.get()));
+    SSL_set_app_data(ssl.get(), cb.filter_state_.get());
+    SSL_set_accept_state(ssl.get());
+    BIO* bio =
+        BIO_new_mem_buf(os_sys_calls.client_hello_.data(), os_sys_calls.client_hello_.size());
+    SSL_set_bio(ssl.get(), bio, bio);
+    RELEASE_ASSERT(SSL_do_handshake(ssl.get()) <= 0, "");
+
+    socket.setDetectedTransportProtocol("");
+    socket.setRequestedServerName("");
+    socket.setRequestedApplicationProtocols({});
+  }
+}
+BENCHMARK(BM_TlsInspectorAndCertificateSelection)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
 
 } // namespace TlsInspector
 } // namespace ListenerFilters
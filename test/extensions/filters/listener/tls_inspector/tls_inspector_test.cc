@@ -2,12 +2,14 @@
 #include "source/common/http/utility.h"
 #include "source/common/network/io_socket_handle_impl.h"
 #include "source/common/network/listener_filter_buffer_impl.h"
+#include "source/common/ssl/client_hello_info.h"
 #include "source/extensions/filters/listener/tls_inspector/tls_inspector.h"
 
 #include "test/extensions/filters/listener/tls_inspector/tls_utility.h"
 #include "test/mocks/api/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
 #include "absl/strings/str_format.h"
@@ -44,6 +46,7 @@ public:
     filter_ = std::make_unique<Filter>(cfg_);
 
     EXPECT_CALL(cb_, socket()).WillRepeatedly(ReturnRef(socket_));
+    EXPECT_CALL(cb_, filterState()).Times(testing::AnyNumber());
     EXPECT_CALL(socket_, ioHandle()).WillRepeatedly(ReturnRef(*io_handle_));
     EXPECT_CALL(dispatcher_,
                 createFileEvent_(_, _, Event::PlatformDefaultTriggerType,
@@ -150,6 +153,47 @@ TEST_P(TlsInspectorTest, AlpnRegistered) {
   EXPECT_EQ(1, cfg_->stats().alpn_found_.value());
 }
 
+// Test that the parsed ClientHello is stored in the filter state for the TLS transport socket.
+TEST_P(TlsInspectorTest, ClientHelloInfoShared) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.tls_inspector_share_client_hello", "true"}});
+  init();
+  std::vector<uint8_t> client_hello = Tls::Test::generateClientHello(
+      std::get<0>(GetParam()), std::get<1>(GetParam()), "example.com", "");
+  mockSysCallForPeek(client_hello);
+  EXPECT_CALL(socket_, setRequestedServerName(_));
+  EXPECT_CALL(socket_, setDetectedTransportProtocol(absl::string_view("tls")));
+  EXPECT_CALL(socket_, detectedTransportProtocol()).Times(::testing::AnyNumber());
+  // trigger the event to copy the client hello message into buffer
+  file_event_callback_(Event::FileReadyType::Read);
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onData(*buffer_));
+
+  const auto* client_hello_info =
+      cb_.filter_state_.getDataReadOnly<Ssl::ClientHelloInfo>(Ssl::ClientHelloInfo::key());
+  ASSERT_NE(nullptr, client_hello_info);
+  EXPECT_EQ(std::get<1>(GetParam()) >= TLS1_3_VERSION, client_hello_info->hasSupportedVersions());
+  EXPECT_EQ(std::get<1>(GetParam()) >= TLS1_2_VERSION,
+            client_hello_info->offersEcdsaP256Signature());
+  EXPECT_TRUE(client_hello_info->offersP256Curve());
+  EXPECT_FALSE(client_hello_info->hasStatusRequest());
+}
+
+// Test that the parsed ClientHello is not shared by default.
+TEST_P(TlsInspectorTest, ClientHelloInfoNotSharedByDefault) {
+  init();
+  std::vector<uint8_t> client_hello = Tls::Test::generateClientHello(
+      std::get<0>(GetParam()), std::get<1>(GetParam()), "example.com", "");
+  mockSysCallForPeek(client_hello);
+  EXPECT_CALL(socket_, setRequestedServerName(_));
+  EXPECT_CALL(socket_, setDetectedTransportProtocol(absl::string_view("tls")));
+  EXPECT_CALL(socket_, detectedTransportProtocol()).Times(::testing::AnyNumber());
+  // trigger the event to copy the client hello message into buffer
+  file_event_callback_(Event::FileReadyType::Read);
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onData(*buffer_));
+  EXPECT_FALSE(cb_.filter_state_.hasDataWithName(Ssl::ClientHelloInfo::key()));
+}
+
 // Test with the ClientHello spread over multiple socket reads.
 TEST_P(TlsInspectorTest, MultipleReads) {
   init();
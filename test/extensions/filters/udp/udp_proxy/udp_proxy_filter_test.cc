@@ -9,6 +9,8 @@
 #include "source/extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
 
 #include "test/mocks/api/mocks.h"
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/network/mocks.h"
 #include "test/mocks/network/socket.h"
 #include "test/mocks/server/listener_factory_context.h"
 #include "test/mocks/upstream/cluster_manager.h"
@@ -16,18 +18,30 @@
 #include "test/mocks/upstream/cluster_update_callbacks_handle.h"
 #include "test/mocks/upstream/host.h"
 #include "test/mocks/upstream/thread_local_cluster.h"
+#include "test/test_common/registry.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
+#ifdef ENVOY_ENABLE_QUIC
+#include "source/extensions/udp_packet_writer/gso/config.h"
+
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+#include "quiche/quic/test_tools/quic_mock_syscall_wrapper.h"
+#endif
+#endif
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::Assign;
 using testing::AtLeast;
 using testing::ByMove;
 using testing::DoAll;
 using testing::DoDefault;
 using testing::InSequence;
+using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::Return;
+using testing::ReturnPointee;
 using testing::ReturnNew;
 using testing::SaveArg;
 
@@ -55,6 +69,36 @@ Api::IoCallUint64Result makeError(int sys_errno) {
                                                     Network::IoSocketError::deleteIoError));
 }
 
+// Creates batching writers which buffer every datagram until they are flushed.
+class TestUdpPacketWriterFactoryFactory : public Network::UdpPacketWriterFactoryFactory {
+public:
+  std::string name() const override { return "test.udp_packet_writer"; }
+  Network::UdpPacketWriterFactoryPtr
+  createUdpPacketWriterFactory(const envoy::config::core::v3::TypedExtensionConfig&) override {
+    auto factory = std::make_unique<NiceMock<Network::MockUdpPacketWriterFactory>>();
+    ON_CALL(*factory, createUdpPacketWriter(_, _))
+        .WillByDefault(
+            Invoke([this](Network::IoHandle&, Stats::Scope&) -> Network::UdpPacketWriterPtr {
+              auto writer = std::make_unique<NiceMock<Network::MockUdpPacketWriter>>();
+              ON_CALL(*writer, isBatchMode()).WillByDefault(Return(true));
+              ON_CALL(*writer, writePacket(_, _, _))
+                  .WillByDefault(Invoke([](const Buffer::Instance& buffer,
+                                           const Network::Address::Ip*,
+                                           const Network::Address::Instance&) {
+                    return makeNoError(buffer.length());
+                  }));
+              writers_.push_back(writer.get());
+              return writer;
+            }));
+    return factory;
+  }
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<ProtobufWkt::Struct>();
+  }
+
+  std::vector<Network::MockUdpPacketWriter*> writers_;
+};
+
 class UdpProxyFilterTest : public testing::Test {
 public:
   struct TestSession {
@@ -77,7 +121,6 @@ public:
     void expectWriteToUpstream(const std::string& data, int sys_errno = 0,
                                const Network::Address::Ip* local_ip = nullptr,
                                bool expect_connect = false, int connect_sys_errno = 0) {
-      EXPECT_CALL(*idle_timer_, enableTimer(parent_.config_->sessionTimeout(), nullptr));
       if (expect_connect) {
         EXPECT_CALL(*socket_->io_handle_, connect(_))
             .WillOnce(Invoke([connect_sys_errno]() -> Api::SysCallIntResult {
@@ -118,8 +161,6 @@ public:
 
     void recvDataFromUpstream(const std::string& data, int recv_sys_errno = 0,
                               int send_sys_errno = 0) {
-      EXPECT_CALL(*idle_timer_, enableTimer(parent_.config_->sessionTimeout(), nullptr));
-
       if (parent_.expect_gro_) {
         EXPECT_CALL(*socket_->io_handle_, supportsUdpGro());
       }
@@ -167,7 +208,6 @@ public:
 
     UdpProxyFilterTest& parent_;
     const Network::Address::InstanceConstSharedPtr upstream_address_;
-    Event::MockTimer* idle_timer_{};
     NiceMock<Network::MockSocket>* socket_;
     std::map<int, std::map<int, int>> sock_opts_;
     Event::FileReadyCb file_event_cb_;
@@ -186,6 +226,9 @@ public:
     ON_CALL(os_sys_calls_, supportsIpTransparent()).WillByDefault(Return(true));
     EXPECT_CALL(os_sys_calls_, supportsUdpGro()).Times(AtLeast(0)).WillRepeatedly(Return(true));
     EXPECT_CALL(callbacks_, udpListener()).Times(AtLeast(0));
+    EXPECT_CALL(callbacks_.udp_listener_.dispatcher_, approximateMonotonicTime())
+        .Times(AtLeast(0))
+        .WillRepeatedly(ReturnPointee(&now_));
     EXPECT_CALL(*factory_context_.cluster_manager_.thread_local_cluster_.lb_.host_, address())
         .WillRepeatedly(Return(upstream_address_));
     EXPECT_CALL(*factory_context_.cluster_manager_.thread_local_cluster_.lb_.host_, health())
@@ -200,6 +243,7 @@ public:
     EXPECT_CALL(factory_context_.cluster_manager_, addThreadLocalClusterUpdateCallbacks_(_))
         .WillOnce(DoAll(SaveArgAddress(&cluster_update_callbacks_),
                         ReturnNew<Upstream::MockClusterUpdateCallbacksHandle>()));
+    idle_timer_ = new Event::MockTimer(&callbacks_.udp_listener_.dispatcher_);
     if (has_cluster) {
       factory_context_.cluster_manager_.initializeThreadLocalClusters({"fake_cluster"});
     }
@@ -218,10 +262,15 @@ public:
     filter_->onData(data);
   }
 
+  // Lets the sessions reach the session timeout and runs the idle session scan.
+  void expireIdleSessions() {
+    now_ += config_->sessionTimeout();
+    idle_timer_->invokeCallback();
+  }
+
   void expectSessionCreate(const Network::Address::InstanceConstSharedPtr& address) {
     test_sessions_.emplace_back(*this, address);
     TestSession& new_session = test_sessions_.back();
-    new_session.idle_timer_ = new Event::MockTimer(&callbacks_.udp_listener_.dispatcher_);
     EXPECT_CALL(*filter_, createSocket(_))
         .WillOnce(Return(ByMove(Network::SocketPtr{test_sessions_.back().socket_})));
     EXPECT_CALL(
@@ -326,6 +375,8 @@ use_original_src_ip: true
   UdpProxyFilterConfigSharedPtr config_;
   Network::MockUdpReadFilterCallbacks callbacks_;
   Upstream::ClusterUpdateCallbacks* cluster_update_callbacks_{};
+  MonotonicTime now_;
+  Event::MockTimer* idle_timer_{};
   std::unique_ptr<TestUdpProxyFilter> filter_;
   std::vector<TestSession> test_sessions_;
   StringViewSaver access_log_data_;
@@ -456,7 +507,7 @@ matcher:
   EXPECT_EQ(1, config_->stats().downstream_sess_total_.value());
   EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
 
-  test_sessions_[0].idle_timer_->invokeCallback();
+  expireIdleSessions();
   EXPECT_EQ(1, config_->stats().downstream_sess_total_.value());
   EXPECT_EQ(0, config_->stats().downstream_sess_active_.value());
 
@@ -492,7 +543,7 @@ matcher:
   EXPECT_EQ(1, config_->stats().downstream_sess_total_.value());
   EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
 
-  test_sessions_[0].idle_timer_->invokeCallback();
+  expireIdleSessions();
   EXPECT_EQ(1, config_->stats().downstream_sess_total_.value());
   EXPECT_EQ(0, config_->stats().downstream_sess_active_.value());
 
@@ -607,6 +658,169 @@ matcher:
   EXPECT_EQ(access_log_data_.value(), "fake_cluster 0 5 0 0 0 1");
 }
 
+// Datagrams written by a batching upstream writer are flushed once at the end of the event loop
+// iteration.
+TEST_F(UdpProxyFilterTest, BatchedUpstreamWrites) {
+  TestUdpPacketWriterFactoryFactory writer_factory;
+  Registry::InjectFactory<Network::UdpPacketWriterFactoryFactory> registration(writer_factory);
+
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+upstream_packet_writer_config:
+  name: test.udp_packet_writer
+  typed_config:
+    '@type': type.googleapis.com/google.protobuf.Struct
+  )EOF"));
+
+  auto* flush_cb = new Event::MockSchedulableCallback(&callbacks_.udp_listener_.dispatcher_);
+  expectSessionCreate(upstream_address_);
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, connect(_))
+      .WillOnce(Return(Api::SysCallIntResult{0, 0}));
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, sendmsg(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(*flush_cb, scheduleCallbackCurrentIteration());
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  ASSERT_EQ(1, writer_factory.writers_.size());
+  Network::MockUdpPacketWriter& writer = *writer_factory.writers_[0];
+  EXPECT_CALL(writer, writePacket(BufferStringEqual("hello2"), nullptr, _))
+      .WillOnce(Return(ByMove(makeNoError(6))));
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello2");
+  EXPECT_EQ(
+      2, TestUtility::findCounter(
+             factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_,
+             "udp.sess_tx_datagrams")
+             ->value());
+
+  EXPECT_CALL(writer, flush()).WillOnce(Return(ByMove(makeNoError(11))));
+  EXPECT_CALL(writer, setWritable()).Times(0);
+  flush_cb->invokeCallback();
+
+  // A datagram still buffered when the session goes away is dropped with it.
+  EXPECT_CALL(*flush_cb, scheduleCallbackCurrentIteration());
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello3");
+  EXPECT_CALL(writer, flush()).Times(0);
+  filter_.reset();
+}
+
+// A blocked upstream writer keeps its buffered datagrams and drops new ones until the upstream
+// socket becomes writable, when the buffered datagrams are flushed.
+TEST_F(UdpProxyFilterTest, BlockedUpstreamWriterWaitsForWritable) {
+  TestUdpPacketWriterFactoryFactory writer_factory;
+  Registry::InjectFactory<Network::UdpPacketWriterFactoryFactory> registration(writer_factory);
+
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+upstream_packet_writer_config:
+  name: test.udp_packet_writer
+  typed_config:
+    '@type': type.googleapis.com/google.protobuf.Struct
+  )EOF"));
+
+  auto* flush_cb = new Event::MockSchedulableCallback(&callbacks_.udp_listener_.dispatcher_);
+  expectSessionCreate(upstream_address_);
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, connect(_))
+      .WillOnce(Return(Api::SysCallIntResult{0, 0}));
+  EXPECT_CALL(*flush_cb, scheduleCallbackCurrentIteration());
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  ASSERT_EQ(1, writer_factory.writers_.size());
+  Network::MockUdpPacketWriter& writer = *writer_factory.writers_[0];
+  bool write_blocked = false;
+  ON_CALL(writer, isWriteBlocked()).WillByDefault(ReturnPointee(&write_blocked));
+
+  EXPECT_CALL(writer, writePacket(BufferStringEqual("hello2"), nullptr, _))
+      .WillOnce(Invoke([&write_blocked](const Buffer::Instance&, const Network::Address::Ip*,
+                                        const Network::Address::Instance&) {
+        write_blocked = true;
+        return makeError(SOCKET_ERROR_AGAIN);
+      }));
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_,
+              enableFileEvents(Event::FileReadyType::Read | Event::FileReadyType::Write));
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello2");
+
+  // Nothing is written to a blocked writer, not even the end of iteration flush.
+  EXPECT_CALL(writer, writePacket(_, _, _)).Times(0);
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello3");
+  EXPECT_CALL(writer, flush()).Times(0);
+  flush_cb->invokeCallback();
+
+  Stats::Store& stats_store =
+      factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_;
+  EXPECT_EQ(1, TestUtility::findCounter(stats_store, "udp.sess_tx_datagrams")->value());
+  EXPECT_EQ(2, TestUtility::findCounter(stats_store, "udp.sess_tx_writer_blocked")->value());
+  EXPECT_EQ(0, TestUtility::findCounter(stats_store, "udp.sess_tx_errors")->value());
+
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_,
+              enableFileEvents(Event::FileReadyType::Read));
+  EXPECT_CALL(writer, setWritable()).WillOnce(Assign(&write_blocked, false));
+  EXPECT_CALL(writer, flush()).WillOnce(Return(ByMove(makeNoError(5))));
+  test_sessions_[0].file_event_cb_(Event::FileReadyType::Write);
+}
+
+#if defined(ENVOY_ENABLE_QUIC) && UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+// With the GSO batch writer, the datagrams a session forwards within one event loop iteration
+// reach the kernel in a single sendmsg call, where the default writer makes one call per datagram.
+TEST_F(UdpProxyFilterTest, GsoUpstreamWriterSendsOneSyscallPerIteration) {
+  quic::test::MockQuicSyscallWrapper quic_sys_calls;
+  quic::ScopedGlobalSyscallWrapperOverride quic_calls(&quic_sys_calls);
+
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+upstream_packet_writer_config:
+  name: envoy.udp_packet_writer.gso
+  typed_config:
+    '@type': type.googleapis.com/envoy.extensions.udp_packet_writer.v3.UdpGsoBatchWriterFactory
+  )EOF"));
+
+  auto* flush_cb = new Event::MockSchedulableCallback(&callbacks_.udp_listener_.dispatcher_);
+  expectSessionCreate(upstream_address_);
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, connect(_))
+      .WillOnce(Return(Api::SysCallIntResult{0, 0}));
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, sendmsg(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(quic_sys_calls, Sendmsg(_, _, _)).Times(0);
+  EXPECT_CALL(*flush_cb, scheduleCallbackCurrentIteration()).Times(AtLeast(1));
+  for (int i = 0; i < 3; i++) {
+    recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  }
+  EXPECT_EQ(
+      3, TestUtility::findCounter(
+             factory_context_.cluster_manager_.thread_local_cluster_.cluster_.info_->stats_store_,
+             "udp.sess_tx_datagrams")
+             ->value());
+
+  testing::Mock::VerifyAndClearExpectations(&quic_sys_calls);
+  EXPECT_CALL(quic_sys_calls, Sendmsg(_, _, _))
+      .WillOnce(Invoke([](int, const msghdr* msg, int) -> ssize_t {
+        size_t length = 0;
+        for (size_t i = 0; i < msg->msg_iovlen; ++i) {
+          length += msg->msg_iov[i].iov_len;
+        }
+        EXPECT_EQ(15u, length);
+        return length;
+      }));
+  flush_cb->invokeCallback();
+}
+#endif
+
 // No upstream host handling.
 TEST_F(UdpProxyFilterTest, NoUpstreamHost) {
   InSequence s;
@@ -730,7 +944,7 @@ matcher:
   EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
 
   // Timing out the 1st session should allow us to create another.
-  test_sessions_[0].idle_timer_->invokeCallback();
+  expireIdleSessions();
   EXPECT_EQ(1, config_->stats().downstream_sess_total_.value());
   EXPECT_EQ(0, config_->stats().downstream_sess_active_.value());
   expectSessionCreate(upstream_address_);
@@ -740,6 +954,83 @@ matcher:
   EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
 }
 
+// A single timer scans for idle sessions and keeps running while there are sessions left.
+TEST_F(UdpProxyFilterTest, IdleTimeoutOnlyExpiresIdleSessions) {
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+  )EOF"));
+
+  expectSessionCreate(upstream_address_);
+  test_sessions_[0].expectWriteToUpstream("hello", 0, nullptr, true);
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  EXPECT_TRUE(idle_timer_->enabled_);
+
+  now_ += config_->sessionTimeout() / 2;
+  expectSessionCreate(upstream_address_);
+  test_sessions_[1].expectWriteToUpstream("hello", 0, nullptr, true);
+  recvDataFromDownstream("10.0.0.3:1000", "10.0.0.2:80", "hello");
+  EXPECT_EQ(2, config_->stats().downstream_sess_active_.value());
+
+  // Only the 1st session has been idle for the session timeout.
+  now_ += config_->sessionTimeout() / 2;
+  EXPECT_CALL(*idle_timer_, enableTimer(std::chrono::milliseconds(1000), nullptr));
+  idle_timer_->invokeCallback();
+  EXPECT_EQ(1, config_->stats().idle_timeout_.value());
+  EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
+
+  // The timer is not re-enabled once the last session has expired.
+  expireIdleSessions();
+  EXPECT_EQ(2, config_->stats().idle_timeout_.value());
+  EXPECT_EQ(0, config_->stats().downstream_sess_active_.value());
+  EXPECT_FALSE(idle_timer_->enabled_);
+}
+
+// A session with recent traffic is not expired, even if it was created before an idle one.
+TEST_F(UdpProxyFilterTest, IdleTimeoutFollowsLastActivity) {
+  setup(readConfig(R"EOF(
+stat_prefix: foo
+matcher:
+  on_no_match:
+    action:
+      name: route
+      typed_config:
+        '@type': type.googleapis.com/envoy.extensions.filters.udp.udp_proxy.v3.Route
+        cluster: fake_cluster
+  )EOF"));
+
+  expectSessionCreate(upstream_address_);
+  test_sessions_[0].expectWriteToUpstream("hello", 0, nullptr, true);
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+
+  now_ += config_->sessionTimeout() / 4;
+  expectSessionCreate(upstream_address_);
+  test_sessions_[1].expectWriteToUpstream("hello", 0, nullptr, true);
+  recvDataFromDownstream("10.0.0.3:1000", "10.0.0.2:80", "hello");
+
+  // Traffic on the 1st session makes the 2nd one the least recently active.
+  now_ += config_->sessionTimeout() / 4;
+  test_sessions_[0].expectWriteToUpstream("hello2");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello2");
+
+  now_ += config_->sessionTimeout() * 3 / 4;
+  EXPECT_CALL(*idle_timer_, enableTimer(std::chrono::milliseconds(1000), nullptr));
+  idle_timer_->invokeCallback();
+  EXPECT_EQ(1, config_->stats().idle_timeout_.value());
+  EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
+
+  // The 1st session is still there to forward to.
+  test_sessions_[0].expectWriteToUpstream("hello3");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello3");
+  EXPECT_EQ(2, config_->stats().downstream_sess_total_.value());
+}
+
 // Verify that all sessions for a host are removed when a host is removed.
 TEST_F(UdpProxyFilterTest, RemoveHostSessions) {
   InSequence s;
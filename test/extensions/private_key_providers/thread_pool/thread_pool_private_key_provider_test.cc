@@ -0,0 +1,302 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include "test/mocks/server/transport_socket_factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/logging.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+class TestCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  explicit TestCallbacks(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override {
+    ++completions_;
+    dispatcher_.exit();
+  }
+
+  Event::Dispatcher& dispatcher_;
+  uint32_t completions_{};
+};
+
+class ThreadPoolPrivateKeyProviderTest : public testing::Test {
+protected:
+  ThreadPoolPrivateKeyProviderTest()
+      : api_(Api::createApiForTest(store_)), dispatcher_(api_->allocateDispatcher("test_thread")),
+        ssl_ctx_(SSL_CTX_new(TLS_method())), callbacks_(*dispatcher_) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(factory_context_, scope()).WillByDefault(ReturnRef(store_));
+  }
+
+  Ssl::PrivateKeyMethodProviderSharedPtr createProvider(const std::string& yaml) {
+    envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider config;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(yaml), config);
+    auto* factory =
+        Registry::FactoryRegistry<Ssl::PrivateKeyMethodProviderInstanceFactory>::getFactory(
+            config.provider_name());
+    EXPECT_NE(nullptr, factory);
+    return factory->createPrivateKeyMethodProviderInstance(config, factory_context_);
+  }
+
+  bssl::UniquePtr<SSL> newSsl(Ssl::PrivateKeyMethodProvider& provider) {
+    bssl::UniquePtr<SSL> ssl(SSL_new(ssl_ctx_.get()));
+    provider.registerPrivateKeyMethod(ssl.get(), callbacks_, *dispatcher_);
+    return ssl;
+  }
+
+  bssl::UniquePtr<EVP_PKEY> readKey(const std::string& key_path) {
+    const std::string pem =
+        TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(key_path));
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(pem.data(), pem.size()));
+    return bssl::UniquePtr<EVP_PKEY>(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  }
+
+  bool verify(EVP_PKEY* pkey, uint16_t signature_algorithm, const std::vector<uint8_t>& input,
+              const uint8_t* signature, size_t signature_len) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    if (!EVP_DigestVerifyInit(ctx.get(), &pctx,
+                              SSL_get_signature_algorithm_digest(signature_algorithm), nullptr,
+                              pkey)) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+      return false;
+    }
+    return EVP_DigestVerify(ctx.get(), signature, signature_len, input.data(), input.size());
+  }
+
+  uint64_t counterValue(const std::string& name) {
+    return TestUtility::findCounter(store_, "thread_pool_private_key." + name)->value();
+  }
+
+  uint64_t gaugeValue(const std::string& name) {
+    return TestUtility::findGauge(store_, "thread_pool_private_key." + name)->value();
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  TestCallbacks callbacks_;
+  const std::vector<uint8_t> input_{'h', 'a', 'n', 'd', 's', 'h', 'a', 'k', 'e'};
+};
+
+const std::string RsaKeyPath =
+    "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem";
+const std::string EcdsaKeyPath = "{{ test_rundir "
+                                 "}}/test/extensions/transport_sockets/tls/test_data/"
+                                 "selfsigned_ecdsa_p256_key.pem";
+
+std::string rsaProviderYaml(uint32_t max_pending_operations, uint32_t thread_count = 2) {
+  return absl::StrCat(R"EOF(
+provider_name: envoy.tls.key_providers.thread_pool
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+  private_key:
+    filename: ")EOF",
+                      RsaKeyPath, R"EOF("
+  thread_count: )EOF",
+                      thread_count, R"EOF(
+  max_pending_operations: )EOF",
+                      max_pending_operations);
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RsaSignIsOffloaded) {
+  auto provider = createProvider(rsaProviderYaml(16));
+  auto method = provider->getBoringSslPrivateKeyMethod();
+  bssl::UniquePtr<SSL> ssl = newSsl(*provider);
+
+  uint8_t out[512];
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry, method->sign(ssl.get(), out, &out_len, sizeof(out),
+                                                SSL_SIGN_RSA_PSS_RSAE_SHA256, input_.data(),
+                                                input_.size()));
+  // Not performed yet, or at least not consumed by the worker yet.
+  EXPECT_EQ(ssl_private_key_retry, method->complete(ssl.get(), out, &out_len, sizeof(out)));
+
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_EQ(1, callbacks_.completions_);
+  EXPECT_EQ(ssl_private_key_success, method->complete(ssl.get(), out, &out_len, sizeof(out)));
+
+  auto pkey = readKey(RsaKeyPath);
+  EXPECT_TRUE(verify(pkey.get(), SSL_SIGN_RSA_PSS_RSAE_SHA256, input_, out, out_len));
+  EXPECT_EQ(1, counterValue("offloaded_operations"));
+  EXPECT_EQ(0, counterValue("inline_operations"));
+  EXPECT_EQ(0, gaugeValue("pending_operations"));
+
+  provider->unregisterPrivateKeyMethod(ssl.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, EcdsaSignIsOffloaded) {
+  auto provider = createProvider(absl::StrCat(R"EOF(
+provider_name: envoy.tls.key_providers.thread_pool
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+  private_key:
+    filename: ")EOF",
+                                              EcdsaKeyPath, "\""));
+  auto method = provider->getBoringSslPrivateKeyMethod();
+  bssl::UniquePtr<SSL> ssl = newSsl(*provider);
+
+  uint8_t out[512];
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry, method->sign(ssl.get(), out, &out_len, sizeof(out),
+                                                SSL_SIGN_ECDSA_SECP256R1_SHA256, input_.data(),
+                                                input_.size()));
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_EQ(ssl_private_key_success, method->complete(ssl.get(), out, &out_len, sizeof(out)));
+
+  auto pkey = readKey(EcdsaKeyPath);
+  EXPECT_TRUE(verify(pkey.get(), SSL_SIGN_ECDSA_SECP256R1_SHA256, input_, out, out_len));
+  EXPECT_TRUE(provider->checkFips());
+
+  provider->unregisterPrivateKeyMethod(ssl.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, MismatchedSignatureAlgorithmFails) {
+  auto provider = createProvider(rsaProviderYaml(16));
+  auto method = provider->getBoringSslPrivateKeyMethod();
+  bssl::UniquePtr<SSL> ssl = newSsl(*provider);
+
+  uint8_t out[512];
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry, method->sign(ssl.get(), out, &out_len, sizeof(out),
+                                                SSL_SIGN_ECDSA_SECP256R1_SHA256, input_.data(),
+                                                input_.size()));
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_EQ(ssl_private_key_failure, method->complete(ssl.get(), out, &out_len, sizeof(out)));
+  EXPECT_EQ(1, counterValue("failed_operations"));
+
+  provider->unregisterPrivateKeyMethod(ssl.get());
+}
+
+// Once max_pending_operations operations are pending, further operations are performed on the
+// worker thread instead of queuing up behind them.
+TEST_F(ThreadPoolPrivateKeyProviderTest, OperationsBeyondCapArePerformedInline) {
+  auto provider = createProvider(rsaProviderYaml(1));
+  auto method = provider->getBoringSslPrivateKeyMethod();
+  bssl::UniquePtr<SSL> ssl1 = newSsl(*provider);
+  bssl::UniquePtr<SSL> ssl2 = newSsl(*provider);
+
+  uint8_t out[512];
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry, method->sign(ssl1.get(), out, &out_len, sizeof(out),
+                                                SSL_SIGN_RSA_PKCS1_SHA256, input_.data(),
+                                                input_.size()));
+  EXPECT_EQ(ssl_private_key_success, method->sign(ssl2.get(), out, &out_len, sizeof(out),
+                                                  SSL_SIGN_RSA_PKCS1_SHA256, input_.data(),
+                                                  input_.size()));
+  auto pkey = readKey(RsaKeyPath);
+  EXPECT_TRUE(verify(pkey.get(), SSL_SIGN_RSA_PKCS1_SHA256, input_, out, out_len));
+  EXPECT_EQ(1, counterValue("offloaded_operations"));
+  EXPECT_EQ(1, counterValue("inline_operations"));
+
+  // The slot of the offloaded operation is freed once it has been performed, before its result
+  // is consumed.
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_EQ(0, gaugeValue("pending_operations"));
+  EXPECT_EQ(ssl_private_key_retry, method->sign(ssl2.get(), out, &out_len, sizeof(out),
+                                                SSL_SIGN_RSA_PKCS1_SHA256, input_.data(),
+                                                input_.size()));
+  EXPECT_EQ(2, counterValue("offloaded_operations"));
+  EXPECT_EQ(ssl_private_key_success, method->complete(ssl1.get(), out, &out_len, sizeof(out)));
+
+  provider->unregisterPrivateKeyMethod(ssl1.get());
+  provider->unregisterPrivateKeyMethod(ssl2.get());
+}
+
+// A connection closed while its operation is in flight discards the result, and the provider
+// waits for the pool to be done with the operation before going away.
+TEST_F(ThreadPoolPrivateKeyProviderTest, UnregisterWithPendingOperation) {
+  auto provider = createProvider(rsaProviderYaml(1));
+  auto method = provider->getBoringSslPrivateKeyMethod();
+  bssl::UniquePtr<SSL> ssl = newSsl(*provider);
+
+  uint8_t out[512];
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry, method->sign(ssl.get(), out, &out_len, sizeof(out),
+                                                SSL_SIGN_RSA_PKCS1_SHA256, input_.data(),
+                                                input_.size()));
+  provider->unregisterPrivateKeyMethod(ssl.get());
+  EXPECT_EQ(ssl_private_key_failure, method->complete(ssl.get(), out, &out_len, sizeof(out)));
+
+  provider.reset();
+  EXPECT_EQ(0, gaugeValue("pending_operations"));
+
+  // Any completion which was posted before the connection went away is a no-op.
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(0, callbacks_.completions_);
+}
+
+// All the providers offload their operations to a single pool, which is sized by the provider
+// creating it.
+TEST_F(ThreadPoolPrivateKeyProviderTest, ProvidersShareOnePool) {
+  auto provider1 = createProvider(rsaProviderYaml(16, 2));
+  Ssl::PrivateKeyMethodProviderSharedPtr provider2;
+  EXPECT_LOG_CONTAINS("warn", "using the existing pool of 2 threads rather than 3 threads",
+                      provider2 = createProvider(rsaProviderYaml(16, 3)));
+
+  bssl::UniquePtr<SSL> ssl1 = newSsl(*provider1);
+  bssl::UniquePtr<SSL> ssl2 = newSsl(*provider2);
+  uint8_t out[512];
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry,
+            provider1->getBoringSslPrivateKeyMethod()->sign(
+                ssl1.get(), out, &out_len, sizeof(out), SSL_SIGN_RSA_PKCS1_SHA256, input_.data(),
+                input_.size()));
+  EXPECT_EQ(ssl_private_key_retry,
+            provider2->getBoringSslPrivateKeyMethod()->sign(
+                ssl2.get(), out, &out_len, sizeof(out), SSL_SIGN_RSA_PKCS1_SHA256, input_.data(),
+                input_.size()));
+  while (callbacks_.completions_ < 2) {
+    dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  }
+  EXPECT_EQ(2, counterValue("offloaded_operations"));
+
+  provider1->unregisterPrivateKeyMethod(ssl1.get());
+  provider2->unregisterPrivateKeyMethod(ssl2.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, InvalidPrivateKey) {
+  EXPECT_THROW_WITH_MESSAGE(createProvider(R"EOF(
+provider_name: envoy.tls.key_providers.thread_pool
+typed_config:
+  "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+  private_key:
+    inline_string: "not a key"
+)EOF"),
+                            EnvoyException, "Failed to read private key.");
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
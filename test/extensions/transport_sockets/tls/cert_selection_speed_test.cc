@@ -0,0 +1,144 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures TLS handshakes with a server context holding a certificate for each of many server
+// names, with the client asking for the last one. Certificates are selected by looking up the SNI
+// in an index, so the handshake cost should not depend on the number of certificates.
+
+#include "envoy/extensions/transport_sockets/tls/v3/tls.pb.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/transport_sockets/tls/context_config_impl.h"
+#include "source/extensions/transport_sockets/tls/context_impl.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/server/transport_socket_factory_context.h"
+#include "test/test_common/test_time.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+#include "openssl/x509v3.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+std::string serverName(uint32_t i) { return absl::StrCat("server", i, ".example.com"); }
+
+std::string bioContents(BIO& bio) {
+  const uint8_t* data;
+  size_t length;
+  RELEASE_ASSERT(BIO_mem_contents(&bio, &data, &length) == 1, "");
+  return {reinterpret_cast<const char*>(data), length};
+}
+
+// Returns a PEM self-signed certificate for the server name.
+std::string createCertificate(EVP_PKEY& key, uint32_t serial, const std::string& server_name) {
+  bssl::UniquePtr<X509> cert(X509_new());
+  RELEASE_ASSERT(X509_set_version(cert.get(), 2) == 1, "");
+  RELEASE_ASSERT(ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), serial) == 1, "");
+  X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert.get()), 24 * 60 * 60);
+  X509_NAME* name = X509_get_subject_name(cert.get());
+  RELEASE_ASSERT(X509_NAME_add_entry_by_txt(
+                     name, "CN", MBSTRING_UTF8,
+                     reinterpret_cast<const uint8_t*>(server_name.c_str()), -1, -1, 0) == 1,
+                 "");
+  RELEASE_ASSERT(X509_set_issuer_name(cert.get(), name) == 1, "");
+  RELEASE_ASSERT(X509_set_pubkey(cert.get(), &key) == 1, "");
+  bssl::UniquePtr<X509_EXTENSION> san(X509V3_EXT_nconf_nid(
+      nullptr, nullptr, NID_subject_alt_name, absl::StrCat("DNS:", server_name).c_str()));
+  RELEASE_ASSERT(san != nullptr && X509_add_ext(cert.get(), san.get(), -1) == 1, "");
+  RELEASE_ASSERT(X509_sign(cert.get(), &key, EVP_sha256()) != 0, "");
+
+  bssl::UniquePtr<BIO> bio(BIO_new(BIO_s_mem()));
+  RELEASE_ASSERT(PEM_write_bio_X509(bio.get(), cert.get()) == 1, "");
+  return bioContents(*bio);
+}
+
+class CertSelectionSpeedTest {
+public:
+  explicit CertSelectionSpeedTest(uint32_t num_certs) : server_name_(serverName(num_certs - 1)) {
+    // All the certificates share a P-256 key, which is quick to sign them with.
+    bssl::UniquePtr<EC_KEY> ec_key(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+    RELEASE_ASSERT(EC_KEY_generate_key(ec_key.get()) == 1, "");
+    bssl::UniquePtr<EVP_PKEY> key(EVP_PKEY_new());
+    RELEASE_ASSERT(EVP_PKEY_set1_EC_KEY(key.get(), ec_key.get()) == 1, "");
+    bssl::UniquePtr<BIO> bio(BIO_new(BIO_s_mem()));
+    RELEASE_ASSERT(
+        PEM_write_bio_PrivateKey(bio.get(), key.get(), nullptr, nullptr, 0, nullptr, nullptr) == 1,
+        "");
+    const std::string private_key = bioContents(*bio);
+
+    envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+    for (uint32_t i = 0; i < num_certs; ++i) {
+      auto* tls_certificate = tls_context.mutable_common_tls_context()->add_tls_certificates();
+      tls_certificate->mutable_certificate_chain()->set_inline_string(
+          createCertificate(*key, i + 1, serverName(i)));
+      tls_certificate->mutable_private_key()->set_inline_string(private_key);
+    }
+    config_ = std::make_unique<ServerContextConfigImpl>(tls_context, factory_context_);
+    server_context_ = std::make_unique<ServerContextImpl>(store_, *config_,
+                                                          std::vector<std::string>{}, time_system_);
+  }
+
+  void handshake(benchmark::State& state) {
+    for (auto _ : state) { // NOLINT: Silences warning about dead store
+      bssl::UniquePtr<SSL> server_ssl = server_context_->newSsl(nullptr);
+      SSL_set_accept_state(server_ssl.get());
+      bssl::UniquePtr<SSL> client_ssl(SSL_new(client_ctx_.get()));
+      SSL_set_connect_state(client_ssl.get());
+      RELEASE_ASSERT(SSL_set_tlsext_host_name(client_ssl.get(), server_name_.c_str()) == 1, "");
+      BIO* client_bio;
+      BIO* server_bio;
+      RELEASE_ASSERT(BIO_new_bio_pair(&client_bio, 0, &server_bio, 0) == 1, "");
+      SSL_set_bio(client_ssl.get(), client_bio, client_bio);
+      SSL_set_bio(server_ssl.get(), server_bio, server_bio);
+
+      bool handshake_success = false;
+      for (int i = 0; i < 10 && !handshake_success; ++i) {
+        const int client_rc = SSL_do_handshake(client_ssl.get());
+        const int server_rc = SSL_do_handshake(server_ssl.get());
+        handshake_success = client_rc == 1 && server_rc == 1;
+      }
+      RELEASE_ASSERT(handshake_success, "handshake failed");
+
+      bssl::UniquePtr<X509> peer_cert(SSL_get_peer_certificate(client_ssl.get()));
+      RELEASE_ASSERT(X509_check_host(peer_cert.get(), server_name_.data(), server_name_.size(), 0,
+                                     nullptr) == 1,
+                     "unexpected certificate selected");
+    }
+  }
+
+private:
+  const std::string server_name_;
+  Event::GlobalTimeSystem time_system_;
+  Stats::IsolatedStoreImpl store_;
+  testing::NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  std::unique_ptr<ServerContextConfigImpl> config_;
+  std::unique_ptr<ServerContextImpl> server_context_;
+  bssl::UniquePtr<SSL_CTX> client_ctx_{SSL_CTX_new(TLS_method())};
+};
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
+
+static void bmHandshakeWithManyCertificates(benchmark::State& state) {
+  const uint32_t num_certs =
+      Envoy::skipExpensiveBenchmarks() ? std::min<uint32_t>(state.range(0), 100) : state.range(0);
+  Envoy::Extensions::TransportSockets::Tls::CertSelectionSpeedTest speed_test(num_certs);
+  speed_test.handshake(state);
+}
+BENCHMARK(bmHandshakeWithManyCertificates)
+    ->Arg(1)
+    ->Arg(100)
+    ->Arg(10000)
+    ->Unit(benchmark::kMicrosecond);
@@ -1,16 +1,20 @@
 #include <string>
 #include <vector>
 
+#include "source/common/network/transport_socket_options_impl.h"
 #include "source/extensions/transport_sockets/tls/cert_validator/default_validator.h"
 #include "source/extensions/transport_sockets/tls/cert_validator/san_matcher.h"
+#include "source/extensions/transport_sockets/tls/cert_validator/verified_certificate_cache.h"
 
 #include "test/extensions/transport_sockets/tls/cert_validator/test_common.h"
 #include "test/extensions/transport_sockets/tls/ssl_test_utility.h"
 #include "test/test_common/environment.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
+#include "openssl/sha.h"
 #include "openssl/ssl.h"
 #include "openssl/x509v3.h"
 
@@ -292,6 +296,88 @@ TEST(DefaultCertValidatorTest, WithVerifyDepth) {
   EXPECT_EQ(X509_STORE_CTX_get_error(store_ctx.get()), X509_V_OK);
 }
 
+TEST(DefaultCertValidatorTest, VerifiedCertificateCache) {
+  Stats::TestUtil::TestStore test_store;
+  SslStats stats = generateSslStats(test_store);
+  Event::SimulatedTimeSystem time_system;
+  envoy::config::core::v3::TypedExtensionConfig typed_conf;
+
+  // The test certificates may be expired, which is not what is tested here.
+  auto test_config = std::make_unique<TestCertificateValidationContextConfig>(
+      typed_conf, /*allow_expired_certificate=*/true,
+      std::vector<envoy::extensions::transport_sockets::tls::v3::SubjectAltNameMatcher>{},
+      TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+          "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ca_cert.pem")),
+      absl::nullopt, 16, std::chrono::seconds(60));
+  DefaultCertValidator validator(test_config.get(), stats, time_system);
+  SSLContextPtr ssl_ctx = SSL_CTX_new(TLS_method());
+  validator.initializeSslContexts({ssl_ctx.get()}, false);
+  // A context which trusts nothing, so that any chain actually verified against it fails.
+  SSLContextPtr untrusted_ssl_ctx = SSL_CTX_new(TLS_method());
+
+  bssl::UniquePtr<STACK_OF(X509)> cert_chain(sk_X509_new_null());
+  ASSERT_TRUE(bssl::PushToStack(
+      cert_chain.get(),
+      readCertFromFile(TestEnvironment::substitute(
+          "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"))));
+  auto verify = [&](SSL_CTX& ctx,
+                    const Network::TransportSocketOptionsConstSharedPtr& options = nullptr) {
+    TestSslExtendedSocketInfo extended_socket_info;
+    const ValidationResults results = validator.doVerifyCertChain(
+        *cert_chain, /*callback=*/nullptr, &extended_socket_info, options, ctx, {}, false, "");
+    EXPECT_EQ(results.status == ValidationResults::ValidationStatus::Successful,
+              extended_socket_info.certificateValidationStatus() ==
+                  Ssl::ClientValidationStatus::Validated);
+    return results.status;
+  };
+
+  EXPECT_EQ(ValidationResults::ValidationStatus::Successful, verify(*ssl_ctx));
+  EXPECT_EQ(1, stats.verified_certificate_cache_miss_.value());
+
+  // The chain was verified recently, so it is not verified again.
+  EXPECT_EQ(ValidationResults::ValidationStatus::Successful, verify(*untrusted_ssl_ctx));
+  EXPECT_EQ(1, stats.verified_certificate_cache_hit_.value());
+
+  // A connection overriding the SANs to verify is a different entry.
+  auto options = std::make_shared<Network::TransportSocketOptionsImpl>(
+      "", std::vector<std::string>{"server1.example.com"});
+  EXPECT_EQ(ValidationResults::ValidationStatus::Failed, verify(*untrusted_ssl_ctx, options));
+  EXPECT_EQ(2, stats.verified_certificate_cache_miss_.value());
+  EXPECT_EQ(ValidationResults::ValidationStatus::Successful, verify(*ssl_ctx, options));
+  EXPECT_EQ(ValidationResults::ValidationStatus::Successful, verify(*untrusted_ssl_ctx, options));
+  EXPECT_EQ(2, stats.verified_certificate_cache_hit_.value());
+
+  // Entries are verified again once the TTL elapses.
+  time_system.advanceTimeWait(std::chrono::seconds(61));
+  EXPECT_EQ(ValidationResults::ValidationStatus::Failed, verify(*untrusted_ssl_ctx));
+  EXPECT_EQ(4, stats.verified_certificate_cache_miss_.value());
+  EXPECT_EQ(2, stats.verified_certificate_cache_hit_.value());
+}
+
+// The digests of a chain can't be mistaken for overrides, or the other way around.
+TEST(DefaultCertValidatorTest, VerifiedCertificateCacheKeyIsUnambiguous) {
+  bssl::UniquePtr<X509> cert1 = readCertFromFile(TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"));
+  bssl::UniquePtr<X509> cert2 = readCertFromFile(TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ca_cert.pem"));
+  uint8_t cert2_hash[SHA256_DIGEST_LENGTH];
+  unsigned cert2_hash_length = 0;
+  ASSERT_EQ(1, X509_digest(cert2.get(), EVP_sha256(), cert2_hash, &cert2_hash_length));
+  const absl::string_view cert2_digest(reinterpret_cast<const char*>(cert2_hash),
+                                       cert2_hash_length);
+
+  bssl::UniquePtr<STACK_OF(X509)> long_chain(sk_X509_new_null());
+  ASSERT_TRUE(bssl::PushToStack(long_chain.get(), bssl::UpRef(cert1)));
+  ASSERT_TRUE(bssl::PushToStack(long_chain.get(), bssl::UpRef(cert2)));
+  bssl::UniquePtr<STACK_OF(X509)> short_chain(sk_X509_new_null());
+  ASSERT_TRUE(bssl::PushToStack(short_chain.get(), bssl::UpRef(cert1)));
+
+  EXPECT_NE(VerifiedCertificateCache::key(*long_chain, ""),
+            VerifiedCertificateCache::key(*short_chain, cert2_digest));
+  EXPECT_EQ(VerifiedCertificateCache::key(*long_chain, "overrides"),
+            VerifiedCertificateCache::key(*long_chain, "overrides"));
+}
+
 class MockCertificateValidationContextConfig : public Ssl::CertificateValidationContextConfig {
 public:
   MockCertificateValidationContextConfig() {
@@ -320,6 +406,10 @@ public:
   MOCK_METHOD(Api::Api&, api, (), (const override));
   bool onlyVerifyLeafCertificateCrl() const override { return false; }
   absl::optional<uint32_t> maxVerifyDepth() const override { return absl::nullopt; }
+  uint32_t verifiedCertificateCacheMaxEntries() const override { return 0; }
+  std::chrono::milliseconds verifiedCertificateCacheTtl() const override {
+    return std::chrono::milliseconds(0);
+  }
 
 private:
   std::string s_;
@@ -45,10 +45,14 @@ public:
       bool allow_expired_certificate = false,
       std::vector<envoy::extensions::transport_sockets::tls::v3::SubjectAltNameMatcher>
           san_matchers = {},
-      std::string ca_cert = "", absl::optional<uint32_t> verify_depth = absl::nullopt)
+      std::string ca_cert = "", absl::optional<uint32_t> verify_depth = absl::nullopt,
+      uint32_t verified_certificate_cache_max_entries = 0,
+      std::chrono::milliseconds verified_certificate_cache_ttl = std::chrono::milliseconds(0))
       : allow_expired_certificate_(allow_expired_certificate), api_(Api::createApiForTest()),
         custom_validator_config_(custom_config), san_matchers_(san_matchers), ca_cert_(ca_cert),
-        max_verify_depth_(verify_depth){};
+        max_verify_depth_(verify_depth),
+        verified_certificate_cache_max_entries_(verified_certificate_cache_max_entries),
+        verified_certificate_cache_ttl_(verified_certificate_cache_ttl){};
   TestCertificateValidationContextConfig()
       : api_(Api::createApiForTest()), custom_validator_config_(absl::nullopt){};
 
@@ -88,6 +92,12 @@ public:
   bool onlyVerifyLeafCertificateCrl() const override { return false; }
 
   absl::optional<uint32_t> maxVerifyDepth() const override { return max_verify_depth_; }
+  uint32_t verifiedCertificateCacheMaxEntries() const override {
+    return verified_certificate_cache_max_entries_;
+  }
+  std::chrono::milliseconds verifiedCertificateCacheTtl() const override {
+    return verified_certificate_cache_ttl_;
+  }
 
 private:
   bool allow_expired_certificate_{false};
@@ -98,6 +108,8 @@ private:
   const std::string ca_cert_;
   const std::string ca_cert_path_{"TEST_CA_CERT_PATH"};
   const absl::optional<uint32_t> max_verify_depth_{absl::nullopt};
+  const uint32_t verified_certificate_cache_max_entries_{0};
+  const std::chrono::milliseconds verified_certificate_cache_ttl_{0};
 };
 
 } // namespace Tls
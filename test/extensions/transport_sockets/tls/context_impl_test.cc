@@ -10,6 +10,8 @@
 #include "source/common/json/json_loader.h"
 #include "source/common/secret/sds_api.h"
 #include "source/common/stats/isolated_store_impl.h"
+#include "source/common/stats/thread_local_store.h"
+#include "source/common/thread_local/thread_local_impl.h"
 #include "source/extensions/transport_sockets/tls/context_config_impl.h"
 #include "source/extensions/transport_sockets/tls/context_impl.h"
 #include "source/extensions/transport_sockets/tls/utility.h"
@@ -22,12 +24,14 @@
 #include "test/extensions/transport_sockets/tls/test_data/unittest_cert_info.h"
 #include "test/mocks/init/mocks.h"
 #include "test/mocks/local_info/mocks.h"
+#include "test/mocks/runtime/mocks.h"
 #include "test/mocks/secret/mocks.h"
 #include "test/mocks/server/transport_socket_factory_context.h"
 #include "test/mocks/ssl/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/test_runtime.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -36,6 +40,7 @@
 using Envoy::Protobuf::util::MessageDifferencer;
 using testing::EndsWith;
 using testing::NiceMock;
+using testing::Return;
 using testing::ReturnRef;
 
 namespace Envoy {
@@ -493,6 +498,37 @@ TEST_F(SslContextImplTest, AtMostOneEcdsaCert) {
                           "at most one certificate of a given type may be specified");
 }
 
+// Multiple certificates of the same type are accepted if they are for different server names.
+TEST_F(SslContextImplTest, MultipleRsaCertsForDifferentServerNames) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_key.pem"
+  )EOF";
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  Envoy::Ssl::ServerContextSharedPtr server_ctx(
+      manager_.createSslServerContext(store_, server_context_config, {}));
+  auto cleanup = cleanUpHelper(server_ctx);
+  EXPECT_EQ(2, server_ctx->getCertChainInformation().size());
+
+  // Certificates can't be selected by server name without the index.
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.tls_select_certificate_by_sni", "false"}});
+  EXPECT_THROW_WITH_REGEX(manager_.createSslServerContext(store_, server_context_config, {}),
+                          EnvoyException,
+                          "at most one certificate of a given type may be specified");
+}
+
 // Certificates with no subject CN and no SANs are rejected.
 TEST_F(SslContextImplTest, MustHaveSubjectOrSAN) {
   envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
@@ -510,6 +546,198 @@ TEST_F(SslContextImplTest, MustHaveSubjectOrSAN) {
                           EnvoyException, "has neither subject CN nor SAN names");
 }
 
+// Server contexts queued in a batch are only built and handed out when the batch is finished.
+TEST_F(SslContextImplTest, ServerContextBatch) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem"
+  )EOF";
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  // The contexts are built concurrently, but a threaded store may only be used on this thread,
+  // where their stats are created first.
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr main_dispatcher = api->allocateDispatcher("main_thread");
+  ThreadLocal::InstanceImpl tls;
+  tls.registerThread(*main_dispatcher, true);
+  Stats::AllocatorImpl alloc(store_.symbolTable());
+  Stats::ThreadLocalStoreImpl thread_safe_store(alloc);
+  thread_safe_store.initializeThreading(*main_dispatcher, tls);
+
+  std::vector<Envoy::Ssl::ServerContextSharedPtr> contexts(8);
+  manager_.startServerContextBatch();
+  for (auto& context : contexts) {
+    manager_.createSslServerContextDeferred(
+        thread_safe_store, server_context_config, {},
+        [&context](Envoy::Ssl::ServerContextSharedPtr ctx) { context = std::move(ctx); });
+  }
+  for (const auto& context : contexts) {
+    EXPECT_EQ(nullptr, context);
+  }
+  manager_.finishServerContextBatch(Thread::threadFactoryForTest(), 4);
+
+  size_t count = 0;
+  manager_.iterateContexts([&count](const Envoy::Ssl::Context&) { ++count; });
+  EXPECT_EQ(contexts.size(), count);
+  EXPECT_NE(nullptr, TestUtility::findCounter(thread_safe_store, "ssl.handshake"));
+  for (auto& context : contexts) {
+    EXPECT_NE(nullptr, context);
+    manager_.removeContext(context);
+  }
+
+  // Outside of a batch the context is built immediately.
+  Envoy::Ssl::ServerContextSharedPtr context;
+  manager_.createSslServerContextDeferred(
+      thread_safe_store, server_context_config, {},
+      [&context](Envoy::Ssl::ServerContextSharedPtr ctx) { context = std::move(ctx); });
+  EXPECT_NE(nullptr, context);
+  manager_.removeContext(context);
+
+  tls.shutdownGlobalThreading();
+  thread_safe_store.shutdownThreading();
+  tls.shutdownThread();
+}
+
+// Contexts with a certificate validator and a private key provider are built on the batch threads.
+TEST_F(SslContextImplTest, ServerContextBatchWithValidationAndPrivateKeyProvider) {
+  NiceMock<Ssl::MockContextManager> context_manager;
+  NiceMock<Ssl::MockPrivateKeyMethodManager> private_key_method_manager;
+  auto private_key_method_provider =
+      std::make_shared<NiceMock<Ssl::MockPrivateKeyMethodProvider>>();
+  auto private_key_method = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  ON_CALL(factory_context_, sslContextManager()).WillByDefault(ReturnRef(context_manager));
+  ON_CALL(context_manager, privateKeyMethodManager())
+      .WillByDefault(ReturnRef(private_key_method_manager));
+  ON_CALL(private_key_method_manager, createPrivateKeyMethodProvider(_, _))
+      .WillByDefault(Return(private_key_method_provider));
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_cert.pem"
+      private_key_provider:
+        provider_name: mock_provider
+        typed_config:
+          "@type": type.googleapis.com/google.protobuf.Struct
+          value:
+            test_value: 100
+    validation_context:
+      trusted_ca:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ca_cert.pem"
+      crl:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ca_cert.crl"
+      match_typed_subject_alt_names:
+      - san_type: DNS
+        matcher:
+          exact: "server1.example.com"
+  )EOF";
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  Stats::AllocatorImpl alloc(store_.symbolTable());
+  Stats::ThreadLocalStoreImpl thread_safe_store(alloc);
+
+  std::vector<Envoy::Ssl::ServerContextSharedPtr> contexts(8);
+  EXPECT_CALL(*private_key_method_provider, getBoringSslPrivateKeyMethod())
+      .Times(contexts.size())
+      .WillRepeatedly(Return(private_key_method));
+  manager_.startServerContextBatch();
+  for (auto& context : contexts) {
+    manager_.createSslServerContextDeferred(
+        thread_safe_store, server_context_config, {},
+        [&context](Envoy::Ssl::ServerContextSharedPtr ctx) { context = std::move(ctx); });
+  }
+  manager_.finishServerContextBatch(Thread::threadFactoryForTest(), 4);
+
+  for (auto& context : contexts) {
+    ASSERT_NE(nullptr, context);
+    EXPECT_THAT(context->getCaCertInformation()->path(), EndsWith("ca_cert.pem"));
+    manager_.removeContext(context);
+  }
+}
+
+// A failure to build any context in a batch is rethrown, after the contexts which were built are
+// handed out.
+TEST_F(SslContextImplTest, ServerContextBatchError) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext good_tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem"
+  )EOF"),
+                            good_tls_context);
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext bad_tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/no_subject_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/no_subject_key.pem"
+  )EOF"),
+                            bad_tls_context);
+  ServerContextConfigImpl good_config(good_tls_context, factory_context_);
+  ServerContextConfigImpl bad_config(bad_tls_context, factory_context_);
+  Stats::AllocatorImpl alloc(store_.symbolTable());
+  Stats::ThreadLocalStoreImpl thread_safe_store(alloc);
+
+  Envoy::Ssl::ServerContextSharedPtr good_context;
+  bool bad_called = false;
+  manager_.startServerContextBatch();
+  manager_.createSslServerContextDeferred(
+      thread_safe_store, good_config, {},
+      [&good_context](Envoy::Ssl::ServerContextSharedPtr ctx) { good_context = std::move(ctx); });
+  manager_.createSslServerContextDeferred(thread_safe_store, bad_config, {},
+                                          [&bad_called](Envoy::Ssl::ServerContextSharedPtr) {
+                                            bad_called = true;
+                                          });
+  EXPECT_THROW_WITH_REGEX(manager_.finishServerContextBatch(Thread::threadFactoryForTest(), 2),
+                          EnvoyException, "has neither subject CN nor SAN names");
+  EXPECT_FALSE(bad_called);
+  ASSERT_NE(nullptr, good_context);
+  size_t count = 0;
+  manager_.iterateContexts([&count](const Envoy::Ssl::Context&) { ++count; });
+  EXPECT_EQ(1, count);
+  manager_.removeContext(good_context);
+  good_context.reset();
+
+  // A cancelled batch drops its queued contexts without calling back.
+  manager_.startServerContextBatch();
+  manager_.createSslServerContextDeferred(
+      thread_safe_store, good_config, {},
+      [&good_context](Envoy::Ssl::ServerContextSharedPtr ctx) { good_context = std::move(ctx); });
+  manager_.createSslServerContextDeferred(thread_safe_store, bad_config, {},
+                                          [&bad_called](Envoy::Ssl::ServerContextSharedPtr) {
+                                            bad_called = true;
+                                          });
+  manager_.cancelServerContextBatch();
+  EXPECT_EQ(nullptr, good_context);
+  EXPECT_FALSE(bad_called);
+  count = 0;
+  manager_.iterateContexts([&count](const Envoy::Ssl::Context&) { ++count; });
+  EXPECT_EQ(0, count);
+}
+
+// The shared session cache is sized from runtime when the manager is created.
+TEST_F(SslContextImplTest, SessionCacheSizeFromRuntime) {
+  NiceMock<Runtime::MockLoader> runtime;
+  EXPECT_CALL(runtime.snapshot_, getInteger("tls.shared_session_cache.max_sessions",
+                                            ContextManagerImpl::DefaultSessionCacheMaxSessions))
+      .WillOnce(Return(128));
+  EXPECT_CALL(runtime.snapshot_, getInteger("tls.shared_session_cache.shards",
+                                            ContextManagerImpl::DefaultSessionCacheShards))
+      .WillOnce(Return(4));
+  ContextManagerImpl manager(time_system_, runtime);
+}
+
 class SslServerContextImplOcspTest : public SslContextImplTest {
 public:
   Envoy::Ssl::ServerContextSharedPtr loadConfig(ServerContextConfigImpl& cfg) {
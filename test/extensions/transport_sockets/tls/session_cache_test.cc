@@ -0,0 +1,109 @@
+#include "source/extensions/transport_sockets/tls/session_cache.h"
+
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+class SessionCacheTest : public testing::Test {
+protected:
+  bssl::UniquePtr<SSL_SESSION> newSession(uint16_t version = TLS1_2_VERSION) {
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ssl_ctx_.get()));
+    EXPECT_EQ(1, SSL_SESSION_set_protocol_version(session.get(), version));
+    return session;
+  }
+
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_{SSL_CTX_new(TLS_method())};
+};
+
+TEST_F(SessionCacheTest, LookupReturnsMostRecentSession) {
+  SessionCache cache(16, 1);
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+
+  bssl::UniquePtr<SSL_SESSION> first = newSession();
+  bssl::UniquePtr<SSL_SESSION> second = newSession();
+  SSL_SESSION* second_ptr = second.get();
+  cache.insert("a", std::move(first), 2);
+  cache.insert("a", std::move(second), 2);
+  EXPECT_EQ(2, cache.size());
+
+  // Reusable sessions stay in the cache.
+  EXPECT_EQ(second_ptr, cache.lookup("a").get());
+  EXPECT_EQ(second_ptr, cache.lookup("a").get());
+  EXPECT_EQ(nullptr, cache.lookup("b"));
+  EXPECT_EQ(2, cache.size());
+}
+
+TEST_F(SessionCacheTest, MaxSessionsPerKey) {
+  SessionCache cache(16, 1);
+  cache.insert("a", newSession(), 1);
+  bssl::UniquePtr<SSL_SESSION> second = newSession();
+  SSL_SESSION* second_ptr = second.get();
+  cache.insert("a", std::move(second), 1);
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(second_ptr, cache.lookup("a").get());
+}
+
+TEST_F(SessionCacheTest, SingleUseSessionsAreRemoved) {
+  SessionCache cache(16, 1);
+  bssl::UniquePtr<SSL_SESSION> reusable = newSession();
+  SSL_SESSION* reusable_ptr = reusable.get();
+  bssl::UniquePtr<SSL_SESSION> single_use = newSession(TLS1_3_VERSION);
+  SSL_SESSION* single_use_ptr = single_use.get();
+  cache.insert("a", std::move(reusable), 2);
+  cache.insert("a", std::move(single_use), 2);
+
+  EXPECT_EQ(single_use_ptr, cache.lookup("a").get());
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(reusable_ptr, cache.lookup("a").get());
+}
+
+TEST_F(SessionCacheTest, EvictsLeastRecentlyUsedKeys) {
+  SessionCache cache(2, 1);
+  cache.insert("a", newSession(), 1);
+  cache.insert("b", newSession(), 1);
+  // Using "a" makes "b" the least recently used key.
+  EXPECT_NE(nullptr, cache.lookup("a"));
+  cache.insert("c", newSession(), 1);
+
+  EXPECT_EQ(2, cache.size());
+  EXPECT_NE(nullptr, cache.lookup("a"));
+  EXPECT_EQ(nullptr, cache.lookup("b"));
+  EXPECT_NE(nullptr, cache.lookup("c"));
+}
+
+TEST_F(SessionCacheTest, Remove) {
+  SessionCache cache(16, 4);
+  bssl::UniquePtr<SSL_SESSION> session = newSession();
+  SSL_SESSION* session_ptr = session.get();
+  cache.insert("a", std::move(session), 1);
+
+  // Only the given session is removed.
+  bssl::UniquePtr<SSL_SESSION> other = newSession();
+  cache.remove("a", other.get());
+  cache.remove("b", session_ptr);
+  EXPECT_EQ(1, cache.size());
+
+  cache.remove("a", session_ptr);
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+}
+
+TEST_F(SessionCacheTest, BoundedAcrossShards) {
+  SessionCache cache(64, 4);
+  for (int i = 0; i < 1000; ++i) {
+    cache.insert(std::to_string(i), newSession(), 1);
+  }
+  EXPECT_LE(cache.size(), 64);
+  EXPECT_NE(nullptr, cache.lookup("999"));
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
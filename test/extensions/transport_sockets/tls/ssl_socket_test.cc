@@ -31,6 +31,7 @@
 #include "test/extensions/transport_sockets/tls/test_data/san_dns3_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_data/san_dns4_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_data/san_dns_cert_info.h"
+#include "test/extensions/transport_sockets/tls/test_data/san_multiple_dns_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_data/san_uri_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_data/selfsigned_ecdsa_p256_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_private_key_method_provider.h"
@@ -938,7 +939,8 @@ protected:
 
   void testClientSessionResumption(const std::string& server_ctx_yaml,
                                    const std::string& client_ctx_yaml, bool expect_reuse,
-                                   const Network::Address::IpVersion version);
+                                   const Network::Address::IpVersion version,
+                                   bool separate_client_contexts = false);
 
   NiceMock<Runtime::MockLoader> runtime_;
   Event::DispatcherPtr dispatcher_;
@@ -1297,6 +1299,42 @@ TEST_P(SslSocketTest, MultiCertPreferEcdsa) {
   testUtil(test_options);
 }
 
+// Verify that the certificate valid for the SNI is selected, either by exact or wildcard name, and
+// that the first certificate is used when none is.
+TEST_P(SslSocketTest, MultiCertSelectBySni) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_key.pem"
+)EOF";
+  // The handshake only succeeds if the server presents the expected certificate.
+  const auto test_sni = [&](absl::string_view sni, absl::string_view expected_cert_hash) {
+    const std::string client_ctx_yaml = absl::StrCat(R"EOF(
+    sni: ")EOF",
+                                                     sni, R"EOF("
+    common_tls_context:
+      validation_context:
+        verify_certificate_hash: )EOF",
+                                                     expected_cert_hash);
+    TestUtilOptions test_options(client_ctx_yaml, server_ctx_yaml, true, version_);
+    testUtil(test_options);
+  };
+
+  test_sni("server1.example.com", TEST_SAN_DNS_CERT_256_HASH);
+  test_sni("server2.example.com", TEST_SAN_MULTIPLE_DNS_CERT_256_HASH);
+  test_sni("SERVER2.example.com", TEST_SAN_MULTIPLE_DNS_CERT_256_HASH);
+  test_sni("www.example.com", TEST_SAN_MULTIPLE_DNS_CERT_256_HASH);
+  test_sni("www.server1.example.com", TEST_SAN_DNS_CERT_256_HASH);
+  test_sni("example.com", TEST_SAN_DNS_CERT_256_HASH);
+}
+
 TEST_P(SslSocketTest, GetUriWithLocalUriSan) {
   const std::string client_ctx_yaml = R"EOF(
   common_tls_context:
@@ -3290,6 +3328,34 @@ TEST_P(SslSocketTest, TicketSessionResumption) {
                               version_);
 }
 
+// Sessions resumed by session ID are found by other server contexts with the same session ID
+// context through the shared session cache.
+TEST_P(SslSocketTest, SessionIdResumptionAcrossContexts) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.tls_shared_session_cache", "true"}});
+
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+  disable_stateless_session_resumption: true
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      tls_params:
+        tls_maximum_protocol_version: TLSv1_2
+  )EOF";
+
+  testTicketSessionResumption(server_ctx_yaml, {}, server_ctx_yaml, {}, client_ctx_yaml, true,
+                              version_);
+}
+
 TEST_P(SslSocketTest, TicketSessionResumptionCustomTimeout) {
   const std::string server_ctx_yaml = R"EOF(
   common_tls_context:
@@ -3911,7 +3977,8 @@ TEST_P(SslSocketTest, ClientAuthCrossListenerSessionResumption) {
 void SslSocketTest::testClientSessionResumption(const std::string& server_ctx_yaml,
                                                 const std::string& client_ctx_yaml,
                                                 bool expect_reuse,
-                                                const Network::Address::IpVersion version) {
+                                                const Network::Address::IpVersion version,
+                                                bool separate_client_contexts) {
   InSequence s;
 
   ContextManagerImpl manager(time_system_);
@@ -3953,6 +4020,11 @@ void SslSocketTest::testClientSessionResumption(const std::string& server_ctx_ya
       std::make_unique<ClientContextConfigImpl>(client_ctx_proto, client_factory_context);
   ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager,
                                                    client_stats_store);
+  // When requested, the second connection uses another context with the same configuration, e.g.
+  // as if the cluster had been updated in between.
+  ClientSslSocketFactory second_client_ssl_socket_factory(
+      std::make_unique<ClientContextConfigImpl>(client_ctx_proto, client_factory_context), manager,
+      client_stats_store);
   Network::ClientConnectionPtr client_connection = dispatcher->createClientConnection(
       socket->connectionInfoProvider().localAddress(), Network::Address::InstanceConstSharedPtr(),
       client_ssl_socket_factory.createTransportSocket(nullptr, nullptr), nullptr, nullptr);
@@ -4017,7 +4089,10 @@ void SslSocketTest::testClientSessionResumption(const std::string& server_ctx_ya
 
   client_connection = dispatcher->createClientConnection(
       socket->connectionInfoProvider().localAddress(), Network::Address::InstanceConstSharedPtr(),
-      client_ssl_socket_factory.createTransportSocket(nullptr, nullptr), nullptr, nullptr);
+      separate_client_contexts
+          ? second_client_ssl_socket_factory.createTransportSocket(nullptr, nullptr)
+          : client_ssl_socket_factory.createTransportSocket(nullptr, nullptr),
+      nullptr, nullptr);
   client_connection->addConnectionCallbacks(client_connection_callbacks);
   client_connection->connect();
 
@@ -4119,6 +4194,34 @@ TEST_P(SslSocketTest, ClientSessionResumptionEnabledTls12) {
   testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, true, version_);
 }
 
+// Sessions are only resumed across client contexts through the shared session cache.
+TEST_P(SslSocketTest, ClientSessionResumptionAcrossContexts) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_0
+      tls_maximum_protocol_version: TLSv1_2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_0
+      tls_maximum_protocol_version: TLSv1_2
+)EOF";
+
+  testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, false, version_, true);
+
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.tls_shared_session_cache", "true"}});
+  testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, true, version_, true);
+}
+
 // Make sure client session resumption is not happening with TLS 1.3 when it's disabled.
 TEST_P(SslSocketTest, ClientSessionResumptionDisabledTls13) {
   const std::string server_ctx_yaml = R"EOF(
@@ -5292,6 +5395,10 @@ protected:
     listener_ = dispatcher_->createListener(socket_, listener_callbacks_, runtime_, true, false);
 
     TestUtility::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml_), upstream_tls_context_);
+    if (client_dynamic_record_sizing_.has_value()) {
+      *upstream_tls_context_.mutable_common_tls_context()->mutable_dynamic_record_sizing() =
+          *client_dynamic_record_sizing_;
+    }
     auto client_cfg =
         std::make_unique<ClientContextConfigImpl>(upstream_tls_context_, factory_context_);
 
@@ -5470,6 +5577,8 @@ protected:
   std::shared_ptr<Network::MockReadFilter> read_filter_;
   StrictMock<Network::MockConnectionCallbacks> client_callbacks_;
   Network::Address::InstanceConstSharedPtr source_address_;
+  absl::optional<envoy::extensions::transport_sockets::tls::v3::DynamicRecordSizing>
+      client_dynamic_record_sizing_;
 };
 
 INSTANTIATE_TEST_SUITE_P(
@@ -5584,6 +5693,80 @@ TEST_P(SslReadBufferLimitTest, SmallReadsIntoSameSlice) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// Verify that with dynamic record sizing, the records written are small at the start of the
+// connection and once it was idle, and full-sized otherwise.
+TEST_P(SslReadBufferLimitTest, DynamicRecordSizing) {
+  client_dynamic_record_sizing_.emplace();
+  client_dynamic_record_sizing_->mutable_initial_record_size()->set_value(1024);
+  client_dynamic_record_sizing_->mutable_ramp_up_bytes()->set_value(4096);
+  initialize();
+
+  EXPECT_CALL(listener_callbacks_, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server_connection_ = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory_->createDownstreamTransportSocket(),
+            stream_info_);
+        server_connection_->addConnectionCallbacks(server_callbacks_);
+        server_connection_->addReadFilter(read_filter_);
+      }));
+  EXPECT_CALL(client_callbacks_, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  // Record the size of the records the client writes, from their headers.
+  std::vector<uint32_t> record_sizes;
+  SSL* client_ssl =
+      dynamic_cast<const SslHandshakerImpl*>(client_connection_->ssl().get())->ssl();
+  SSL_set_msg_callback(client_ssl, [](int is_write, int, int content_type, const void* buf,
+                                      size_t len, SSL*, void* arg) {
+    if (is_write && content_type == SSL3_RT_HEADER && len == SSL3_RT_HEADER_LENGTH) {
+      const uint8_t* header = static_cast<const uint8_t*>(buf);
+      static_cast<std::vector<uint32_t>*>(arg)->push_back((header[3] << 8) | header[4]);
+    }
+  });
+  SSL_set_msg_callback_arg(client_ssl, &record_sizes);
+
+  uint64_t filter_seen = 0;
+  uint64_t bytes_written = 0;
+  EXPECT_CALL(*read_filter_, onNewConnection());
+  EXPECT_CALL(*read_filter_, onData(_, _))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> Network::FilterStatus {
+        filter_seen += data.length();
+        data.drain(data.length());
+        if (filter_seen == bytes_written) {
+          dispatcher_->exit();
+        }
+        return Network::FilterStatus::StopIteration;
+      }));
+  const auto write = [&](uint64_t bytes) {
+    record_sizes.clear();
+    bytes_written += bytes;
+    Buffer::OwnedImpl data(std::string(bytes, 'a'));
+    client_connection_->write(data, false);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  };
+  // The records are encrypted, which adds less than 64 bytes to their payload.
+  const auto small_records = [&]() {
+    return std::count_if(record_sizes.begin(), record_sizes.end(),
+                         [](uint32_t size) { return size < 1024 + 64; });
+  };
+
+  write(32 * 1024);
+  EXPECT_EQ(4, small_records());
+  ASSERT_GT(record_sizes.size(), 4);
+  EXPECT_GT(record_sizes[4], 16 * 1024);
+
+  write(32 * 1024);
+  EXPECT_EQ(0, small_records());
+
+  // The default idle timeout is 1 second.
+  time_system_.advanceTimeWait(std::chrono::seconds(2));
+  write(32 * 1024);
+  EXPECT_EQ(4, small_records());
+
+  disconnect();
+}
+
 // Test asynchronous signing (ECDHE) using a private key provider.
 TEST_P(SslSocketTest, RsaPrivateKeyProviderAsyncSignSuccess) {
   const std::string server_ctx_yaml = R"EOF(
@@ -115,6 +115,7 @@ MockListenerFilter::~MockListenerFilter() { destroy_(); }
 
 MockListenerFilterCallbacks::MockListenerFilterCallbacks() {
   ON_CALL(*this, socket()).WillByDefault(ReturnRef(socket_));
+  ON_CALL(*this, filterState()).WillByDefault(ReturnRef(filter_state_));
 }
 MockListenerFilterCallbacks::~MockListenerFilterCallbacks() = default;
 
@@ -176,6 +176,7 @@ public:
 
   MOCK_METHOD(void, onData, (UdpRecvData && data));
   MOCK_METHOD(void, onDatagramsDropped, (uint32_t dropped));
+  MOCK_METHOD(void, onPacketBuffersAcquired, (uint64_t allocated, uint64_t reused));
   MOCK_METHOD(void, onReadReady, ());
   MOCK_METHOD(void, onWriteReady, (const Socket& socket));
   MOCK_METHOD(void, onReceiveError, (Api::IoError::IoErrorCode err));
@@ -382,6 +383,7 @@ public:
   MOCK_METHOD(StreamInfo::FilterState&, filterState, (), ());
 
   NiceMock<MockConnectionSocket> socket_;
+  StreamInfo::FilterStateImpl filter_state_{StreamInfo::FilterState::LifeSpan::Connection};
 };
 
 class MockListenSocketFactory : public ListenSocketFactory {
@@ -53,7 +53,7 @@ public:
   MOCK_METHOD(uint64_t, getInteger, (absl::string_view key, uint64_t default_value), (const));
   MOCK_METHOD(double, getDouble, (absl::string_view key, double default_value), (const));
   MOCK_METHOD(bool, getBoolean, (absl::string_view key, bool default_value), (const));
-  MOCK_METHOD(const std::vector<OverrideLayerConstPtr>&, getLayers, (), (const));
+  MOCK_METHOD(const std::vector<OverrideLayerConstSharedPtr>&, getLayers, (), (const));
 };
 
 class MockLoader : public Loader {
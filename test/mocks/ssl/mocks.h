@@ -29,6 +29,13 @@ public:
   MOCK_METHOD(ServerContextSharedPtr, createSslServerContext,
               (Stats::Scope & stats, const ServerContextConfig& config,
                const std::vector<std::string>& server_names));
+  MOCK_METHOD(void, createSslServerContextDeferred,
+              (Stats::Scope & stats, const ServerContextConfig& config,
+               const std::vector<std::string>& server_names, ServerContextCb cb));
+  MOCK_METHOD(void, startServerContextBatch, ());
+  MOCK_METHOD(void, finishServerContextBatch,
+              (Thread::ThreadFactory & thread_factory, uint32_t max_threads));
+  MOCK_METHOD(void, cancelServerContextBatch, ());
   MOCK_METHOD(absl::optional<uint32_t>, daysUntilFirstCertExpires, (), (const));
   MOCK_METHOD(absl::optional<uint64_t>, secondsUntilFirstOcspResponseExpires, (), (const));
   MOCK_METHOD(void, iterateContexts, (std::function<void(const Context&)> callback));
@@ -104,6 +111,7 @@ public:
   MOCK_METHOD(const Network::Address::IpList&, tlsKeyLogRemote, (), (const));
   MOCK_METHOD(const std::string&, tlsKeyLogPath, (), (const));
   MOCK_METHOD(AccessLog::AccessLogManager&, accessLogManager, (), (const));
+  MOCK_METHOD(absl::optional<DynamicRecordSizing>, dynamicRecordSizing, (), (const));
   Ssl::HandshakerCapabilities capabilities_;
   std::string sni_{"default_sni.example.com"};
   std::string ciphers_{"RSA"};
@@ -142,6 +150,7 @@ public:
   MOCK_METHOD(const Network::Address::IpList&, tlsKeyLogRemote, (), (const));
   MOCK_METHOD(const std::string&, tlsKeyLogPath, (), (const));
   MOCK_METHOD(AccessLog::AccessLogManager&, accessLogManager, (), (const));
+  MOCK_METHOD(absl::optional<DynamicRecordSizing>, dynamicRecordSizing, (), (const));
 };
 
 class MockTlsCertificateConfig : public TlsCertificateConfig {
@@ -182,6 +191,8 @@ public:
               trustChainVerification, (), (const));
   MOCK_METHOD(bool, onlyVerifyLeafCertificateCrl, (), (const));
   MOCK_METHOD(absl::optional<uint32_t>, maxVerifyDepth, (), (const));
+  MOCK_METHOD(uint32_t, verifiedCertificateCacheMaxEntries, (), (const));
+  MOCK_METHOD(std::chrono::milliseconds, verifiedCertificateCacheTtl, (), (const));
 };
 
 class MockPrivateKeyMethodManager : public PrivateKeyMethodManager {
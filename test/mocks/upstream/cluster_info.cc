@@ -26,6 +26,7 @@ MockLoadBalancerSubsetInfo::MockLoadBalancerSubsetInfo() {
       .WillByDefault(Return(envoy::config::cluster::v3::Cluster::LbSubsetConfig::ANY_ENDPOINT));
   ON_CALL(*this, defaultSubset()).WillByDefault(ReturnRef(ProtobufWkt::Struct::default_instance()));
   ON_CALL(*this, subsetSelectors()).WillByDefault(ReturnRef(subset_selectors_));
+  ON_CALL(*this, lazySubsetIdleTimeout()).WillByDefault(Return(std::chrono::minutes(5)));
 }
 
 MockLoadBalancerSubsetInfo::~MockLoadBalancerSubsetInfo() = default;
@@ -65,6 +66,8 @@ MockClusterInfo::MockClusterInfo()
   ON_CALL(*this, connectTimeout()).WillByDefault(Return(std::chrono::milliseconds(5001)));
   ON_CALL(*this, idleTimeout()).WillByDefault(Return(absl::optional<std::chrono::milliseconds>()));
   ON_CALL(*this, perUpstreamPreconnectRatio()).WillByDefault(Return(1.0));
+  ON_CALL(*this, ratePredictivePreconnect()).WillByDefault(ReturnRef(rate_predictive_preconnect_));
+  ON_CALL(*this, warmTcpConnections()).WillByDefault(ReturnRef(warm_tcp_connections_));
   ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
   ON_CALL(*this, observabilityName()).WillByDefault(ReturnRef(observability_name_));
   ON_CALL(*this, edsServiceName()).WillByDefault(ReturnPointee(&eds_service_name_));
@@ -102,6 +105,9 @@ MockClusterInfo::MockClusterInfo()
   ON_CALL(*this, lbType()).WillByDefault(ReturnPointee(&lb_type_));
   ON_CALL(*this, lbSubsetInfo()).WillByDefault(ReturnRef(lb_subset_));
   ON_CALL(*this, lbRoundRobinConfig()).WillByDefault(ReturnRef(lb_round_robin_config_));
+  ON_CALL(*this, lbPeakEwmaConfig()).WillByDefault(ReturnRef(lb_peak_ewma_config_));
+  ON_CALL(*this, lbOrcaWeightedRoundRobinConfig())
+      .WillByDefault(ReturnRef(lb_orca_weighted_round_robin_config_));
   ON_CALL(*this, lbRingHashConfig()).WillByDefault(ReturnRef(lb_ring_hash_config_));
   ON_CALL(*this, lbMaglevConfig()).WillByDefault(ReturnRef(lb_maglev_config_));
   ON_CALL(*this, lbOriginalDstConfig()).WillByDefault(ReturnRef(lb_original_dst_config_));
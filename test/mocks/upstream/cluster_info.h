@@ -52,6 +52,8 @@ public:
   MOCK_METHOD(bool, scaleLocalityWeight, (), (const));
   MOCK_METHOD(bool, panicModeAny, (), (const));
   MOCK_METHOD(bool, listAsAny, (), (const));
+  MOCK_METHOD(bool, lazySubsetCreation, (), (const));
+  MOCK_METHOD(std::chrono::milliseconds, lazySubsetIdleTimeout, (), (const));
 
   std::vector<SubsetSelectorPtr> subset_selectors_;
 };
@@ -104,6 +106,9 @@ public:
               (const));
   MOCK_METHOD(float, perUpstreamPreconnectRatio, (), (const));
   MOCK_METHOD(float, peekaheadRatio, (), (const));
+  MOCK_METHOD(const absl::optional<RatePredictivePreconnect>&, ratePredictivePreconnect, (),
+              (const));
+  MOCK_METHOD(const absl::optional<WarmTcpConnections>&, warmTcpConnections, (), (const));
   MOCK_METHOD(uint32_t, perConnectionBufferLimitBytes, (), (const));
   MOCK_METHOD(uint64_t, features, (), (const));
   MOCK_METHOD(const Http::Http1Settings&, http1Settings, (), (const));
@@ -129,6 +134,11 @@ public:
               lbRoundRobinConfig, (), (const));
   MOCK_METHOD(const absl::optional<envoy::config::cluster::v3::Cluster::LeastRequestLbConfig>&,
               lbLeastRequestConfig, (), (const));
+  MOCK_METHOD(const absl::optional<envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig>&,
+              lbPeakEwmaConfig, (), (const));
+  MOCK_METHOD(
+      const absl::optional<envoy::config::cluster::v3::Cluster::OrcaWeightedRoundRobinLbConfig>&,
+      lbOrcaWeightedRoundRobinConfig, (), (const));
   MOCK_METHOD(const absl::optional<envoy::config::cluster::v3::Cluster::OriginalDstLbConfig>&,
               lbOriginalDstConfig, (), (const));
   MOCK_METHOD(const absl::optional<envoy::config::core::v3::TypedExtensionConfig>&, upstreamConfig,
@@ -153,6 +163,7 @@ public:
               (const));
   MOCK_METHOD(bool, drainConnectionsOnHostRemoval, (), (const));
   MOCK_METHOD(bool, connectionPoolPerDownstreamConnection, (), (const));
+  MOCK_METHOD(uint32_t, sharedConnectionPoolOwnerThreads, (), (const));
   MOCK_METHOD(bool, warmHosts, (), (const));
   MOCK_METHOD(bool, setLocalInterfaceNameOnUpstreamConnections, (), (const));
   MOCK_METHOD(const absl::optional<envoy::config::core::v3::UpstreamHttpProtocolOptions>&,
@@ -212,7 +223,12 @@ public:
       upstream_http_protocol_options_;
   absl::optional<envoy::config::core::v3::AlternateProtocolsCacheOptions>
       alternate_protocols_cache_options_;
+  absl::optional<RatePredictivePreconnect> rate_predictive_preconnect_;
+  absl::optional<WarmTcpConnections> warm_tcp_connections_;
   absl::optional<envoy::config::cluster::v3::Cluster::RoundRobinLbConfig> lb_round_robin_config_;
+  absl::optional<envoy::config::cluster::v3::Cluster::PeakEwmaLbConfig> lb_peak_ewma_config_;
+  absl::optional<envoy::config::cluster::v3::Cluster::OrcaWeightedRoundRobinLbConfig>
+      lb_orca_weighted_round_robin_config_;
   absl::optional<envoy::config::cluster::v3::Cluster::RingHashLbConfig> lb_ring_hash_config_;
   absl::optional<envoy::config::cluster::v3::Cluster::MaglevLbConfig> lb_maglev_config_;
   absl::optional<envoy::config::cluster::v3::Cluster::OriginalDstLbConfig> lb_original_dst_config_;
@@ -30,6 +30,12 @@ MockDetector::~MockDetector() = default;
 MockHealthCheckHostMonitor::MockHealthCheckHostMonitor() = default;
 MockHealthCheckHostMonitor::~MockHealthCheckHostMonitor() = default;
 
+MockResponseTimeEstimator::MockResponseTimeEstimator() = default;
+MockResponseTimeEstimator::~MockResponseTimeEstimator() = default;
+
+MockUtilizationWeight::MockUtilizationWeight() = default;
+MockUtilizationWeight::~MockUtilizationWeight() = default;
+
 MockHostDescription::MockHostDescription()
     : address_(Network::Utility::resolveUrl("tcp://10.0.0.1:443")),
       socket_factory_(new testing::NiceMock<Network::MockTransportSocketFactory>) {
@@ -38,6 +44,8 @@ MockHostDescription::MockHostDescription()
   ON_CALL(*this, outlierDetector()).WillByDefault(ReturnRef(outlier_detector_));
   ON_CALL(*this, stats()).WillByDefault(ReturnRef(stats_));
   ON_CALL(*this, loadMetricStats()).WillByDefault(ReturnRef(load_metric_stats_));
+  ON_CALL(*this, responseTimeEstimator()).WillByDefault(ReturnRef(response_time_estimator_));
+  ON_CALL(*this, utilizationWeight()).WillByDefault(ReturnRef(utilization_weight_));
   ON_CALL(*this, locality()).WillByDefault(ReturnRef(locality_));
   ON_CALL(*this, cluster()).WillByDefault(ReturnRef(cluster_));
   ON_CALL(*this, healthChecker()).WillByDefault(ReturnRef(health_checker_));
@@ -55,6 +63,8 @@ MockHost::MockHost() : socket_factory_(new testing::NiceMock<Network::MockTransp
   ON_CALL(*this, outlierDetector()).WillByDefault(ReturnRef(outlier_detector_));
   ON_CALL(*this, stats()).WillByDefault(ReturnRef(stats_));
   ON_CALL(*this, loadMetricStats()).WillByDefault(ReturnRef(load_metric_stats_));
+  ON_CALL(*this, responseTimeEstimator()).WillByDefault(ReturnRef(response_time_estimator_));
+  ON_CALL(*this, utilizationWeight()).WillByDefault(ReturnRef(utilization_weight_));
   ON_CALL(*this, warmed()).WillByDefault(Return(true));
   ON_CALL(*this, transportSocketFactory()).WillByDefault(ReturnRef(*socket_factory_));
 }
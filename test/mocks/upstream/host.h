@@ -77,6 +77,26 @@ public:
   MOCK_METHOD(void, setUnhealthy, (UnhealthyType));
 };
 
+class MockResponseTimeEstimator : public ResponseTimeEstimator {
+public:
+  MockResponseTimeEstimator();
+  ~MockResponseTimeEstimator() override;
+
+  MOCK_METHOD(void, add, (std::chrono::milliseconds response_time));
+  MOCK_METHOD(double, estimate, (), (const));
+};
+
+class MockUtilizationWeight : public UtilizationWeight {
+public:
+  MockUtilizationWeight();
+  ~MockUtilizationWeight() override;
+
+  MOCK_METHOD(void, update, (double rps, double utilization));
+  MOCK_METHOD(double, weight,
+              (std::chrono::milliseconds blackout_period,
+               std::chrono::milliseconds expiration_period));
+};
+
 class MockHostDescription : public HostDescription {
 public:
   MockHostDescription();
@@ -99,6 +119,8 @@ public:
   MOCK_METHOD(Network::UpstreamTransportSocketFactory&, transportSocketFactory, (), (const));
   MOCK_METHOD(HostStats&, stats, (), (const));
   MOCK_METHOD(LoadMetricStats&, loadMetricStats, (), (const));
+  MOCK_METHOD(ResponseTimeEstimator&, responseTimeEstimator, (), (const));
+  MOCK_METHOD(UtilizationWeight&, utilizationWeight, (), (const));
   MOCK_METHOD(const envoy::config::core::v3::Locality&, locality, (), (const));
   MOCK_METHOD(uint32_t, priority, (), (const));
   MOCK_METHOD(void, priority, (uint32_t));
@@ -118,6 +140,8 @@ public:
   testing::NiceMock<MockClusterInfo> cluster_;
   HostStats stats_;
   LoadMetricStatsImpl load_metric_stats_;
+  testing::NiceMock<MockResponseTimeEstimator> response_time_estimator_;
+  testing::NiceMock<MockUtilizationWeight> utilization_weight_;
   envoy::config::core::v3::Locality locality_;
   mutable Stats::TestUtil::TestSymbolTable symbol_table_;
   mutable std::unique_ptr<Stats::StatNameManagedStorage> locality_zone_stat_name_;
@@ -194,6 +218,8 @@ public:
   MOCK_METHOD(void, setOutlierDetector_, (Outlier::DetectorHostMonitorPtr & outlier_detector));
   MOCK_METHOD(HostStats&, stats, (), (const));
   MOCK_METHOD(LoadMetricStats&, loadMetricStats, (), (const));
+  MOCK_METHOD(ResponseTimeEstimator&, responseTimeEstimator, (), (const));
+  MOCK_METHOD(UtilizationWeight&, utilizationWeight, (), (const));
   MOCK_METHOD(uint32_t, weight, (), (const));
   MOCK_METHOD(void, weight, (uint32_t new_weight));
   MOCK_METHOD(bool, used, (), (const));
@@ -210,6 +236,8 @@ public:
   testing::NiceMock<Outlier::MockDetectorHostMonitor> outlier_detector_;
   HostStats stats_;
   LoadMetricStatsImpl load_metric_stats_;
+  testing::NiceMock<MockResponseTimeEstimator> response_time_estimator_;
+  testing::NiceMock<MockUtilizationWeight> utilization_weight_;
   mutable Stats::TestUtil::TestSymbolTable symbol_table_;
   mutable std::unique_ptr<Stats::StatNameManagedStorage> locality_zone_stat_name_;
 };
@@ -6,12 +6,14 @@
 #include "source/common/network/listen_socket_impl.h"
 #include "source/common/network/socket_option_factory.h"
 #include "source/common/network/udp_packet_writer_handler_impl.h"
+#include "source/common/network/utility.h"
 #include "source/server/active_udp_listener.h"
 
 #include "test/mocks/network/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -43,6 +45,9 @@ public:
                              config),
         destination_(worker_index) {}
   uint32_t destination(const Network::UdpRecvData&) const override { return destination_; }
+  uint32_t listenerDestination(const Network::UdpRecvData& data) const {
+    return ActiveRawUdpListener::destination(data);
+  }
 
   uint32_t destination_;
 };
@@ -54,8 +59,9 @@ public:
       : version_(GetParam()), local_address_(Network::Test::getCanonicalLoopbackAddress(version_)) {
   }
 
-  void setup(uint32_t concurrency = 1) {
+  void setup(uint32_t concurrency = 1, bool route_by_address_hash = false) {
     udp_listener_config_ = std::make_unique<NiceMock<Network::MockUdpListenerConfig>>(2);
+    udp_listener_config_->config_.set_route_by_address_hash(route_by_address_hash);
     ON_CALL(conn_handler_, dispatcher()).WillByDefault(ReturnRef(dispatcher_));
     EXPECT_CALL(conn_handler_, statPrefix()).WillRepeatedly(ReturnRef(listener_stat_prefix_));
 
@@ -224,6 +230,34 @@ TEST_P(ActiveUdpListenerTest, UdpListenerWorkerRouterTest) {
   EXPECT_CALL(*another_udp_listener, onDestroy());
 }
 
+TEST_P(ActiveUdpListenerTest, RouteToReceivingWorker) {
+  setup(2);
+
+  Network::UdpRecvData data;
+  data.addresses_.local_ = local_address_;
+  for (uint32_t port = 1000; port < 1100; ++port) {
+    data.addresses_.peer_ = Network::Utility::getAddressWithPort(*local_address_, port);
+    EXPECT_EQ(0, active_listener_->listenerDestination(data));
+  }
+}
+
+TEST_P(ActiveUdpListenerTest, RouteByAddressHash) {
+  setup(2, true);
+
+  // Each flow is always routed to the same worker, and flows are spread across the workers.
+  absl::flat_hash_set<uint32_t> workers;
+  Network::UdpRecvData data;
+  data.addresses_.local_ = local_address_;
+  for (uint32_t port = 1000; port < 1100; ++port) {
+    data.addresses_.peer_ = Network::Utility::getAddressWithPort(*local_address_, port);
+    const uint32_t worker = active_listener_->listenerDestination(data);
+    EXPECT_LT(worker, 2u);
+    EXPECT_EQ(worker, active_listener_->listenerDestination(data));
+    workers.insert(worker);
+  }
+  EXPECT_EQ(2, workers.size());
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
@@ -249,13 +249,13 @@ TEST_P(AdminInstanceTest, StatsWithMultipleChunks) {
   // easily be changed from this test. This covers a bug fix due to
   // AdminImpl::runRunCallback not draining the buffer after each chunk, which
   // it is not required to do. This test ensures that StatsRequest::nextChunk
-  // writes up to StatsRequest::DefaultChunkSize *additional* bytes on each
+  // writes up to Utility::DefaultChunkSize *additional* bytes on each
   // call.
   const std::string prefix(1000, 'a');
   uint32_t expected_size = 0;
 
   // Declare enough counters so that we are sure to exceed the chunk size.
-  const uint32_t n = (StatsRequest::DefaultChunkSize + prefix.size() / 2) / prefix.size() + 1;
+  const uint32_t n = (Utility::DefaultChunkSize + prefix.size() / 2) / prefix.size() + 1;
   for (uint32_t i = 0; i <= n; ++i) {
     const std::string name = absl::StrCat(prefix, i);
     store.counterFromString(name);
@@ -263,7 +263,7 @@ TEST_P(AdminInstanceTest, StatsWithMultipleChunks) {
   }
   EXPECT_EQ(Http::Code::OK, getCallback("/stats", header_map, response));
   EXPECT_LT(expected_size, response.length());
-  EXPECT_LT(StatsRequest::DefaultChunkSize, response.length());
+  EXPECT_LT(Utility::DefaultChunkSize, response.length());
   EXPECT_THAT(response.toString(), StartsWith(absl::StrCat(prefix, "0: 0\n", prefix)));
 }
 
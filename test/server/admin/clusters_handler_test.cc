@@ -240,5 +240,85 @@ fake_cluster::1.2.3.4:80::local_origin_success_rate::93.2
   EXPECT_EQ(expected_text, response2.toString());
 }
 
+TEST_P(AdminInstanceTest, ClustersJsonAndTextMultipleClusters) {
+  Upstream::ClusterManager::ClusterInfoMaps cluster_maps;
+  ON_CALL(server_.cluster_manager_, clusters()).WillByDefault(ReturnPointee(&cluster_maps));
+
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster1;
+  cluster1.info_->name_ = "cluster_1";
+  cluster_maps.active_clusters_.emplace(cluster1.info_->name_, cluster1);
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster2;
+  cluster2.info_->name_ = "cluster_2";
+  cluster_maps.active_clusters_.emplace(cluster2.info_->name_, cluster2);
+
+  Buffer::OwnedImpl response;
+  Http::TestResponseHeaderMapImpl header_map;
+  EXPECT_EQ(Http::Code::OK, getCallback("/clusters?format=json", header_map, response));
+  envoy::admin::v3::Clusters output_proto;
+  TestUtility::loadFromJson(response.toString(), output_proto);
+  std::vector<std::string> names;
+  for (const auto& cluster_status : output_proto.cluster_statuses()) {
+    names.push_back(cluster_status.name());
+  }
+  EXPECT_THAT(names, testing::UnorderedElementsAre("cluster_1", "cluster_2"));
+
+  Buffer::OwnedImpl response2;
+  EXPECT_EQ(Http::Code::OK, getCallback("/clusters", header_map, response2));
+  EXPECT_THAT(response2.toString(), testing::HasSubstr("cluster_1::added_via_api::false\n"));
+  EXPECT_THAT(response2.toString(), testing::HasSubstr("cluster_2::added_via_api::false\n"));
+}
+
+// Test that the status streamed out in many chunks, each holding a single cluster, is identical to
+// the one streamed out in a single chunk.
+TEST_P(AdminInstanceTest, ClustersJsonAndTextInMultipleChunks) {
+  Upstream::ClusterManager::ClusterInfoMaps cluster_maps;
+  ON_CALL(server_.cluster_manager_, clusters()).WillByDefault(ReturnPointee(&cluster_maps));
+
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster1;
+  cluster1.info_->name_ = "cluster_1";
+  cluster_maps.active_clusters_.emplace(cluster1.info_->name_, cluster1);
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster2;
+  cluster2.info_->name_ = "cluster_2";
+  cluster_maps.active_clusters_.emplace(cluster2.info_->name_, cluster2);
+  NiceMock<Upstream::MockClusterMockPrioritySet> cluster3;
+  cluster3.info_->name_ = "cluster_3";
+  cluster_maps.active_clusters_.emplace(cluster3.info_->name_, cluster3);
+
+  ClustersHandler handler(server_);
+  for (const std::string path : {"/clusters", "/clusters?format=json"}) {
+    Buffer::OwnedImpl expected;
+    Http::TestResponseHeaderMapImpl header_map;
+    EXPECT_EQ(Http::Code::OK, getCallback(path, header_map, expected));
+
+    request_headers_.setMethod(Http::Headers::get().MethodValues.Get);
+    request_headers_.setPath(path);
+    admin_filter_.decodeHeaders(request_headers_, false);
+    Admin::RequestPtr request = handler.makeRequest(admin_filter_, 1);
+    EXPECT_EQ(Http::Code::OK, request->start(header_map));
+
+    Buffer::OwnedImpl response;
+    Buffer::OwnedImpl chunk;
+    uint32_t num_chunks = 1;
+    while (request->nextChunk(chunk)) {
+      response.move(chunk);
+      ++num_chunks;
+    }
+    response.move(chunk);
+    EXPECT_EQ(3, num_chunks) << path;
+    EXPECT_EQ(expected.toString(), response.toString()) << path;
+  }
+}
+
+TEST_P(AdminInstanceTest, ClustersJsonNoClusters) {
+  Upstream::ClusterManager::ClusterInfoMaps cluster_maps;
+  ON_CALL(server_.cluster_manager_, clusters()).WillByDefault(ReturnPointee(&cluster_maps));
+
+  Buffer::OwnedImpl response;
+  Http::TestResponseHeaderMapImpl header_map;
+  EXPECT_EQ(Http::Code::OK, getCallback("/clusters?format=json", header_map, response));
+  EXPECT_EQ(MessageUtil::getJsonStringFromMessageOrError(envoy::admin::v3::Clusters(), true),
+            response.toString());
+}
+
 } // namespace Server
 } // namespace Envoy
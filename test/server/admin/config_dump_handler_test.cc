@@ -1,3 +1,5 @@
+#include "envoy/admin/v3/config_dump.pb.h"
+
 #include "test/server/admin/admin_instance.h"
 
 using testing::HasSubstr;
@@ -115,6 +117,84 @@ TEST_P(AdminInstanceTest, ConfigDumpMaintainsOrder) {
   }
 }
 
+// Test that configs are rendered as the dump is streamed out, so the callbacks of configs in later
+// chunks are not invoked until those chunks are requested.
+TEST_P(AdminInstanceTest, ConfigDumpStreamsConfigsInChunks) {
+  const std::string value(Utility::DefaultChunkSize * 3 / 4, 'a');
+  uint32_t num_dumped = 0;
+  std::vector<ConfigTracker::EntryOwnerPtr> entries;
+  for (const std::string name : {"a", "b", "c"}) {
+    entries.push_back(admin_.getConfigTracker().add(
+        name, [&value, &num_dumped](const Matchers::StringMatcher&) {
+          ++num_dumped;
+          auto msg = std::make_unique<ProtobufWkt::StringValue>();
+          msg->set_value(value);
+          return msg;
+        }));
+  }
+
+  request_headers_.setMethod(Http::Headers::get().MethodValues.Get);
+  request_headers_.setPath("/config_dump");
+  admin_filter_.decodeHeaders(request_headers_, false);
+  Admin::RequestPtr request = admin_.createRequestFunction()(admin_filter_);
+  Http::TestResponseHeaderMapImpl header_map;
+  EXPECT_EQ(Http::Code::OK, request->start(header_map));
+  EXPECT_EQ(0, num_dumped);
+
+  Buffer::OwnedImpl response;
+  Buffer::OwnedImpl chunk;
+  EXPECT_TRUE(request->nextChunk(chunk));
+  EXPECT_EQ(2, num_dumped);
+  response.move(chunk);
+  EXPECT_FALSE(request->nextChunk(chunk));
+  EXPECT_EQ(3, num_dumped);
+  response.move(chunk);
+
+  envoy::admin::v3::ConfigDump dump;
+  TestUtility::loadFromJson(response.toString(), dump);
+  ASSERT_EQ(3, dump.configs_size());
+  for (const auto& config : dump.configs()) {
+    ProtobufWkt::StringValue string_value;
+    config.UnpackTo(&string_value);
+    EXPECT_EQ(value, string_value.value());
+  }
+}
+
+// Test that a dump streamed out in many chunks, each holding a single config, is identical to the
+// one streamed out in a single chunk.
+TEST_P(AdminInstanceTest, ConfigDumpInMultipleChunks) {
+  std::vector<ConfigTracker::EntryOwnerPtr> entries;
+  for (const std::string name : {"a", "b", "c", "d"}) {
+    entries.push_back(admin_.getConfigTracker().add(name, [name](const Matchers::StringMatcher&) {
+      auto msg = std::make_unique<ProtobufWkt::StringValue>();
+      msg->set_value(absl::StrCat(name, "_config"));
+      return msg;
+    }));
+  }
+  Buffer::OwnedImpl expected;
+  Http::TestResponseHeaderMapImpl header_map;
+  EXPECT_EQ(Http::Code::OK, getCallback("/config_dump", header_map, expected));
+
+  request_headers_.setMethod(Http::Headers::get().MethodValues.Get);
+  request_headers_.setPath("/config_dump");
+  admin_filter_.decodeHeaders(request_headers_, false);
+  ConfigDumpHandler handler(admin_.getConfigTracker(), server_);
+  Admin::RequestPtr request = handler.makeRequest(admin_filter_, 1);
+  EXPECT_EQ(Http::Code::OK, request->start(header_map));
+
+  Buffer::OwnedImpl response;
+  Buffer::OwnedImpl chunk;
+  uint32_t num_chunks = 1;
+  while (request->nextChunk(chunk)) {
+    response.move(chunk);
+    ++num_chunks;
+  }
+  response.move(chunk);
+  // One chunk per config, and a last one closing the dump.
+  EXPECT_EQ(5, num_chunks);
+  EXPECT_EQ(expected.toString(), response.toString());
+}
+
 // Test that using ?include_eds parameter adds EDS to the config dump.
 TEST_P(AdminInstanceTest, ConfigDumpWithEndpoint) {
   Upstream::ClusterManager::ClusterInfoMaps cluster_maps;
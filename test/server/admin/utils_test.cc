@@ -1,5 +1,7 @@
+#include "envoy/admin/v3/clusters.pb.h"
 #include "envoy/http/query_params.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/server/admin/utils.h"
 
 #include "test/test_common/utility.h"
@@ -55,5 +57,25 @@ TEST_F(UtilsTest, QueryParam) {
   EXPECT_EQ("value", Utility::queryParam(query_, "key").value());
 }
 
+// The streamed JSON must match pretty-printing the whole message, which is what admin endpoints
+// returned before they were streamed.
+TEST_F(UtilsTest, RepeatedFieldJsonStreamer) {
+  envoy::admin::v3::Clusters clusters;
+  for (uint32_t i = 0; i < 3; ++i) {
+    Buffer::OwnedImpl response;
+    Utility::RepeatedFieldJsonStreamer streamer(envoy::admin::v3::Clusters::default_instance(),
+                                                "cluster_statuses");
+    for (const auto& cluster_status : clusters.cluster_statuses()) {
+      streamer.addElement(cluster_status, response);
+    }
+    streamer.finish(response);
+    EXPECT_EQ(MessageUtil::getJsonStringFromMessageOrError(clusters, true), response.toString());
+
+    auto* cluster_status = clusters.add_cluster_statuses();
+    cluster_status->set_name(absl::StrCat("cluster_", i));
+    cluster_status->add_host_statuses()->set_hostname("line\nbreak");
+  }
+}
+
 } // namespace Server
 } // namespace Envoy
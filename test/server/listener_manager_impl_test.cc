@@ -5065,6 +5065,58 @@ TEST_P(ListenerManagerImplWithRealFiltersTest, TlsCertificateIncomplete) {
                             "Failed to load incomplete private key from path: ");
 }
 
+// The server TLS contexts queued by filter chains that were built before another one failed are
+// dropped along with their socket factories, and the next listener gets a batch of its own.
+TEST_P(ListenerManagerImplWithRealFiltersTest, TlsContextBatchCancelledOnFilterChainFailure) {
+  const std::string good_filter_chain = R"EOF(
+    - name: good
+      filter_chain_match: { destination_port: 8080 }
+      transport_socket:
+        name: tls
+        typed_config:
+          "@type": type.googleapis.com/envoy.extensions.transport_sockets.tls.v3.DownstreamTlsContext
+          common_tls_context:
+            tls_certificates:
+              - certificate_chain: { filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns3_chain.pem" }
+                private_key: { filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns3_key.pem" }
+  )EOF";
+  const std::string bad_filter_chain = R"EOF(
+    - name: bad
+      filter_chain_match: { destination_port: 8081 }
+      transport_socket:
+        name: tls
+        typed_config:
+          "@type": type.googleapis.com/envoy.extensions.transport_sockets.tls.v3.DownstreamTlsContext
+          common_tls_context:
+            tls_certificates:
+              - certificate_chain: { filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns3_chain.pem" }
+  )EOF";
+  const std::string listener = R"EOF(
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    filter_chains:
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(
+      addOrUpdateListener(parseListenerFromV3Yaml(TestEnvironment::substitute(
+          absl::StrCat(listener, good_filter_chain, bad_filter_chain),
+          Network::Address::IpVersion::v4))),
+      EnvoyException, "Failed to load incomplete private key from path: ");
+  size_t contexts = 0;
+  server_.ssl_context_manager_.iterateContexts(
+      [&contexts](const Envoy::Ssl::Context&) { ++contexts; });
+  EXPECT_EQ(0, contexts);
+
+  EXPECT_CALL(server_.api_.random_, uuid());
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _, default_bind_type, _, 0));
+  addOrUpdateListener(parseListenerFromV3Yaml(TestEnvironment::substitute(
+      absl::StrCat(listener, good_filter_chain), Network::Address::IpVersion::v4)));
+  EXPECT_EQ(1U, manager_->listeners().size());
+  server_.ssl_context_manager_.iterateContexts(
+      [&contexts](const Envoy::Ssl::Context&) { ++contexts; });
+  EXPECT_EQ(1, contexts);
+}
+
 TEST_P(ListenerManagerImplWithRealFiltersTest, TlsCertificateInvalidCertificateChain) {
   const std::string yaml = TestEnvironment::substitute(R"EOF(
     address:
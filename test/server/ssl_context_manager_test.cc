@@ -2,6 +2,7 @@
 
 #include "source/server/ssl_context_manager.h"
 
+#include "test/mocks/runtime/mocks.h"
 #include "test/mocks/ssl/mocks.h"
 #include "test/mocks/stats/mocks.h"
 #include "test/test_common/simulated_time_system.h"
@@ -15,12 +16,13 @@ namespace {
 
 TEST(SslContextManager, createStub) {
   Event::SimulatedTimeSystem time_system;
+  testing::NiceMock<Runtime::MockLoader> runtime;
   Stats::MockStore scope;
   Ssl::MockClientContextConfig client_config;
   Ssl::MockServerContextConfig server_config;
   std::vector<std::string> server_names;
 
-  Ssl::ContextManagerPtr manager = createContextManager("fake_factory_name", time_system);
+  Ssl::ContextManagerPtr manager = createContextManager("fake_factory_name", time_system, runtime);
 
   // Check we've created a stub, not real manager.
   EXPECT_EQ(manager->daysUntilFirstCertExpires().value(), std::numeric_limits<uint32_t>::max());
@@ -29,6 +31,10 @@ TEST(SslContextManager, createStub) {
                             "SSL is not supported in this configuration");
   EXPECT_THROW_WITH_MESSAGE(manager->createSslServerContext(scope, server_config, server_names),
                             EnvoyException, "SSL is not supported in this configuration");
+  EXPECT_THROW_WITH_MESSAGE(manager->createSslServerContextDeferred(
+                                scope, server_config, server_names,
+                                [](Ssl::ServerContextSharedPtr) -> void {}),
+                            EnvoyException, "SSL is not supported in this configuration");
   EXPECT_NO_THROW(manager->iterateContexts([](const Envoy::Ssl::Context&) -> void {}));
 }
 